@@ -0,0 +1,96 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Size class arena allocator.  Allows many containers to share one pool of memory that can be released all at once
+
+/// Arena allocator
+///
+/// Small allocations are rounded up to a power of two size class and served by a { @link cr8r_sla } for that class,
+/// so freeing and reallocating them is O(1) and never returns memory to the system until the arena is reset or deleted.
+/// Allocations larger than the largest size class are passed through to malloc, but are tracked by the arena so they
+/// are released together with everything else.  Frees are sized: the caller must pass the same size it allocated with,
+/// which all container callbacks know anyway.  Every container in this library has default callbacks which allocate
+/// from an arena pointed to by ft->base.data, see { @link cr8r_default_resize_arena }, { @link cr8r_default_alloc_arena_avl },
+/// { @link cr8r_default_alloc_arena_cll }, { @link cr8r_default_alloc_arena_pheap }, and { @link cr8r_default_alloc_arena }.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <crater/container.h>
+#include <crater/sla.h>
+
+/// log2 of the smallest size class
+#define CR8R_ARENA_MIN_CLASS_LOG 4
+/// Number of size classes.  Size classes are 16, 32, ..., 4096 bytes
+#define CR8R_ARENA_NUM_CLASSES 9
+/// Size of the first slab allocated for each size class, in bytes
+#define CR8R_ARENA_SLAB_BYTES 16384
+
+typedef struct{
+	/// Slab allocator for each size class.  Initialized lazily the first time a size class is used, so
+	/// an arena which only ever holds one kind of node only reserves memory for that node size.
+	cr8r_sla classes[CR8R_ARENA_NUM_CLASSES];
+	/// Doubly linked list of allocations too large for any size class
+	void *large;
+} cr8r_arena;
+
+/// Initialize an arena
+///
+/// No memory is reserved until the first allocation.  A zero initialized arena is also valid.
+/// @param [out] self: arena to initialize
+void cr8r_arena_init(cr8r_arena *self);
+
+/// Delete an arena
+///
+/// Frees all memory owned by the arena.  All pointers allocated from it are invalidated.
+/// @param [in, out] self: arena to delete
+void cr8r_arena_delete(cr8r_arena *self);
+
+/// Free everything allocated from an arena at once
+///
+/// Calls { @link cr8r_sla_reset } on every size class and frees all large allocations.
+/// Containers using the arena should simply be forgotten (or zeroed) rather than deleted after this.
+/// @param [in, out] self: arena to reset
+/// @param [in] release: if true, return all but the first slab of each size class to the system, otherwise keep them for reuse
+void cr8r_arena_reset(cr8r_arena *self, bool release);
+
+/// Allocate memory from an arena
+///
+/// The result is aligned to 16 bytes.
+/// @param [in, out] self: arena to allocate from
+/// @param [in] size: number of bytes to allocate.  must not be 0
+/// @return pointer to uninitialized memory, or NULL on allocation failure
+void *cr8r_arena_alloc(cr8r_arena *self, uint64_t size);
+
+/// Allocate zeroed memory from an arena
+///
+/// Like { @link cr8r_arena_alloc } but the memory is zeroed, like calloc
+/// @param [in, out] self: arena to allocate from
+/// @param [in] size: number of bytes to allocate.  must not be 0
+/// @return pointer to zeroed memory, or NULL on allocation failure
+void *cr8r_arena_calloc(cr8r_arena *self, uint64_t size);
+
+/// Resize an allocation from an arena
+///
+/// Like realloc, the contents are preserved up to the smaller of the two sizes.
+/// If both sizes fall in the same size class, p is returned unchanged.
+/// @param [in, out] self: arena p was allocated from
+/// @param [in] p: allocation to resize, or NULL to allocate a new buffer
+/// @param [in] old_size: size p was allocated with (ignored if p is NULL)
+/// @param [in] new_size: size to resize to.  must not be 0
+/// @return pointer to the resized allocation, or NULL on failure (in which case p is still valid)
+void *cr8r_arena_realloc(cr8r_arena *self, void *p, uint64_t old_size, uint64_t new_size);
+
+/// Free memory allocated from an arena
+///
+/// @param [in, out] self: arena p was allocated from
+/// @param [in] p: allocation to free.  NULL is ignored
+/// @param [in] size: size p was allocated with
+void cr8r_arena_free(cr8r_arena *self, void *p, uint64_t size);
+
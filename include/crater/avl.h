@@ -15,6 +15,7 @@
 
 #include <crater/container.h>
 #include <crater/sla.h>
+#include <crater/stats.h>
 
 /// An avl tree node, also used to store an entire tree by synecdoche.
 /// The data field is a flexible length array in which any element type (uint64_t, custom struct, etc) can be stored.
@@ -117,6 +118,17 @@ bool cr8r_avl_ft_initsla(cr8r_avl_ft*,
 	int (*add)(cr8r_base_ft*, void*, void*)
 );
 
+/// ft->alloc implementation for avl trees
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+/// Allocates offsetof(cr8r_avl_node, data) + ft->base.size bytes.
+void *cr8r_default_alloc_arena_avl(cr8r_base_ft*);
+
+/// ft->free implementation for avl trees
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+void cr8r_default_free_arena_avl(cr8r_base_ft*, void*);
+
 /// Allocate a new avl node and initialize it with given data
 ///
 /// Remember that ft->alloc(ft->base.data) will be called to allocate the node
@@ -323,6 +335,13 @@ cr8r_avl_node *cr8r_avl_heappop_node(cr8r_avl_node **r, cr8r_avl_ft*);
 /// @param [in, out] r: root of the tree to reorder, reordering is in place and does not change the root
 void cr8r_avl_reorder(cr8r_avl_node *r, cr8r_avl_ft*);
 
+/// Compute snapshot statistics for an avl tree
+///
+/// Visits every node, so this takes linear time.
+/// @param [in] r: root of the tree (can be NULL)
+/// @param [out] stats: statistics to fill in
+void cr8r_avl_get_stats(const cr8r_avl_node *r, cr8r_avl_stats *stats);
+
 /// Get a pointer to the data field of an avl node and cast to a given type
 #define CR8R_AVL_DATA(T, n) CR8R_FLA_CAST(T, (char*)((cr8r_avl_node*)(n))->data)
 
@@ -238,6 +238,13 @@ bool cr8r_bvec_any(const cr8r_bvec*);
 /// Count the number of bits set
 uint64_t cr8r_bvec_popcount(const cr8r_bvec*);
 
+/// Count the number of bits set in both a and b, ie the popcount of a & b, without modifying either
+///
+/// If one vector is shorter, missing bits are treated as zero.
+/// Together with { @link cr8r_bvec_popcount } this gives the Jaccard similarity |a & b|/|a | b|,
+/// since |a | b| = |a| + |b| - |a & b|.
+uint64_t cr8r_bvec_popcount_and(const cr8r_bvec *a, const cr8r_bvec *b);
+
 /// Count leading zeros (starting from the largest index self->len - 1)
 uint64_t cr8r_bvec_clz(const cr8r_bvec*);
 
@@ -267,6 +274,24 @@ void cr8r_bvec_ior(cr8r_bvec *self, const cr8r_bvec *other);
 /// If the other vector is shorter, missing bits are treated as zero
 void cr8r_bvec_ixor(cr8r_bvec *self, const cr8r_bvec *other);
 
+/// Bitwise and not (&= ~) a bit vector with another in place, ie clear the bits which are set in other
+/// If the other vector is shorter, missing bits are treated as zero
+void cr8r_bvec_iandnot(cr8r_bvec *self, const cr8r_bvec *other);
+
+/// Bitwise and (&=) a bit vector with many others in place
+///
+/// Equivalent to calling { @link cr8r_bvec_iand } with each of the others in turn, but works on one block of self
+/// at a time so that it stays in cache, so self is only read from and written to memory once.
+/// @param [in] others: array of n bit vectors, which may include self
+void cr8r_bvec_iand_many(cr8r_bvec *self, const cr8r_bvec *const *others, uint64_t n);
+
+/// Bitwise or (|=) a bit vector with many others in place
+///
+/// Equivalent to calling { @link cr8r_bvec_ior } with each of the others in turn, but works on one block of self
+/// at a time so that it stays in cache, so self is only read from and written to memory once.
+/// @param [in] others: array of n bit vectors, which may include self
+void cr8r_bvec_ior_many(cr8r_bvec *self, const cr8r_bvec *const *others, uint64_t n);
+
 /// Test if any bit in the range [a, b) is set
 /// If the range is invalid, 0 is returned.
 bool cr8r_bvec_any_range(const cr8r_bvec*, uint64_t a, uint64_t b);
@@ -101,6 +101,18 @@ bool cr8r_cll_ft_initsla(cr8r_cll_ft*,
 	int (*cmp)(const cr8r_base_ft*, const void*, const void*)
 );
 
+/// ft->alloc implementation for circular lists
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+/// Allocates offsetof(cr8r_cll_node, data) + ft->base.size bytes.
+void *cr8r_default_alloc_arena_cll(cr8r_base_ft*);
+
+/// ft->del implementation for circular lists
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+/// Elements which own resources need a custom ft->del which cleans them up and then calls this.
+void cr8r_default_free_arena_cll(cr8r_base_ft*, void*);
+
 
 /// Allocate a new list node and initialize it with given data
 ///
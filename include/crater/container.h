@@ -11,7 +11,7 @@
 /// @section DESCRIPTION
 /// Crater is a collection of generic data structures for C, including vectors,
 /// avl trees, heaps (binary, pairing, and minmax), kd trees, linked lists,
-/// hash tables, slab allocators, random number generators, and option parsing
+/// hash tables, slab and arena allocators, random number generators, and option parsing
 
 #include <inttypes.h>
 
@@ -143,6 +143,57 @@ void *cr8r_default_alloc_sla(cr8r_base_ft*);
 /// See { @link cr8r_cll_ft_initsla } and { @link cr8r_cll_ft_initsla }.
 void cr8r_default_free_sla(cr8r_base_ft*, void*);
 
+/// ft->resize implementation (for vectors)
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+/// Each buffer is prefixed by a small header recording its capacity, since the arena needs to know
+/// the size of an allocation to free it.  Buffers must only be resized by this function.
+/// @param [in] p: the buffer to resize
+/// @param [in] cap: the capacity to resize to
+/// @return a pointer to the resized buffer, or NULL on failure or if cap is 0
+void *cr8r_default_resize_arena(cr8r_base_ft*, void *p, uint64_t cap);
+
+/// ft->alloc implementation (for hash tables)
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+/// Like calloc, the returned memory is zeroed.
+/// @param [in] size: the number of bytes to allocate
+/// @return a pointer to the zeroed allocation, or NULL on failure
+void *cr8r_default_alloc_arena(const cr8r_base_ft*, uint64_t size);
+
+/// ft->free implementation (for hash tables)
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+/// @param [in] p: the allocation to free
+/// @param [in] size: the size p was allocated with
+void cr8r_default_free_arena(const cr8r_base_ft*, void *p, uint64_t size);
+
+/// ft->resize implementation (for vectors) using hugepages for large buffers
+///
+/// ft->base.data must be NULL or point to a { @link cr8r_hugemem } configuration.
+/// Buffers at least as large as the configured threshold are mapped with mmap and grown with mremap,
+/// smaller ones use malloc.  Each buffer is prefixed by a small header recording how it was allocated,
+/// so buffers must only be resized by this function.
+/// @param [in] p: the buffer to resize
+/// @param [in] cap: the capacity to resize to
+/// @return a pointer to the resized buffer, or NULL on failure or if cap is 0
+void *cr8r_default_resize_huge(cr8r_base_ft*, void *p, uint64_t cap);
+
+/// ft->alloc implementation (for hash tables) using hugepages for large tables
+///
+/// ft->base.data must be NULL or point to a { @link cr8r_hugemem } configuration.
+/// Like calloc, the returned memory is zeroed (mapped pages are zero filled by the kernel, so this is free for large tables).
+/// @param [in] size: the number of bytes to allocate
+/// @return a pointer to the zeroed allocation, or NULL on failure
+void *cr8r_default_alloc_huge(const cr8r_base_ft*, uint64_t size);
+
+/// ft->free implementation (for hash tables) using hugepages for large tables
+///
+/// ft->base.data must be the same configuration that was used to allocate p.
+/// @param [in] p: the allocation to free
+/// @param [in] size: the size p was allocated with
+void cr8r_default_free_huge(const cr8r_base_ft*, void *p, uint64_t size);
+
 /// ft->del implementation (for hash tables or vectors)
 ///
 /// Wraps free().  Keep in mind that the second argument is
@@ -206,3 +257,25 @@ uint64_t cr8r_pow_u64(uint64_t b, uint64_t e);
 #define CR8R_ATTR_NO_SAN(...)
 #endif
 
+/// Build an extra avx2 clone of a function, picked at load time if the cpu supports it
+///
+/// Meant for kernels written with gcc vector extensions, which are otherwise lowered to sse2 on any x86_64.
+/// Only does anything on x86_64 linux with gcc.
+#if !defined(DOXYGEN) && defined(__x86_64__) && defined(__linux__) && defined(__GNUC__) && !defined(__clang__)
+#define CR8R_ATTR_SIMD_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define CR8R_ATTR_SIMD_CLONES
+#endif
+
+/// Build extra avx512f and avx2 clones of a function, picked at load time if the cpu supports them
+///
+/// Meant for memory bound kernels written with 512 bit gcc vector extensions, which are lowered to pairs of avx2 instructions
+/// or groups of four sse2 instructions on cpus without avx512f.  Most kernels should use { @link CR8R_ATTR_SIMD_CLONES } instead,
+/// since avx512 code can lower the clock speed of some cpus.
+/// Only does anything on x86_64 linux with gcc.
+#if !defined(DOXYGEN) && defined(__x86_64__) && defined(__linux__) && defined(__GNUC__) && !defined(__clang__)
+#define CR8R_ATTR_WIDE_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define CR8R_ATTR_WIDE_SIMD_CLONES
+#endif
+
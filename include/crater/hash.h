@@ -18,6 +18,7 @@
 #include <stdbool.h>
 
 #include <crater/container.h>
+#include <crater/stats.h>
 
 /// A hash table.
 /// Fields of this struct should not be edited directly, only through the functions in this file.
@@ -83,6 +84,14 @@ typedef struct{
 	/// can be expected even up to 50% load factor or possibly higher.  Setting lower than .3 would be extravagant and
 	/// lower than .1 would probably be absurd.
 	double load_factor;
+	/// Function to allocate the internal tables.  Not required.
+	/// Must return zeroed memory, like calloc.  If not specified, calloc is used.
+	/// See { @link cr8r_default_alloc_arena } to allocate from an arena.
+	void *(*alloc)(const cr8r_base_ft*, uint64_t size);
+	/// Function to free the internal tables.  Not required, but must be specified if alloc is.
+	/// The size passed is the size the allocation was requested with.  If not specified, free is used.
+	/// See { @link cr8r_default_free_arena }.
+	void (*free)(const cr8r_base_ft*, void *p, uint64_t size);
 } cr8r_hashtbl_ft;
 
 
@@ -98,6 +107,7 @@ typedef struct{
 /// @param [in] add: element composition function.  can be NULL for all functions besides { @link cr8r_hash_append }.
 /// called to combine an existing and new element when this function is called and the element to insert is already in the tree.
 /// @param [in] del: called on any element before deleting it.  can be NULL if no action is required.
+/// alloc and free are set to NULL so the internal tables use calloc and free, and can be set afterwards to use another allocator.
 /// @return 1 on success, 0 on failure (if hash or cmp is NULL)
 bool cr8r_hash_ft_init(cr8r_hashtbl_ft*,
 	void *data, uint64_t size,
@@ -182,6 +192,13 @@ void cr8r_hash_clear(cr8r_hashtbl_t*, cr8r_hashtbl_ft*);
 /// constant time if free is.
 void cr8r_hash_destroy(cr8r_hashtbl_t*, cr8r_hashtbl_ft*);
 
+/// Compute snapshot statistics for a hash table
+///
+/// Rehashes every entry to find how many probes are needed to reach it, so this takes time proportional to
+/// the total probe length of all entries.  Does not modify the table or perform incremental moving.
+/// @param [out] stats: statistics to fill in
+void cr8r_hash_get_stats(const cr8r_hashtbl_t*, const cr8r_hashtbl_ft*, cr8r_hash_stats *stats);
+
 /// Iterate through the entries of a hash table.
 ///
 /// If cur is NULL, find the first entry.  Otherwise, find the next entry.  If no more entries exist (including when cur is NULL
@@ -5,6 +5,16 @@
 /// @version 0.3.0
 /// Functions to use a { @link cr8r_vec } as a heap.
 ///
+/// Besides the usual binary heap, d-ary heaps are supported by the functions ending in _d.
+/// A 4-ary or 8-ary heap is shallower than a binary heap and each sift down compares children which are next to each
+/// other in memory, so they are often faster even though each level takes more comparisons.
+/// Arities 2, 4, and 8 have specialized implementations.
+///
+/// None of these functions know anything about the elements except through ft, so to support decrease key,
+/// ft->swap can record the position of each element it moves (eg by storing a pointer to the vector in ft->base.data
+/// so the index can be computed), and then { @link cr8r_heap_sift_up } or { @link cr8r_heap_sift_up_d } can be called
+/// on the element.  Note that push copies the new element to the end of the vector without calling swap.
+///
 /// This Source Code Form is subject to the terms of the Mozilla Public
 /// License, v. 2.0. If a copy of the MPL was not distributed with this
 /// file, You can obtain one at http://mozilla.org/MPL/2.0/.
@@ -55,3 +65,63 @@ bool cr8r_heap_push(cr8r_vec*, cr8r_vec_ft*, const void *e, int ord);
 /// @return 1 on success, 0 on failure (empty heap)
 bool cr8r_heap_pop(cr8r_vec*, cr8r_vec_ft*, void *o, int ord);
 
+/// Add many elements to a heap at once
+///
+/// The elements are appended and then only the subtrees containing them are fixed, bottom up,
+/// which takes O(n + log(len)^2) time instead of O(n log(len)) for pushing them one at a time.
+/// @param [in] es: pointer to an array of n elements, which are COPIED into the heap
+/// @param [in] n: number of elements
+/// @param [in] ord: 1 to use a max heap (use ft->cmp directly), -1 to use a min heap (invert ft->cmp)
+/// @return 1 on success, 0 on failure (allocation failure, in which case the heap is unchanged)
+bool cr8r_heap_push_many(cr8r_vec*, cr8r_vec_ft*, const void *es, uint64_t n, int ord);
+
+/// Remove the top k elements from a heap
+///
+/// @param [in] k: number of elements to remove.  If the heap has fewer, all elements are removed
+/// @param [out] out: vector to store the removed elements in, from the top down.  Must be initialized but will
+/// be cleared before use.
+/// @param [in] ord: 1 to use a max heap (use ft->cmp directly), -1 to use a min heap (invert ft->cmp)
+/// @return 1 on success, 0 on failure (allocation failure, in which case the heap is unchanged)
+bool cr8r_heap_pop_k(cr8r_vec*, cr8r_vec_ft*, uint64_t k, cr8r_vec *out, int ord);
+
+/// Add all elements of another heap (or any vector) to a heap
+///
+/// Uses { @link cr8r_heap_push_many }, so the other vector does not need to be a heap and is not modified.
+/// @param [in] other: vector whose elements are COPIED into the heap
+/// @param [in] ord: 1 to use a max heap (use ft->cmp directly), -1 to use a min heap (invert ft->cmp)
+/// @return 1 on success, 0 on failure (allocation failure, in which case the heap is unchanged)
+bool cr8r_heap_merge(cr8r_vec*, cr8r_vec_ft*, const cr8r_vec *other, int ord);
+
+/// Turn a vector into a d-ary heap in place in linear time
+///
+/// @param [in] arity: number of children of each node, at least 2
+/// @param [in] ord: 1 to use a max heap (use ft->cmp directly), -1 to use a min heap (invert ft->cmp)
+void cr8r_heap_ify_d(cr8r_vec*, cr8r_vec_ft*, uint64_t arity, int ord);
+
+/// Move an element up a d-ary heap as necessary to restore the heap invariant
+///
+/// See { @link cr8r_heap_sift_up }
+/// @param [in] arity: number of children of each node, at least 2
+void cr8r_heap_sift_up_d(cr8r_vec*, cr8r_vec_ft*, uint64_t arity, void *e, int ord);
+
+/// Move an element down a d-ary heap as necessary to restore the heap invariant
+///
+/// See { @link cr8r_heap_sift_down }
+/// @param [in] arity: number of children of each node, at least 2
+void cr8r_heap_sift_down_d(cr8r_vec*, cr8r_vec_ft*, uint64_t arity, void *e, int ord);
+
+/// Add a new element to a d-ary heap
+///
+/// See { @link cr8r_heap_push }
+/// @param [in] arity: number of children of each node, at least 2
+/// @return 1 on success, 0 on failure (allocation failure)
+bool cr8r_heap_push_d(cr8r_vec*, cr8r_vec_ft*, uint64_t arity, const void *e, int ord);
+
+/// Remove the top (typically max) element from a d-ary heap
+///
+/// See { @link cr8r_heap_pop }.  The top element of a d-ary heap is also at the start of the vector,
+/// so { @link cr8r_heap_top } works for d-ary heaps too.
+/// @param [in] arity: number of children of each node, at least 2
+/// @return 1 on success, 0 on failure (empty heap)
+bool cr8r_heap_pop_d(cr8r_vec*, cr8r_vec_ft*, uint64_t arity, void *o, int ord);
+
@@ -0,0 +1,52 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Hugepage and NUMA aware backing storage for large vectors and hash tables
+
+/// Large buffers (at least { @link cr8r_hugemem::threshold } bytes) are mapped directly with mmap and advised
+/// to use transparent hugepages, or explicit hugetlb pages if requested and available, which greatly decreases
+/// TLB misses for random access into multi gigabyte tables.  Growing a mapped vector uses mremap, so the kernel
+/// moves page table entries instead of copying the buffer.  Pages can optionally be interleaved across or bound
+/// to a set of NUMA nodes with mbind.  Smaller buffers use malloc as usual.
+/// Hugepages, hugetlb, and NUMA placement are all best effort: if the kernel refuses any of them, the buffer
+/// is still allocated with ordinary pages.  On systems other than Linux, everything falls back to malloc.
+///
+/// To use these, point ft->base.data at a { @link cr8r_hugemem } (or leave it NULL for the defaults) and set
+/// ft->resize to { @link cr8r_default_resize_huge } for vectors, or ft->alloc and ft->free to
+/// { @link cr8r_default_alloc_huge } and { @link cr8r_default_free_huge } for hash tables.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+
+#include <crater/container.h>
+
+/// Threshold used when { @link cr8r_hugemem::threshold } is 0: the size of an x86 transparent hugepage
+#define CR8R_HUGEMEM_DEFAULT_THRESHOLD (1ULL << 21)
+
+/// Flags for { @link cr8r_hugemem::flags }
+enum{
+	/// Try to map explicit hugetlb pages (MAP_HUGETLB) before falling back to transparent hugepages.
+	/// Explicit hugepages must be reserved by the administrator (eg via /proc/sys/vm/nr_hugepages).
+	CR8R_HUGEMEM_HUGETLB = 1,
+	/// Interleave pages round robin across the nodes in { @link cr8r_hugemem::nodemask }
+	CR8R_HUGEMEM_INTERLEAVE = 2,
+	/// Bind pages to the nodes in { @link cr8r_hugemem::nodemask }
+	CR8R_HUGEMEM_BIND = 4
+};
+
+/// Configuration for hugepage backed buffers, pointed to by ft->base.data
+typedef struct{
+	/// Buffers at least this many bytes are mapped with mmap, smaller buffers use malloc.  0 means { @link CR8R_HUGEMEM_DEFAULT_THRESHOLD }
+	uint64_t threshold;
+	/// Bitwise or of CR8R_HUGEMEM_* flags
+	uint64_t flags;
+	/// NUMA nodes to interleave across or bind to, bit i corresponding to node i.  Ignored unless
+	/// { @link CR8R_HUGEMEM_INTERLEAVE } or { @link CR8R_HUGEMEM_BIND } is set.
+	uint64_t nodemask;
+} cr8r_hugemem;
+
@@ -0,0 +1,125 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Bucketed kd trees, whose leaves hold many points in structure of arrays form.
+///
+/// A normal kd tree (see { @link cr8r_kd_ify }) splits all the way down to single points, and computes the distance
+/// to each point it visits with an indirect call to ft->sqdist.  A bucketed kd tree stops splitting once a subarray has
+/// at most leaf_size points, and keeps a copy of the coordinates of each leaf in structure of arrays form,
+/// so that a whole leaf can be checked with one call to the vectorized ft->soa_sqdists.
+/// This needs a function table with the optional soa callbacks, like { @link cr8r_kd_ft_init_cf64 }.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <crater/vec.h>
+#include <crater/kd_tree.h>
+#include <crater/prand.h>
+
+/// Default number of points per leaf
+#define CR8R_KD_BUCKET_DEFAULT_LEAF 32
+
+/// Structure of arrays coordinates for a bucketed kd tree
+///
+/// The points themselves stay in the vector passed to { @link cr8r_kd_buckets_build }, which is rearranged into the
+/// same implicit layout as a normal kd tree except that subarrays of at most leaf_size points are not arranged further.
+/// So other kd tree functions like { @link cr8r_kd_walk } can NOT be used on the vector.
+typedef struct{
+	/// Coordinates of the points in each leaf.  The leaf consisting of points [a, b) has its coordinates at
+	/// soa + a*ft->soa_size in the layout written by ft->to_soa
+	void *soa;
+	/// Number of points in the tree
+	uint64_t len;
+	/// Maximum number of points in a leaf
+	uint64_t leaf_size;
+} cr8r_kd_buckets;
+
+/// Randomized kd forest for approximate nearest neighbor searches in high dimensions
+///
+/// Holds several bucketed kd trees over separate copies of the same points, each splitting on the dimensions
+/// in a different random order.  Searching all trees together with a shared budget finds more of the true nearest
+/// neighbors than spending the same budget on one tree, since a point which is close to the query point but on the
+/// wrong side of a split in one tree is usually on the right side in another.
+typedef struct{
+	/// Number of trees
+	uint64_t num_trees;
+	/// Copy of the points for each tree, arranged by { @link cr8r_kd_buckets_build }
+	cr8r_vec *ents;
+	/// Structure of arrays coordinates for each tree
+	cr8r_kd_buckets *trees;
+	/// Split order of each tree, as num_trees permutations of [0, ft->dim) (see { @link cr8r_kd_ft.split_dims })
+	uint64_t *split_dims;
+	/// Bounds of all the points
+	void *bounds;
+} cr8r_kd_rforest;
+
+/// Rearrange a vector of points into a bucketed kd tree
+///
+/// @param [in, out] ents: points to arrange.  Must not be modified while the bucketed tree is in use.
+/// @param [in] ft: function table with soa callbacks.  (uint64_t)ft->super.base.data is interpreted as the depth,
+/// so should usually be zero.  A nonzero depth rotates the order dimensions are split in, and the same ft must be
+/// passed to searches
+/// @param [in] leaf_size: maximum number of points per leaf, or 0 for { @link CR8R_KD_BUCKET_DEFAULT_LEAF }
+/// @return 1 on success, 0 on failure (allocation, or ft does not support soa)
+bool cr8r_kd_buckets_build(cr8r_kd_buckets*, cr8r_vec *ents, cr8r_kd_ft *ft, uint64_t leaf_size);
+
+/// Free the coordinate buffer of a bucketed kd tree
+void cr8r_kd_buckets_delete(cr8r_kd_buckets*);
+
+/// Find the k closest points to a given point
+///
+/// Like { @link cr8r_kd_k_closest }, but subtrees are visited nearest first and leaves are searched with ft->soa_sqdists.
+/// @param [in] ents: the vector passed to { @link cr8r_kd_buckets_build }
+/// @param [in] bounds: the bounds of the tree
+/// @param [in] pt: point to find k closest points to
+/// @param [in] k: the number of points to find
+/// @param [out] out: vector where the k closest points will be stored, sorted by increasing distance.
+/// Must be initialized but will be cleared before use.
+/// @return true on success, false on (allocation) failure
+bool cr8r_kd_buckets_k_closest(const cr8r_kd_buckets*, const cr8r_vec *ents, cr8r_kd_ft *ft, const void *bounds, const void *pt, uint64_t k, cr8r_vec *out);
+
+/// Find approximately the k closest points to a given point
+///
+/// Searches leaves in order of their distance from pt (best bin first) instead of depth first,
+/// which finds most of the true k closest points within the first few leaves.
+/// @param [in] ents: the vector passed to { @link cr8r_kd_buckets_build }
+/// @param [in] bounds: the bounds of the tree
+/// @param [in] pt: point to find k closest points to
+/// @param [in] k: the number of points to find
+/// @param [in] eps: stop once no unsearched leaf can contain a point closer than the current kth closest point divided by 1 + eps.
+/// So if max_leaves is not reached, the kth closest point found is at most 1 + eps times farther than the true kth closest point.
+/// 0 for an exact search
+/// @param [in] max_leaves: stop after searching this many leaves, or 0 for no limit
+/// @param [out] out: vector where the points found will be stored, sorted by increasing distance.
+/// Must be initialized but will be cleared before use.
+/// @return true on success, false on (allocation) failure
+bool cr8r_kd_buckets_k_closest_approx(const cr8r_kd_buckets*, const cr8r_vec *ents, cr8r_kd_ft *ft, const void *bounds, const void *pt, uint64_t k, double eps, uint64_t max_leaves, cr8r_vec *out);
+
+/// Build a randomized kd forest
+///
+/// @param [in] ents: points to copy into each tree.  Not modified
+/// @param [in] ft: function table with soa callbacks
+/// @param [in] bounds: the bounds of the points
+/// @param [in] num_trees: number of trees, at least 1.  Each tree splits on the dimensions in its own random order
+/// @param [in] leaf_size: maximum number of points per leaf, or 0 for { @link CR8R_KD_BUCKET_DEFAULT_LEAF }
+/// @param [in] prng: random number generator used to pick the split orders
+/// @return 1 on success, 0 on failure (allocation, num_trees is 0, or ft does not support soa)
+bool cr8r_kd_rforest_build(cr8r_kd_rforest*, const cr8r_vec *ents, cr8r_kd_ft *ft, const void *bounds, uint64_t num_trees, uint64_t leaf_size, cr8r_prng *prng);
+
+/// Free the points and coordinate buffers of a randomized kd forest
+void cr8r_kd_rforest_delete(cr8r_kd_rforest*, cr8r_kd_ft *ft);
+
+/// Find approximately the k closest points to a given point in a randomized kd forest
+///
+/// Like { @link cr8r_kd_buckets_k_closest_approx }, but the leaves of all trees are searched from one shared queue,
+/// so max_leaves is the total budget across all trees.  Points found in more than one tree are only reported once
+/// (which also means equal points in ents are only reported once).
+/// @return true on success, false on (allocation) failure
+bool cr8r_kd_rforest_k_closest(const cr8r_kd_rforest*, cr8r_kd_ft *ft, const void *pt, uint64_t k, double eps, uint64_t max_leaves, cr8r_vec *out);
+
@@ -0,0 +1,97 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Dynamic kd "forests" which support inserting and removing points.
+///
+/// A kd forest is a list of static kd trees (see { @link cr8r_kd_ify }) of doubling size.
+/// Level i holds at most 2^i points.  Inserting a point finds the first empty level j,
+/// and merges the new point and all levels below j into it, so each point is merged O(log n) times
+/// and insertion takes amortized O(log^2 n) time (the "logarithmic method").
+/// Removing a point only marks it as deleted, and once there are more deleted points than
+/// live ones, the whole forest is compacted into a single tree.
+/// Queries visit every level, so they cost about O(log n) times more than a single static tree.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <crater/vec.h>
+#include <crater/bitvec.h>
+#include <crater/kd_tree.h>
+
+/// Maximum number of levels in a kd forest
+#define CR8R_KD_FOREST_LEVELS 64
+
+/// A dynamic kd tree, see the file level documentation
+///
+/// All functions take the { @link cr8r_kd_ft } as an argument, like the functions for static kd trees.
+/// The depth stored in ft->super.base.data is ignored, since every level is a complete tree.
+typedef struct{
+	/// Static kd tree for each level.  trees[i].len is at most 2^i, and the vector is kept
+	/// around after a level is merged into a higher one so its buffer can be reused
+	cr8r_vec trees[CR8R_KD_FOREST_LEVELS];
+	/// Mask of deleted points for each level, parallel to trees
+	cr8r_bvec deleted[CR8R_KD_FOREST_LEVELS];
+	/// Number of live points in the forest
+	uint64_t len;
+	/// Number of points which are marked as deleted but have not been compacted away yet
+	uint64_t deleted_len;
+	/// Bounds object containing every point ever inserted, used as the bounds of every level
+	void *bounds;
+} cr8r_kd_forest;
+
+/// Initialize an empty kd forest
+///
+/// @param [in] bounds: initial bounds object.  It will be extended with ft->update as points are inserted,
+/// so it may be a degenerate bounds object around any point (but ft->split must be able to handle this)
+/// @return 1 on success, 0 on failure (allocation)
+bool cr8r_kd_forest_init(cr8r_kd_forest*, cr8r_kd_ft *ft, const void *bounds);
+
+/// Free all buffers of a kd forest
+void cr8r_kd_forest_delete(cr8r_kd_forest*, cr8r_kd_ft *ft);
+
+/// Insert a point into a kd forest
+///
+/// Takes amortized O(log^2 n) time, since the levels below the first empty one are merged and re-treeified.
+/// @param [in] ent: the point to insert
+/// @return 1 on success, 0 on failure (allocation).  The forest is unchanged on failure.
+bool cr8r_kd_forest_insert(cr8r_kd_forest*, cr8r_kd_ft *ft, const void *ent);
+
+/// Remove a point from a kd forest
+///
+/// The point is only marked as deleted, and skipped by later queries.  When more than half of the stored points
+/// are deleted, { @link cr8r_kd_forest_compact } is called.
+/// @param [in] ent: the point to remove.  Only an entry which is bitwise identical to ent (including any tag)
+/// is removed, and if there are several such entries only one of them is.
+/// @return 1 if an entry was removed, 0 if no matching entry was found
+bool cr8r_kd_forest_remove(cr8r_kd_forest*, cr8r_kd_ft *ft, const void *ent);
+
+/// Rebuild a kd forest into a single tree, dropping all deleted points
+///
+/// @return 1 on success, 0 on failure (allocation).  The forest is unchanged on failure.
+bool cr8r_kd_forest_compact(cr8r_kd_forest*, cr8r_kd_ft *ft);
+
+/// Perform a traversal of the live points in a kd forest and call a visitor callback on each
+///
+/// Each level is traversed in preorder like { @link cr8r_kd_walk }, starting from the smallest.
+/// Deleted points are not passed to the visitor, but their children are still visited.
+/// If the visitor returns CR8R_WALK_STOP, no further levels are visited.
+/// @param [in] visitor: function to call at each entry in the forest
+/// @param [in, out] data: passed to visitor to facillitate input/output
+void cr8r_kd_forest_walk(cr8r_kd_forest*, cr8r_kd_ft *ft, cr8r_kdvisitor visitor, void *data);
+
+/// Find the k closest points to a given point
+///
+/// Works exactly like { @link cr8r_kd_k_closest }, but one heap of candidates is shared across all levels
+/// so levels visited later can be pruned using the points found in earlier ones.
+/// @param [in] pt: point to find k closest points to
+/// @param [in] k: the number of points to find
+/// @param [out] out: vector where the k closest points will be stored.  Must be allocated but will be cleared before use.
+/// @return true on success, false on (allocation) failure
+bool cr8r_kd_forest_k_closest(cr8r_kd_forest*, cr8r_kd_ft *ft, const void *pt, uint64_t k, cr8r_vec *out);
+
@@ -61,7 +61,7 @@ struct cr8r_kd_ft{
 	/// split a bounds object in two along some dimension
 	///
 	/// the bounds object self is split into the part before root_pt (stored in o1) and the part after root_pt
-	/// (stored in o2), in the dimenstion depth%ft->dim.  depth is stored in ft->super.base.data
+	/// (stored in o2), in the dimenstion { @link cr8r_kd_split_dim } (usually depth%ft->dim).  depth is stored in ft->super.base.data
 	void (*split)(const cr8r_kd_ft *ft, const void *self, const void *root_pt, void *o1, void *o2);
 	/// update a bounds object to include some point
 	///
@@ -72,8 +72,55 @@ struct cr8r_kd_ft{
 	double (*min_sqdist)(const cr8r_kd_ft *ft, const void *self, const void *pt);
 	/// find the squared distance between two points
 	double (*sqdist)(const cr8r_kd_ft *ft, const void *a, const void *b);
+	/// find the maximum squared distance from any point in a bounds object to a point
+	///
+	/// Optional (may be NULL).  Used by { @link cr8r_kd_count_within_radius } and { @link cr8r_kd_within_radius }
+	/// to take whole subtrees which are inside the radius without checking each point.
+	double (*max_sqdist)(const cr8r_kd_ft *ft, const void *self, const void *pt);
+	/// check if a bounds object is entirely contained in a region described by another bounds object
+	///
+	/// Optional (may be NULL).  Used by { @link cr8r_kd_count_in_box } and { @link cr8r_kd_in_box }
+	/// to take whole subtrees which are inside the box without checking each point.
+	bool (*contains)(const cr8r_kd_ft *ft, const void *region, const void *self);
+	/// check if a bounds object overlaps a region described by another bounds object
+	///
+	/// Optional (may be NULL).  Used by { @link cr8r_kd_count_in_box } and { @link cr8r_kd_in_box }
+	/// to skip subtrees which are entirely outside the box.  If this is NULL, every point has to be checked.
+	bool (*intersects)(const cr8r_kd_ft *ft, const void *region, const void *self);
+	/// Size in bytes of the coordinates of one point in structure of arrays form
+	///
+	/// Optional (may be 0, in which case to_soa and soa_sqdists should be NULL).
+	/// Needed to use this table with { @link cr8r_kd_buckets }.
+	uint64_t soa_size;
+	/// copy the coordinates of n points into structure of arrays form
+	///
+	/// soa has room for n*ft->soa_size bytes.  Usually coordinate j of point i is stored at index j*n + i
+	/// of an array of the coordinate type, but the layout only has to agree with soa_sqdists.
+	void (*to_soa)(const cr8r_kd_ft *ft, const void *ents, uint64_t n, void *soa);
+	/// find the squared distances from a point to n points in structure of arrays form
+	///
+	/// This is the inner loop of searching a leaf of a { @link cr8r_kd_buckets }, so it should be vectorized.
+	/// @param [in] soa: coordinates of n points, as written by to_soa
+	/// @param [in] pt: a normal (not structure of arrays) point
+	/// @param [out] out: where to store the n squared distances
+	void (*soa_sqdists)(const cr8r_kd_ft *ft, const void *soa, uint64_t n, const void *pt, double *out);
+	/// Order to split dimensions in
+	///
+	/// Optional (may be NULL, in which case nodes at depth d split in dimension d%ft->dim).
+	/// Otherwise, a permutation of [0, ft->dim), and nodes at depth d split in dimension split_dims[d%ft->dim].
+	/// Callbacks should find the dimension with { @link cr8r_kd_split_dim }.
+	/// Used by { @link cr8r_kd_rforest } to give each tree a different random split order.
+	const uint64_t *split_dims;
 };
 
+/// Get the dimension a node splits in
+///
+/// The depth of the node is stored in ft->super.base.data.
+static inline uint64_t cr8r_kd_split_dim(const cr8r_kd_ft *ft){
+	uint64_t i = (uint64_t)ft->super.base.data%ft->dim;
+	return ft->split_dims ? ft->split_dims[i] : i;
+}
+
 /// Concrete bounds object for spherical and cuboid kd trees with 3 i64 coords
 ///
 /// Bounds objects describe the range of points contained in a kd tree or subtree.
@@ -94,13 +141,20 @@ typedef struct{
 	int64_t tr[3];
 } cr8r_kdwin_s2i64;
 
-/// Additional state for { @link }
+/// Additional state for { @link cr8r_kd_k_closest_visitor }
 typedef struct{
 	cr8r_kd_ft ft;
 	const void *pt;
 	cr8r_vec *ents;
 	uint64_t k;
 	double max_sqdist;
+	/// Approximation factor: subtrees are skipped if they can't contain a point closer than the current kth closest
+	/// point divided by 1 + eps.  0 for an exact search
+	double eps;
+	/// Maximum number of points to visit before stopping, or 0 for no limit
+	uint64_t max_visits;
+	/// Number of points visited so far (only counted if max_visits is not 0)
+	uint64_t visits;
 } cr8r_kd_k_closest_state;
 
 /// Type of a visitor callback for a kd tree traversal
@@ -131,6 +185,21 @@ bool cr8r_kdwin_bounding_i64x3(cr8r_kdwin_s2i64*, const cr8r_vec *ents, const cr
 /// Should be 0, self->len to treeify the entire vector.
 bool cr8r_kd_ify(cr8r_vec*, cr8r_kd_ft *ft, uint64_t a, uint64_t b);
 
+/// Rearrange a vector of points into a kd tree using multiple threads
+///
+/// Produces the same implicit layout as { @link cr8r_kd_ify }, so the result can be used with all the other kd tree functions.
+/// The median of large subarrays is found with a parallel partition, and then the two halves are built on separate threads,
+/// each with half of the remaining threads, until subarrays are small enough to build on one thread.
+/// ft->super.cmp is called from several threads at once, so it must not modify shared state.
+/// Elements are moved with memcpy during the parallel partition, not ft->super.swap.
+/// @param [in] ft: (uint64_t)ft->super.base.data is interpreted as the depth of the current subarray, and
+/// so should be zero when calling this function generally on the whole vector
+/// @param [in] a, b: the start (inclusive) and end (exclusive) indices of the subarray to process.
+/// Should be 0, self->len to treeify the entire vector.
+/// @param [in] threads: maximum number of threads to use at once, including the calling thread.  0 or 1 is the same as { @link cr8r_kd_ify }
+/// @return 1 on success, 0 on failure
+bool cr8r_kd_ify_mt(cr8r_vec*, cr8r_kd_ft *ft, uint64_t a, uint64_t b, uint64_t threads);
+
 /// Perform a preorder traversal of the points in a kd tree and call a visitor callback on each
 ///
 /// @param [in] ft: (uint64_t)ft->super.base.data is interpreted as the depth of the current subarray, and
@@ -157,6 +226,84 @@ void cr8r_kd_walk(cr8r_vec*, const cr8r_kd_ft *ft, const void *bounds, cr8r_kdvi
 /// return fewer than k points if fewer than k are available
 bool cr8r_kd_k_closest(cr8r_vec*, cr8r_kd_ft *ft, const void *bounds, const void *pt, uint64_t k, cr8r_vec *out);
 
+/// Find approximately the k closest points to a given point
+///
+/// Like { @link cr8r_kd_k_closest }, but can trade accuracy for speed, which is useful in high dimensions where
+/// exact searches end up visiting most of the tree.
+/// @param [in] eps: if the search is not stopped early, the kth closest point found is at most 1 + eps times farther from pt
+/// than the true kth closest point.  0 for an exact search.
+/// @param [in] max_visits: stop after visiting this many points, or 0 for no limit.  Since this tree visits subtrees
+/// in order rather than nearest first, { @link cr8r_kd_buckets_k_closest_approx } gives much better results with a budget.
+/// @return true on success, false on (allocation) failure
+bool cr8r_kd_k_closest_approx(cr8r_vec*, cr8r_kd_ft *ft, const void *bounds, const void *pt, uint64_t k, double eps, uint64_t max_visits, cr8r_vec *out);
+
+/// Find all points within a given distance of a point
+///
+/// Subtrees whose bounds are farther than r from pt are skipped, and if ft->max_sqdist is not NULL,
+/// subtrees whose bounds are entirely within r of pt are copied to the output without checking each point.
+/// @param [in] ft: (uint64_t)_ft->super.base.data is interpreted as the depth of the current subarray, and
+/// so should be zero when calling this function generally on the whole vector
+/// @param [in] bounds: the bounds of the tree
+/// @param [in] pt: center of the search
+/// @param [in] r: radius of the search.  Points at distance exactly r are included.
+/// @param [out] out: vector where the points will be stored.  Must be initialized but will be cleared before use.
+/// The points are in no specified order.
+/// @return true on success, false on (allocation) failure
+bool cr8r_kd_within_radius(cr8r_vec*, cr8r_kd_ft *ft, const void *bounds, const void *pt, double r, cr8r_vec *out);
+
+/// Count the points within a given distance of a point
+///
+/// Works like { @link cr8r_kd_within_radius }, but without storing the points, so subtrees entirely within r of pt
+/// only cost one call to ft->max_sqdist.
+/// @return the number of points at distance at most r from pt
+uint64_t cr8r_kd_count_within_radius(cr8r_vec*, cr8r_kd_ft *ft, const void *bounds, const void *pt, double r);
+
+/// Find all points in a given region
+///
+/// A point is in the region if ft->min_sqdist from the region to the point is 0.
+/// If ft->intersects is not NULL, subtrees whose bounds do not intersect the region are skipped, and if ft->contains
+/// is not NULL, subtrees whose bounds are inside the region are copied to the output without checking each point.
+/// @param [in] ft: (uint64_t)_ft->super.base.data is interpreted as the depth of the current subarray, and
+/// so should be zero when calling this function generally on the whole vector
+/// @param [in] bounds: the bounds of the tree
+/// @param [in] box: bounds object describing the region to search, such as a { @link cr8r_kdwin_s2i64 }
+/// @param [out] out: vector where the points will be stored.  Must be initialized but will be cleared before use.
+/// The points are in no specified order.
+/// @return true on success, false on (allocation) failure
+bool cr8r_kd_in_box(cr8r_vec*, cr8r_kd_ft *ft, const void *bounds, const void *box, cr8r_vec *out);
+
+/// Count the points in a given region
+///
+/// Works like { @link cr8r_kd_in_box }, but without storing the points, so subtrees inside the region
+/// only cost one call to ft->contains.
+/// @return the number of points in the region
+uint64_t cr8r_kd_count_in_box(cr8r_vec*, cr8r_kd_ft *ft, const void *bounds, const void *box);
+
+/// Find the k closest points to each of a list of query points
+///
+/// Queries are first sorted by where they would fall in the tree, so consecutive queries visit mostly the same
+/// subtrees, and then split into contiguous chunks which are searched on separate threads.
+/// ft->super.cmp and ft->sqdist are called from several threads at once, so they must not modify shared state.
+/// @param [in] ft: (uint64_t)_ft->super.base.data is interpreted as the depth of the current subarray, and
+/// so should be zero when calling this function generally on the whole vector
+/// @param [in] bounds: the bounds of the tree
+/// @param [in] pts: vector of query points, with the same element size as the tree
+/// @param [in] k: the number of points to find for each query.  If the tree has fewer than k points, all of them are
+/// returned for each query and k is effectively reduced to self->len
+/// @param [out] out: vector where the results are stored.  Must be initialized but will be cleared before use.
+/// The k closest points to query i are stored at indices [i*k, (i + 1)*k), sorted by increasing distance from the query.
+/// @param [in] threads: maximum number of threads to use, including the calling thread.  0 or 1 means only the calling thread is used.
+/// @return true on success, false on (allocation) failure
+bool cr8r_kd_k_closest_batch(cr8r_vec*, cr8r_kd_ft *ft, const void *bounds, const cr8r_vec *pts, uint64_t k, cr8r_vec *out, uint64_t threads);
+
+/// Visitor callback used by { @link cr8r_kd_k_closest }
+///
+/// Adds ent to the heap of candidates in data, and skips the subtree if it cannot contain any closer points.
+/// Exposed so that other structures built out of kd trees can share one search state across several trees.
+/// @param [in, out] data: a { @link cr8r_kd_k_closest_state } whose ents vector has capacity at least k + 1
+/// and whose ft->super.cmp is { @link cr8r_default_cmp_kd_kcs_pt_dist }
+cr8r_walk_decision cr8r_kd_k_closest_visitor(cr8r_kd_ft *ft, const void *bounds, void *ent, void *data);
+
 /// Comparison function that compares two kd tree points based on their distance from a fixed point
 ///
 /// This function MUST be called with _ft pointing at a cr8r_base_ft WITHIN { @link cr8r_kd_k_closest_state }.
@@ -168,3 +315,40 @@ extern cr8r_kd_ft cr8r_kdft_s2i64;
 /// kdft implementation for cuboid kd trees in 3 dimensions with i64 coordintates
 extern cr8r_kd_ft cr8r_kdft_c3i64;
 
+/// Initialize a kdft for cuboid kd trees with double coordinates in any number of dimensions
+///
+/// Points start with dim doubles, which may be followed by any other data (a tag), and bounds objects
+/// are an array of 2*dim doubles, where the first dim are the minimum ("bottom left") point and the last dim are the
+/// maximum ("top right") point.  The table includes all optional callbacks, including the vectorized soa ones.
+/// @param [in] dim: number of coordinates
+/// @param [in] size: size of a point including any tag, must be at least dim*sizeof(double)
+/// @return 1 on success, 0 if size is too small
+bool cr8r_kd_ft_init_cf64(cr8r_kd_ft*, uint64_t dim, uint64_t size);
+
+/// Initialize a kdft for cuboid kd trees with float coordinates in any number of dimensions
+///
+/// Exactly like { @link cr8r_kd_ft_init_cf64 } but with floats instead of doubles.
+/// Distances are still returned as doubles, but are computed in single precision.
+bool cr8r_kd_ft_init_cf32(cr8r_kd_ft*, uint64_t dim, uint64_t size);
+
+/// Initialize a bounds object for a cf64 table to bound a list of points
+///
+/// @param [out] bounds: array of 2*ft->dim doubles
+/// @return 1 on success, 0 if ents is empty
+bool cr8r_kdwin_bounding_cf64(double *bounds, const cr8r_vec *ents, const cr8r_kd_ft *ft);
+
+/// Initialize a bounds object for a cf32 table to bound a list of points
+///
+/// @param [out] bounds: array of 2*ft->dim floats
+/// @return 1 on success, 0 if ents is empty
+bool cr8r_kdwin_bounding_cf32(float *bounds, const cr8r_vec *ents, const cr8r_kd_ft *ft);
+
+/// kdft implementation for cuboid kd trees in 2 dimensions with double coordinates, see { @link cr8r_kd_ft_init_cf64 }
+extern cr8r_kd_ft cr8r_kdft_c2f64;
+/// kdft implementation for cuboid kd trees in 3 dimensions with double coordinates, see { @link cr8r_kd_ft_init_cf64 }
+extern cr8r_kd_ft cr8r_kdft_c3f64;
+/// kdft implementation for cuboid kd trees in 2 dimensions with float coordinates, see { @link cr8r_kd_ft_init_cf32 }
+extern cr8r_kd_ft cr8r_kdft_c2f32;
+/// kdft implementation for cuboid kd trees in 3 dimensions with float coordinates, see { @link cr8r_kd_ft_init_cf32 }
+extern cr8r_kd_ft cr8r_kdft_c3f32;
+
@@ -93,3 +93,35 @@ bool cr8r_mmheap_pushpop_min(cr8r_vec*, cr8r_vec_ft*, const void *e, void *o);
 /// @return 1 on success, 0 on failure (allocation failure)
 bool cr8r_mmheap_pushpop_max(cr8r_vec*, cr8r_vec_ft*, const void *e, void *o);
 
+/// Add many elements to a minmax heap at once
+///
+/// Like { @link cr8r_heap_push_many }, only the subtrees containing the new elements are fixed,
+/// taking O(n + log(len)^2) time.
+/// @param [in] es: pointer to an array of n elements, which are COPIED into the heap
+/// @param [in] n: number of elements
+/// @return 1 on success, 0 on failure (allocation failure, in which case the heap is unchanged)
+bool cr8r_mmheap_push_many(cr8r_vec*, cr8r_vec_ft*, const void *es, uint64_t n);
+
+/// Remove the k smallest elements from a minmax heap
+///
+/// @param [in] k: number of elements to remove.  If the heap has fewer, all elements are removed
+/// @param [out] out: vector to store the removed elements in, in increasing order.  Must be initialized but will
+/// be cleared before use.
+/// @return 1 on success, 0 on failure (allocation failure, in which case the heap is unchanged)
+bool cr8r_mmheap_pop_k_min(cr8r_vec*, cr8r_vec_ft*, uint64_t k, cr8r_vec *out);
+
+/// Remove the k largest elements from a minmax heap
+///
+/// @param [in] k: number of elements to remove.  If the heap has fewer, all elements are removed
+/// @param [out] out: vector to store the removed elements in, in decreasing order.  Must be initialized but will
+/// be cleared before use.
+/// @return 1 on success, 0 on failure (allocation failure, in which case the heap is unchanged)
+bool cr8r_mmheap_pop_k_max(cr8r_vec*, cr8r_vec_ft*, uint64_t k, cr8r_vec *out);
+
+/// Add all elements of another minmax heap (or any vector) to a minmax heap
+///
+/// Uses { @link cr8r_mmheap_push_many }, so the other vector does not need to be a heap and is not modified.
+/// @param [in] other: vector whose elements are COPIED into the heap
+/// @return 1 on success, 0 on failure (allocation failure, in which case the heap is unchanged)
+bool cr8r_mmheap_merge(cr8r_vec*, cr8r_vec_ft*, const cr8r_vec *other);
+
@@ -32,12 +32,13 @@
 
 typedef struct cr8r_pheap_node cr8r_pheap_node;
 struct cr8r_pheap_node{
-	/// pointer to the first child (or NULL).  All children form a circularly linked list
+	/// pointer to the first child (or NULL).  All children form a doubly linked list
 	cr8r_pheap_node *first_child;
-	/// pointer to the next sibling.  These are the pointers that form a cll.
+	/// pointer to the next sibling (or NULL for the last child)
 	cr8r_pheap_node *sibling;
-	/// pointer to the parent
-	cr8r_pheap_node *parent;
+	/// pointer to the previous sibling, or to the parent for the first child, or NULL for the root.
+	/// This lets any node be unlinked from its parent in constant time
+	cr8r_pheap_node *prev;
 };
 
 /// function table for pairing heaps
@@ -83,15 +84,30 @@ typedef struct{
 /// not the last member of the outer struct (including if there is padding due to alignment),
 /// or if there is padding in the struct and some other code cares about its value, this
 /// function does not work and the allocation must be done manually.
-/// @param [in] first_child, sibling, parent: Initializers for the intrusive struct's fields
+/// @param [in] first_child, sibling, prev: Initializers for the intrusive struct's fields
 /// @return A pointer to the pheap node within the outer struct that was allocated and initialized, or NULL if the allocator failed.
-cr8r_pheap_node *cr8r_pheap_new(void *key, cr8r_pheap_ft*, cr8r_pheap_node *first_child, cr8r_pheap_node *sibling, cr8r_pheap_node *parent);
+cr8r_pheap_node *cr8r_pheap_new(void *key, cr8r_pheap_ft*, cr8r_pheap_node *first_child, cr8r_pheap_node *sibling, cr8r_pheap_node *prev);
+
+/// ft->alloc implementation for pairing heaps
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+/// Allocates ft->base.size + sizeof(cr8r_pheap_node) bytes, so the same caveats as { @link cr8r_pheap_new } apply.
+void *cr8r_default_alloc_arena_pheap(cr8r_base_ft*);
+
+/// ft->free implementation for pairing heaps
+///
+/// Wraps an arena allocator.  WARNING: ft->base.data must point to an arena ( { @link cr8r_arena } ).
+/// Takes a pointer to the cr8r_pheap_node (as { @link cr8r_pheap_delete } passes), not the outer struct.
+void cr8r_default_free_arena_pheap(cr8r_base_ft*, void*);
 
 /// Return a pointer to the minimal data element of a pairing heap, or NULL if the heap is empty.
 /// The pointer returned is to the outer struct.
 void *cr8r_pheap_top(cr8r_pheap_node*, cr8r_pheap_ft*);
 
 /// Return a pointer to the root node given a pointer to any node in a heap.
+///
+/// This follows prev pointers, so it takes time proportional to the number of ancestors and older siblings
+/// of all ancestors, which can be linear.  Prefer keeping track of the root.
 cr8r_pheap_node *cr8r_pheap_root(cr8r_pheap_node*);
 
 /// Combine two pairing heaps, invalidating them
@@ -119,10 +135,28 @@ cr8r_pheap_node *cr8r_pheap_push(cr8r_pheap_node*, void *key, cr8r_pheap_ft*);
 cr8r_pheap_node *cr8r_pheap_pop(cr8r_pheap_node **r, cr8r_pheap_ft*);
 
 /// Restore the (min) heap invariant after decreasing the key of a node.
+///
+/// Has to find the root with { @link cr8r_pheap_root }, so { @link cr8r_pheap_decrease } should be used instead
+/// whenever the root is known.
 /// @param [in] n: the node whose key was decreased and may now be less than its parent
 /// @return the root of the heap after any necessary changes
 cr8r_pheap_node *cr8r_pheap_decreased_key(cr8r_pheap_node *n, cr8r_pheap_ft*);
 
+/// Restore the (min) heap invariant after decreasing the key of a node, in constant time.
+///
+/// The node is cut from its parent and melded with the root, so the root does not need to be found.
+/// @param [in,out] r: pointer to pointer to root node, updated to the new root
+/// @param [in] n: the node whose key was decreased
+void cr8r_pheap_decrease(cr8r_pheap_node **r, cr8r_pheap_node *n, cr8r_pheap_ft*);
+
+/// Remove an arbitrary node from a pairing heap.
+///
+/// The node is cut from its parent and its children are merged as in { @link cr8r_pheap_pop }, so this takes the
+/// same amortized time as popping.  The node is not freed.
+/// @param [in,out] r: pointer to pointer to root node, updated to the new root
+/// @param [in] n: the node to remove
+void cr8r_pheap_remove(cr8r_pheap_node **r, cr8r_pheap_node *n, cr8r_pheap_ft*);
+
 /// Delete all nodes in a pairing heap.
 /// The same note as for cr8r_pheap_new applies here:
 /// typically, the allocation should be handled by a primary
@@ -45,16 +45,19 @@
 /// You may wish to write a program that generates random numbers in multiple
 /// threads.  Generally, Crater functions require you to do appropriate locking
 /// on your own, but for PRNGs the situation is more subtle.
-/// If using a single PRNG from multiple threads, it MUST be locked, unless it
-/// is known to be a "system" PRNG since then the state is maintained by the OS.
+/// If using a single PRNG from multiple threads, it MUST be locked.  This includes
+/// "system" PRNGs, which keep a buffer of bytes from the OS in their state.
 /// However, locking is usually not ideal because it has significant overhead if
 /// you are generating a lot of random numbers.  Therefore, use a different
 /// PRNG in each thread.  HOWEVER, you should NOT simply use a different seed for
 /// each, as for some PRNG types this can cause increased correlation.  Instead,
 /// the particular "jump" functions should be used to split up the output of the
 /// PRNG for a single seed.  "jump" functions allow a PRNG to be advanced as if it
-/// were called a huge number of times very quickly.  Currently, only 2 fixed
-/// size jump functions for Xoro are available, but more will be added soon.
+/// were called a huge number of times very quickly.  { @link cr8r_prng_jump } can jump
+/// every generator except "system" and "chacha" by any number of steps in O(log n) time,
+/// and Xoro also has 2 fixed size jump functions.
+/// Alternatively, counter based generators like { @link cr8r_prng_init_philox4x32 } give each thread
+/// its own stream number with no shared state at all.
 ///
 /// The fact that randomized seeds are (usually, not as much for lcgs) worse than
 /// "jumping" to equidistant points in the output sequence may be very
@@ -86,7 +89,7 @@
 /// Finally, some PRNGs are more suitable for cryptography and secure
 /// purporses than others.  Generally this comes at the cost of speed.
 /// Only "system", the wrapper around Linux's getrandom syscall,
-/// should be considered secure.
+/// and "chacha", a ChaCha20 generator keyed from it, should be considered secure.
 ///
 /// This Source Code Form is subject to the terms of the Mozilla Public
 /// License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -107,6 +110,16 @@ typedef struct{
 	uint64_t state_size;
 	/// Callback to get 4 unsigned bytes from the underlying generator
 	uint32_t (*get_u32)(void*);
+	/// Callback to get 8 unsigned bytes from the underlying generator, or NULL to use two calls to get_u32.
+	/// Generators whose natural output is 64 bits use this to avoid throwing half of each output away
+	uint64_t (*get_u64)(void*);
+	/// Callback to fill a buffer with random bytes, or NULL to use repeated calls to get_u64 (or get_u32).
+	/// This lets generators produce many outputs per indirect call, and for some generators
+	/// (see { @link cr8r_prng_init_xoro_lanes }) run several streams in parallel with simd instructions
+	void (*fill)(void*, uint64_t size, void *buf);
+	/// Callback to advance the generator as if get_u32 were called n times, or NULL if the generator can not jump.
+	/// Returns 0 on (allocation) failure, see { @link cr8r_prng_jump }
+	bool (*jump)(void*, uint64_t n);
 	/// Called after "randomizing" the state.
 	/// Typically the state is initialized using splitmix and then this function is called to
 	/// ensure it is good.
@@ -129,29 +142,69 @@ bool cr8r_prng_seed(cr8r_prng*, uint64_t);
 /// Some prngs have a different natural output size than 32 bits, but all have been coerced into
 /// a size of 32 bits.  This is because a lot of the time 32 bits is more than enough and 64 bits
 /// would require 2 calls for LCGs and LFGs, and MTs and Xoroshift can have problems with entropy in
-/// low bits anyway.
+/// low bits anyway.  Generators with 64 bit outputs (MT, Xoroshiro, SplitMix) provide them whole through
+/// { @link cr8r_prng_get_u64 }.
 uint32_t cr8r_prng_get_u32(cr8r_prng*);
 
 /// Get a single uint64_t from a prng
 ///
-/// Always results in 2 calls to self->get_u32 in the current implementation
+/// Uses self->get_u64 if the generator has it, otherwise 2 calls to self->get_u32 (low half first)
 uint64_t cr8r_prng_get_u64(cr8r_prng*);
 
 /// Fill a buffer with random bytes from a prng
 ///
-/// Gotten from ceil(size / 4) calls to self->get_u32
+/// Uses self->fill if the generator has it, otherwise ceil(size / 8) calls to { @link cr8r_prng_get_u64 }.
+/// For generators with a fill callback, this is much faster than getting numbers one at a time,
+/// so code that needs many random numbers should generate them in batches with this.
 void cr8r_prng_get_bytes(cr8r_prng*, uint64_t size, void *buf);
 
+/// Advance a prng as if { @link cr8r_prng_get_u32 } were called n times
+///
+/// Takes O(log n) time (generators step directly for small n, where that is faster):
+/// - LCG: the affine map x -> a*x + c is raised to the nth power by repeated squaring
+/// - Multiplicative LFG: the exponents of the outputs follow an additive recurrence, so the new window is a product of powers
+/// of the current one, with exponents from t**n mod the characteristic polynomial
+/// - Subtract with carry LFG: this is equivalent to an LCG with a 576 bit modulus (Marsaglia and Zaman)
+/// - MT and Xoroshiro: the state is multiplied by x**n mod the minimal polynomial of the generator over F2.
+/// The minimal polynomial is found once with Berlekamp-Massey the first time a generator of the type jumps a long way.
+/// For MT, this and each long jump take tens of milliseconds, so jump once per thread rather than in a loop
+/// - SplitMix, Philox, and multi lane Xoroshiro: these jump directly.  Since the Philox and multi lane Xoroshiro generators
+/// are streams of bytes, this skips 4*n bytes
+///
+/// For generators whose 64 bit outputs are a single step (Xoroshiro and SplitMix), this is also the same as calling
+/// { @link cr8r_prng_get_u64 } n times.  So threads can each take a disjoint part of one seeded stream by copying a prng
+/// and jumping the copy by a multiple of the part length.
+/// @return 1 on success, 0 if the generator can not jump ("system" and "chacha") or on allocation failure,
+/// in which case the state is unchanged
+bool cr8r_prng_jump(cr8r_prng*, uint64_t n);
+
 /// Get a uint64_t which is uniformly distributed on [a, b).
 ///
-/// The output is not low-biased: if b - a <= 1 << 32, the generator
-/// is sampled 32 bits at a time until a result below the highest multiple
-/// of b - a <= 1 << 32 is obtained.  This should always take less than 2 samples
-/// on average.  If b - a > 1 << 32, the generator is sampled 64 bits at a
-/// time until a result below the highest multiple of b - a <= 1 << 64 is obtained.
-/// This should always take less than 4 32 bit samples on average.
+/// The output is not low-biased.  Uses Lemire's nearly divisionless method: a random number is multiplied by b - a
+/// and the high half of the product is the result, except that the rare products whose low half falls in a small
+/// biased range are rejected and redrawn.  So this usually takes one sample and no divisions.
+/// If b - a < 1 << 32, the generator is sampled 32 bits at a time, otherwise 64 bits at a time.
+/// If b == a, returns a without sampling the generator.
 uint64_t cr8r_prng_uniform_u64(cr8r_prng*, uint64_t a, uint64_t b);
 
+/// Fill a buffer with uint64_t's which are uniformly distributed on [a, b)
+///
+/// Like calling { @link cr8r_prng_uniform_u64 } n times, but the random numbers are generated all at once
+/// with { @link cr8r_prng_get_bytes }, and are always sampled 64 bits at a time.
+/// @param [in] n: number of samples
+/// @param [out] out: buffer for n samples
+void cr8r_prng_fill_uniform_u64(cr8r_prng*, uint64_t a, uint64_t b, uint64_t n, uint64_t *out);
+
+/// Fill a buffer with uint64_t's with decreasing bounds, as needed by a Fisher-Yates shuffle
+///
+/// out[i] is uniformly distributed on [0, bound - i).  The random numbers are generated all at once
+/// with { @link cr8r_prng_get_bytes }.
+/// So to shuffle an array of length len, get indices for bound = len and swap element len - 1 - i with element out[i].
+/// @param [in] bound: exclusive upper bound for out[0]
+/// @param [in] n: number of samples, must be at most bound
+/// @param [out] out: buffer for n samples
+void cr8r_prng_fill_fisher_yates(cr8r_prng*, uint64_t bound, uint64_t n, uint64_t *out);
+
 /// Get a double which is uniformly distributed on [0, 1)
 ///
 /// Does not include denormalized numbers, only normal format doubles
@@ -218,14 +271,46 @@ extern const uint64_t cr8r_prng_2tg_t64[4];
 
 #define CR8R_DEFAULT_PRNG_LCG_SEED 0xe9352d1427990d8e
 
+/// Size in bytes of the buffer a { @link cr8r_prng_init_system } generator refills with one syscall
+#define CR8R_PRNG_SYSTEM_BUF 4096
+
+/// Number of ChaCha20 blocks a { @link cr8r_prng_init_chacha } generator computes per refill
+#define CR8R_PRNG_CHACHA_BLOCKS 16
+
 /// Create a PRNG based on the system's prng device
 ///
 /// On Linux, this is based on "getrandom".
-/// The state size is 0 and attempts to seed generators of
-/// this type fail.
+/// Bytes are read { @link CR8R_PRNG_SYSTEM_BUF } at a time into a buffer in the state, so getting small numbers
+/// does not make a syscall each time, and are erased from the buffer as they are used.
+/// Requests of at least the buffer size read directly into the output.
+/// The buffer is discarded in a child process after fork, so the parent and child never get the same bytes.
+/// Attempts to seed generators of this type fail (and leave the buffer empty).
 /// @return pointer to new system based prng (must be free'd), or NULL on failure (allocation/unsupported)
 cr8r_prng *cr8r_prng_init_system();
 
+/// Compute n consecutive ChaCha20 blocks
+///
+/// This is the block function from RFC 8439, with a 32 bit block counter and 96 bit nonce,
+/// used by { @link cr8r_prng_init_chacha }.  Groups of 8 blocks are computed at once with simd instructions.
+/// @param [in] key: 256 bit key, as little endian words
+/// @param [in] counter: block counter of the first block.  Incremented for each block (wrapping without carrying into the nonce)
+/// @param [in] nonce: 96 bit nonce, as little endian words
+/// @param [in] n: number of blocks
+/// @param [out] out: buffer for n*64 bytes of output
+void cr8r_prng_chacha20_blocks(const uint32_t key[static 8], uint32_t counter, const uint32_t nonce[static 3], uint64_t n, void *out);
+
+/// Create a cryptographically secure PRNG based on ChaCha20 with fast key erasure
+///
+/// The key is read from the system prng.  Each refill computes { @link CR8R_PRNG_CHACHA_BLOCKS } blocks,
+/// replaces the key with the first 32 bytes and hands out the rest, erasing bytes as they are used,
+/// so earlier outputs can not be recovered even if the state leaks.
+/// This makes secure random bytes about as cheap as a non cryptographic generator's, without any syscalls after the first.
+/// Like the system prng, a child process after fork mixes fresh system randomness into the key before generating anything.
+/// { @link cr8r_prng_seed } makes the generator deterministic, which is only useful for testing: a seeded chacha
+/// prng is NOT secure since the key comes from splitmix.
+/// @return pointer to new chacha based prng (must be free'd), or NULL on failure (allocation/getrandom unsupported)
+cr8r_prng *cr8r_prng_init_chacha();
+
 /// Create a PRNG based on a Linear Congruential Generator
 ///
 /// Seed value must not be 0!
@@ -299,6 +384,70 @@ cr8r_prng *cr8r_prng_init_mt(uint64_t seed);
 /// (allocation; algorithm is seed-agnostic)
 cr8r_prng *cr8r_prng_init_xoro(uint64_t seed);
 
+/// Number of interleaved streams in a { @link cr8r_prng_init_xoro_lanes } generator (must be a multiple of 4)
+#define CR8R_PRNG_XORO_LANES 8
+
+/// Create a PRNG which runs several Xoroshiro256** streams in parallel
+///
+/// WARNING: accesses { @link cr8r_default_prng_splitmix }, all accesses to the default splitmix
+/// prng should be done in the same thread or protected by locks.
+/// The generator holds { @link CR8R_PRNG_XORO_LANES } xoroshiro256** states, where lane i is lane 0 jumped
+/// forwards by i*2**128 steps (see { @link cr8r_prng_xoro_jump_t128 }), so the streams never overlap.
+/// Each step advances all lanes at once using gcc vector extensions (with an avx2 clone on x86_64)
+/// and produces one 64 bit output from each lane, in lane order.
+/// So lane 0 produces exactly the same outputs as { @link cr8r_prng_init_xoro } with the same seed.
+/// { @link cr8r_prng_get_bytes } generates whole steps directly into the buffer, and is several times faster than
+/// a single xoroshiro256** generator, while single outputs are taken from a buffer holding the last step.
+/// cr8r_prng_xoro_jump_* functions must not be called on this generator.
+/// @return pointer to new multi lane xoroshiro256** based prng (must be free'd), or NULL on failure
+/// (allocation; algorithm is seed-agnostic)
+cr8r_prng *cr8r_prng_init_xoro_lanes(uint64_t seed);
+
+/// Compute one Philox4x32-10 block
+///
+/// Philox is a counter based generator: the output for a counter is a keyed bijection of it, so any point in the stream
+/// can be computed directly, with no state besides the key and counter.  Matches the Random123 reference implementation.
+/// @param [in] ctr: 128 bit counter
+/// @param [in] key: 64 bit key
+/// @param [out] out: 128 bits of output
+void cr8r_prng_philox4x32(const uint32_t ctr[static 4], const uint32_t key[static 2], uint32_t out[static 4]);
+
+/// Compute one Philox4x64-10 block
+///
+/// See { @link cr8r_prng_philox4x32 }.  The 64 bit version uses 128 bit multiplies, which makes it
+/// faster one block at a time but impossible to vectorize without 64x64 -> 128 bit vector multiplies.
+/// @param [in] ctr: 256 bit counter
+/// @param [in] key: 128 bit key
+/// @param [out] out: 256 bits of output
+void cr8r_prng_philox4x64(const uint64_t ctr[static 4], const uint64_t key[static 2], uint64_t out[static 4]);
+
+/// Create a PRNG based on the Philox4x32-10 counter based generator
+///
+/// Does NOT access { @link cr8r_default_prng_splitmix } or any other global state, so threads can create their own
+/// independent generators with the same key and different streams, or split one stream with { @link cr8r_prng_philox_seek }.
+/// Outputs are the blocks for counters (block, stream) for block = 0, 1, 2, ..., each one 16 bytes.
+/// Bulk fills compute 8 blocks at once with simd instructions.
+/// If seeded with { @link cr8r_prng_seed }, the key and stream are set from splitmix and the generator starts at block 0.
+/// @param [in] key: 64 bit philox key
+/// @param [in] stream: high 64 bits of the counter
+/// @return pointer to new philox based prng (must be free'd), or NULL on failure (allocation)
+cr8r_prng *cr8r_prng_init_philox4x32(uint64_t key, uint64_t stream);
+
+/// Create a PRNG based on the Philox4x64-10 counter based generator
+///
+/// Like { @link cr8r_prng_init_philox4x32 }, except each block is 32 bytes.
+/// The key is (key, 0) and the counter for each block is (block, 0, stream, 0).
+/// @param [in] key: low 64 bits of the philox key
+/// @param [in] stream: third word of the counter
+/// @return pointer to new philox based prng (must be free'd), or NULL on failure (allocation)
+cr8r_prng *cr8r_prng_init_philox4x64(uint64_t key, uint64_t stream);
+
+/// Move a philox based prng to the start of a given block in its stream in constant time
+///
+/// Do not call on non philox prngs, it will scramble your memory.
+/// Blocks are 16 bytes for { @link cr8r_prng_init_philox4x32 } and 32 bytes for { @link cr8r_prng_init_philox4x64 }.
+void cr8r_prng_philox_seek(cr8r_prng*, uint64_t block);
+
 /// Create a PRNG based on Vigna's version of SplitMix
 ///
 /// SplitMix is a light hash applied to a counter.
@@ -0,0 +1,125 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Non-uniform random distributions on top of { @link cr8r_prng }.
+///
+/// Normal and exponential variates use the ziggurat method (Marsaglia and Tsang, "The Ziggurat Method for Generating
+/// Random Variables") with 256 layers, which takes one 64 bit output and a couple of comparisons for about 99% of samples
+/// and only calls exp or log for the rest.  Poisson and binomial variates use inversion for small means and
+/// Hörmann's transformed rejection (PTRS and BTRS) for large ones, so the expected time is O(1) in both cases.
+/// Alias tables sample from any discrete distribution in O(1) time after O(n) setup.
+///
+/// Every sampler has a fill variant.  The normal, exponential, and alias table ones generate random bits in batches with
+/// { @link cr8r_prng_get_bytes }, which is much faster than getting them one at a time for generators with a native fill callback,
+/// and the Poisson and binomial ones only set up their constants once.
+/// The fill variants produce samples from the same distribution as the single sample functions,
+/// but not necessarily the same samples for the same prng state.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <crater/prand.h>
+
+/// Get a double with the standard normal distribution (mean 0, variance 1)
+///
+/// For mean mu and standard deviation sigma, use mu + sigma*cr8r_prng_normal(prng).
+/// Uses the ziggurat method.  The tables are computed the first time any normal sampler is called.
+double cr8r_prng_normal(cr8r_prng*);
+
+/// Fill a buffer with doubles with the standard normal distribution
+///
+/// @param [in] n: number of samples
+/// @param [out] out: buffer for n samples
+void cr8r_prng_fill_normal(cr8r_prng*, uint64_t n, double *out);
+
+/// Get a double with the standard exponential distribution (rate 1, mean 1)
+///
+/// For rate lambda, divide by lambda.
+/// Uses the ziggurat method.  The tables are computed the first time any exponential sampler is called.
+double cr8r_prng_exponential(cr8r_prng*);
+
+/// Fill a buffer with doubles with the standard exponential distribution
+///
+/// @param [in] n: number of samples
+/// @param [out] out: buffer for n samples
+void cr8r_prng_fill_exponential(cr8r_prng*, uint64_t n, double *out);
+
+/// Get a uint64_t with the Poisson distribution with mean lambda
+///
+/// For lambda < 10, this uses inversion (sequential search from 0), and otherwise
+/// Hörmann's PTRS (transformed rejection with squeeze), which accepts about 90% of candidates without evaluating any logs.
+/// When sampling many values with the same lambda, { @link cr8r_prng_fill_poisson } only sets up the constants once.
+/// @param [in] lambda: mean, must be nonnegative and finite
+uint64_t cr8r_prng_poisson(cr8r_prng*, double lambda);
+
+/// Fill a buffer with uint64_t's with the Poisson distribution with mean lambda
+///
+/// @param [in] lambda: mean, must be nonnegative and finite
+/// @param [in] n: number of samples
+/// @param [out] out: buffer for n samples
+void cr8r_prng_fill_poisson(cr8r_prng*, double lambda, uint64_t n, uint64_t *out);
+
+/// Get a uint64_t with the binomial distribution, ie the number of successes in trials independent trials with probability p
+///
+/// For p > 1/2, this samples the number of failures instead.  Then for trials*p < 10, this uses inversion, and otherwise
+/// Hörmann's BTRS (transformed rejection with squeeze).
+/// @param [in] trials: number of trials
+/// @param [in] p: probability of success for each trial, in [0, 1]
+uint64_t cr8r_prng_binomial(cr8r_prng*, uint64_t trials, double p);
+
+/// Fill a buffer with uint64_t's with the binomial distribution
+///
+/// @param [in] trials: number of trials
+/// @param [in] p: probability of success for each trial, in [0, 1]
+/// @param [in] n: number of samples
+/// @param [out] out: buffer for n samples
+void cr8r_prng_fill_binomial(cr8r_prng*, uint64_t trials, double p, uint64_t n, uint64_t *out);
+
+/// One column of an alias table
+typedef struct{
+	/// A sample landing in this column gives its own index if a 64 bit uniform value is below threshold, and alias otherwise
+	uint64_t threshold;
+	/// The other index in this column
+	uint64_t alias;
+} cr8r_prng_alias_ent;
+
+/// Alias table for sampling indices from an arbitrary discrete distribution in O(1) time
+///
+/// Built with Vose's method, so each column holds (the rest of) one index and part of at most one other index.
+/// Sampling takes one 64 bit output: the high half of its product with n picks the column, and the low half is compared
+/// to the column's threshold.  This is biased by at most n/2**64, which is far below what any test could detect.
+typedef struct{
+	/// Number of indices
+	uint64_t n;
+	/// Columns
+	cr8r_prng_alias_ent *ents;
+} cr8r_prng_alias;
+
+/// Build an alias table for the distribution with given weights
+///
+/// Weights do not need to be normalized.
+/// @param [in] n: number of weights, must be nonzero
+/// @param [in] weights: nonnegative weights, which must have a positive finite sum
+/// @return 1 on success, 0 on failure (allocation or invalid weights)
+bool cr8r_prng_alias_init(cr8r_prng_alias*, uint64_t n, const double *weights);
+
+/// Free the columns of an alias table
+void cr8r_prng_alias_delete(cr8r_prng_alias*);
+
+/// Sample an index from an alias table
+///
+/// Returns i with probability weights[i]/sum(weights)
+uint64_t cr8r_prng_alias_sample(const cr8r_prng_alias*, cr8r_prng*);
+
+/// Fill a buffer with indices sampled from an alias table
+///
+/// @param [in] n: number of samples
+/// @param [out] out: buffer for n samples
+void cr8r_prng_alias_fill(const cr8r_prng_alias*, cr8r_prng*, uint64_t n, uint64_t *out);
+
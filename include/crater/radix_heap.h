@@ -0,0 +1,104 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Radix heaps, a priority queue for monotone integer keys.
+///
+/// A radix heap only works if keys are never smaller than the last key popped, which is the case for
+/// Dijkstra's algorithm and many event simulations.  In exchange, push and decrease key take constant time and
+/// pop takes amortized O(log(C)) time where C is the largest key, without any comparisons between elements.
+/// Elements are kept in 65 buckets based on the highest bit where their key differs from the last key popped.
+/// Popping from an empty bucket 0 finds the first nonempty bucket and redistributes it into lower buckets, and
+/// each element can only move to lower buckets 64 times.
+///
+/// This radix heap is indexed: it holds ids in [0, n), each with a key, so that keys can be decreased by id.
+/// Ids can correspond to indices of graph nodes or any other array.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <crater/vec.h>
+
+/// Bucket number for ids which are not in a radix heap
+#define CR8R_RADIX_HEAP_ABSENT UINT8_MAX
+
+/// Indexed radix heap
+typedef struct{
+	/// Bucket i > 0 holds ids whose keys first differ from last in bit i - 1 (counting from the lowest bit), and bucket 0
+	/// holds ids whose keys equal last
+	cr8r_vec buckets[65];
+	/// Key of each id
+	uint64_t *keys;
+	/// Index of each id within its bucket
+	uint64_t *slots;
+	/// Bucket of each id, or { @link CR8R_RADIX_HEAP_ABSENT }
+	uint8_t *where;
+	/// Number of possible ids
+	uint64_t n;
+	/// Number of ids currently in the heap
+	uint64_t len;
+	/// Last key popped (or 0).  Keys smaller than this can't be added
+	uint64_t last;
+} cr8r_radix_heap;
+
+/// Initialize an empty radix heap
+///
+/// @param [in] n: number of possible ids
+/// @return 1 on success, 0 on (allocation) failure
+bool cr8r_radix_heap_init(cr8r_radix_heap*, uint64_t n);
+
+/// Free the buffers of a radix heap
+void cr8r_radix_heap_delete(cr8r_radix_heap*);
+
+/// Remove all ids from a radix heap and reset the last key to 0
+void cr8r_radix_heap_clear(cr8r_radix_heap*);
+
+/// Check if an id is currently in a radix heap
+static inline bool cr8r_radix_heap_contains(const cr8r_radix_heap *self, uint64_t id){
+	return id < self->n && self->where[id] != CR8R_RADIX_HEAP_ABSENT;
+}
+
+/// Add an id to a radix heap
+///
+/// Ids which were popped before can be pushed again.
+/// @param [in] id: id to add, must be less than n and not currently in the heap
+/// @param [in] key: key of the id, must be at least self->last
+/// @return 1 on success, 0 on failure (invalid id or key, or allocation failure)
+bool cr8r_radix_heap_push(cr8r_radix_heap*, uint64_t id, uint64_t key);
+
+/// Decrease the key of an id in a radix heap in constant time
+///
+/// @param [in] id: id whose key to decrease, must be in the heap
+/// @param [in] key: the new key, must be at least self->last and at most the current key
+/// @return 1 on success, 0 on failure (id not in heap, invalid key, or allocation failure, in which case nothing is changed)
+bool cr8r_radix_heap_decrease(cr8r_radix_heap*, uint64_t id, uint64_t key);
+
+/// Remove the id with the smallest key from a radix heap
+///
+/// If several ids have the smallest key, which one is removed is unspecified.
+/// @param [out] id, key: the id and its key.  Either can be NULL
+/// @return 1 on success, 0 on failure (empty heap, or allocation failure, in which case nothing is changed)
+bool cr8r_radix_heap_pop(cr8r_radix_heap*, uint64_t *id, uint64_t *key);
+
+/// Convert a nonnegative double to a radix heap key
+///
+/// The bits of nonnegative doubles (not NaN) are ordered the same way as the doubles, so the bits can be used as keys.
+static inline uint64_t cr8r_radix_heap_key_f64(double x){
+	uint64_t key;
+	memcpy(&key, &x, sizeof(key));
+	return key;
+}
+
+/// Convert a radix heap key back to a double, see { @link cr8r_radix_heap_key_f64 }
+static inline double cr8r_radix_heap_f64_key(uint64_t key){
+	double x;
+	memcpy(&x, &key, sizeof(x));
+	return x;
+}
+
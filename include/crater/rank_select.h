@@ -0,0 +1,85 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Rank/select index over a { @link cr8r_bvec }, for counting the set bits before a position and finding the position of the jth set bit.
+///
+/// The layout follows Zhou, Andersen, and Kaminsky's "poppy": bits are split into 2048 bit blocks, and each block has one
+/// 64 bit entry holding the number of set bits between the start of its 2**32 bit region and the block, plus the counts
+/// of its first three 512 bit sub blocks.  Together with one 64 bit count per region, this takes about 3.1% of the size of the bit vector.
+/// Rank reads one entry and popcounts at most 8 words, so it takes O(1) time.
+/// Select additionally keeps the block containing every 8192nd set bit (at most 0.4% more space),
+/// and binary searches the entries between the samples before and after the set bit it is looking for,
+/// so it is O(1) unless the set bits are very unevenly spread out, and O(log(len)) in any case.
+///
+/// The index does not own or keep a pointer to the bit vector, so the same bit vector must be passed to every function.
+/// If some bits are changed, { @link cr8r_bvec_rs_update } only recounts the blocks containing them
+/// (and adjusts the counts after them), instead of rebuilding the whole index.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <crater/bitvec.h>
+
+/// Rank/select index over a bit vector
+typedef struct{
+	/// Length of the bit vector (in bits) when the index was built
+	uint64_t len;
+	/// Total number of set bits
+	uint64_t ones;
+	/// Number of 2048 bit blocks, ie ceil(len/2048)
+	uint64_t num_blocks;
+	/// Number of set bits before each 2**32 bit region
+	uint64_t *regions;
+	/// For each block, the low 32 bits are the number of set bits between the start of its region and the block,
+	/// and the next 30 bits are the counts of its first three 512 bit sub blocks (10 bits each)
+	uint64_t *blocks;
+	/// Number of select samples, ie ceil(ones/8192)
+	uint64_t num_samples;
+	/// Allocated length of samples
+	uint64_t samples_cap;
+	/// For each k, the index of the block containing set bit 8192*k (counting from 0)
+	uint32_t *samples;
+} cr8r_bvec_rs;
+
+/// Build a rank/select index over a bit vector
+///
+/// Takes O(len) time.  Bit vectors can have at most 2**43 bits.
+/// @param [out] self: the index to initialize
+/// @param [in] bvec: bit vector to index
+/// @return 1 on success, 0 on failure (allocation or bit vector too long)
+bool cr8r_bvec_rs_init(cr8r_bvec_rs *self, const cr8r_bvec *bvec);
+
+/// Free the buffers of a rank/select index
+void cr8r_bvec_rs_delete(cr8r_bvec_rs *self);
+
+/// Update a rank/select index after the bits in [a, b) of the bit vector have changed
+///
+/// Recounts the blocks overlapping [a, b) and shifts the counts of later blocks if the number of set bits changed,
+/// which is much cheaper than a rebuild for small ranges.
+/// The length of the bit vector must not have changed; if it has, delete the index and build a new one.
+/// @param [in] bvec: the bit vector the index was built over
+/// @param [in] a, b: the range of bits which may have changed
+/// @return 1 on success, 0 on failure (allocation, or bvec->len has changed)
+bool cr8r_bvec_rs_update(cr8r_bvec_rs *self, const cr8r_bvec *bvec, uint64_t a, uint64_t b);
+
+/// Count the set bits before position i, ie in [0, i)
+///
+/// @param [in] bvec: the bit vector the index was built over
+/// @param [in] i: position, must be at most bvec->len
+/// @return the number of set bits in [0, i)
+uint64_t cr8r_bvec_rank(const cr8r_bvec_rs *self, const cr8r_bvec *bvec, uint64_t i);
+
+/// Find the position of the jth set bit (counting from 0)
+///
+/// This is the inverse of rank, ie if j < self->ones and i is the result, then bit i is set and cr8r_bvec_rank(self, bvec, i) == j.
+/// @param [in] bvec: the bit vector the index was built over
+/// @param [in] j: index of the set bit to find
+/// @return the position of the jth set bit, or bvec->len if j >= self->ones
+uint64_t cr8r_bvec_select(const cr8r_bvec_rs *self, const cr8r_bvec *bvec, uint64_t j);
+
@@ -0,0 +1,137 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Reservoir sampling, for picking k random elements from a vector or a stream of unknown length.
+///
+/// A reservoir keeps a sample of up to k elements, and elements are pushed into it one at a time or in batches.
+/// After any number of pushes, the sample is a uniformly random subset of the elements pushed so far
+/// (or a weighted random subset, for weighted reservoirs), without replacement.
+///
+/// Uniform reservoirs use Li's Algorithm L, which computes how many elements to skip before the next one that will be kept
+/// instead of drawing a random number for every element, so sampling from n elements takes O(k(1 + log(n/k))) random numbers.
+/// { @link cr8r_reservoir_push_many } and { @link cr8r_vec_sample } jump straight to the kept elements, so they also take
+/// O(k(1 + log(n/k))) time rather than O(n).
+///
+/// Weighted reservoirs use Efraimidis and Spirakis's A-ExpJ, which similarly computes how much total weight to skip before the next
+/// kept element, so it also takes O(k(1 + log(n/k))) random numbers (but still has to look at the weight of every element).
+/// Each element gets a random key u**(1/w) where w is its weight, and the k elements with the largest keys are kept,
+/// so the sample is the same as sampling k elements one at a time with probability proportional to weight and without replacement.
+///
+/// Elements are copied into the sample with ft->copy if it is not NULL and memcpy otherwise, and elements evicted from the sample
+/// are deleted with ft->del if it is not NULL, so the caller keeps ownership of the elements it pushes.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <crater/vec.h>
+#include <crater/prand.h>
+
+/// Reservoir for sampling k elements uniformly from a stream
+typedef struct{
+	/// The elements sampled so far, in no particular order
+	cr8r_vec sample;
+	/// Maximum size of the sample
+	uint64_t k;
+	/// Number of elements pushed so far
+	uint64_t n;
+	/// Index of the next element which will be kept
+	uint64_t next;
+	/// Algorithm L keeps an element with probability proportional to W, which decreases as more elements are seen
+	double w;
+	/// Random number generator, not owned by the reservoir
+	cr8r_prng *prng;
+} cr8r_reservoir;
+
+/// Reservoir for sampling k elements with given weights from a stream
+typedef struct{
+	/// The elements sampled so far, in no particular order
+	cr8r_vec sample;
+	/// Min heap of the keys of the sampled elements, as (log(key), index in sample) pairs
+	cr8r_vec keys;
+	/// Maximum size of the sample
+	uint64_t k;
+	/// Total weight to skip before the next element which will be kept
+	double skip;
+	/// Random number generator, not owned by the reservoir
+	cr8r_prng *prng;
+} cr8r_wreservoir;
+
+/// Initialize a reservoir
+///
+/// @param [in] k: maximum size of the sample
+/// @param [in] prng: random number generator to use.  Must stay valid until the reservoir is deleted
+/// @return 1 on success, 0 on failure (allocation)
+bool cr8r_reservoir_init(cr8r_reservoir*, cr8r_vec_ft*, uint64_t k, cr8r_prng *prng);
+
+/// Delete a reservoir and all the elements in its sample
+void cr8r_reservoir_delete(cr8r_reservoir*, cr8r_vec_ft*);
+
+/// Push one element into a reservoir
+///
+/// Only draws random numbers if the element is kept, so this is O(1) and usually just increments a counter.
+/// @return 1 on success, 0 on failure (allocation)
+bool cr8r_reservoir_push(cr8r_reservoir*, cr8r_vec_ft*, const void *e);
+
+/// Push an array of elements into a reservoir
+///
+/// Only looks at the elements which are kept, so this takes O(number kept) time, which is O(k(1 + log((n + self->n)/self->n)))
+/// on average.
+/// @param [in] es: array of n elements
+/// @return 1 on success, 0 on failure (allocation)
+bool cr8r_reservoir_push_many(cr8r_reservoir*, cr8r_vec_ft*, const void *es, uint64_t n);
+
+/// Get the number of upcoming elements which will be discarded
+///
+/// A stream which can skip elements cheaply (eg by seeking in a file) can skip this many elements and
+/// call { @link cr8r_reservoir_advance } instead of pushing them.
+uint64_t cr8r_reservoir_skip(const cr8r_reservoir*);
+
+/// Count elements as pushed without looking at them
+///
+/// @param [in] n: number of elements to skip, must be at most { @link cr8r_reservoir_skip }
+/// @return 1 on success, 0 if n is too large (in which case the reservoir is not changed)
+bool cr8r_reservoir_advance(cr8r_reservoir*, uint64_t n);
+
+/// Initialize a weighted reservoir
+///
+/// @param [in] k: maximum size of the sample
+/// @param [in] prng: random number generator to use.  Must stay valid until the reservoir is deleted
+/// @return 1 on success, 0 on failure (allocation)
+bool cr8r_wreservoir_init(cr8r_wreservoir*, cr8r_vec_ft*, uint64_t k, cr8r_prng *prng);
+
+/// Delete a weighted reservoir and all the elements in its sample
+void cr8r_wreservoir_delete(cr8r_wreservoir*, cr8r_vec_ft*);
+
+/// Push one element with a given weight into a weighted reservoir
+///
+/// Only draws random numbers if the element is kept, and then takes O(log(k)) time to update the heap of keys.
+/// @param [in] weight: weight of the element.  Elements with weight 0 (or negative or NaN weights) are never kept
+/// @return 1 on success, 0 on failure (allocation)
+bool cr8r_wreservoir_push(cr8r_wreservoir*, cr8r_vec_ft*, const void *e, double weight);
+
+/// Sample k elements of a vector uniformly without replacement
+///
+/// Equivalent to pushing all elements into a { @link cr8r_reservoir }, but only looks at the elements which are kept.
+/// If k >= src->len, all elements are copied.
+/// @param [out] dest: vector to store the sample in, in no particular order.  Initialized by this function
+/// @param [in] src: vector to sample from
+/// @param [in] k: number of elements to sample
+/// @return 1 on success, 0 on failure (allocation)
+bool cr8r_vec_sample(cr8r_vec *dest, const cr8r_vec *src, cr8r_vec_ft *ft, uint64_t k, cr8r_prng *prng);
+
+/// Sample k elements of a vector with given weights without replacement
+///
+/// Equivalent to pushing all elements into a { @link cr8r_wreservoir }.
+/// @param [out] dest: vector to store the sample in, in no particular order.  Initialized by this function
+/// @param [in] src: vector to sample from
+/// @param [in] k: number of elements to sample.  If fewer than k elements have positive weight, all of them are in the sample
+/// @param [in] weights: weight of each element of src
+/// @return 1 on success, 0 on failure (allocation)
+bool cr8r_vec_sample_weighted(cr8r_vec *dest, const cr8r_vec *src, cr8r_vec_ft *ft, uint64_t k, const double *weights, cr8r_prng *prng);
+
@@ -11,6 +11,8 @@
 /// Maintains an array of "slabs", buffers of many fixed size elements.
 /// The unallocated elements are linked together so that unallocated elements can
 /// be found and returned and allocated elements can be deallocated trivially.
+/// Elements which have never been allocated are not put on this list, instead they are handed out
+/// from a "bump region" at the end of the newest slab, so slab memory is only touched as it is used.
 ///
 /// This Source Code Form is subject to the terms of the Mozilla Public
 /// License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -19,24 +21,48 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#include <crater/stats.h>
+
+/// A single slab (element buffer) owned by a slab allocator
+typedef struct{
+	/// Pointer to the element buffer
+	void *buf;
+	/// Number of elements in the buffer
+	uint64_t cap;
+} cr8r_sla_slab;
+
 typedef struct{
-	/// Array of pointers to "slabs" (elements buffers).  Each buffer is twice the size of the last.
+	/// Array of "slabs" (elements buffers).  Each buffer is twice the size of the last, up to { @link max_slab_cap }.
 	/// New buffers are allocated only whem all elements on all buffers have been allocated.
 	/// Creating new buffers in this way allows the backing storage to be increased without needing to move existing allocated elements.
-	void **slabs;
-	/// Pointer to first unallocated element.  Internally, each unallocated element contains a pointer to the next unallocated element
+	cr8r_sla_slab *slabs;
+	/// Pointer to first freed element.  Internally, each freed element contains a pointer to the next freed element
 	/// at the beginning of its memory, hence slab allocators can only be created if the element size is >= sizeof(void*)
 	void *first_elem;
+	/// Pointer to the first element of the bump region, the part of slab { @link bump_slab } which has never been allocated.
+	/// Once the free list is empty, elements are taken from here.
+	void *bump;
+	/// Pointer one past the end of the bump region
+	void *bump_end;
+	/// Index of the slab containing the bump region.  Slabs after this one have not been used at all
+	/// (this only happens after { @link cr8r_sla_reset }), and the bump region moves to them once it is exhausted.
+	uint64_t bump_slab;
 	/// Number of slabs
 	uint64_t slabs_len;
-	/// Capacity of last slab
+	/// Capacity of last slab.  The next slab will be twice this big (subject to { @link max_slab_cap })
 	uint64_t slab_cap;
 	/// Size of a single element
 	uint64_t elem_size;
+	/// Maximum capacity of any slab allocated after the first one, or 0 for no limit.
+	/// Once slabs reach this size, the allocator grows linearly instead of doubling, so that a one-off spike
+	/// in usage does not leave an enormous slab behind.  Set to 0 by { @link cr8r_sla_init }, and may be
+	/// changed directly at any time.
+	uint64_t max_slab_cap;
 } cr8r_sla;
 
 /// Initialize a slab allocator
 ///
+/// The initial slab is not written to, so its pages are only faulted in as elements are allocated.
 /// @param [out] self: slab allocator to initialize
 /// @param [in] elem_size: size of a single element in bytes.  allocations returned will be this big.  must be at least sizeof(void*)
 /// @param [in] cap: the number of elements to reserve space for initially, which is all reserved in a single "slab".  must be at least 1
@@ -49,6 +75,27 @@ bool cr8r_sla_init(cr8r_sla *self, uint64_t elem_size, uint64_t cap);
 /// @param [in, out] self: slab allocator to delete
 void cr8r_sla_delete(cr8r_sla *self);
 
+/// Free every element of a slab allocator at once
+///
+/// All pointers previously returned by { @link cr8r_sla_alloc } become invalid.  This allows using the slab allocator
+/// as an arena: many objects can be allocated and then released together without freeing them individually.
+/// The first slab is always kept.  If release is false, all other slabs are kept as well so the allocator can be
+/// refilled without requesting memory again, otherwise they are returned to the system.
+/// Takes O(1) time if release is false, or O(s) time to free s slabs otherwise.
+/// @param [in, out] self: slab allocator to reset
+/// @param [in] release: if true, free all slabs except the first, otherwise keep them for reuse
+void cr8r_sla_reset(cr8r_sla *self, bool release);
+
+/// Return completely unallocated slabs to the system
+///
+/// Finds all slabs none of whose elements are currently allocated and frees them, removing their elements from the free list.
+/// The first slab is never released.  Afterwards { @link cr8r_sla::slab_cap } is set to the capacity of the largest remaining slab,
+/// so future growth restarts from there instead of from the largest slab that was ever allocated.
+/// Takes O(f*log(s)) time where f is the number of free elements and s is the number of slabs.
+/// @param [in, out] self: slab allocator to trim
+/// @return the number of slabs released (0 if none were completely free or if temporary storage could not be allocated)
+uint64_t cr8r_sla_trim(cr8r_sla *self);
+
 /// Allocate an object
 ///
 /// If successful, the returned pointer will point to uninitialized memory with the element size of the slab allocator.
@@ -69,3 +116,11 @@ void *cr8r_sla_alloc(cr8r_sla *self);
 /// @param [in] p: pointer to free
 void cr8r_sla_free(cr8r_sla *self, void *p);
 
+/// Compute snapshot statistics for a slab allocator
+///
+/// Walks the free list, so this takes O(f*log(s)) time like { @link cr8r_sla_trim }.
+/// If temporary storage cannot be allocated, { @link cr8r_sla_stats::free_slabs } is left as 0.
+/// @param [in] self: slab allocator to examine
+/// @param [out] stats: statistics to fill in
+void cr8r_sla_get_stats(const cr8r_sla *self, cr8r_sla_stats *stats);
+
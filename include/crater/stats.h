@@ -0,0 +1,128 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Opt-in statistics for Crater containers and allocators
+
+/// There are two kinds of statistics.  Event counters (resizes, rotations, probes, and so on) are accumulated
+/// in a thread local { @link cr8r_counters } while containers are used, but only if the library is compiled with
+/// CR8R_STATS defined.  Otherwise the instrumentation compiles to nothing and the counters stay 0, so there is no cost
+/// to leaving the calls in.  Snapshot statistics (probe length histograms, tree height, slab utilization, and so on)
+/// are computed on demand by walking a container with functions like { @link cr8r_hash_get_stats }, and are always available.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/// Number of buckets in { @link cr8r_hash_stats::probe_hist }.  The last bucket counts all longer probe sequences.
+#define CR8R_STATS_PROBE_BUCKETS 16
+
+/// Event counters, accumulated per thread when compiled with CR8R_STATS
+typedef struct{
+	/// Number of times a vector had to grow to fit more elements
+	uint64_t vec_grows;
+	/// Number of calls to a vector's ft->resize (including growing, trimming, and freeing)
+	uint64_t vec_resizes;
+	/// Number of times a hash table started expanding into a new internal table
+	uint64_t hash_resizes;
+	/// Number of entries moved by incremental rehashing
+	uint64_t hash_moves;
+	/// Number of lookups in a hash table (including those done by insert and remove)
+	uint64_t hash_lookups;
+	/// Total number of slots examined by those lookups
+	uint64_t hash_probes;
+	/// Number of single rotations done to rebalance avl trees
+	uint64_t avl_rotations;
+	/// Number of slabs allocated by slab allocators, including the first
+	uint64_t sla_slabs_allocated;
+	/// Number of slabs released by { @link cr8r_sla_trim } and { @link cr8r_sla_reset }
+	uint64_t sla_slabs_released;
+} cr8r_counters;
+
+/// Event counters for the current thread
+extern _Thread_local cr8r_counters cr8r_stats_counters;
+
+#if defined(CR8R_STATS) || defined(DOXYGEN)
+/// Add n to an event counter.  Compiles to nothing unless CR8R_STATS is defined
+#define CR8R_STATS_ADD(field, n) ((void)(cr8r_stats_counters.field += (n)))
+#else
+#define CR8R_STATS_ADD(field, n) ((void)0)
+#endif
+
+/// Increment an event counter.  Compiles to nothing unless CR8R_STATS is defined
+#define CR8R_STATS_INC(field) CR8R_STATS_ADD(field, 1)
+
+/// Snapshot statistics for a hash table, see { @link cr8r_hash_get_stats }
+typedef struct{
+	/// Number of entries present
+	uint64_t len;
+	/// Total number of slots in both internal tables
+	uint64_t slots;
+	/// Number of slots whose entry was removed and which have not been reused yet
+	uint64_t tombstones;
+	/// True if the table is partway through incremental rehashing
+	bool resizing;
+	/// Longest probe sequence needed to find any present entry (0 if it is in its home slot)
+	uint64_t max_probe;
+	/// Average probe sequence length needed to find a present entry
+	double avg_probe;
+	/// probe_hist[i] is the number of entries found after i probes past the home slot
+	uint64_t probe_hist[CR8R_STATS_PROBE_BUCKETS];
+} cr8r_hash_stats;
+
+/// Snapshot statistics for an avl tree, see { @link cr8r_avl_get_stats }
+typedef struct{
+	/// Number of nodes
+	uint64_t nodes;
+	/// Height of the tree (0 for an empty tree, 1 for a single node)
+	uint64_t height;
+	/// Average depth of a node (1 for the root)
+	double avg_depth;
+} cr8r_avl_stats;
+
+/// Snapshot statistics for a slab allocator, see { @link cr8r_sla_get_stats }
+typedef struct{
+	/// Number of slabs
+	uint64_t slabs;
+	/// Total number of elements in all slabs
+	uint64_t cap;
+	/// Number of elements currently allocated
+	uint64_t allocated;
+	/// Number of freed elements waiting on the free list
+	uint64_t free_listed;
+	/// Number of elements which have never been allocated (the bump region and untouched slabs)
+	uint64_t untouched;
+	/// Number of slabs with no allocated elements, which { @link cr8r_sla_trim } could release (the first slab is never counted)
+	uint64_t free_slabs;
+	/// Fraction of freed elements among those which have ever been allocated: free_listed/(allocated + free_listed).
+	/// High fragmentation with few free_slabs means freed elements are scattered across slabs.
+	double fragmentation;
+} cr8r_sla_stats;
+
+/// Print the event counters of the current thread
+/// @param [in] file: where to print
+void cr8r_stats_dump(FILE *file);
+
+/// Reset the event counters of the current thread to 0
+void cr8r_stats_clear();
+
+/// Print hash table snapshot statistics
+/// @param [in] file: where to print
+/// @param [in] stats: statistics to print
+void cr8r_hash_stats_dump(FILE *file, const cr8r_hash_stats *stats);
+
+/// Print avl tree snapshot statistics
+/// @param [in] file: where to print
+/// @param [in] stats: statistics to print
+void cr8r_avl_stats_dump(FILE *file, const cr8r_avl_stats *stats);
+
+/// Print slab allocator snapshot statistics
+/// @param [in] file: where to print
+/// @param [in] stats: statistics to print
+void cr8r_sla_stats_dump(FILE *file, const cr8r_sla_stats *stats);
+
@@ -175,6 +175,19 @@ void cr8r_vec_clear(cr8r_vec*, cr8r_vec_ft*);
 /// cause any remotely meaningful patterns.
 void cr8r_vec_shuffle(cr8r_vec*, cr8r_vec_ft*, cr8r_prng*);
 
+/// Shuffle a large vector into a random permutation using multiple threads
+///
+/// { @link cr8r_vec_shuffle } takes a cache miss for almost every element of a vector much larger than the cache.
+/// Instead, this scatters the elements into random buckets which fit in cache, and then shuffles each bucket
+/// with Fisher-Yates.  This is also uniform, and both parts split across threads.
+/// Each thread uses its own multi lane xoroshiro generator (see { @link cr8r_prng_init_xoro_lanes }) seeded from prng,
+/// so the result is reproducible for a given prng state and number of threads.
+/// Elements are moved with memcpy, not ft->swap, and a temporary buffer as large as the vector is allocated.
+/// Small vectors (or if allocation fails) are shuffled with { @link cr8r_vec_shuffle } instead.
+/// @param [in] threads: maximum number of threads to use at once, including the calling thread.
+/// 0 or 1 means only the calling thread is used, but large vectors are still shuffled in buckets.
+void cr8r_vec_shuffle_mt(cr8r_vec*, cr8r_vec_ft*, cr8r_prng*, uint64_t threads);
+
 
 /// Get the element at a given index
 ///
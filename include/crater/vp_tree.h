@@ -0,0 +1,87 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Vantage point trees, for nearest neighbor and radius searches in arbitrary metric spaces.
+///
+/// KD trees (see { @link cr8r_kd_ft }) split along coordinates and so only work for points with coordinates.
+/// A vantage point tree only needs a distance function satisfying the triangle inequality, so it also works
+/// for things like great circle distance between points on a sphere or edit distance between strings.
+/// Each subtree picks one of its points as the vantage point, and splits the rest into an inner half which is
+/// at most the median distance from the vantage point and an outer half which is at least the median distance.
+///
+/// Like a kd tree, a vantage point tree is stored implicitly in a vector: the subtree consisting of the points
+/// in [a, b) has its vantage point at a, its inner subtree at [a + 1, m), and its outer subtree at [m, b),
+/// where m = a + 1 + (b - a - 1)/2.  The only extra storage is the median distance for each vantage point.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include <crater/vec.h>
+
+typedef struct cr8r_vp_ft cr8r_vp_ft;
+/// Function table for vantage point tree
+struct cr8r_vp_ft{
+	/// Subtable for vector ft, see { @link cr8r_kd_ft }
+	cr8r_vec_ft super;
+	/// find the distance between two points
+	///
+	/// Must be a metric: nonnegative, symmetric, and satisfy the triangle inequality.
+	/// Note this is the actual distance, not the squared distance like { @link cr8r_kd_ft } uses.
+	double (*dist)(const cr8r_vp_ft *ft, const void *a, const void *b);
+};
+
+/// Median distances for a vantage point tree
+///
+/// The points themselves are in the vector passed to { @link cr8r_vp_build }.
+typedef struct{
+	/// radii[a] is the distance from the vantage point at a to the boundary between its inner and outer subtrees
+	double *radii;
+	/// Number of points in the tree
+	uint64_t len;
+} cr8r_vp_tree;
+
+/// Rearrange a vector of points into a vantage point tree
+///
+/// Takes O(n log(n)) distance computations.
+/// @param [in, out] ents: points to arrange.  Must not be modified while the tree is in use.
+/// @param [in] ft: function table
+/// @return 1 on success, 0 on (allocation) failure
+bool cr8r_vp_build(cr8r_vp_tree*, cr8r_vec *ents, cr8r_vp_ft *ft);
+
+/// Free the median distances of a vantage point tree
+void cr8r_vp_delete(cr8r_vp_tree*);
+
+/// Find the k closest points to a given point
+///
+/// Subtrees are searched nearest first, and skipped if the triangle inequality shows they can't contain
+/// any point closer than the current kth closest point.
+/// @param [in] ents: the vector passed to { @link cr8r_vp_build }
+/// @param [in] pt: point to find k closest points to
+/// @param [in] k: the number of points to find
+/// @param [out] out: vector where the k closest points will be stored, sorted by increasing distance.
+/// Must be initialized but will be cleared before use.
+/// @return true on success, false on (allocation) failure
+bool cr8r_vp_k_closest(const cr8r_vp_tree*, const cr8r_vec *ents, cr8r_vp_ft *ft, const void *pt, uint64_t k, cr8r_vec *out);
+
+/// Find all points within a given distance of a point
+///
+/// @param [in] ents: the vector passed to { @link cr8r_vp_build }
+/// @param [in] pt: center of the search
+/// @param [in] r: radius of the search.  Points at distance exactly r are included.
+/// @param [out] out: vector where the points will be stored.  Must be initialized but will be cleared before use.
+/// The points are in no specified order.
+/// @return true on success, false on (allocation) failure
+bool cr8r_vp_within_radius(const cr8r_vp_tree*, const cr8r_vec *ents, cr8r_vp_ft *ft, const void *pt, double r, cr8r_vec *out);
+
+/// Count the points within a given distance of a point
+///
+/// Works like { @link cr8r_vp_within_radius }, but without storing the points.
+/// @return the number of points at distance at most r from pt
+uint64_t cr8r_vp_count_within_radius(const cr8r_vp_tree*, const cr8r_vec *ents, cr8r_vp_ft *ft, const void *pt, double r);
+
@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <crater/arena.h>
+
+// slabs for a size class stop doubling once they reach this many bytes
+#define CR8R_ARENA_MAX_SLAB_BYTES (1ULL << 20)
+
+typedef struct large_header large_header;
+struct large_header{
+	large_header *prev, *next;
+};
+
+// find the size class for an allocation of a given size, or CR8R_ARENA_NUM_CLASSES if it is too large for all of them
+static uint64_t size_class(uint64_t size){
+	if(size <= 1ULL << CR8R_ARENA_MIN_CLASS_LOG){
+		return 0;
+	}
+	uint64_t i = 64 - __builtin_clzll(size - 1) - CR8R_ARENA_MIN_CLASS_LOG;
+	return i < CR8R_ARENA_NUM_CLASSES ? i : CR8R_ARENA_NUM_CLASSES;
+}
+
+void cr8r_arena_init(cr8r_arena *self){
+	*self = (cr8r_arena){};
+}
+
+static void free_large(cr8r_arena *self){
+	for(large_header *it = self->large, *next; it; it = next){
+		next = it->next;
+		free(it);
+	}
+	self->large = NULL;
+}
+
+void cr8r_arena_delete(cr8r_arena *self){
+	for(uint64_t i = 0; i < CR8R_ARENA_NUM_CLASSES; ++i){
+		cr8r_sla_delete(self->classes + i);
+	}
+	free_large(self);
+}
+
+void cr8r_arena_reset(cr8r_arena *self, bool release){
+	for(uint64_t i = 0; i < CR8R_ARENA_NUM_CLASSES; ++i){
+		cr8r_sla_reset(self->classes + i, release);
+	}
+	free_large(self);
+}
+
+void *cr8r_arena_alloc(cr8r_arena *self, uint64_t size){
+	uint64_t i = size_class(size);
+	if(i == CR8R_ARENA_NUM_CLASSES){
+		large_header *h = malloc(sizeof(large_header) + size);
+		if(!h){
+			return NULL;
+		}
+		*h = (large_header){.next = self->large};
+		if(h->next){
+			h->next->prev = h;
+		}
+		self->large = h;
+		return h + 1;
+	}
+	cr8r_sla *sla = self->classes + i;
+	if(!sla->slabs_len){
+		uint64_t elem_size = 1ULL << (i + CR8R_ARENA_MIN_CLASS_LOG);
+		if(!cr8r_sla_init(sla, elem_size, CR8R_ARENA_SLAB_BYTES/elem_size)){
+			return NULL;
+		}
+		sla->max_slab_cap = CR8R_ARENA_MAX_SLAB_BYTES/elem_size;
+	}
+	return cr8r_sla_alloc(sla);
+}
+
+void *cr8r_arena_calloc(cr8r_arena *self, uint64_t size){
+	void *ret = cr8r_arena_alloc(self, size);
+	if(ret){
+		memset(ret, 0, size);
+	}
+	return ret;
+}
+
+void *cr8r_arena_realloc(cr8r_arena *self, void *p, uint64_t old_size, uint64_t new_size){
+	if(!p){
+		return cr8r_arena_alloc(self, new_size);
+	}
+	uint64_t i = size_class(old_size), j = size_class(new_size);
+	if(i == j && i != CR8R_ARENA_NUM_CLASSES){
+		return p;
+	}else if(i == j){
+		large_header *h = (large_header*)p - 1;
+		large_header *prev = h->prev, *next = h->next;
+		if(!(h = realloc(h, sizeof(large_header) + new_size))){
+			return NULL;
+		}
+		if(prev){
+			prev->next = h;
+		}else{
+			self->large = h;
+		}
+		if(next){
+			next->prev = h;
+		}
+		return h + 1;
+	}
+	void *ret = cr8r_arena_alloc(self, new_size);
+	if(ret){
+		memcpy(ret, p, old_size < new_size ? old_size : new_size);
+		cr8r_arena_free(self, p, old_size);
+	}
+	return ret;
+}
+
+void cr8r_arena_free(cr8r_arena *self, void *p, uint64_t size){
+	if(!p){
+		return;
+	}
+	uint64_t i = size_class(size);
+	if(i == CR8R_ARENA_NUM_CLASSES){
+		large_header *h = (large_header*)p - 1;
+		if(h->prev){
+			h->prev->next = h->next;
+		}else{
+			self->large = h->next;
+		}
+		if(h->next){
+			h->next->prev = h->prev;
+		}
+		free(h);
+		return;
+	}
+	cr8r_sla_free(self->classes + i, p);
+}
+
+void *cr8r_default_alloc_arena(const cr8r_base_ft *base, uint64_t size){
+	return cr8r_arena_calloc(base->data, size);
+}
+
+void cr8r_default_free_arena(const cr8r_base_ft *base, void *p, uint64_t size){
+	cr8r_arena_free(base->data, p, size);
+}
+
+// vector buffers are prefixed with their capacity, since ft->resize is not told the old capacity
+#define RESIZE_HEADER 16
+
+void *cr8r_default_resize_arena(cr8r_base_ft *base, void *p, uint64_t cap){
+	uint64_t old_cap = p ? *(uint64_t*)(p - RESIZE_HEADER) : 0;
+	if(!cap){
+		if(p){
+			cr8r_arena_free(base->data, p - RESIZE_HEADER, RESIZE_HEADER + old_cap*base->size);
+		}
+		return NULL;
+	}
+	if(!base->size){
+		return p;
+	}
+	void *ret = cr8r_arena_realloc(base->data, p ? p - RESIZE_HEADER : NULL, RESIZE_HEADER + old_cap*base->size, RESIZE_HEADER + cap*base->size);
+	if(!ret){
+		return NULL;
+	}
+	*(uint64_t*)ret = cap;
+	return ret + RESIZE_HEADER;
+}
+
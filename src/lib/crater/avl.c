@@ -4,6 +4,8 @@
 
 #include <crater/avl_check.h>
 #include <crater/avl.h>
+#include <crater/arena.h>
+#include <crater/stats.h>
 
 static cr8r_avl_node *cr8r_avl_insert_recursive(cr8r_avl_node *r, void *key, cr8r_avl_ft *ft);
 inline static cr8r_avl_node *cr8r_avl_insert_rebalance_r(cr8r_avl_node *p, cr8r_avl_node *n);
@@ -67,6 +69,14 @@ void cr8r_default_free_sla(cr8r_base_ft *ft, void *p){
 	cr8r_sla_free(ft->data, p);
 }
 
+void *cr8r_default_alloc_arena_avl(cr8r_base_ft *ft){
+	return cr8r_arena_alloc(ft->data, offsetof(cr8r_avl_node, data) + ft->size);
+}
+
+void cr8r_default_free_arena_avl(cr8r_base_ft *ft, void *p){
+	cr8r_arena_free(ft->data, p, offsetof(cr8r_avl_node, data) + ft->size);
+}
+
 
 cr8r_avl_node *cr8r_avl_next(cr8r_avl_node *n){
 	if(n->right){
@@ -471,6 +481,7 @@ cr8r_avl_node *cr8r_avl_remove_rebalance_r(cr8r_avl_node *p){//mirror image of c
 
 cr8r_avl_node *cr8r_avl_rotate_l(cr8r_avl_node *n){//does not update balance factors because the caller knows better
 	cr8r_avl_node *l = n->left;//assume existence of swapped node
+	CR8R_STATS_INC(avl_rotations);
 	l->parent = n->parent;
 	if(n->parent){
 		if(n->parent->left == n){
@@ -490,6 +501,7 @@ cr8r_avl_node *cr8r_avl_rotate_l(cr8r_avl_node *n){//does not update balance fac
 
 cr8r_avl_node *cr8r_avl_rotate_r(cr8r_avl_node *n){
 	cr8r_avl_node *r = n->right;//assume existence of swapped node
+	CR8R_STATS_INC(avl_rotations);
 	r->parent = n->parent;
 	if(n->parent){
 		if(n->parent->left == n){
@@ -792,3 +804,22 @@ cr8r_avl_node *cr8r_avl_reorder_relink(cr8r_avl_node *n){
 	return n->parent;
 }
 
+// returns the height of the subtree at r, adding its size and the total depth of its nodes to stats
+static uint64_t cr8r_avl_get_stats_r(const cr8r_avl_node *r, uint64_t depth, cr8r_avl_stats *stats, uint64_t *total_depth){
+	if(!r){
+		return 0;
+	}
+	++stats->nodes;
+	*total_depth += depth;
+	uint64_t hl = cr8r_avl_get_stats_r(r->left, depth + 1, stats, total_depth);
+	uint64_t hr = cr8r_avl_get_stats_r(r->right, depth + 1, stats, total_depth);
+	return 1 + (hl > hr ? hl : hr);
+}
+
+void cr8r_avl_get_stats(const cr8r_avl_node *r, cr8r_avl_stats *stats){
+	*stats = (cr8r_avl_stats){};
+	uint64_t total_depth = 0;
+	stats->height = cr8r_avl_get_stats_r(r, 1, stats, &total_depth);
+	stats->avg_depth = stats->nodes ? (double)total_depth/stats->nodes : 0.;
+}
+
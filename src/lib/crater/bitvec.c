@@ -9,6 +9,7 @@ bool cr8r_bvec_init(cr8r_bvec *self, cr8r_bvec_ft *ft, uint64_t bits){
 	uint64_t cap = (bits + 63)/64;
 	uint64_t *tmp = ft->resize(&ft->base, NULL, cap);
 	if(!tmp){
+		*self = (cr8r_bvec){};
 		return !cap;
 	}
 	*self = (cr8r_bvec){.buf=tmp, .cap = 64*cap};
@@ -25,6 +26,7 @@ bool cr8r_bvec_copy(cr8r_bvec *dest, const cr8r_bvec *src, cr8r_bvec_ft *ft){
 		return 0;
 	}
 	memcpy(dest->buf, src->buf, dest->cap/64*sizeof(uint64_t));
+	dest->len = src->len;
 	return 1;
 }
 
@@ -127,29 +129,26 @@ void cr8r_bvec_clear(cr8r_bvec *self){
 // non-set bits randomly and sets them if not set until k have been set.  If there
 // are more zeros than ones, we set all bits and pick n-k to zero out instead.
 // This ensures that the expected number of random numbers needed is below n.
+// The random indices are generated in batches, since this is a hot loop for large bit vectors.
 void cr8r_bvec_shuffle(cr8r_bvec *self, cr8r_prng *prng){
 	uint64_t num_ones = cr8r_bvec_popcount(self);
-	if(2*num_ones > self->len){
-		if(num_ones == self->len){
-			return;
+	if(num_ones == self->len || !num_ones){
+		return;
+	}
+	bool flip = 2*num_ones > self->len;
+	uint64_t num_set = flip ? self->len - num_ones : num_ones;
+	cr8r_bvec_set_range(self, 0, self->len, flip);
+	uint64_t idxs[256], num_idxs = 0, j = 0;
+	while(num_set){
+		if(j == num_idxs){
+			num_idxs = num_set < 256 ? num_set : 256;
+			cr8r_prng_fill_uniform_u64(prng, 0, self->len, num_idxs, idxs);
+			j = 0;
 		}
-		cr8r_bvec_set_range(self, 0, self->len, 1);
-		for(uint64_t num_zeros = self->len - num_ones, i; num_zeros-- > 0;){
-			do{
-				i = cr8r_prng_uniform_u64(prng, 0, self->len);
-			}while(!cr8r_bvec_getu(self, i));
-			cr8r_bvec_setu(self, i, 0);
-		}
-	}else{
-		if(!num_ones){
-			return;
-		}
-		cr8r_bvec_set_range(self, 0, self->len, 0);
-		for(uint64_t i; num_ones-- > 0;){
-			do{
-				i = cr8r_prng_uniform_u64(prng, 0, self->len);
-			}while(cr8r_bvec_getu(self, i));
-			cr8r_bvec_setu(self, i, 1);
+		uint64_t i = idxs[j++];
+		if(cr8r_bvec_getu(self, i) == flip){
+			cr8r_bvec_setu(self, i, !flip);
+			--num_set;
 		}
 	}
 }
@@ -429,13 +428,114 @@ bool cr8r_bvec_any(const cr8r_bvec *self){
 	return 0;
 }
 
+// The bulk kernels below use 512 bit gcc vector extensions, and have avx512f and avx2 clones where
+// CR8R_ATTR_WIDE_SIMD_CLONES supports them and an sse2 default.  They work on whole words, and the
+// public functions deal with partial words at the end.
+typedef uint64_t v8u64 __attribute__((vector_size(64)));
+
+// Define words_<name>(a, b, n), which sets a[i] = expr for i in [0, n).
+// expr is written in terms of a and b, and is used for both vectors of 8 words and single words.
+#define DEFINE_WORDS_OP(name, expr) \
+CR8R_ATTR_WIDE_SIMD_CLONES static void words_##name(uint64_t *a_buf, const uint64_t *b_buf, uint64_t n){ \
+	uint64_t i = 0; \
+	for(; i + 8 <= n; i += 8){ \
+		v8u64 a, b; \
+		memcpy(&a, a_buf + i, sizeof(a)); \
+		memcpy(&b, b_buf + i, sizeof(b)); \
+		a = (expr); \
+		memcpy(a_buf + i, &a, sizeof(a)); \
+	} \
+	for(; i < n; ++i){ \
+		uint64_t a = a_buf[i], b = b_buf[i]; \
+		a_buf[i] = (expr); \
+	} \
+}
+
+DEFINE_WORDS_OP(and, a & b)
+DEFINE_WORDS_OP(or, a | b)
+DEFINE_WORDS_OP(xor, a ^ b)
+DEFINE_WORDS_OP(andnot, a & ~b)
+
+CR8R_ATTR_WIDE_SIMD_CLONES static void words_compl(uint64_t *buf, uint64_t n){
+	uint64_t i = 0;
+	for(; i + 8 <= n; i += 8){
+		v8u64 a;
+		memcpy(&a, buf + i, sizeof(a));
+		a = ~a;
+		memcpy(buf + i, &a, sizeof(a));
+	}
+	for(; i < n; ++i){
+		buf[i] = ~buf[i];
+	}
+}
+
+// Define words_popcount_<name>(a, b, n), which returns the sum of popcount(expr) over the first n words.
+// There is no vector popcount instruction before avx512vpopcntdq, so each vector is reduced to 8 bit counts
+// with the usual bit twiddling, and these are summed for up to 31 vectors (at most 248 per byte) before
+// being widened to 64 bit counts.
+#define DEFINE_WORDS_POPCOUNT(name, expr) \
+CR8R_ATTR_WIDE_SIMD_CLONES static uint64_t words_popcount_##name(const uint64_t *a_buf, const uint64_t *b_buf, uint64_t n){ \
+	uint64_t i = 0, res = 0; \
+	while(i + 8 <= n){ \
+		uint64_t end = n - (n - i)%8; \
+		if(end - i > 8*31){ \
+			end = i + 8*31; \
+		} \
+		v8u64 counts = {}; \
+		for(; i < end; i += 8){ \
+			v8u64 a, b; \
+			memcpy(&a, a_buf + i, sizeof(a)); \
+			memcpy(&b, b_buf + i, sizeof(b)); \
+			v8u64 x = (expr); \
+			x -= (x >> 1) & 0x5555555555555555ull; \
+			x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull); \
+			counts += (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full; \
+		} \
+		counts = (counts & 0x00FF00FF00FF00FFull) + ((counts >> 8) & 0x00FF00FF00FF00FFull); \
+		counts = (counts & 0x0000FFFF0000FFFFull) + ((counts >> 16) & 0x0000FFFF0000FFFFull); \
+		counts = (counts & 0x00000000FFFFFFFFull) + (counts >> 32); \
+		for(uint64_t j = 0; j < 8; ++j){ \
+			res += counts[j]; \
+		} \
+	} \
+	for(; i < n; ++i){ \
+		uint64_t a = a_buf[i], b = b_buf[i]; \
+		(void)b; \
+		res += __builtin_popcountll(expr); \
+	} \
+	return res; \
+}
+
+DEFINE_WORDS_POPCOUNT(id, a)
+DEFINE_WORDS_POPCOUNT(and, a & b)
+
+// Find the highest index i < n with a[i] != b[i], or return n if there is none
+CR8R_ATTR_WIDE_SIMD_CLONES static uint64_t words_last_diff(const uint64_t *a_buf, const uint64_t *b_buf, uint64_t n){
+	uint64_t i = n;
+	for(; i >= 8; i -= 8){
+		v8u64 a, b;
+		memcpy(&a, a_buf + i - 8, sizeof(a));
+		memcpy(&b, b_buf + i - 8, sizeof(b));
+		v8u64 x = a ^ b;
+		x |= __builtin_shufflevector(x, x, 4, 5, 6, 7, 0, 1, 2, 3);
+		x |= __builtin_shufflevector(x, x, 2, 3, 0, 1, 6, 7, 4, 5);
+		x |= __builtin_shufflevector(x, x, 1, 0, 3, 2, 5, 4, 7, 6);
+		if(x[0]){
+			break;
+		}
+	}
+	while(i-- > 0){
+		if(a_buf[i] != b_buf[i]){
+			return i;
+		}
+	}
+	return n;
+}
+
 uint64_t cr8r_bvec_popcount(const cr8r_bvec *self){
 	uint64_t l = self->len/64;
 	uint64_t w = self->len%64;
-	uint64_t res = 0;
-	for(uint64_t i = 0; i < l; ++i){
-		res += __builtin_popcountll(self->buf[i]);
-	}
+	uint64_t res = words_popcount_id(self->buf, self->buf, l);
 	if(w){
 		uint64_t mask = ~0ull >> (64 - w);
 		res += __builtin_popcountll(self->buf[l] & mask);
@@ -443,13 +543,25 @@ uint64_t cr8r_bvec_popcount(const cr8r_bvec *self){
 	return res;
 }
 
+uint64_t cr8r_bvec_popcount_and(const cr8r_bvec *a, const cr8r_bvec *b){
+	uint64_t len = a->len < b->len ? a->len : b->len;
+	uint64_t l = len/64;
+	uint64_t w = len%64;
+	uint64_t res = words_popcount_and(a->buf, b->buf, l);
+	if(w){
+		uint64_t mask = ~0ull >> (64 - w);
+		res += __builtin_popcountll(a->buf[l] & b->buf[l] & mask);
+	}
+	return res;
+}
+
 uint64_t cr8r_bvec_clz(const cr8r_bvec *self){
 	uint64_t l = self->len/64;
 	uint64_t w = self->len%64;
 	uint64_t res = 0;
 	if(w){
 		uint64_t mask = ~0ull >> w;
-		res = __builtin_clzll((self->buf[l] << w) | mask);
+		res = __builtin_clzll((self->buf[l] << (64 - w)) | mask);
 	}
 	for(uint64_t i = l; i-- > 0;){
 		if(!self->buf[i]){
@@ -484,7 +596,7 @@ uint64_t cr8r_bvec_clo(const cr8r_bvec *self){
 	uint64_t w = self->len%64;
 	uint64_t res = 0;
 	if(w){
-		res = __builtin_clzll(~(self->buf[l] << w));
+		res = __builtin_clzll(~(self->buf[l] << (64 - w)));
 	}
 	for(uint64_t i = l; i-- > 0;){
 		if(!~self->buf[i]){
@@ -515,48 +627,96 @@ uint64_t cr8r_bvec_cto(const cr8r_bvec *self){
 }
 
 void cr8r_bvec_icompl(cr8r_bvec *self){
-	uint64_t cap = (self->len + 63)/64;
-	for(uint64_t i = 0; i < cap; ++i){
-		self->buf[i] ^= ~0ull;
-	}
+	words_compl(self->buf, (self->len + 63)/64);
 }
 
-void cr8r_bvec_iand(cr8r_bvec *self, const cr8r_bvec *other){
-	uint64_t cap = other->len < self->len ? other->len : self->len;
-	uint64_t l = cap/64;
-	uint64_t w = cap%64;
-	for(uint64_t i = 0; i < l; ++i){
-		self->buf[i] &= other->buf[i];
+// Each of these applies one in place operation to the words of self in [a, b), so that the _many variants
+// can apply every operand to one block of self while it is in cache.
+// Bits of other past the end of the shorter vector are treated as zero.
+
+static void and_words(cr8r_bvec *self, const cr8r_bvec *other, uint64_t a, uint64_t b){
+	uint64_t len = other->len < self->len ? other->len : self->len;
+	uint64_t l = len/64;
+	uint64_t w = len%64;
+	if(a < l){
+		words_and(self->buf + a, other->buf + a, (b < l ? b : l) - a);
 	}
-	if(w){
-		self->buf[l] &= other->buf[l];
+	if(w && a <= l && l < b){
+		self->buf[l] &= other->buf[l] & (~0ull >> (64 - w));
+	}
+	uint64_t z = l + !!w;
+	if(z < a){
+		z = a;
 	}
-	if(other->len < self->len){
-		cr8r_bvec_set_range(self, other->len, self->len, 0);
+	if(z < b){
+		memset(self->buf + z, 0, (b - z)*sizeof(uint64_t));
 	}
 }
 
-void cr8r_bvec_ior(cr8r_bvec *self, const cr8r_bvec *other){
-	uint64_t cap = other->len < self->len ? other->len : self->len;
-	uint64_t l = cap/64;
-	uint64_t w = cap%64;
-	for(uint64_t i = 0; i < l; ++i){
-		self->buf[i] |= other->buf[i];
+#define DEFINE_OP_WORDS(name, op) \
+static void name##_words(cr8r_bvec *self, const cr8r_bvec *other, uint64_t a, uint64_t b){ \
+	uint64_t len = other->len < self->len ? other->len : self->len; \
+	uint64_t l = len/64; \
+	uint64_t w = len%64; \
+	if(a < l){ \
+		words_##name(self->buf + a, other->buf + a, (b < l ? b : l) - a); \
+	} \
+	if(w && a <= l && l < b){ \
+		self->buf[l] op other->buf[l] & (~0ull >> (64 - w)); \
+	} \
+}
+
+DEFINE_OP_WORDS(or, |=)
+DEFINE_OP_WORDS(xor, ^=)
+
+static void andnot_words(cr8r_bvec *self, const cr8r_bvec *other, uint64_t a, uint64_t b){
+	uint64_t len = other->len < self->len ? other->len : self->len;
+	uint64_t l = len/64;
+	uint64_t w = len%64;
+	if(a < l){
+		words_andnot(self->buf + a, other->buf + a, (b < l ? b : l) - a);
 	}
-	if(w){
-		self->buf[l] |= other->buf[l] & (~0ull >> (64-w));
+	if(w && a <= l && l < b){
+		self->buf[l] &= ~(other->buf[l] & (~0ull >> (64 - w)));
 	}
 }
 
+void cr8r_bvec_iand(cr8r_bvec *self, const cr8r_bvec *other){
+	and_words(self, other, 0, (self->len + 63)/64);
+}
+
+void cr8r_bvec_ior(cr8r_bvec *self, const cr8r_bvec *other){
+	or_words(self, other, 0, (self->len + 63)/64);
+}
+
 void cr8r_bvec_ixor(cr8r_bvec *self, const cr8r_bvec *other){
-	uint64_t cap = other->len < self->len ? other->len : self->len;
-	uint64_t l = cap/64;
-	uint64_t w = cap%64;
-	for(uint64_t i = 0; i < l; ++i){
-		self->buf[i] ^= other->buf[i];
+	xor_words(self, other, 0, (self->len + 63)/64);
+}
+
+void cr8r_bvec_iandnot(cr8r_bvec *self, const cr8r_bvec *other){
+	andnot_words(self, other, 0, (self->len + 63)/64);
+}
+
+// 16 KiB blocks of self fit in L1 cache alongside the operand being streamed in
+#define BVEC_MANY_BLOCK 2048
+
+void cr8r_bvec_iand_many(cr8r_bvec *self, const cr8r_bvec *const *others, uint64_t n){
+	uint64_t cap = (self->len + 63)/64;
+	for(uint64_t a = 0; a < cap; a += BVEC_MANY_BLOCK){
+		uint64_t b = cap - a < BVEC_MANY_BLOCK ? cap : a + BVEC_MANY_BLOCK;
+		for(uint64_t i = 0; i < n; ++i){
+			and_words(self, others[i], a, b);
+		}
 	}
-	if(w){
-		self->buf[l] ^= other->buf[l] & (~0ull >> (64-w));
+}
+
+void cr8r_bvec_ior_many(cr8r_bvec *self, const cr8r_bvec *const *others, uint64_t n){
+	uint64_t cap = (self->len + 63)/64;
+	for(uint64_t a = 0; a < cap; a += BVEC_MANY_BLOCK){
+		uint64_t b = cap - a < BVEC_MANY_BLOCK ? cap : a + BVEC_MANY_BLOCK;
+		for(uint64_t i = 0; i < n; ++i){
+			or_words(self, others[i], a, b);
+		}
 	}
 }
 
@@ -678,14 +838,11 @@ int cr8r_bvec_cmp(const cr8r_bvec *a, const cr8r_bvec *b){
 			return -1;
 		}
 	}
-	while(l-- > 0){
-		if(a->buf[l] > b->buf[l]){
-			return 1;
-		}else if(a->buf[l] < b->buf[l]){
-			return -1;
-		}
+	uint64_t i = words_last_diff(a->buf, b->buf, l);
+	if(i == l){
+		return 0;
 	}
-	return 0;
+	return a->buf[i] > b->buf[i] ? 1 : -1;
 }
 
 cr8r_bvec_ft cr8r_bvecft = {
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include <crater/cll.h>
+#include <crater/arena.h>
 
 
 bool cr8r_cll_ft_init(cr8r_cll_ft *ft,
@@ -24,6 +25,14 @@ bool cr8r_cll_ft_init(cr8r_cll_ft *ft,
 	return true;
 }
 
+void *cr8r_default_alloc_arena_cll(cr8r_base_ft *ft){
+	return cr8r_arena_alloc(ft->data, offsetof(cr8r_cll_node, data) + ft->size);
+}
+
+void cr8r_default_free_arena_cll(cr8r_base_ft *ft, void *p){
+	cr8r_arena_free(ft->data, p, offsetof(cr8r_cll_node, data) + ft->size);
+}
+
 bool cr8r_cll_ft_initsla(cr8r_cll_ft *ft,
 	cr8r_sla *sla, uint64_t size, uint64_t reserve,
 	void (*copy)(cr8r_base_ft*, void*, const void*),
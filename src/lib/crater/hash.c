@@ -133,10 +133,30 @@ bool cr8r_hash_ft_init(cr8r_hashtbl_ft *ft,
 	ft->cmp = cmp;
 	ft->add = add;
 	ft->del = del;
+	ft->alloc = NULL;
+	ft->free = NULL;
 	return 1;
 }
 
 
+inline static void *cr8r_hash_alloc(const cr8r_hashtbl_ft *ft, uint64_t size){
+	return ft->alloc ? ft->alloc(&ft->base, size) : calloc(1, size);
+}
+
+inline static void cr8r_hash_free(const cr8r_hashtbl_ft *ft, void *p, uint64_t size){
+	if(!p){
+		return;
+	}else if(ft->free){
+		ft->free(&ft->base, p, size);
+	}else{
+		free(p);
+	}
+}
+
+inline static uint64_t cr8r_hash_flags_size(uint64_t len){
+	return (((len - 1) >> 5) + 1)*sizeof(uint64_t);
+}
+
 int cr8r_hash_init(cr8r_hashtbl_t *self, const cr8r_hashtbl_ft *ft, uint64_t reserve){
 	*self = (cr8r_hashtbl_t){};
 	if(!reserve){
@@ -144,13 +164,13 @@ int cr8r_hash_init(cr8r_hashtbl_t *self, const cr8r_hashtbl_ft *ft, uint64_t res
 	}
 	uint64_t i = 64 - __builtin_clzll(reserve - 1);
 	self->len_a = exp_primes[i];
-	self->table_a = calloc(ft->base.size, self->len_a);
+	self->table_a = cr8r_hash_alloc(ft, self->len_a*ft->base.size);
 	if(!self->table_a){
 		return 0;
 	}
-	self->flags_a = calloc(sizeof(uint64_t), ((self->len_a - 1) >> 5) + 1);
+	self->flags_a = cr8r_hash_alloc(ft, cr8r_hash_flags_size(self->len_a));
 	if(!self->flags_a){
-		free(self->table_a);
+		cr8r_hash_free(ft, self->table_a, self->len_a*ft->base.size);
 		self->table_a = NULL;
 		return 0;
 	}
@@ -171,8 +191,10 @@ inline static uint64_t cr8r_hash_find_slot_re(cr8r_hashtbl_t *self, const cr8r_h
 
 inline static uint64_t cr8r_hash_find_slot_ap(cr8r_hashtbl_t *self, const cr8r_hashtbl_ft *ft, const void *key){
 	uint64_t a = ft->hash(&ft->base,key) % self->len_a;
+	CR8R_STATS_INC(hash_lookups);
 	for(uint64_t j = 0, i; j < self->len_a; ++j){
 		i = (a + (j&1 ? j*j : self->len_a - j*j%self->len_a))%self->len_a;
+		CR8R_STATS_INC(hash_probes);
 		uint64_t f = (self->flags_a[i >> 5] >> (i&0x1F))&0x100000001ULL;
 		if(!(f&0x100000000ULL && ft->cmp(&ft->base, key, self->table_a + i*ft->base.size))){
 			return i;
@@ -184,13 +206,13 @@ inline static uint64_t cr8r_hash_find_slot_ap(cr8r_hashtbl_t *self, const cr8r_h
 inline static int cr8r_hash_ix_start(cr8r_hashtbl_t *self, const cr8r_hashtbl_ft *ft){
 	uint64_t i = self->len_a ? 64 - __builtin_clzll(self->len_a - 1) : 1;
 	uint64_t new_len = exp_primes[i];
-	void *new_table = calloc(ft->base.size, new_len);
+	void *new_table = cr8r_hash_alloc(ft, new_len*ft->base.size);
 	if(!new_table){
 		return 0;
 	}
-	uint64_t *new_flags = calloc(sizeof(uint64_t), ((new_len - 1) >> 5) + 1);
+	uint64_t *new_flags = cr8r_hash_alloc(ft, cr8r_hash_flags_size(new_len));
 	if(!new_flags){
-		free(new_table);
+		cr8r_hash_free(ft, new_table, new_len*ft->base.size);
 		return 0;
 	}
 	uint64_t new_cap = new_len*(double)ft->load_factor;
@@ -213,6 +235,7 @@ inline static int cr8r_hash_ix_start(cr8r_hashtbl_t *self, const cr8r_hashtbl_ft
 	self->cap = new_cap;
 	self->r = ceill((self->full + 1.)/(new_cap - self->full - 1.));
 	self->i = 0;
+	CR8R_STATS_INC(hash_resizes);
 	return 1;
 }
 
@@ -231,14 +254,15 @@ inline static void cr8r_hash_ix_move(cr8r_hashtbl_t *self, const cr8r_hashtbl_ft
 		self->flags_b[b >> 5] &= ~(0x100000000ULL << (b&0x1F));
 		self->flags_a[a >> 5] |= 0x100000000ULL << (a&0x1F);
 		self->flags_a[a >> 5] &= ~(0x1ULL << (a&0x1F));
+		CR8R_STATS_INC(hash_moves);
 		if(!--n){
 			break;
 		}
 	}
 	self->i = b;
 	if(b == self->len_b){
-		free(self->table_b);
-		free(self->flags_b);
+		cr8r_hash_free(ft, self->table_b, self->len_b*ft->base.size);
+		cr8r_hash_free(ft, self->flags_b, cr8r_hash_flags_size(self->len_b));
 		self->table_b = NULL;
 		self->flags_b = NULL;
 		self->len_b = 0;
@@ -248,8 +272,10 @@ inline static void cr8r_hash_ix_move(cr8r_hashtbl_t *self, const cr8r_hashtbl_ft
 
 inline static uint64_t cr8r_hash_get_index(void *table, uint64_t *flags, uint64_t len, uint64_t a, const cr8r_hashtbl_ft *ft, const void *key){
 	a %= len;
+	CR8R_STATS_INC(hash_lookups);
 	for(uint64_t j = 0, i; j < len; ++j){
 		i = (a + (j&1 ? j*j : len - j*j%len))%len;
+		CR8R_STATS_INC(hash_probes);
 		uint64_t f = (flags[i >> 5] >> (i&0x1F))&0x100000001ULL;
 		if(!f){
 			return ~0ULL;
@@ -447,9 +473,9 @@ void cr8r_hash_clear(cr8r_hashtbl_t *self, cr8r_hashtbl_ft *ft){
 			}
 		}
 	}
-	free(self->table_b);
+	cr8r_hash_free(ft, self->table_b, self->len_b*ft->base.size);
 	self->table_b = NULL;
-	free(self->flags_b);
+	cr8r_hash_free(ft, self->flags_b, cr8r_hash_flags_size(self->len_b));
 	self->flags_b = NULL;
 	self->len_b = 0;
 	memset(self->flags_a, 0, (((self->len_a - 1) >> 5) + 1)*sizeof(uint64_t));
@@ -458,11 +484,39 @@ void cr8r_hash_clear(cr8r_hashtbl_t *self, cr8r_hashtbl_ft *ft){
 
 void cr8r_hash_destroy(cr8r_hashtbl_t *self, cr8r_hashtbl_ft *ft){
 	cr8r_hash_clear(self, ft);
-	free(self->table_a);
+	cr8r_hash_free(ft, self->table_a, self->len_a*ft->base.size);
 	self->table_a = NULL;
-	free(self->flags_a);
+	cr8r_hash_free(ft, self->flags_a, cr8r_hash_flags_size(self->len_a));
 	self->flags_a = NULL;
 	self->len_a = 0;
 	self->cap = 0;
 }
 
+static void cr8r_hash_get_stats_table(const void *table, const uint64_t *flags, uint64_t len, const cr8r_hashtbl_ft *ft, cr8r_hash_stats *stats, uint64_t *total){
+	for(uint64_t i = 0; i < len; ++i){
+		uint64_t f = (flags[i >> 5] >> (i&0x1F))&0x100000001ULL;
+		if(!(f&0x100000000ULL)){
+			stats->tombstones += f&1;
+			continue;
+		}
+		uint64_t a = ft->hash(&ft->base, table + i*ft->base.size)%len, j = 0;
+		while((a + (j&1 ? j*j : len - j*j%len))%len != i){
+			++j;
+		}
+		++stats->len;
+		*total += j;
+		if(j > stats->max_probe){
+			stats->max_probe = j;
+		}
+		++stats->probe_hist[j < CR8R_STATS_PROBE_BUCKETS ? j : CR8R_STATS_PROBE_BUCKETS - 1];
+	}
+}
+
+void cr8r_hash_get_stats(const cr8r_hashtbl_t *self, const cr8r_hashtbl_ft *ft, cr8r_hash_stats *stats){
+	*stats = (cr8r_hash_stats){.slots = self->len_a + self->len_b, .resizing = !!self->table_b};
+	uint64_t total = 0;
+	cr8r_hash_get_stats_table(self->table_a, self->flags_a, self->len_a, ft, stats, &total);
+	cr8r_hash_get_stats_table(self->table_b, self->flags_b, self->len_b, ft, stats, &total);
+	stats->avg_probe = stats->len ? (double)total/stats->len : 0.;
+}
+
@@ -64,3 +64,122 @@ bool cr8r_heap_pop(cr8r_vec *self, cr8r_vec_ft *ft, void *o, int ord){
 	return 1;
 }
 
+bool cr8r_heap_push_many(cr8r_vec *self, cr8r_vec_ft *ft, const void *es, uint64_t n, int ord){
+	if(!n){
+		return 1;
+	}
+	if(!cr8r_vec_ensure_cap(self, ft, self->len + n)){
+		return 0;
+	}
+	uint64_t lo = self->len;
+	memcpy(self->buf + lo*ft->base.size, es, n*ft->base.size);
+	self->len += n;
+	if(!lo){
+		cr8r_heap_ify(self, ft, ord);
+		return 1;
+	}
+	// sift down every element in [lo, hi) from the right, so that children are always fixed before their parents,
+	// then move on to the range of their parents.  The ranges halve in size until they are single ancestors
+	for(uint64_t hi = self->len;;){
+		for(uint64_t i = hi; i-- > lo;){
+			cr8r_heap_sift_down(self, ft, self->buf + i*ft->base.size, ord);
+		}
+		if(!lo){
+			return 1;
+		}
+		lo = (lo - 1) >> 1;
+		hi = ((hi - 2) >> 1) + 1;
+	}
+}
+
+bool cr8r_heap_pop_k(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t k, cr8r_vec *out, int ord){
+	cr8r_vec_clear(out, ft);
+	if(k > self->len){
+		k = self->len;
+	}
+	if(!cr8r_vec_ensure_cap(out, ft, k)){
+		return 0;
+	}
+	for(; out->len < k; ++out->len){
+		cr8r_heap_pop(self, ft, out->buf + out->len*ft->base.size, ord);
+	}
+	return 1;
+}
+
+bool cr8r_heap_merge(cr8r_vec *self, cr8r_vec_ft *ft, const cr8r_vec *other, int ord){
+	return cr8r_heap_push_many(self, ft, other->buf, other->len, ord);
+}
+
+void cr8r_heap_ify_d(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t arity, int ord){
+	if(self->len < 2){
+		return;
+	}
+	// (len - 2)/arity is the parent of the last element
+	for(uint64_t i = (self->len - 2)/arity + 1; i--;){
+		cr8r_heap_sift_down_d(self, ft, arity, self->buf + i*ft->base.size, ord);
+	}
+}
+
+void cr8r_heap_sift_up_d(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t arity, void *e, int ord){
+	for(uint64_t i = (e - self->buf)/ft->base.size, j; i; i = j){
+		j = (i - 1)/arity;
+		if(ord*ft->cmp(&ft->base, self->buf + i*ft->base.size, self->buf + j*ft->base.size) <= 0){
+			break;
+		}
+		ft->swap(&ft->base, self->buf + i*ft->base.size, self->buf + j*ft->base.size);
+	}
+}
+
+// always inlined so that the common arities get specialized copies where the arity is a constant
+static inline __attribute__((always_inline)) void sift_down_d(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t arity, uint64_t i, int ord){
+	while(1){
+		uint64_t first = i*arity + 1;
+		if(first >= self->len){
+			return;
+		}
+		uint64_t end = self->len - first > arity ? first + arity : self->len;
+		uint64_t j = first;
+		for(uint64_t k = first + 1; k < end; ++k){
+			if(ord*ft->cmp(&ft->base, self->buf + k*ft->base.size, self->buf + j*ft->base.size) > 0){
+				j = k;
+			}
+		}
+		if(ord*ft->cmp(&ft->base, self->buf + i*ft->base.size, self->buf + j*ft->base.size) >= 0){
+			return;
+		}
+		ft->swap(&ft->base, self->buf + i*ft->base.size, self->buf + j*ft->base.size);
+		i = j;
+	}
+}
+
+void cr8r_heap_sift_down_d(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t arity, void *e, int ord){
+	uint64_t i = (e - self->buf)/ft->base.size;
+	switch(arity){
+		case 2: sift_down_d(self, ft, 2, i, ord); break;
+		case 4: sift_down_d(self, ft, 4, i, ord); break;
+		case 8: sift_down_d(self, ft, 8, i, ord); break;
+		default: sift_down_d(self, ft, arity, i, ord);
+	}
+}
+
+bool cr8r_heap_push_d(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t arity, const void *e, int ord){
+	if(!cr8r_vec_pushr(self, ft, e)){
+		return 0;
+	}
+	cr8r_heap_sift_up_d(self, ft, arity, self->buf + (self->len - 1)*ft->base.size, ord);
+	return 1;
+}
+
+bool cr8r_heap_pop_d(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t arity, void *o, int ord){
+	if(self->len > 1){
+		ft->swap(&ft->base, self->buf, self->buf + (self->len - 1)*ft->base.size);
+	}
+	if(!cr8r_vec_popr(self, ft, o)){
+		return 0;
+	}
+	if(self->len){
+		cr8r_heap_sift_down_d(self, ft, arity, self->buf, ord);
+	}
+	return 1;
+}
+
@@ -0,0 +1,167 @@
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#endif
+
+#include <crater/hugemem.h>
+
+// size of an x86 hugepage, which hugetlb mappings must be a multiple of
+#define HUGE_PAGE_SIZE (1ULL << 21)
+
+// vector buffers are prefixed with how they were allocated, since ft->resize is not told the old capacity
+typedef struct{
+	uint64_t map_len;//length of the mapping, or 0 if the buffer came from malloc
+	uint64_t size;//bytes in use, including this header
+} buf_header;
+
+static const cr8r_hugemem default_cfg = {};
+
+static const cr8r_hugemem *get_cfg(const cr8r_base_ft *base){
+	return base->data ?: &default_cfg;
+}
+
+#ifdef __linux__
+static uint64_t get_threshold(const cr8r_hugemem *cfg){
+	return cfg->threshold ?: CR8R_HUGEMEM_DEFAULT_THRESHOLD;
+}
+
+static uint64_t map_len(const cr8r_hugemem *cfg, uint64_t size){
+	uint64_t align = cfg->flags & CR8R_HUGEMEM_HUGETLB ? HUGE_PAGE_SIZE : (uint64_t)sysconf(_SC_PAGESIZE);
+	return (size + align - 1)/align*align;
+}
+
+// advise the kernel to use transparent hugepages and apply the numa policy, if any.  both are best effort
+static void apply_policy(const cr8r_hugemem *cfg, void *p, uint64_t len){
+	(void)!madvise(p, len, MADV_HUGEPAGE);
+	int mode = cfg->flags & CR8R_HUGEMEM_INTERLEAVE ? MPOL_INTERLEAVE : cfg->flags & CR8R_HUGEMEM_BIND ? MPOL_BIND : MPOL_DEFAULT;
+	if(mode != MPOL_DEFAULT){
+		unsigned long nodemask = cfg->nodemask;
+		(void)!syscall(SYS_mbind, p, len, mode, &nodemask, 8*sizeof(nodemask) + 1, 0);
+	}
+}
+
+static void *map_pages(const cr8r_hugemem *cfg, uint64_t len){
+	void *p = MAP_FAILED;
+	if(cfg->flags & CR8R_HUGEMEM_HUGETLB){
+		p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	}
+	if(p == MAP_FAILED){
+		p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(p == MAP_FAILED){
+			return NULL;
+		}
+	}
+	apply_policy(cfg, p, len);
+	return p;
+}
+
+static void *remap_pages(const cr8r_hugemem *cfg, void *p, uint64_t old_len, uint64_t new_len){
+	void *res = mremap(p, old_len, new_len, MREMAP_MAYMOVE);
+	if(res != MAP_FAILED){
+		apply_policy(cfg, res, new_len);
+		return res;
+	}
+	//older kernels cannot mremap hugetlb mappings, so fall back to copying
+	if(!(res = map_pages(cfg, new_len))){
+		return NULL;
+	}
+	memcpy(res, p, old_len < new_len ? old_len : new_len);
+	munmap(p, old_len);
+	return res;
+}
+
+static void unmap_pages(void *p, uint64_t len){
+	munmap(p, len);
+}
+#else
+static uint64_t get_threshold(const cr8r_hugemem *cfg){
+	return UINT64_MAX;
+}
+
+static uint64_t map_len(const cr8r_hugemem *cfg, uint64_t size){
+	return size;
+}
+
+static void *map_pages(const cr8r_hugemem *cfg, uint64_t len){
+	return NULL;
+}
+
+static void *remap_pages(const cr8r_hugemem *cfg, void *p, uint64_t old_len, uint64_t new_len){
+	return NULL;
+}
+
+static void unmap_pages(void *p, uint64_t len){}
+#endif
+
+void *cr8r_default_resize_huge(cr8r_base_ft *base, void *p, uint64_t cap){
+	const cr8r_hugemem *cfg = get_cfg(base);
+	buf_header *h = p ? p - sizeof(buf_header) : NULL;
+	if(!cap){
+		if(h){
+			if(h->map_len){
+				unmap_pages(h, h->map_len);
+			}else{
+				free(h);
+			}
+		}
+		return NULL;
+	}
+	if(!base->size){
+		return p;
+	}
+	uint64_t size = sizeof(buf_header) + cap*base->size;
+	buf_header *res;
+	if(h && h->map_len){//once a buffer is mapped it stays mapped, even if it shrinks below the threshold
+		uint64_t len = map_len(cfg, size);
+		if(len == h->map_len){
+			h->size = size;
+			return p;
+		}else if(!(res = remap_pages(cfg, h, h->map_len, len))){
+			return NULL;
+		}
+		res->map_len = len;
+	}else if(size >= get_threshold(cfg)){
+		uint64_t len = map_len(cfg, size);
+		if(!(res = map_pages(cfg, len))){
+			return NULL;
+		}
+		if(h){
+			memcpy(res, h, h->size < size ? h->size : size);
+			free(h);
+		}
+		res->map_len = len;
+	}else{
+		if(!(res = realloc(h, size))){
+			return NULL;
+		}
+		res->map_len = 0;
+	}
+	res->size = size;
+	return res + 1;
+}
+
+void *cr8r_default_alloc_huge(const cr8r_base_ft *base, uint64_t size){
+	const cr8r_hugemem *cfg = get_cfg(base);
+	if(size < get_threshold(cfg)){
+		return calloc(1, size);
+	}
+	return map_pages(cfg, map_len(cfg, size));//fresh anonymous mappings are already zeroed
+}
+
+void cr8r_default_free_huge(const cr8r_base_ft *base, void *p, uint64_t size){
+	const cr8r_hugemem *cfg = get_cfg(base);
+	if(!p){
+		return;
+	}else if(size < get_threshold(cfg)){
+		free(p);
+	}else{
+		unmap_pages(p, map_len(cfg, size));
+	}
+}
+
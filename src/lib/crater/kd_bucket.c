@@ -0,0 +1,336 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <crater/kd_bucket.h>
+#include <crater/heap.h>
+#include <crater/prand.h>
+
+typedef struct{
+	double sqdist;
+	const void *ent;
+} candidate;
+
+// A subtree waiting to be searched by the best bin first search.  Followed in memory by its bounds object
+typedef struct{
+	double sqdist;// lower bound on the distance from the query point to any point in the subtree
+	uint64_t tree, a, b, depth;
+} branch;
+
+typedef struct{
+	const cr8r_kd_buckets *tree;
+	const cr8r_vec *ents;
+	cr8r_kd_ft ft;
+	const void *pt;
+	uint64_t k;
+	cr8r_vec *heap;// max heap of candidates
+	double *sqdists;// scratch space for one leaf
+} buckets_knn_state;
+
+static int cmp_candidates(const cr8r_base_ft *ft, const void *_a, const void *_b){
+	const candidate *a = _a, *b = _b;
+	return (a->sqdist > b->sqdist) - (a->sqdist < b->sqdist);
+}
+
+static cr8r_vec_ft candidate_ft = {
+	.base.size = sizeof(candidate),
+	.new_size = cr8r_default_new_size,
+	.resize = cr8r_default_resize,
+	.cmp = cmp_candidates,
+	.swap = cr8r_default_swap
+};
+
+static int cmp_branches(const cr8r_base_ft *ft, const void *_a, const void *_b){
+	const branch *a = _a, *b = _b;
+	return (a->sqdist > b->sqdist) - (a->sqdist < b->sqdist);
+}
+
+static bool build_r(cr8r_kd_buckets *self, cr8r_vec *ents, cr8r_kd_ft *_ft, uint64_t a, uint64_t b){
+	cr8r_kd_ft ft = *_ft;
+	while(b - a > self->leaf_size){
+		uint64_t mid_idx = (a + b)/2;
+		void *piv = cr8r_vec_ith(ents, &ft.super, a, b, mid_idx - a);
+		if(!piv || !cr8r_vec_partition_with_median(ents, &ft.super, a, b, piv)){
+			return 0;
+		}
+		// increment depth
+		++*(uint64_t*)&ft.super.base.data;
+		if(!build_r(self, ents, &ft, mid_idx + 1, b)){
+			return 0;
+		}
+		b = mid_idx;
+	}
+	ft.to_soa(&ft, ents->buf + a*ft.super.base.size, b - a, self->soa + a*ft.soa_size);
+	return 1;
+}
+
+bool cr8r_kd_buckets_build(cr8r_kd_buckets *self, cr8r_vec *ents, cr8r_kd_ft *ft, uint64_t leaf_size){
+	if(!ft->soa_size || !ft->to_soa || !ft->soa_sqdists){
+		return 0;
+	}
+	*self = (cr8r_kd_buckets){.len = ents->len, .leaf_size = leaf_size ?: CR8R_KD_BUCKET_DEFAULT_LEAF};
+	if(!(self->soa = malloc(ents->len*ft->soa_size ?: 1))){
+		return 0;
+	}
+	if(!build_r(self, ents, ft, 0, ents->len)){
+		cr8r_kd_buckets_delete(self);
+		return 0;
+	}
+	return 1;
+}
+
+void cr8r_kd_buckets_delete(cr8r_kd_buckets *self){
+	free(self->soa);
+	*self = (cr8r_kd_buckets){};
+}
+
+static void consider(cr8r_vec *heap, uint64_t k, double sqdist, const void *ent){
+	if(heap->len < k){
+		cr8r_heap_push(heap, &candidate_ft, &(candidate){sqdist, ent}, 1);
+	}else{
+		candidate *top = cr8r_heap_top(heap, &candidate_ft);
+		if(sqdist < top->sqdist){
+			*top = (candidate){sqdist, ent};
+			cr8r_heap_sift_down(heap, &candidate_ft, top, 1);
+		}
+	}
+}
+
+static bool pruned(buckets_knn_state *st, const void *bounds){
+	if(st->heap->len < st->k){
+		return false;
+	}
+	const candidate *top = cr8r_heap_top(st->heap, &candidate_ft);
+	return st->ft.min_sqdist(&st->ft, bounds, st->pt) >= top->sqdist;
+}
+
+static void knn_r(buckets_knn_state *st, void *bounds, uint64_t a, uint64_t b){
+	cr8r_kd_ft *ft = &st->ft;
+	uint64_t depth = (uint64_t)ft->super.base.data;
+	char sub0[ft->bounds_size];
+	char sub1[ft->bounds_size];
+	while(b > a){
+		ft->super.base.data = (void*)depth;
+		if(pruned(st, bounds)){
+			return;
+		}
+		if(b - a <= st->tree->leaf_size){
+			ft->soa_sqdists(ft, st->tree->soa + a*ft->soa_size, b - a, st->pt, st->sqdists);
+			for(uint64_t i = 0; i < b - a; ++i){
+				consider(st->heap, st->k, st->sqdists[i], st->ents->buf + (a + i)*ft->super.base.size);
+			}
+			return;
+		}
+		uint64_t mid_idx = (a + b)/2;
+		const void *ent = st->ents->buf + mid_idx*ft->super.base.size;
+		consider(st->heap, st->k, ft->sqdist(ft, st->pt, ent), ent);
+		ft->split(ft, bounds, ent, sub0, sub1);
+		bool left_first = ft->super.cmp(&ft->super.base, st->pt, ent) < 0;
+		// increment depth
+		ft->super.base.data = (void*)++depth;
+		// search the side containing pt first, so the other side is more likely to be pruned
+		if(left_first){
+			knn_r(st, sub0, a, mid_idx);
+			a = mid_idx + 1;
+			memcpy(bounds, sub1, ft->bounds_size);
+		}else{
+			knn_r(st, sub1, mid_idx + 1, b);
+			b = mid_idx;
+			memcpy(bounds, sub0, ft->bounds_size);
+		}
+	}
+}
+
+// popping from the max heap gives the candidates from farthest to closest, so fill out from the back
+static void pop_candidates(cr8r_vec *heap, const cr8r_kd_ft *ft, cr8r_vec *out){
+	out->len = heap->len;
+	for(candidate c; heap->len;){
+		cr8r_heap_pop(heap, &candidate_ft, &c, 1);
+		memcpy(out->buf + heap->len*ft->super.base.size, c.ent, ft->super.base.size);
+	}
+}
+
+bool cr8r_kd_buckets_k_closest(const cr8r_kd_buckets *self, const cr8r_vec *ents, cr8r_kd_ft *ft, const void *_bounds, const void *pt, uint64_t k, cr8r_vec *out){
+	cr8r_vec_clear(out, &ft->super);
+	if(!cr8r_vec_ensure_cap(out, &ft->super, k)){
+		return false;
+	}
+	cr8r_vec heap;
+	if(!cr8r_vec_init(&heap, &candidate_ft, k + 1)){
+		return false;
+	}
+	double sqdists[self->leaf_size];
+	char bounds[ft->bounds_size];
+	memcpy(bounds, _bounds, ft->bounds_size);
+	buckets_knn_state st = {.tree = self, .ents = ents, .ft = *ft, .pt = pt, .k = k, .heap = &heap, .sqdists = sqdists};
+	if(k){
+		knn_r(&st, bounds, 0, self->len);
+	}
+	pop_candidates(&heap, ft, out);
+	cr8r_vec_delete(&heap, &candidate_ft);
+	return true;
+}
+
+// The same point is in every tree of a randomized forest, so when searching several trees, points already in the heap
+// have to be skipped.  Only candidates with exactly the same distance need to be compared.
+static bool already_found(const cr8r_vec *heap, const cr8r_kd_ft *ft, double sqdist, const void *ent){
+	for(uint64_t i = 0; i < heap->len; ++i){
+		const candidate *c = heap->buf + i*sizeof(candidate);
+		if(c->sqdist == sqdist && !memcmp(c->ent, ent, ft->super.base.size)){
+			return true;
+		}
+	}
+	return false;
+}
+
+static void consider_unique(cr8r_vec *heap, uint64_t k, bool dedup, const cr8r_kd_ft *ft, double sqdist, const void *ent){
+	if(heap->len == k && sqdist >= ((const candidate*)cr8r_heap_top(heap, &candidate_ft))->sqdist){
+		return;
+	}
+	if(dedup && already_found(heap, ft, sqdist, ent)){
+		return;
+	}
+	consider(heap, k, sqdist, ent);
+}
+
+// Best bin first search over one or more bucketed trees built on copies of the same points.
+// All trees share one min heap of unsearched subtrees, ordered by their distance lower bounds.  Popping a subtree
+// descends straight to the leaf on the query point's side, pushing the far child of each node on the way.
+// Tree t splits in the order split_dims + t*ft->dim if split_dims is not NULL, and starts at depth root_depth.
+static bool bbf_k_closest(uint64_t num_trees, const cr8r_kd_buckets *trees, const cr8r_vec *ents, const uint64_t *split_dims, uint64_t root_depth, cr8r_kd_ft *_ft, const void *root_bounds, const void *pt, uint64_t k, double eps, uint64_t max_leaves, cr8r_vec *out){
+	cr8r_kd_ft ft = *_ft;
+	cr8r_vec_clear(out, &ft.super);
+	if(!cr8r_vec_ensure_cap(out, &ft.super, k)){
+		return false;
+	}
+	cr8r_vec_ft branch_ft = candidate_ft;
+	branch_ft.base.size = sizeof(branch) + ft.bounds_size;
+	branch_ft.cmp = cmp_branches;
+	cr8r_vec heap, branches;
+	if(!cr8r_vec_init(&heap, &candidate_ft, k + 1)){
+		return false;
+	}
+	if(!cr8r_vec_init(&branches, &branch_ft, 2*num_trees)){
+		cr8r_vec_delete(&heap, &candidate_ft);
+		return false;
+	}
+	bool ok = true;
+	uint64_t leaf_size = trees[0].leaf_size;
+	double sqdists[leaf_size];
+	_Alignas(branch) char curr_buf[branch_ft.base.size], next_buf[branch_ft.base.size];
+	branch *curr = (branch*)curr_buf, *next = (branch*)next_buf;
+	char *curr_bounds = curr_buf + sizeof(branch), *next_bounds = next_buf + sizeof(branch);
+	char sub0[ft.bounds_size], sub1[ft.bounds_size];
+	double slack = (1 + eps)*(1 + eps);
+	for(uint64_t t = 0; t < num_trees && k; ++t){
+		*curr = (branch){ft.min_sqdist(&ft, root_bounds, pt), t, 0, trees[t].len, root_depth};
+		memcpy(curr_bounds, root_bounds, ft.bounds_size);
+		ok = ok && cr8r_heap_push(&branches, &branch_ft, curr, -1);
+	}
+	for(uint64_t leaves = 0; ok && branches.len && (!max_leaves || leaves < max_leaves); ++leaves){
+		cr8r_heap_pop(&branches, &branch_ft, curr, -1);
+		if(heap.len == k && curr->sqdist*slack >= ((const candidate*)cr8r_heap_top(&heap, &candidate_ft))->sqdist){
+			break;
+		}
+		const cr8r_kd_buckets *tree = trees + curr->tree;
+		const cr8r_vec *tree_ents = ents + curr->tree;
+		if(split_dims){
+			ft.split_dims = split_dims + curr->tree*ft.dim;
+		}
+		while(curr->b - curr->a > leaf_size){
+			ft.super.base.data = (void*)curr->depth;
+			uint64_t mid_idx = (curr->a + curr->b)/2;
+			const void *ent = tree_ents->buf + mid_idx*ft.super.base.size;
+			consider_unique(&heap, k, num_trees > 1, &ft, ft.sqdist(&ft, pt, ent), ent);
+			*next = (branch){.tree = curr->tree, .depth = curr->depth + 1};
+			ft.split(&ft, curr_bounds, ent, sub0, sub1);
+			if(ft.super.cmp(&ft.super.base, pt, ent) < 0){
+				memcpy(curr_bounds, sub0, ft.bounds_size);
+				memcpy(next_bounds, sub1, ft.bounds_size);
+				next->a = mid_idx + 1;
+				next->b = curr->b;
+				curr->b = mid_idx;
+			}else{
+				memcpy(curr_bounds, sub1, ft.bounds_size);
+				memcpy(next_bounds, sub0, ft.bounds_size);
+				next->a = curr->a;
+				next->b = mid_idx;
+				curr->a = mid_idx + 1;
+			}
+			++curr->depth;
+			next->sqdist = ft.min_sqdist(&ft, next_bounds, pt);
+			if(next->b > next->a && (heap.len < k || next->sqdist*slack < ((const candidate*)cr8r_heap_top(&heap, &candidate_ft))->sqdist)){
+				ok = ok && cr8r_heap_push(&branches, &branch_ft, next, -1);
+			}
+		}
+		ft.soa_sqdists(&ft, tree->soa + curr->a*ft.soa_size, curr->b - curr->a, pt, sqdists);
+		for(uint64_t i = 0; i < curr->b - curr->a; ++i){
+			consider_unique(&heap, k, num_trees > 1, &ft, sqdists[i], tree_ents->buf + (curr->a + i)*ft.super.base.size);
+		}
+	}
+	pop_candidates(&heap, &ft, out);
+	cr8r_vec_delete(&heap, &candidate_ft);
+	cr8r_vec_delete(&branches, &branch_ft);
+	return ok;
+}
+
+bool cr8r_kd_buckets_k_closest_approx(const cr8r_kd_buckets *self, const cr8r_vec *ents, cr8r_kd_ft *ft, const void *bounds, const void *pt, uint64_t k, double eps, uint64_t max_leaves, cr8r_vec *out){
+	return bbf_k_closest(1, self, ents, ft->split_dims, (uint64_t)ft->super.base.data, ft, bounds, pt, k, eps, max_leaves, out);
+}
+
+bool cr8r_kd_rforest_build(cr8r_kd_rforest *self, const cr8r_vec *ents, cr8r_kd_ft *ft, const void *bounds, uint64_t num_trees, uint64_t leaf_size, cr8r_prng *prng){
+	if(!num_trees){
+		return 0;
+	}
+	*self = (cr8r_kd_rforest){.num_trees = num_trees};
+	if(
+		!(self->ents = calloc(num_trees, sizeof(cr8r_vec))) ||
+		!(self->trees = calloc(num_trees, sizeof(cr8r_kd_buckets))) ||
+		!(self->split_dims = calloc(num_trees*ft->dim, sizeof(uint64_t))) ||
+		!(self->bounds = malloc(ft->bounds_size))
+	){
+		cr8r_kd_rforest_delete(self, ft);
+		return 0;
+	}
+	memcpy(self->bounds, bounds, ft->bounds_size);
+	// give each tree its own random split order with an inside out Fisher-Yates shuffle
+	for(uint64_t i = 0; i < num_trees; ++i){
+		uint64_t *order = self->split_dims + i*ft->dim;
+		for(uint64_t j = 0; j < ft->dim; ++j){
+			uint64_t r = cr8r_prng_uniform_u64(prng, 0, j + 1);
+			order[j] = order[r];
+			order[r] = j;
+		}
+	}
+	cr8r_kd_ft tree_ft = *ft;
+	tree_ft.super.base.data = 0;
+	for(uint64_t i = 0; i < num_trees; ++i){
+		tree_ft.split_dims = self->split_dims + i*ft->dim;
+		if(!cr8r_vec_copy(self->ents + i, ents, &ft->super) || !cr8r_kd_buckets_build(self->trees + i, self->ents + i, &tree_ft, leaf_size)){
+			cr8r_kd_rforest_delete(self, ft);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+void cr8r_kd_rforest_delete(cr8r_kd_rforest *self, cr8r_kd_ft *ft){
+	for(uint64_t i = 0; i < self->num_trees; ++i){
+		if(self->ents){
+			cr8r_vec_delete(self->ents + i, &ft->super);
+		}
+		if(self->trees){
+			cr8r_kd_buckets_delete(self->trees + i);
+		}
+	}
+	free(self->ents);
+	free(self->trees);
+	free(self->split_dims);
+	free(self->bounds);
+	*self = (cr8r_kd_rforest){};
+}
+
+bool cr8r_kd_rforest_k_closest(const cr8r_kd_rforest *self, cr8r_kd_ft *ft, const void *pt, uint64_t k, double eps, uint64_t max_leaves, cr8r_vec *out){
+	return bbf_k_closest(self->num_trees, self->trees, self->ents, self->split_dims, 0, ft, self->bounds, pt, k, eps, max_leaves, out);
+}
+
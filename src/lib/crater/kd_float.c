@@ -0,0 +1,202 @@
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <crater/kd_tree.h>
+
+// The leaf distance kernels use gcc vector extensions, which are lowered to whatever simd instructions the target has
+// (sse2 on any x86_64), plus an avx2 clone where CR8R_ATTR_SIMD_CLONES supports it.
+
+typedef double v4f64 __attribute__((vector_size(32)));
+typedef float v8f32 __attribute__((vector_size(32)));
+
+// Define all the callbacks for cuboid kd trees with coordinates of type T.
+// Bounds objects are T[2*dim], with the minimum point followed by the maximum point.
+#define DEFINE_KD_FLOAT(T, sfx, VT, LANES) \
+static int cmp_depth_c##sfx(const cr8r_base_ft *_ft, const void *_a, const void *_b){ \
+	const cr8r_kd_ft *ft = (const cr8r_kd_ft*)_ft; \
+	uint64_t idx = cr8r_kd_split_dim(ft); \
+	T a = ((const T*)_a)[idx], b = ((const T*)_b)[idx]; \
+	return (a > b) - (a < b); \
+} \
+\
+static void split_c##sfx(const cr8r_kd_ft *ft, const void *_self, const void *_root_pt, void *_o1, void *_o2){ \
+	const T *root = _root_pt; \
+	T *o1 = _o1, *o2 = _o2; \
+	uint64_t idx = cr8r_kd_split_dim(ft); \
+	memcpy(o1, _self, ft->bounds_size); \
+	memcpy(o2, _self, ft->bounds_size); \
+	o1[ft->dim + idx] = root[idx]; \
+	o2[idx] = root[idx]; \
+} \
+\
+static void update_c##sfx(const cr8r_kd_ft *ft, void *_self, const void *_pt){ \
+	T *self = _self; \
+	const T *pt = _pt; \
+	for(uint64_t i = 0; i < ft->dim; ++i){ \
+		if(pt[i] < self[i]){ \
+			self[i] = pt[i]; \
+		} \
+		if(pt[i] > self[ft->dim + i]){ \
+			self[ft->dim + i] = pt[i]; \
+		} \
+	} \
+} \
+\
+static double min_sqdist_c##sfx(const cr8r_kd_ft *ft, const void *_self, const void *_pt){ \
+	const T *self = _self, *pt = _pt; \
+	double sqdist = 0; \
+	for(uint64_t i = 0; i < ft->dim; ++i){ \
+		double axdist = 0; \
+		if(pt[i] < self[i]){ \
+			axdist = (double)self[i] - pt[i]; \
+		}else if(pt[i] > self[ft->dim + i]){ \
+			axdist = (double)pt[i] - self[ft->dim + i]; \
+		} \
+		sqdist += axdist*axdist; \
+	} \
+	return sqdist; \
+} \
+\
+static double max_sqdist_c##sfx(const cr8r_kd_ft *ft, const void *_self, const void *_pt){ \
+	const T *self = _self, *pt = _pt; \
+	double sqdist = 0; \
+	for(uint64_t i = 0; i < ft->dim; ++i){ \
+		double axdist = fmax(fabs((double)pt[i] - self[i]), fabs((double)self[ft->dim + i] - pt[i])); \
+		sqdist += axdist*axdist; \
+	} \
+	return sqdist; \
+} \
+\
+static double sqdist_c##sfx(const cr8r_kd_ft *ft, const void *_a, const void *_b){ \
+	const T *a = _a, *b = _b; \
+	T res = 0; \
+	for(uint64_t i = 0; i < ft->dim; ++i){ \
+		res += (a[i] - b[i])*(a[i] - b[i]); \
+	} \
+	return res; \
+} \
+\
+static bool contains_c##sfx(const cr8r_kd_ft *ft, const void *_region, const void *_self){ \
+	const T *region = _region, *self = _self; \
+	for(uint64_t i = 0; i < ft->dim; ++i){ \
+		if(self[i] < region[i] || self[ft->dim + i] > region[ft->dim + i]){ \
+			return false; \
+		} \
+	} \
+	return true; \
+} \
+\
+static bool intersects_c##sfx(const cr8r_kd_ft *ft, const void *_region, const void *_self){ \
+	const T *region = _region, *self = _self; \
+	for(uint64_t i = 0; i < ft->dim; ++i){ \
+		if(self[ft->dim + i] < region[i] || self[i] > region[ft->dim + i]){ \
+			return false; \
+		} \
+	} \
+	return true; \
+} \
+\
+static void to_soa_c##sfx(const cr8r_kd_ft *ft, const void *ents, uint64_t n, void *_soa){ \
+	T *soa = _soa; \
+	for(uint64_t i = 0; i < n; ++i){ \
+		const T *pt = ents + i*ft->super.base.size; \
+		for(uint64_t j = 0; j < ft->dim; ++j){ \
+			soa[j*n + i] = pt[j]; \
+		} \
+	} \
+} \
+\
+CR8R_ATTR_SIMD_CLONES static void soa_sqdists_c##sfx(const cr8r_kd_ft *ft, const void *_soa, uint64_t n, const void *_pt, double *out){ \
+	const T *soa = _soa, *pt = _pt; \
+	uint64_t i = 0; \
+	for(; i + LANES <= n; i += LANES){ \
+		VT acc = {}; \
+		for(uint64_t j = 0; j < ft->dim; ++j){ \
+			VT x; \
+			memcpy(&x, soa + j*n + i, sizeof(VT)); \
+			x -= pt[j]; \
+			acc += x*x; \
+		} \
+		for(uint64_t l = 0; l < LANES; ++l){ \
+			out[i + l] = acc[l]; \
+		} \
+	} \
+	for(; i < n; ++i){ \
+		T acc = 0; \
+		for(uint64_t j = 0; j < ft->dim; ++j){ \
+			T x = soa[j*n + i] - pt[j]; \
+			acc += x*x; \
+		} \
+		out[i] = acc; \
+	} \
+} \
+\
+bool cr8r_kdwin_bounding_c##sfx(T *bounds, const cr8r_vec *ents, const cr8r_kd_ft *ft){ \
+	if(!ents->len){ \
+		return 0; \
+	} \
+	memcpy(bounds, ents->buf, ft->dim*sizeof(T)); \
+	memcpy(bounds + ft->dim, ents->buf, ft->dim*sizeof(T)); \
+	for(uint64_t i = 1; i < ents->len; ++i){ \
+		ft->update(ft, bounds, ents->buf + i*ft->super.base.size); \
+	} \
+	return 1; \
+} \
+\
+cr8r_kd_ft cr8r_kdft_c2##sfx = { \
+	.super.base.size = 2*sizeof(T), \
+	.super.new_size = cr8r_default_new_size, \
+	.super.resize = cr8r_default_resize, \
+	.super.cmp = cmp_depth_c##sfx, \
+	.super.swap = cr8r_default_swap, \
+	.dim = 2, \
+	.bounds_size = 4*sizeof(T), \
+	.split = split_c##sfx, \
+	.update = update_c##sfx, \
+	.min_sqdist = min_sqdist_c##sfx, \
+	.sqdist = sqdist_c##sfx, \
+	.max_sqdist = max_sqdist_c##sfx, \
+	.contains = contains_c##sfx, \
+	.intersects = intersects_c##sfx, \
+	.soa_size = 2*sizeof(T), \
+	.to_soa = to_soa_c##sfx, \
+	.soa_sqdists = soa_sqdists_c##sfx \
+}; \
+\
+cr8r_kd_ft cr8r_kdft_c3##sfx = { \
+	.super.base.size = 3*sizeof(T), \
+	.super.new_size = cr8r_default_new_size, \
+	.super.resize = cr8r_default_resize, \
+	.super.cmp = cmp_depth_c##sfx, \
+	.super.swap = cr8r_default_swap, \
+	.dim = 3, \
+	.bounds_size = 6*sizeof(T), \
+	.split = split_c##sfx, \
+	.update = update_c##sfx, \
+	.min_sqdist = min_sqdist_c##sfx, \
+	.sqdist = sqdist_c##sfx, \
+	.max_sqdist = max_sqdist_c##sfx, \
+	.contains = contains_c##sfx, \
+	.intersects = intersects_c##sfx, \
+	.soa_size = 3*sizeof(T), \
+	.to_soa = to_soa_c##sfx, \
+	.soa_sqdists = soa_sqdists_c##sfx \
+}; \
+\
+bool cr8r_kd_ft_init_c##sfx(cr8r_kd_ft *ft, uint64_t dim, uint64_t size){ \
+	if(!dim || size < dim*sizeof(T)){ \
+		return 0; \
+	} \
+	/* copy the callbacks from a static table, since gcc mistakes assigning the address of a cloned function for a dangling pointer */ \
+	*ft = cr8r_kdft_c2##sfx; \
+	ft->super.base.size = size; \
+	ft->dim = dim; \
+	ft->bounds_size = 2*dim*sizeof(T); \
+	ft->soa_size = dim*sizeof(T); \
+	return 1; \
+}
+
+DEFINE_KD_FLOAT(double, f64, v4f64, 4)
+DEFINE_KD_FLOAT(float, f32, v8f32, 8)
+
@@ -0,0 +1,208 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <crater/kd_forest.h>
+
+typedef struct{
+	cr8r_vec *tree;
+	cr8r_bvec *deleted;
+	cr8r_kdvisitor visitor;
+	void *data;
+	bool stopped;
+} forest_walk_state;
+
+typedef struct{
+	const void *ent;
+	cr8r_bvec *deleted;
+	cr8r_vec *tree;
+	bool found;
+} forest_remove_state;
+
+// get the depth 0 ft used for the root of every level
+static cr8r_kd_ft root_ft(cr8r_kd_ft *ft){
+	cr8r_kd_ft res = *ft;
+	res.super.base.data = (void*)0;
+	return res;
+}
+
+static bool is_deleted(cr8r_bvec *deleted, const cr8r_vec *tree, cr8r_kd_ft *ft, const void *ent){
+	return cr8r_bvec_getu(deleted, (ent - tree->buf)/ft->super.base.size);
+}
+
+// set the deleted mask for a level to len zeros
+static bool reset_deleted(cr8r_bvec *deleted, uint64_t len){
+	if(deleted->cap < len && !cr8r_bvec_resize(deleted, &cr8r_bvecft, len)){
+		return 0;
+	}
+	deleted->len = len;
+	if(len){
+		cr8r_bvec_set_range(deleted, 0, len, 0);
+	}
+	return 1;
+}
+
+// append the live points of a level to out, which must have enough capacity
+static void push_live(cr8r_vec *out, const cr8r_vec *tree, cr8r_bvec *deleted, cr8r_kd_ft *ft){
+	uint64_t size = ft->super.base.size;
+	for(uint64_t i = 0; i < tree->len; ++i){
+		if(!cr8r_bvec_getu(deleted, i)){
+			memcpy(out->buf + out->len++*size, tree->buf + i*size, size);
+		}
+	}
+}
+
+bool cr8r_kd_forest_init(cr8r_kd_forest *self, cr8r_kd_ft *ft, const void *bounds){
+	*self = (cr8r_kd_forest){};
+	if(!(self->bounds = malloc(ft->bounds_size))){
+		return 0;
+	}
+	memcpy(self->bounds, bounds, ft->bounds_size);
+	return 1;
+}
+
+void cr8r_kd_forest_delete(cr8r_kd_forest *self, cr8r_kd_ft *ft){
+	for(uint64_t i = 0; i < CR8R_KD_FOREST_LEVELS; ++i){
+		cr8r_vec_delete(self->trees + i, &ft->super);
+		cr8r_bvec_delete(self->deleted + i, &cr8r_bvecft);
+	}
+	free(self->bounds);
+	*self = (cr8r_kd_forest){};
+}
+
+bool cr8r_kd_forest_insert(cr8r_kd_forest *self, cr8r_kd_ft *ft, const void *ent){
+	uint64_t j = 0, total = 1;
+	for(; j < CR8R_KD_FOREST_LEVELS && self->trees[j].len; ++j){
+		total += self->trees[j].len - cr8r_bvec_popcount(self->deleted + j);
+	}
+	if(j == CR8R_KD_FOREST_LEVELS){
+		return 0;
+	}
+	cr8r_vec *tree = self->trees + j;
+	if(!cr8r_vec_ensure_cap(tree, &ft->super, total) || !reset_deleted(self->deleted + j, total)){
+		return 0;
+	}
+	for(uint64_t i = 0; i < j; ++i){
+		push_live(tree, self->trees + i, self->deleted + i, ft);
+		self->deleted_len -= cr8r_bvec_popcount(self->deleted + i);
+		self->trees[i].len = 0;// the points were moved, so ft->super.del should not be called on them
+		cr8r_bvec_clear(self->deleted + i);
+	}
+	memcpy(tree->buf + tree->len++*ft->super.base.size, ent, ft->super.base.size);
+	cr8r_kd_ft _ft = root_ft(ft);
+	// cr8r_kd_ify only fails if ft->super.cmp is inconsistent, since the buffer is already allocated
+	cr8r_kd_ify(tree, &_ft, 0, tree->len);
+	ft->update(ft, self->bounds, ent);
+	++self->len;
+	return 1;
+}
+
+static cr8r_walk_decision remove_visitor(cr8r_kd_ft *ft, const void *bounds, void *ent, void *_data){
+	forest_remove_state *data = _data;
+	if(ft->min_sqdist(ft, bounds, data->ent) > 0){
+		return CR8R_WALK_SKIP_CHILDREN;
+	}
+	if(!memcmp(ent, data->ent, ft->super.base.size) && !is_deleted(data->deleted, data->tree, ft, ent)){
+		cr8r_bvec_setu(data->deleted, (ent - data->tree->buf)/ft->super.base.size, 1);
+		data->found = true;
+		return CR8R_WALK_STOP;
+	}
+	return CR8R_WALK_CONTINUE;
+}
+
+bool cr8r_kd_forest_remove(cr8r_kd_forest *self, cr8r_kd_ft *ft, const void *ent){
+	forest_remove_state data = {.ent = ent};
+	cr8r_kd_ft _ft = root_ft(ft);
+	for(uint64_t i = 0; i < CR8R_KD_FOREST_LEVELS && !data.found; ++i){
+		if(!self->trees[i].len){
+			continue;
+		}
+		data.tree = self->trees + i;
+		data.deleted = self->deleted + i;
+		cr8r_kd_walk(data.tree, &_ft, self->bounds, remove_visitor, &data);
+	}
+	if(!data.found){
+		return 0;
+	}
+	--self->len;
+	if(++self->deleted_len > self->len){
+		// if compaction fails the point is still marked as deleted, so the forest remains consistent
+		cr8r_kd_forest_compact(self, ft);
+	}
+	return 1;
+}
+
+bool cr8r_kd_forest_compact(cr8r_kd_forest *self, cr8r_kd_ft *ft){
+	uint64_t j = 0;
+	while((1ULL << j) < self->len){
+		++j;
+	}
+	cr8r_vec all = {};
+	if(!cr8r_vec_init(&all, &ft->super, self->len)){
+		return 0;
+	}
+	cr8r_bvec deleted = {};
+	if(!reset_deleted(&deleted, self->len)){
+		cr8r_vec_delete(&all, &ft->super);
+		return 0;
+	}
+	for(uint64_t i = 0; i < CR8R_KD_FOREST_LEVELS; ++i){
+		push_live(&all, self->trees + i, self->deleted + i, ft);
+		self->trees[i].len = 0;
+		cr8r_bvec_clear(self->deleted + i);
+	}
+	cr8r_vec_delete(self->trees + j, &ft->super);
+	cr8r_bvec_delete(self->deleted + j, &cr8r_bvecft);
+	self->trees[j] = all;
+	self->deleted[j] = deleted;
+	self->deleted_len = 0;
+	cr8r_kd_ft _ft = root_ft(ft);
+	cr8r_kd_ify(self->trees + j, &_ft, 0, self->len);
+	return 1;
+}
+
+static cr8r_walk_decision forest_visitor(cr8r_kd_ft *ft, const void *bounds, void *ent, void *_data){
+	forest_walk_state *data = _data;
+	if(is_deleted(data->deleted, data->tree, ft, ent)){
+		return CR8R_WALK_CONTINUE;
+	}
+	cr8r_walk_decision decision = data->visitor(ft, bounds, ent, data->data);
+	if(decision == CR8R_WALK_STOP){
+		data->stopped = true;
+	}
+	return decision;
+}
+
+void cr8r_kd_forest_walk(cr8r_kd_forest *self, cr8r_kd_ft *ft, cr8r_kdvisitor visitor, void *data){
+	forest_walk_state state = {.visitor = visitor, .data = data};
+	cr8r_kd_ft _ft = root_ft(ft);
+	for(uint64_t i = 0; i < CR8R_KD_FOREST_LEVELS && !state.stopped; ++i){
+		if(!self->trees[i].len){
+			continue;
+		}
+		state.tree = self->trees + i;
+		state.deleted = self->deleted + i;
+		cr8r_kd_walk(state.tree, &_ft, self->bounds, forest_visitor, &state);
+	}
+}
+
+bool cr8r_kd_forest_k_closest(cr8r_kd_forest *self, cr8r_kd_ft *ft, const void *pt, uint64_t k, cr8r_vec *out){
+	cr8r_vec_clear(out, &ft->super);
+	if(!cr8r_vec_ensure_cap(out, &ft->super, k + 1)){
+		return false;
+	}
+	cr8r_kd_k_closest_state data = {
+		.ents = out,
+		.ft = *ft,
+		.pt = pt,
+		.k = k,
+		.max_sqdist = INFINITY
+	};
+	data.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
+	if(k){
+		cr8r_kd_forest_walk(self, ft, cr8r_kd_k_closest_visitor, &data);
+	}
+	return true;
+}
+
@@ -8,12 +8,13 @@
 #include <crater/kd_check.h>
 #include <crater/minmax_heap.h>
 
+#include "parallel.h"
+
 static int cmp_depth_i64cu(const cr8r_base_ft *_ft, const void *_a, const void *_b){
 	const cr8r_kd_ft *ft = (cr8r_kd_ft*)_ft;
 	const int64_t *a = _a;
 	const int64_t *b = _b;
-	uint64_t depth = (uint64_t)ft->super.base.data;
-	uint64_t idx = depth%ft->dim;
+	uint64_t idx = cr8r_kd_split_dim(ft);
 	int64_t key_a = a[idx];
 	int64_t key_b = b[idx];
 	if(key_a < key_b){
@@ -28,8 +29,7 @@ static int cmp_depth_i64sp(const cr8r_base_ft *_ft, const void *_a, const void *
 	const cr8r_kd_ft *ft = (cr8r_kd_ft*)_ft;
 	const int64_t *a = _a;
 	const int64_t *b = _b;
-	uint64_t depth = (uint64_t)ft->super.base.data;
-	uint64_t idx = depth%ft->dim;
+	uint64_t idx = cr8r_kd_split_dim(ft);
 	if(idx == ft->dim - 1){
 		int64_t a_x = a[0], a_y = a[1];
 		int64_t b_x = b[0], b_y = b[1];
@@ -78,7 +78,7 @@ static void split_i64sp(const cr8r_kd_ft *ft, const void *_self, const void *_ro
 	const int64_t *root = _root_pt;
 	cr8r_kdwin_s2i64 *o1 = _o1;
 	cr8r_kdwin_s2i64 *o2 = _o2;
-	uint64_t idx = (uint64_t)ft->super.base.data%ft->dim;
+	uint64_t idx = cr8r_kd_split_dim(ft);
 	memcpy(o1, self, sizeof(cr8r_kdwin_s2i64));
 	memcpy(o2, self, sizeof(cr8r_kdwin_s2i64));
 	if(idx == ft->dim - 1){
@@ -189,7 +189,7 @@ static void split_i64cu(const cr8r_kd_ft *ft, const void *_self, const void *_ro
 	const int64_t *root = _root_pt;
 	cr8r_kdwin_s2i64 *o1 = _o1;
 	cr8r_kdwin_s2i64 *o2 = _o2;
-	uint64_t idx = (uint64_t)ft->super.base.data%ft->dim;
+	uint64_t idx = cr8r_kd_split_dim(ft);
 	memcpy(o1, self, sizeof(cr8r_kdwin_s2i64));
 	memcpy(o2, self, sizeof(cr8r_kdwin_s2i64));
 	o1->tr[idx] = root[idx];
@@ -233,6 +233,39 @@ static double sqdist_i64cu(const cr8r_kd_ft *_ft, const void *_a, const void *_b
 	return res;
 }
 
+static double max_sqdist_i64cu(const cr8r_kd_ft *_ft, const void *_self, const void *_pt){
+	const cr8r_kdwin_s2i64 *self = _self;
+	const int64_t *pt = _pt;
+	double sqdist = 0;
+	for(uint64_t i = 0; i < _ft->dim; ++i){
+		int64_t axdist = pt[i] - self->bl[i];
+		if(self->tr[i] - pt[i] > axdist){
+			axdist = self->tr[i] - pt[i];
+		}
+		sqdist += axdist*axdist;
+	}
+	return sqdist;
+}
+
+static bool contains_i64cu(const cr8r_kd_ft *_ft, const void *_region, const void *_self){
+	const cr8r_kdwin_s2i64 *region = _region, *self = _self;
+	for(uint64_t i = 0; i < _ft->dim; ++i){
+		if(self->bl[i] < region->bl[i] || self->tr[i] > region->tr[i]){
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool intersects_i64cu(const cr8r_kd_ft *_ft, const void *_region, const void *_self){
+	const cr8r_kdwin_s2i64 *region = _region, *self = _self;
+	for(uint64_t i = 0; i < _ft->dim; ++i){
+		if(self->tr[i] < region->bl[i] || self->bl[i] > region->tr[i]){
+			return false;
+		}
+	}
+	return true;
+}
 
 
 bool cr8r_kdwin_init_i64sp(cr8r_kdwin_s2i64 *self, const int64_t bl[3], const int64_t tr[3]){
@@ -284,39 +317,220 @@ bool cr8r_kd_ify(cr8r_vec *self, cr8r_kd_ft *_ft, uint64_t a, uint64_t b){
 	return 1;
 }
 
-cr8r_walk_decision cr8r_kd_walk_r(cr8r_vec *self, const cr8r_kd_ft *_ft, void *bounds, cr8r_kdvisitor visitor, void *data, uint64_t a, uint64_t b){
-	cr8r_kd_ft ft = *_ft;
-	char sub0[ft.bounds_size];
-	char sub1[ft.bounds_size];
+// subranges at least this long have their median found with a parallel partition
+#define KD_PAR_PARTITION_MIN (1ULL << 16)
+// subranges shorter than this are always built on the current thread
+#define KD_PAR_FORK_MIN (1ULL << 14)
+// number of elements sampled to pick each pivot of the parallel partition
+#define KD_PAR_SAMPLE 31
+
+typedef struct{
+	cr8r_vec *self;
+	const cr8r_kd_ft *ft;
+	void *scratch;
+	const void *piv;
+	uint64_t off;// start of the range being partitioned, so scratch[i - off] corresponds to self->buf[i]
+	uint64_t a, b;// chunk handled by this task
+	uint64_t lt, eq;// number of elements in the chunk < and == the pivot
+	uint64_t lt_out, eq_out, gt_out;// next index in scratch for elements <, ==, and > the pivot
+	int phase;
+} par_part_task;
+
+typedef struct{
+	cr8r_vec *self;
+	cr8r_kd_ft ft;
+	uint64_t a, b, threads;
+	bool status;
+} par_build_task;
+
+static void *par_part_worker(void *_task){
+	par_part_task *task = _task;
+	const cr8r_vec_ft *ft = &task->ft->super;
+	uint64_t size = ft->base.size;
+	if(task->phase == 2){
+		memcpy(task->self->buf + task->a*size, task->scratch + (task->a - task->off)*size, (task->b - task->a)*size);
+		return NULL;
+	}
+	for(uint64_t i = task->a; i < task->b; ++i){
+		void *ent = task->self->buf + i*size;
+		int ord = ft->cmp(&ft->base, ent, task->piv);
+		if(task->phase == 0){
+			task->lt += ord < 0;
+			task->eq += !ord;
+		}else{
+			uint64_t *out = ord < 0 ? &task->lt_out : ord ? &task->gt_out : &task->eq_out;
+			memcpy(task->scratch + (*out)++*size, ent, size);
+		}
+	}
+	return NULL;
+}
+
+// stable three way partition of [a, b) around piv using threads threads, with scratch as temporary storage.
+// stores the number of elements < piv in *lt and == piv in *eq
+static void par_partition(cr8r_vec *self, const cr8r_kd_ft *ft, uint64_t a, uint64_t b, const void *piv, void *scratch, uint64_t threads, uint64_t *lt, uint64_t *eq){
+	uint64_t chunk = (b - a + threads - 1)/threads;
+	par_part_task tasks[threads];
+	for(uint64_t i = 0; i < threads; ++i){
+		uint64_t ta = a + i*chunk < b ? a + i*chunk : b;
+		uint64_t tb = ta + chunk < b ? ta + chunk : b;
+		tasks[i] = (par_part_task){.self = self, .ft = ft, .scratch = scratch, .piv = piv, .off = a, .a = ta, .b = tb};
+	}
+	cr8r_run_parallel(par_part_worker, tasks, sizeof(par_part_task), threads);
+	uint64_t lt_total = 0, eq_total = 0;
+	for(uint64_t i = 0; i < threads; ++i){
+		lt_total += tasks[i].lt;
+		eq_total += tasks[i].eq;
+	}
+	for(uint64_t i = 0, lt_out = 0, eq_out = lt_total, gt_out = lt_total + eq_total; i < threads; ++i){
+		tasks[i].lt_out = lt_out;
+		tasks[i].eq_out = eq_out;
+		tasks[i].gt_out = gt_out;
+		tasks[i].phase = 1;
+		lt_out += tasks[i].lt;
+		eq_out += tasks[i].eq;
+		gt_out += tasks[i].b - tasks[i].a - tasks[i].lt - tasks[i].eq;
+	}
+	cr8r_run_parallel(par_part_worker, tasks, sizeof(par_part_task), threads);
+	for(uint64_t i = 0; i < threads; ++i){
+		tasks[i].phase = 2;
+	}
+	cr8r_run_parallel(par_part_worker, tasks, sizeof(par_part_task), threads);
+	*lt = lt_total;
+	*eq = eq_total;
+}
+
+// in place three way partition of [a, b) around piv
+static void dnf_partition(cr8r_vec *self, cr8r_kd_ft *ft, uint64_t a, uint64_t b, const void *piv){
+	uint64_t size = ft->super.base.size;
+	for(uint64_t i = a; i < b;){
+		void *ent = self->buf + i*size;
+		int ord = ft->super.cmp(&ft->super.base, ent, piv);
+		if(ord < 0){
+			if(i != a){
+				ft->super.swap(&ft->super.base, self->buf + a*size, ent);
+			}
+			++a, ++i;
+		}else if(ord > 0){
+			--b;
+			if(i != b){
+				ft->super.swap(&ft->super.base, self->buf + b*size, ent);
+			}
+		}else{
+			++i;
+		}
+	}
+}
+
+// place the median of [a, b) in the current dimension at (a + b)/2, with all smaller elements before it
+// and all larger elements after it, like one iteration of cr8r_kd_ify
+static bool par_select_layer(cr8r_vec *self, cr8r_kd_ft *ft, uint64_t a, uint64_t b, uint64_t threads){
+	uint64_t size = ft->super.base.size, mid_idx = (a + b)/2;
+	void *scratch = b - a >= KD_PAR_PARTITION_MIN ? malloc((b - a)*size) : NULL;
+	char piv[size];
+	if(scratch){
+		char sample_buf[KD_PAR_SAMPLE*size];
+		cr8r_vec sample = {.buf = sample_buf, .len = KD_PAR_SAMPLE, .cap = KD_PAR_SAMPLE};
+		while(b - a >= KD_PAR_PARTITION_MIN){
+			// pick the sample element whose rank matches the rank of the median in the remaining range,
+			// so the range shrinks by a large factor each round
+			for(uint64_t i = 0; i < KD_PAR_SAMPLE; ++i){
+				memcpy(sample_buf + i*size, self->buf + (a + (2*i + 1)*(b - a)/(2*KD_PAR_SAMPLE))*size, size);
+			}
+			void *sample_piv = cr8r_vec_ith(&sample, &ft->super, 0, KD_PAR_SAMPLE, (mid_idx - a)*KD_PAR_SAMPLE/(b - a));
+			if(!sample_piv){
+				free(scratch);
+				return 0;
+			}
+			memcpy(piv, sample_piv, size);
+			uint64_t lt, eq;
+			par_partition(self, ft, a, b, piv, scratch, threads, &lt, &eq);
+			if(mid_idx < a + lt){
+				b = a + lt;
+			}else if(mid_idx >= a + lt + eq){
+				a += lt + eq;
+			}else{
+				free(scratch);
+				return 1;
+			}
+		}
+		free(scratch);
+	}
+	void *med = cr8r_vec_ith(self, &ft->super, a, b, mid_idx - a);
+	if(!med){
+		return 0;
+	}
+	memcpy(piv, med, size);
+	dnf_partition(self, ft, a, b, piv);
+	return 1;
+}
+
+static void *par_build_worker(void *_task){
+	par_build_task *task = _task;
+	task->status = cr8r_kd_ify_mt(task->self, &task->ft, task->a, task->b, task->threads);
+	return NULL;
+}
+
+bool cr8r_kd_ify_mt(cr8r_vec *self, cr8r_kd_ft *ft, uint64_t a, uint64_t b, uint64_t threads){
+	if(threads <= 1 || b - a < KD_PAR_FORK_MIN){
+		return cr8r_kd_ify(self, ft, a, b);
+	}
+	if(!par_select_layer(self, ft, a, b, threads)){
+		return 0;
+	}
+#ifdef DEBUG
+	if(!cr8r_kd_check_layer(self, ft, a, b)){
+		__builtin_trap();
+	}
+#endif
+	uint64_t mid_idx = (a + b)/2;
+	par_build_task tasks[2] = {
+		{.self = self, .ft = *ft, .a = a, .b = mid_idx, .threads = threads/2},
+		{.self = self, .ft = *ft, .a = mid_idx + 1, .b = b, .threads = threads - threads/2}
+	};
+	// increment depth
+	++*(uint64_t*)&tasks[0].ft.super.base.data;
+	++*(uint64_t*)&tasks[1].ft.super.base.data;
+	cr8r_run_parallel(par_build_worker, tasks, sizeof(par_build_task), 2);
+	return tasks[0].status && tasks[1].status;
+}
+
+// ft is shared by the whole traversal (only its depth changes), so it isn't copied at every level
+static cr8r_walk_decision cr8r_kd_walk_r(cr8r_vec *self, cr8r_kd_ft *ft, void *bounds, cr8r_kdvisitor visitor, void *data, uint64_t a, uint64_t b){
+	uint64_t depth = (uint64_t)ft->super.base.data;
+	char sub0[ft->bounds_size];
+	char sub1[ft->bounds_size];
 	while(b > a){
+		// the recursive call below changes the depth, so restore it each iteration
+		ft->super.base.data = (void*)depth;
 		uint64_t mid_idx = (a + b)/2;
-		void *ent =  self->buf + mid_idx*ft.super.base.size;
-		cr8r_walk_decision decision = visitor(&ft, bounds, ent, data);
+		void *ent =  self->buf + mid_idx*ft->super.base.size;
+		cr8r_walk_decision decision = visitor(ft, bounds, ent, data);
 		if(decision == CR8R_WALK_STOP){
 			return decision;
 		}else if(decision == CR8R_WALK_SKIP_CHILDREN){
 			return CR8R_WALK_CONTINUE;
 		}
-		ft.split(&ft, bounds, ent, sub0, sub1);
+		ft->split(ft, bounds, ent, sub0, sub1);
 		// increment depth
-		++*(uint64_t*)&ft.super.base.data;
-		decision = cr8r_kd_walk_r(self, &ft, sub0, visitor, data, a, mid_idx);
+		ft->super.base.data = (void*)++depth;
+		decision = cr8r_kd_walk_r(self, ft, sub0, visitor, data, a, mid_idx);
 		if(decision == CR8R_WALK_STOP){
 			return decision;
 		}
 		a = mid_idx + 1;
-		memcpy(bounds, sub1, ft.bounds_size);
+		memcpy(bounds, sub1, ft->bounds_size);
 	}
 	return CR8R_WALK_CONTINUE;
 }
 
-void cr8r_kd_walk(cr8r_vec *self, const cr8r_kd_ft *ft, const void *_bounds, cr8r_kdvisitor visitor, void *data){
-	char bounds[ft->bounds_size];
-	memcpy(bounds, _bounds, ft->bounds_size);
-	cr8r_kd_walk_r(self, ft, bounds, visitor, data, 0, self->len);
+void cr8r_kd_walk(cr8r_vec *self, const cr8r_kd_ft *_ft, const void *_bounds, cr8r_kdvisitor visitor, void *data){
+	cr8r_kd_ft ft = *_ft;
+	char bounds[ft.bounds_size];
+	memcpy(bounds, _bounds, ft.bounds_size);
+	cr8r_kd_walk_r(self, &ft, bounds, visitor, data, 0, self->len);
 }
 
-inline static cr8r_walk_decision k_closest_visitor(cr8r_kd_ft *ft, const void *bounds, void *ent, void *_data){
+cr8r_walk_decision cr8r_kd_k_closest_visitor(cr8r_kd_ft *ft, const void *bounds, void *ent, void *_data){
 	cr8r_kd_k_closest_state *data = _data;
 	char tmp[ft->super.base.size];
 	if(data->ents->len < data->k){
@@ -325,7 +539,11 @@ inline static cr8r_walk_decision k_closest_visitor(cr8r_kd_ft *ft, const void *b
 		cr8r_mmheap_pushpop_max(data->ents, &data->ft.super, ent, tmp);
 		data->max_sqdist = ft->sqdist(ft, data->pt, cr8r_mmheap_peek_max(data->ents, &data->ft.super));
 	}
-	if(isinf(data->max_sqdist) || data->max_sqdist > ft->min_sqdist(ft, bounds, ent)){
+	if(data->max_visits && ++data->visits >= data->max_visits){
+		return CR8R_WALK_STOP;
+	}
+	// with eps > 0, subtrees which can only improve the kth closest distance by a factor of less than 1 + eps are skipped
+	if(isinf(data->max_sqdist) || data->max_sqdist > (1 + data->eps)*(1 + data->eps)*ft->min_sqdist(ft, bounds, data->pt)){
 		return CR8R_WALK_CONTINUE;
 	}
 	return CR8R_WALK_SKIP_CHILDREN;
@@ -357,10 +575,240 @@ bool cr8r_kd_k_closest(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds, const
 		.max_sqdist = INFINITY
 	};
 	data.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
-	cr8r_kd_walk(self, ft, bounds, k_closest_visitor, &data);
+	cr8r_kd_walk(self, ft, bounds, cr8r_kd_k_closest_visitor, &data);
+	return true;
+}
+
+bool cr8r_kd_k_closest_approx(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds, const void *pt, uint64_t k, double eps, uint64_t max_visits, cr8r_vec *out){
+	cr8r_vec_clear(out, &ft->super);
+	if(!cr8r_vec_ensure_cap(out, &ft->super, k + 1)){
+		return false;
+	}
+	cr8r_kd_k_closest_state data = {
+		.ents = out,
+		.ft = *ft,
+		.pt = pt,
+		.k = k,
+		.max_sqdist = INFINITY,
+		.eps = eps,
+		.max_visits = max_visits
+	};
+	data.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
+	cr8r_kd_walk(self, ft, bounds, cr8r_kd_k_closest_visitor, &data);
 	return true;
 }
 
+typedef struct{
+	// radius queries
+	const void *pt;
+	double sqr;
+	// box queries, used if pt is NULL
+	const void *box;
+	// output, or NULL to only count
+	cr8r_vec *out;
+	uint64_t count;
+	bool status;
+} range_state;
+
+// 0 if the bounds are entirely outside the query region, 2 if they are entirely inside, and 1 otherwise
+static int range_classify(const cr8r_kd_ft *ft, const void *bounds, const range_state *st){
+	if(st->pt){
+		if(ft->min_sqdist(ft, bounds, st->pt) > st->sqr){
+			return 0;
+		}
+		return ft->max_sqdist && ft->max_sqdist(ft, bounds, st->pt) <= st->sqr ? 2 : 1;
+	}
+	if(ft->intersects && !ft->intersects(ft, st->box, bounds)){
+		return 0;
+	}
+	return ft->contains && ft->contains(ft, st->box, bounds) ? 2 : 1;
+}
+
+static bool range_match(const cr8r_kd_ft *ft, const void *ent, const range_state *st){
+	if(st->pt){
+		return ft->sqdist(ft, st->pt, ent) <= st->sqr;
+	}
+	return !ft->min_sqdist(ft, st->box, ent);
+}
+
+static void range_push(cr8r_vec *self, cr8r_kd_ft *ft, range_state *st, uint64_t a, uint64_t b){
+	st->count += b - a;
+	if(!st->out){
+		return;
+	}else if(!cr8r_vec_ensure_cap(st->out, &ft->super, st->out->len + b - a)){
+		st->status = false;
+		return;
+	}
+	memcpy(st->out->buf + st->out->len*ft->super.base.size, self->buf + a*ft->super.base.size, (b - a)*ft->super.base.size);
+	st->out->len += b - a;
+}
+
+// like cr8r_kd_walk_r, but has access to the index range of each subtree so that subtrees inside the region
+// can be taken all at once
+static void range_r(cr8r_vec *self, cr8r_kd_ft *ft, void *bounds, range_state *st, uint64_t a, uint64_t b){
+	uint64_t depth = (uint64_t)ft->super.base.data;
+	char sub0[ft->bounds_size];
+	char sub1[ft->bounds_size];
+	while(b > a && st->status){
+		ft->super.base.data = (void*)depth;
+		int cls = range_classify(ft, bounds, st);
+		if(cls != 1){
+			if(cls == 2){
+				range_push(self, ft, st, a, b);
+			}
+			return;
+		}
+		uint64_t mid_idx = (a + b)/2;
+		void *ent = self->buf + mid_idx*ft->super.base.size;
+		if(range_match(ft, ent, st)){
+			range_push(self, ft, st, mid_idx, mid_idx + 1);
+		}
+		ft->split(ft, bounds, ent, sub0, sub1);
+		// increment depth
+		ft->super.base.data = (void*)++depth;
+		range_r(self, ft, sub0, st, a, mid_idx);
+		a = mid_idx + 1;
+		memcpy(bounds, sub1, ft->bounds_size);
+	}
+}
+
+static range_state range_query(cr8r_vec *self, const cr8r_kd_ft *_ft, const void *_bounds, range_state st){
+	cr8r_kd_ft ft = *_ft;
+	char bounds[ft.bounds_size];
+	memcpy(bounds, _bounds, ft.bounds_size);
+	st.status = true;
+	range_r(self, &ft, bounds, &st, 0, self->len);
+	return st;
+}
+
+bool cr8r_kd_within_radius(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds, const void *pt, double r, cr8r_vec *out){
+	cr8r_vec_clear(out, &ft->super);
+	return range_query(self, ft, bounds, (range_state){.pt = pt, .sqr = r*r, .out = out}).status;
+}
+
+uint64_t cr8r_kd_count_within_radius(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds, const void *pt, double r){
+	return range_query(self, ft, bounds, (range_state){.pt = pt, .sqr = r*r}).count;
+}
+
+bool cr8r_kd_in_box(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds, const void *box, cr8r_vec *out){
+	cr8r_vec_clear(out, &ft->super);
+	return range_query(self, ft, bounds, (range_state){.box = box, .out = out}).status;
+}
+
+uint64_t cr8r_kd_count_in_box(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds, const void *box){
+	return range_query(self, ft, bounds, (range_state){.box = box}).count;
+}
+
+typedef struct{
+	cr8r_vec *self;
+	cr8r_kd_ft *ft;
+	const void *bounds;
+	const cr8r_vec *pts;
+	const uint64_t *order;// (key, query index) pairs
+	uint64_t a, b;// range of order handled by this task
+	uint64_t k;
+	void *out;
+	bool status;
+} batch_task;
+
+// find the index in the implicit tree where pt would be inserted, so that queries can be processed in tree order
+static uint64_t tree_order(const cr8r_vec *self, const cr8r_kd_ft *_ft, const void *pt){
+	cr8r_kd_ft ft = *_ft;
+	uint64_t a = 0, b = self->len;
+	while(b > a){
+		uint64_t mid_idx = (a + b)/2;
+		int ord = ft.super.cmp(&ft.super.base, pt, self->buf + mid_idx*ft.super.base.size);
+		// increment depth
+		++*(uint64_t*)&ft.super.base.data;
+		if(ord < 0){
+			b = mid_idx;
+		}else{
+			a = mid_idx + 1;
+		}
+	}
+	return a;
+}
+
+static void *batch_worker(void *_task){
+	batch_task *task = _task;
+	uint64_t size = task->ft->super.base.size;
+	cr8r_vec ents;
+	cr8r_kd_k_closest_state data = {
+		.ents = &ents,
+		.ft = *task->ft,
+		.k = task->k
+	};
+	data.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
+	if(!cr8r_vec_init(&ents, &data.ft.super, task->k + 1)){
+		task->status = 0;
+		return NULL;
+	}
+	for(uint64_t i = task->a; i < task->b; ++i){
+		uint64_t q = task->order[2*i + 1];
+		data.pt = task->pts->buf + q*size;
+		data.max_sqdist = INFINITY;
+		ents.len = 0;
+		cr8r_kd_walk(task->self, task->ft, task->bounds, cr8r_kd_k_closest_visitor, &data);
+		cr8r_vec_sort(&ents, &data.ft.super);
+		memcpy(task->out + q*task->k*size, ents.buf, task->k*size);
+	}
+	cr8r_vec_delete(&ents, &data.ft.super);
+	task->status = 1;
+	return NULL;
+}
+
+bool cr8r_kd_k_closest_batch(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds, const cr8r_vec *pts, uint64_t k, cr8r_vec *out, uint64_t threads){
+	if(k > self->len){
+		k = self->len;
+	}
+	cr8r_vec_clear(out, &ft->super);
+	if(!cr8r_vec_ensure_cap(out, &ft->super, pts->len*k)){
+		return 0;
+	}
+	if(!k || !pts->len){
+		return 1;
+	}
+	cr8r_vec_ft order_ft = {
+		.base.size = 2*sizeof(uint64_t),
+		.new_size = cr8r_default_new_size,
+		.resize = cr8r_default_resize,
+		.cmp = cr8r_default_cmp_u64,// compares only the first u64, which is the key
+		.swap = cr8r_default_swap
+	};
+	cr8r_vec order;
+	if(!cr8r_vec_init(&order, &order_ft, pts->len)){
+		return 0;
+	}
+	for(uint64_t i = 0; i < pts->len; ++i){
+		cr8r_vec_pushr(&order, &order_ft, (uint64_t[2]){tree_order(self, ft, pts->buf + i*ft->super.base.size), i});
+	}
+	cr8r_vec_sort(&order, &order_ft);
+	if(threads > pts->len){
+		threads = pts->len;
+	}else if(!threads){
+		threads = 1;
+	}
+	uint64_t chunk = (pts->len + threads - 1)/threads;
+	batch_task tasks[threads];
+	for(uint64_t i = 0; i < threads; ++i){
+		uint64_t a = i*chunk < pts->len ? i*chunk : pts->len;
+		tasks[i] = (batch_task){
+			.self = self, .ft = ft, .bounds = bounds, .pts = pts, .order = order.buf,
+			.a = a, .b = a + chunk < pts->len ? a + chunk : pts->len,
+			.k = k, .out = out->buf
+		};
+	}
+	cr8r_run_parallel(batch_worker, tasks, sizeof(batch_task), threads);
+	cr8r_vec_delete(&order, &order_ft);
+	for(uint64_t i = 0; i < threads; ++i){
+		if(!tasks[i].status){
+			return 0;
+		}
+	}
+	out->len = pts->len*k;
+	return 1;
+}
+
 bool cr8r_kd_k_closest_naive(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds, const void *pt, uint64_t k, cr8r_vec *out){
 	cr8r_vec_clear(out, &ft->super);
 	if(!cr8r_vec_ensure_cap(out, &ft->super, k + 1)){
@@ -375,7 +823,7 @@ bool cr8r_kd_k_closest_naive(cr8r_vec *self, cr8r_kd_ft *ft, const void *bounds,
 	};
 	data.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
 	for(uint64_t i = 0; i < self->len; ++i){
-		k_closest_visitor(ft, bounds, self->buf + i*ft->super.base.size, &data);
+		cr8r_kd_k_closest_visitor(ft, bounds, self->buf + i*ft->super.base.size, &data);
 	}
 	return true;
 }
@@ -405,6 +853,9 @@ cr8r_kd_ft cr8r_kdft_c3i64 = {
 	.split = split_i64cu,
 	.update = update_i64cu,
 	.min_sqdist = min_sqdist_i64cu,
-	.sqdist = sqdist_i64cu
+	.sqdist = sqdist_i64cu,
+	.max_sqdist = max_sqdist_i64cu,
+	.contains = contains_i64cu,
+	.intersects = intersects_i64cu
 };
 
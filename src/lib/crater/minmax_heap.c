@@ -147,3 +147,62 @@ bool cr8r_mmheap_pushpop_max(cr8r_vec *self, cr8r_vec_ft *ft, const void *e, voi
 	return cr8r_mmheap_pop_max(self, ft, o);
 }
 
+bool cr8r_mmheap_push_many(cr8r_vec *self, cr8r_vec_ft *ft, const void *es, uint64_t n){
+	if(!n){
+		return 1;
+	}
+	if(!cr8r_vec_ensure_cap(self, ft, self->len + n)){
+		return 0;
+	}
+	uint64_t lo = self->len;
+	memcpy(self->buf + lo*ft->base.size, es, n*ft->base.size);
+	self->len += n;
+	if(!lo){
+		cr8r_mmheap_ify(self, ft);
+		return 1;
+	}
+	// same as cr8r_heap_push_many: fix the new elements and then each range of parents from the right
+	for(uint64_t hi = self->len;;){
+		for(uint64_t i = hi; i-- > lo;){
+			cr8r_mmheap_sift_down(self, ft, self->buf + i*ft->base.size);
+		}
+		if(!lo){
+			return 1;
+		}
+		lo = (lo - 1) >> 1;
+		hi = ((hi - 2) >> 1) + 1;
+	}
+}
+
+bool cr8r_mmheap_pop_k_min(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t k, cr8r_vec *out){
+	cr8r_vec_clear(out, ft);
+	if(k > self->len){
+		k = self->len;
+	}
+	if(!cr8r_vec_ensure_cap(out, ft, k)){
+		return 0;
+	}
+	for(; out->len < k; ++out->len){
+		cr8r_mmheap_pop_min(self, ft, out->buf + out->len*ft->base.size);
+	}
+	return 1;
+}
+
+bool cr8r_mmheap_pop_k_max(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t k, cr8r_vec *out){
+	cr8r_vec_clear(out, ft);
+	if(k > self->len){
+		k = self->len;
+	}
+	if(!cr8r_vec_ensure_cap(out, ft, k)){
+		return 0;
+	}
+	for(; out->len < k; ++out->len){
+		cr8r_mmheap_pop_max(self, ft, out->buf + out->len*ft->base.size);
+	}
+	return 1;
+}
+
+bool cr8r_mmheap_merge(cr8r_vec *self, cr8r_vec_ft *ft, const cr8r_vec *other){
+	return cr8r_mmheap_push_many(self, ft, other->buf, other->len);
+}
+
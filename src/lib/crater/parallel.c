@@ -0,0 +1,21 @@
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "parallel.h"
+
+void cr8r_run_parallel(void *(*f)(void*), void *tasks, uint64_t size, uint64_t n){
+	pthread_t tids[n];
+	bool started[n];
+	for(uint64_t i = 1; i < n; ++i){
+		started[i] = !pthread_create(tids + i, NULL, f, tasks + i*size);
+	}
+	f(tasks);
+	for(uint64_t i = 1; i < n; ++i){
+		if(started[i]){
+			pthread_join(tids[i], NULL);
+		}else{
+			f(tasks + i*size);
+		}
+	}
+}
+
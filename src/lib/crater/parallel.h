@@ -0,0 +1,22 @@
+#pragma once
+
+/// @file
+/// @author hacatu
+/// @version 0.3.0
+/// Thread helpers shared by the parallel algorithms in the library.  Not installed or part of the public interface.
+///
+/// This Source Code Form is subject to the terms of the Mozilla Public
+/// License, v. 2.0. If a copy of the MPL was not distributed with this
+/// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <inttypes.h>
+
+/// Run f on n tasks of the given size, using a new thread for all but the first
+///
+/// If a thread can't be created, its task is run on the current thread instead, so all tasks are always run.
+/// @param [in] f: function to run on each task
+/// @param [in,out] tasks: array of n tasks, each size bytes
+/// @param [in] size: size of each task in bytes
+/// @param [in] n: number of tasks, at least 1
+void cr8r_run_parallel(void *(*f)(void*), void *tasks, uint64_t size, uint64_t n);
+
@@ -2,16 +2,25 @@
 #include <string.h>
 
 #include <crater/pheap.h>
+#include <crater/arena.h>
 
-cr8r_pheap_node *cr8r_pheap_new(void *key, cr8r_pheap_ft *ft, cr8r_pheap_node *first_child, cr8r_pheap_node *sibling, cr8r_pheap_node *parent){
+cr8r_pheap_node *cr8r_pheap_new(void *key, cr8r_pheap_ft *ft, cr8r_pheap_node *first_child, cr8r_pheap_node *sibling, cr8r_pheap_node *prev){
 	void *res = ft->alloc ? ft->alloc(&ft->base) : NULL;
 	if(res){
 		memcpy(res, key, ft->base.size);
-		memcpy(res + ft->base.size, &(cr8r_pheap_node){.first_child = first_child, .sibling = sibling, .parent = parent}, sizeof(cr8r_pheap_node));
+		memcpy(res + ft->base.size, &(cr8r_pheap_node){.first_child = first_child, .sibling = sibling, .prev = prev}, sizeof(cr8r_pheap_node));
 	}
 	return res + ft->base.size;
 }
 
+void *cr8r_default_alloc_arena_pheap(cr8r_base_ft *ft){
+	return cr8r_arena_alloc(ft->data, ft->size + sizeof(cr8r_pheap_node));
+}
+
+void cr8r_default_free_arena_pheap(cr8r_base_ft *ft, void *p){
+	cr8r_arena_free(ft->data, p - ft->size, ft->size + sizeof(cr8r_pheap_node));
+}
+
 void *cr8r_pheap_top(cr8r_pheap_node *r, cr8r_pheap_ft *ft){
 	return r ? CR8R_OUTER_S(r, ft) : NULL;
 }
@@ -20,8 +29,8 @@ cr8r_pheap_node *cr8r_pheap_root(cr8r_pheap_node *n){
 	if(!n){
 		return NULL;
 	}
-	while(n->parent){
-		n = n->parent;
+	while(n->prev){
+		n = n->prev;
 	}
 	return n;
 }
@@ -32,14 +41,16 @@ cr8r_pheap_node *cr8r_pheap_meld(cr8r_pheap_node *a, cr8r_pheap_node *b, cr8r_ph
 	}else if(!b){
 		return a;
 	}else if(ft->cmp(&ft->base, CR8R_OUTER_S(a, ft), CR8R_OUTER_S(b, ft)) > 0){
-		a->sibling = b->first_child;
-		b->first_child = a;
-		a->parent = b;
-		return b;
+		cr8r_pheap_node *t = a;
+		a = b;
+		b = t;
 	}
 	b->sibling = a->first_child;
+	if(b->sibling){
+		b->sibling->prev = b;
+	}
 	a->first_child = b;
-	b->parent = a;
+	b->prev = a;
 	return a;
 }
 
@@ -62,7 +73,7 @@ static cr8r_pheap_node *cr8r_pheap_merge_binary(cr8r_pheap_node **n, size_t dept
 		a = *n;
 		*n = (*n)->sibling;
 		a->sibling = NULL;
-		a->parent = NULL;
+		a->prev = NULL;
 		return a;
 	}
 	a = cr8r_pheap_merge_binary(n, depth - 1, ft);
@@ -89,24 +100,44 @@ cr8r_pheap_node *cr8r_pheap_pop(cr8r_pheap_node **r, cr8r_pheap_ft *ft){
 	return ret;
 }
 
+/// helper function to cut a non root node (and its subtree) out of its parent's list of children
+static void cr8r_pheap_unlink(cr8r_pheap_node *n){
+	if(n->prev->first_child == n){
+		n->prev->first_child = n->sibling;
+	}else{
+		n->prev->sibling = n->sibling;
+	}
+	if(n->sibling){
+		n->sibling->prev = n->prev;
+	}
+	n->sibling = NULL;
+	n->prev = NULL;
+}
+
 cr8r_pheap_node *cr8r_pheap_decreased_key(cr8r_pheap_node *n, cr8r_pheap_ft *ft){
 	if(!n){
 		return NULL;
 	}
-	cr8r_pheap_node *p = n->parent;
-	if(!p || ft->cmp(&ft->base, CR8R_OUTER_S(p, ft), CR8R_OUTER_S(n, ft)) <= 0){
-		return cr8r_pheap_root(p);
-	}else if(p->first_child == n){
-		p->first_child = n->sibling;
-	}else for(cr8r_pheap_node *s = p->first_child;; s = s->sibling){
-		if(s->sibling == n){
-			s->sibling = n->sibling;
-			break;
-		}
+	cr8r_pheap_node *r = cr8r_pheap_root(n);
+	cr8r_pheap_decrease(&r, n, ft);
+	return r;
+}
+
+void cr8r_pheap_decrease(cr8r_pheap_node **r, cr8r_pheap_node *n, cr8r_pheap_ft *ft){
+	if(n == *r){
+		return;
 	}
-	n->sibling = NULL;
-	n->parent = NULL;
-	return cr8r_pheap_meld(cr8r_pheap_root(p), n, ft);
+	cr8r_pheap_unlink(n);
+	*r = cr8r_pheap_meld(*r, n, ft);
+}
+
+void cr8r_pheap_remove(cr8r_pheap_node **r, cr8r_pheap_node *n, cr8r_pheap_ft *ft){
+	if(n == *r){
+		cr8r_pheap_pop(r, ft);
+		return;
+	}
+	cr8r_pheap_unlink(n);
+	*r = cr8r_pheap_meld(*r, cr8r_pheap_merge_exponential(&n->first_child, ft), ft);
 }
 
 void cr8r_pheap_delete(cr8r_pheap_node *r, cr8r_pheap_ft *ft){
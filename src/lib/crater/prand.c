@@ -1,4 +1,6 @@
+#include <errno.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -15,11 +17,44 @@ typedef union{
 	};
 } double_bits_t;
 
+// Fill a buffer 4 bytes at a time using a generator's get_u32 callback directly.
+// Always inlined into a generator's own fill callback, so next is a direct call.
+__attribute__((always_inline))
+static inline void fill_u32s(void *state, uint64_t size, void *buf, uint32_t (*next)(void*)){
+	uint64_t i;
+	for(i = 0; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t)){
+		uint32_t tmp = next(state);
+		memcpy(buf + i, &tmp, sizeof(uint32_t));
+	}
+	if(i != size){
+		uint32_t tmp = next(state);
+		memcpy(buf + i, &tmp, size - i);
+	}
+}
+
+// Fill a buffer 8 bytes at a time using a generator's get_u64 callback directly
+__attribute__((always_inline))
+static inline void fill_u64s(void *state, uint64_t size, void *buf, uint64_t (*next)(void*)){
+	uint64_t i;
+	for(i = 0; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)){
+		uint64_t tmp = next(state);
+		memcpy(buf + i, &tmp, sizeof(uint64_t));
+	}
+	if(i != size){
+		uint64_t tmp = next(state);
+		memcpy(buf + i, &tmp, size - i);
+	}
+}
+
+static uint32_t cr8r_prng_splitmix_get_u32(void*);
+
 bool cr8r_prng_seed(cr8r_prng *self, uint64_t seed){
 	if(self->state_size > sizeof(uint64_t)){
 		uint64_t _state = *(uint64_t*)cr8r_default_prng_splitmix->state;
 		*(uint64_t*)cr8r_default_prng_splitmix->state = seed;
-		cr8r_prng_get_bytes(cr8r_default_prng_splitmix, self->state_size, self->state);
+		// state is extended from 32 bit splitmix outputs (rather than using its fill callback)
+		// so that seeds keep producing the same streams they always have
+		fill_u32s(cr8r_default_prng_splitmix->state, self->state_size, self->state, cr8r_prng_splitmix_get_u32);
 		*(uint64_t*)cr8r_default_prng_splitmix->state = _state;
 	}else{
 		memcpy(self->state, &seed, self->state_size);
@@ -32,42 +67,84 @@ uint32_t cr8r_prng_get_u32(cr8r_prng *self){
 }
 
 uint64_t cr8r_prng_get_u64(cr8r_prng *self){
+	if(self->get_u64){
+		return self->get_u64(self->state);
+	}
 	uint64_t res = self->get_u32(self->state);
 	return res | ((uint64_t)self->get_u32(self->state) << 32);
 }
 
 void cr8r_prng_get_bytes(cr8r_prng *self, uint64_t size, void *buf){
+	if(self->fill){
+		self->fill(self->state, size, buf);
+		return;
+	}
 	uint64_t i;
-	for(i = 0; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t)){
-		uint32_t tmp = self->get_u32(self->state);
-		memcpy(buf + i, &tmp, sizeof(uint32_t));
+	for(i = 0; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)){
+		uint64_t tmp = cr8r_prng_get_u64(self);
+		memcpy(buf + i, &tmp, sizeof(uint64_t));
 	}
 	if(i != size){
-		uint32_t tmp = self->get_u32(self->state);
+		uint64_t tmp = cr8r_prng_get_u64(self);
 		memcpy(buf + i, &tmp, size - i);
 	}
 }
 
+bool cr8r_prng_jump(cr8r_prng *self, uint64_t n){
+	return self->jump && self->jump(self->state, n);
+}
+
+// Map a uniform 64 bit value r to [0, l) by taking the high half of r*l (Lemire, "Fast Random Integer Generation in an Interval").
+// The low half is below 2**64 mod l for exactly the values of r that make the result biased, and since that is less than l,
+// the modulo to find it is only needed when the low half is below l, which is rare unless l is huge.
+static inline uint64_t bounded_u64(cr8r_prng *self, uint64_t r, uint64_t l){
+	unsigned __int128 m = (unsigned __int128)r*l;
+	if((uint64_t)m < l){
+		uint64_t t = -l%l;
+		while((uint64_t)m < t){
+			m = (unsigned __int128)cr8r_prng_get_u64(self)*l;
+		}
+	}
+	return m >> 64;
+}
+
 uint64_t cr8r_prng_uniform_u64(cr8r_prng *self, uint64_t a, uint64_t b){
 	uint64_t l = b - a;
 	if(!l){
 		return a;
+	}else if(l > 0xFFFFFFFFull){
+		return bounded_u64(self, cr8r_prng_get_u64(self), l) + a;
 	}
-	uint64_t one_call = l <= 0x100000000ull;
-	uint64_t ub, r;
-	if(one_call){
-		ub = 0x100000000ull;
-		ub -= ub%l;
-		do{
-			r = cr8r_prng_get_u32(self);
-		}while(r >= ub);
-	}else{
-		ub = 0x7FFFFFFFFFFFFFFFull%l*(uint64_t)-2;
-		do{
-			r = cr8r_prng_get_u64(self);
-		}while(r >= ub);
+	uint32_t l32 = l;
+	uint64_t m = (uint64_t)cr8r_prng_get_u32(self)*l32;
+	if((uint32_t)m < l32){
+		uint32_t t = -l32%l32;
+		while((uint32_t)m < t){
+			m = (uint64_t)cr8r_prng_get_u32(self)*l32;
+		}
+	}
+	return (m >> 32) + a;
+}
+
+void cr8r_prng_fill_uniform_u64(cr8r_prng *self, uint64_t a, uint64_t b, uint64_t n, uint64_t *out){
+	uint64_t l = b - a;
+	if(!l){
+		for(uint64_t i = 0; i < n; ++i){
+			out[i] = a;
+		}
+		return;
+	}
+	cr8r_prng_get_bytes(self, n*sizeof(uint64_t), out);
+	for(uint64_t i = 0; i < n; ++i){
+		out[i] = bounded_u64(self, out[i], l) + a;
+	}
+}
+
+void cr8r_prng_fill_fisher_yates(cr8r_prng *self, uint64_t bound, uint64_t n, uint64_t *out){
+	cr8r_prng_get_bytes(self, n*sizeof(uint64_t), out);
+	for(uint64_t i = 0; i < n; ++i){
+		out[i] = bounded_u64(self, out[i], bound - i);
 	}
-	return r%l + a;
 }
 
 double cr8r_prng_uniform01_double(cr8r_prng *self){
@@ -76,7 +153,9 @@ double cr8r_prng_uniform01_double(cr8r_prng *self){
 		return 0.;
 	}
 	uint64_t exp_decrease = __builtin_clzll(u);
+	// shift out the leading 1 too, since it is implicit in the double format
 	u <<= exp_decrease;
+	u <<= 1;
 	double_bits_t bits = {.sign= 0, .exp= 1022 - exp_decrease, .fraction= u >> 12};
 	return bits.as_double;
 }
@@ -126,22 +205,458 @@ uint64_t cr8r_prng_log_mod_t64(uint64_t h){
 	return 0;
 }
 
+// Jumping F2 linear generators (MT and xoroshiro) by arbitrary numbers of steps.
+// If a generator's step is a linear map f on bit vectors and p is the minimal polynomial of its sequence of states,
+// then f**n(s) = g(f)(s) where g = x**n mod p, which can be applied with deg(p) steps by Horner's rule
+// (see "Efficient Jump Ahead for F2-Linear Random Number Generators" by Haramoto, Matsumoto, Nishimura, Panneton and L'Ecuyer).
+// Polynomials over F2 are stored as bit arrays, with bit i the coefficient of x**i.
+
+static inline bool f2_get(const uint64_t *a, uint64_t i){
+	return (a[i/64] >> (i%64))&1;
+}
+
+// get bits [i, i + 64) of a bit array with len words, where bits past the end are 0
+static inline uint64_t f2_window(const uint64_t *a, uint64_t len, uint64_t i){
+	uint64_t w = i/64, b = i%64;
+	uint64_t lo = w < len ? a[w] : 0;
+	if(!b){
+		return lo;
+	}
+	uint64_t hi = w + 1 < len ? a[w + 1] : 0;
+	return (lo >> b) | (hi << (64 - b));
+}
+
+// a ^= b << shift, discarding any bits past the end of a
+static void f2_xor_shifted(uint64_t *a, uint64_t len, const uint64_t *b, uint64_t b_len, uint64_t shift){
+	uint64_t w = shift/64, s = shift%64;
+	for(uint64_t i = 0; i < b_len && i + w < len; ++i){
+		a[i + w] ^= b[i] << s;
+		if(s && i + w + 1 < len){
+			a[i + w + 1] ^= b[i] >> (64 - s);
+		}
+	}
+}
+
+// spread the low 32 bits of x out to the even bits, which squares a polynomial over F2
+static inline uint64_t f2_spread(uint64_t x){
+	x &= 0xFFFFFFFFull;
+	x = (x | (x << 16))&0x0000FFFF0000FFFFull;
+	x = (x | (x << 8))&0x00FF00FF00FF00FFull;
+	x = (x | (x << 4))&0x0F0F0F0F0F0F0F0Full;
+	x = (x | (x << 2))&0x3333333333333333ull;
+	return (x | (x << 1))&0x5555555555555555ull;
+}
+
+// Find the minimal polynomial of the first len bits of seq with the Berlekamp-Massey algorithm.
+// poly must have room for len/64 + 1 words.
+// Returns the degree, or 0 on allocation failure
+static uint64_t f2_min_poly(const uint64_t *seq, uint64_t len, uint64_t *poly){
+	uint64_t words = len/64 + 1, deg = 0;
+	uint64_t *rev = calloc(4*words, sizeof(uint64_t));
+	if(!rev){
+		return 0;
+	}
+	uint64_t *c = rev + words, *b = c + words, *t = b + words;
+	// rev holds the sequence backwards, so that the bits s_(n-i) multiplying c_i in each discrepancy line up with c
+	for(uint64_t i = 0; i < len; ++i){
+		if(f2_get(seq, i)){
+			rev[(len - 1 - i)/64] |= 1ull << ((len - 1 - i)%64);
+		}
+	}
+	c[0] = b[0] = 1;
+	for(uint64_t n = 0, m = 1; n < len; ++n){
+		uint64_t d = 0;
+		for(uint64_t i = 0; i <= deg/64; ++i){
+			d ^= c[i]&f2_window(rev, words, len - 1 - n + 64*i);
+		}
+		if(!(__builtin_popcountll(d)&1)){
+			++m;
+		}else if(2*deg <= n){
+			memcpy(t, c, words*sizeof(uint64_t));
+			f2_xor_shifted(c, words, b, words, m);
+			memcpy(b, t, words*sizeof(uint64_t));
+			deg = n + 1 - deg;
+			m = 1;
+		}else{
+			f2_xor_shifted(c, words, b, words, m);
+			++m;
+		}
+	}
+	// c is the connection polynomial, ie s_n = sum(c_i*s_(n-i)), and the minimal polynomial is its reverse
+	memset(poly, 0, words*sizeof(uint64_t));
+	for(uint64_t i = 0; i <= deg; ++i){
+		if(f2_get(c, i)){
+			poly[(deg - i)/64] |= 1ull << ((deg - i)%64);
+		}
+	}
+	free(rev);
+	return deg;
+}
+
+// Compute x**n mod p into res, where p has degree deg and res has room for deg/64 + 1 words.
+// shifted must have room for 64*(deg/64 + 2) words, and tmp for 2*(deg/64 + 1) words.
+// Reducing means xoring in p shifted by every bit set past its degree, so all 64 shifts of p are precomputed
+// to make that a plain loop over words
+static void f2_xpow_mod(uint64_t n, const uint64_t *p, uint64_t deg, uint64_t *res, uint64_t *shifted, uint64_t *tmp){
+	uint64_t words = deg/64 + 1;
+	for(uint64_t s = 0; s < 64; ++s){
+		memset(shifted + s*(words + 1), 0, (words + 1)*sizeof(uint64_t));
+		f2_xor_shifted(shifted + s*(words + 1), words + 1, p, words, s);
+	}
+	memset(res, 0, words*sizeof(uint64_t));
+	res[0] = 1;
+	for(uint64_t bit = n ? 64 - __builtin_clzll(n) : 0; bit--;){
+		for(uint64_t i = 0; i < words; ++i){
+			tmp[2*i] = f2_spread(res[i]);
+			tmp[2*i + 1] = f2_spread(res[i] >> 32);
+		}
+		if((n >> bit)&1){
+			for(uint64_t i = 2*words; --i;){
+				tmp[i] = (tmp[i] << 1) | (tmp[i - 1] >> 63);
+			}
+			tmp[0] <<= 1;
+		}
+		for(uint64_t i = 2*deg; i-- > deg;){
+			if(f2_get(tmp, i)){
+				const uint64_t *ps = shifted + (i - deg)%64*(words + 1);
+				uint64_t *dst = tmp + (i - deg)/64;
+				// the top word of a shift can only be past the end of tmp if it is 0
+				uint64_t len = (i - deg)/64 + words + 1 <= 2*words ? words + 1 : words;
+				for(uint64_t j = 0; j < len; ++j){
+					dst[j] ^= ps[j];
+				}
+			}
+		}
+		memcpy(res, tmp, words*sizeof(uint64_t));
+	}
+}
+
+// Set state to g(f)(state), where g has degree below deg, the state has len words, and acc has room for len words
+static void f2_apply(uint64_t *state, uint64_t len, const uint64_t *g, uint64_t deg, void (*step)(uint64_t*), uint64_t *acc){
+	memset(acc, 0, len*sizeof(uint64_t));
+	for(uint64_t i = deg; i--;){
+		step(acc);
+		if(f2_get(g, i)){
+			for(uint64_t j = 0; j < len; ++j){
+				acc[j] ^= state[j];
+			}
+		}
+	}
+	memcpy(state, acc, len*sizeof(uint64_t));
+}
+
+typedef struct{
+	uint64_t *poly;
+	uint64_t deg;
+} f2_min_poly_t;
+
+static uint64_t cr8r_prng_splitmix_get_u64(void*);
+
+// Find the minimal polynomial of a generator with a state of len words, which should have degree deg,
+// from bit 0 of the states following some arbitrary state.  On failure, res->deg is left 0
+static void f2_find_min_poly(f2_min_poly_t *res, uint64_t len, uint64_t deg, void (*step)(uint64_t*)){
+	uint64_t words = 2*deg/64 + 1;
+	uint64_t *state = malloc(len*sizeof(uint64_t)), *seq = calloc(words, sizeof(uint64_t)), *poly = malloc(words*sizeof(uint64_t));
+	if(state && seq && poly){
+		uint64_t sm = CR8R_DEFAULT_PRNG_SM_SEED;
+		fill_u64s(&sm, len*sizeof(uint64_t), state, cr8r_prng_splitmix_get_u64);
+		for(uint64_t i = 0; i < 2*deg; ++i){
+			step(state);
+			seq[i/64] |= (state[0]&1) << (i%64);
+		}
+		if(f2_min_poly(seq, 2*deg, poly) == deg){
+			res->poly = poly;
+			res->deg = deg;
+			poly = NULL;
+		}
+	}
+	free(state);
+	free(seq);
+	free(poly);
+}
+
+// Jump an F2 linear generator forwards by n steps, given its minimal polynomial.
+// Returns 0 on allocation failure, in which case the state is not modified
+static bool f2_jump(uint64_t *state, uint64_t len, uint64_t n, const f2_min_poly_t *p, void (*step)(uint64_t*)){
+	uint64_t words = p->deg/64 + 1;
+	uint64_t *tmp = malloc((67*words + 64 + len)*sizeof(uint64_t));
+	if(!tmp){
+		return 0;
+	}
+	f2_xpow_mod(n, p->poly, p->deg, tmp, tmp + 3*words, tmp + words);
+	f2_apply(state, len, tmp, p->deg, step, tmp + words);
+	free(tmp);
+	return 1;
+}
+
+// Buffered generators must never hand the same bytes to a parent and child process, so a fork handler
+// bumps this in the child and each generator discards its buffer when it sees a generation it did not fill in.
+// Checking a global is much cheaper than calling getpid, which is a real syscall in current glibc.
+static uint64_t cr8r_prng_fork_generation = 0;
+static pthread_once_t cr8r_prng_fork_once = PTHREAD_ONCE_INIT;
+
+static void cr8r_prng_on_fork_child(){
+	++cr8r_prng_fork_generation;
+}
+
+static void cr8r_prng_register_fork_handler(){
+	pthread_atfork(NULL, NULL, cr8r_prng_on_fork_child);
+}
+
+static bool cr8r_prng_getrandom(void *buf, uint64_t size){
+	// getrandom can return fewer bytes than requested for requests over 256 bytes if interrupted by a signal
+	for(uint64_t i = 0; i < size;){
+		ssize_t n = getrandom(buf + i, size - i, 0);
+		if(n > 0){
+			i += n;
+		}else if(errno != EINTR){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+// Bytes are handed out from buf[index:] and erased as they are used, so they cannot be recovered from memory later
+typedef struct{
+	uint64_t fork_generation;
+	uint64_t index;
+	uint8_t buf[CR8R_PRNG_SYSTEM_BUF];
+} cr8r_prng_system_st;
+
+static void cr8r_prng_system_fill(void *_state, uint64_t size, void *buf){
+	cr8r_prng_system_st *state = _state;
+	if(state->fork_generation != cr8r_prng_fork_generation){
+		memset(state->buf, 0, sizeof(state->buf));
+		state->index = sizeof(state->buf);
+		state->fork_generation = cr8r_prng_fork_generation;
+	}
+	uint64_t avail = sizeof(state->buf) - state->index;
+	if(size > avail){
+		memcpy(buf, state->buf + state->index, avail);
+		memset(state->buf + state->index, 0, avail);
+		buf += avail;
+		size -= avail;
+		// requests at least as big as the buffer skip it, so they cost one syscall and no copy
+		if(size >= sizeof(state->buf)){
+			(void)!cr8r_prng_getrandom(buf, size);
+			state->index = sizeof(state->buf);
+			return;
+		}
+		(void)!cr8r_prng_getrandom(state->buf, sizeof(state->buf));
+		state->index = 0;
+	}
+	memcpy(buf, state->buf + state->index, size);
+	memset(state->buf + state->index, 0, size);
+	state->index += size;
+}
+
 static uint32_t cr8r_prng_system_get_u32(void *_state){
 	uint32_t res;
-	(void)!getrandom(&res, sizeof(uint32_t), 0);
+	cr8r_prng_system_fill(_state, sizeof(uint32_t), &res);
 	return res;
 }
 
+static uint64_t cr8r_prng_system_get_u64(void *_state){
+	uint64_t res;
+	cr8r_prng_system_fill(_state, sizeof(uint64_t), &res);
+	return res;
+}
+
+// seeding a system prng writes over its buffer, so empty it again before reporting failure
 static bool cr8r_prng_system_fixup(void *_state){
-	return 1;
+	cr8r_prng_system_st *state = _state;
+	memset(state->buf, 0, sizeof(state->buf));
+	state->index = sizeof(state->buf);
+	return 0;
 }
 
 cr8r_prng *cr8r_prng_init_system(){
-	cr8r_prng *res = malloc(offsetof(cr8r_prng, state));
+	uint8_t probe;
+	if(getrandom(&probe, 1, 0) != 1){
+		return NULL;
+	}
+	pthread_once(&cr8r_prng_fork_once, cr8r_prng_register_fork_handler);
+	cr8r_prng *res = malloc(offsetof(cr8r_prng, state) + sizeof(cr8r_prng_system_st));
 	if(res){
-		res->state_size = 0;
+		res->state_size = sizeof(cr8r_prng_system_st);
 		res->get_u32 = cr8r_prng_system_get_u32;
+		res->get_u64 = cr8r_prng_system_get_u64;
+		res->fill = cr8r_prng_system_fill;
+		res->jump = NULL;
 		res->fixup_state = cr8r_prng_system_fixup;
+		cr8r_prng_system_st *state = (cr8r_prng_system_st*)res->state;
+		state->fork_generation = cr8r_prng_fork_generation;
+		state->index = sizeof(state->buf);
+	}
+	return res;
+}
+
+// The ChaCha20 block function from RFC 8439.  QR works on scalars or vectors of uint32_t
+#define CHACHA_ROTL(x, k) (((x) << (k)) | ((x) >> (32 - (k))))
+#define CHACHA_QR(a, b, c, d) do{ \
+	a += b; d ^= a; d = CHACHA_ROTL(d, 16); \
+	c += d; b ^= c; b = CHACHA_ROTL(b, 12); \
+	a += b; d ^= a; d = CHACHA_ROTL(d, 8); \
+	c += d; b ^= c; b = CHACHA_ROTL(b, 7); \
+}while(0)
+#define CHACHA_DOUBLE_ROUND(x) do{ \
+	CHACHA_QR(x[0], x[4], x[8], x[12]); \
+	CHACHA_QR(x[1], x[5], x[9], x[13]); \
+	CHACHA_QR(x[2], x[6], x[10], x[14]); \
+	CHACHA_QR(x[3], x[7], x[11], x[15]); \
+	CHACHA_QR(x[0], x[5], x[10], x[15]); \
+	CHACHA_QR(x[1], x[6], x[11], x[12]); \
+	CHACHA_QR(x[2], x[7], x[8], x[13]); \
+	CHACHA_QR(x[3], x[4], x[9], x[14]); \
+}while(0)
+
+static void cr8r_prng_chacha_init_input(uint32_t in[static 16], const uint32_t key[static 8], uint32_t counter, const uint32_t nonce[static 3]){
+	// "expand 32-byte k"
+	in[0] = 0x61707865;
+	in[1] = 0x3320646e;
+	in[2] = 0x79622d32;
+	in[3] = 0x6b206574;
+	memcpy(in + 4, key, 8*sizeof(uint32_t));
+	in[12] = counter;
+	memcpy(in + 13, nonce, 3*sizeof(uint32_t));
+}
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static void cr8r_prng_chacha_block(const uint32_t in[static 16], void *out){
+	uint32_t x[16];
+	memcpy(x, in, sizeof(x));
+	for(uint64_t i = 0; i < 10; ++i){
+		CHACHA_DOUBLE_ROUND(x);
+	}
+	for(uint64_t i = 0; i < 16; ++i){
+		x[i] += in[i];
+	}
+	// depends on little endianness
+	memcpy(out, x, sizeof(x));
+}
+
+typedef uint32_t v8u32 __attribute__((vector_size(32)));
+
+// Compute 8 consecutive blocks at once, with block b in lane b of each vector
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+CR8R_ATTR_SIMD_CLONES static void cr8r_prng_chacha_blocks8(const uint32_t in[static 16], void *out){
+	v8u32 x[16], x0[16];
+	for(uint64_t i = 0; i < 16; ++i){
+		x0[i] = (v8u32){} + in[i];
+	}
+	x0[12] += (v8u32){0, 1, 2, 3, 4, 5, 6, 7};
+	memcpy(x, x0, sizeof(x));
+	for(uint64_t i = 0; i < 10; ++i){
+		CHACHA_DOUBLE_ROUND(x);
+	}
+	for(uint64_t i = 0; i < 16; ++i){
+		x[i] += x0[i];
+	}
+	for(uint64_t b = 0; b < 8; ++b){
+		for(uint64_t i = 0; i < 16; ++i){
+			uint32_t w = x[i][b];
+			memcpy(out + (16*b + i)*sizeof(uint32_t), &w, sizeof(uint32_t));
+		}
+	}
+}
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+void cr8r_prng_chacha20_blocks(const uint32_t key[static 8], uint32_t counter, const uint32_t nonce[static 3], uint64_t n, void *out){
+	uint32_t in[16];
+	cr8r_prng_chacha_init_input(in, key, counter, nonce);
+	uint64_t i = 0;
+	for(; i + 8 <= n; i += 8, in[12] += 8){
+		cr8r_prng_chacha_blocks8(in, out + 64*i);
+	}
+	for(; i < n; ++i, ++in[12]){
+		cr8r_prng_chacha_block(in, out + 64*i);
+	}
+}
+
+// Fast key erasure (https://blog.cr.yp.to/20170723-random.html): each refill generates CR8R_PRNG_CHACHA_BLOCKS blocks,
+// immediately replaces the key with the first 32 bytes, and hands out the rest, erasing bytes as they are used.
+// So the state never contains anything that could be used to recover earlier outputs.
+typedef struct{
+	uint32_t key[8];
+	uint64_t fork_generation;
+	uint64_t index;
+	uint8_t buf[64*CR8R_PRNG_CHACHA_BLOCKS];
+} cr8r_prng_chacha_st;
+
+static void cr8r_prng_chacha_refill(cr8r_prng_chacha_st *state){
+	static const uint32_t nonce[3] = {};
+	cr8r_prng_chacha20_blocks(state->key, 0, nonce, CR8R_PRNG_CHACHA_BLOCKS, state->buf);
+	memcpy(state->key, state->buf, sizeof(state->key));
+	memset(state->buf, 0, sizeof(state->key));
+	state->index = sizeof(state->key);
+}
+
+static void cr8r_prng_chacha_fill(void *_state, uint64_t size, void *buf){
+	cr8r_prng_chacha_st *state = _state;
+	if(state->fork_generation != cr8r_prng_fork_generation){
+		// the child has the same key as the parent, so mix in fresh system randomness before generating anything
+		uint32_t fresh[8] = {};
+		(void)!cr8r_prng_getrandom(fresh, sizeof(fresh));
+		for(uint64_t i = 0; i < 8; ++i){
+			state->key[i] ^= fresh[i];
+		}
+		memset(fresh, 0, sizeof(fresh));
+		memset(state->buf, 0, sizeof(state->buf));
+		state->index = sizeof(state->buf);
+		state->fork_generation = cr8r_prng_fork_generation;
+	}
+	while(size){
+		if(state->index == sizeof(state->buf)){
+			cr8r_prng_chacha_refill(state);
+		}
+		uint64_t n = sizeof(state->buf) - state->index;
+		if(n > size){
+			n = size;
+		}
+		memcpy(buf, state->buf + state->index, n);
+		memset(state->buf + state->index, 0, n);
+		state->index += n;
+		buf += n;
+		size -= n;
+	}
+}
+
+static uint32_t cr8r_prng_chacha_get_u32(void *_state){
+	uint32_t res;
+	cr8r_prng_chacha_fill(_state, sizeof(uint32_t), &res);
+	return res;
+}
+
+static uint64_t cr8r_prng_chacha_get_u64(void *_state){
+	uint64_t res;
+	cr8r_prng_chacha_fill(_state, sizeof(uint64_t), &res);
+	return res;
+}
+
+static bool cr8r_prng_chacha_fixup(void *_state){
+	cr8r_prng_chacha_st *state = _state;
+	memset(state->buf, 0, sizeof(state->buf));
+	state->index = sizeof(state->buf);
+	state->fork_generation = cr8r_prng_fork_generation;
+	return 1;
+}
+
+cr8r_prng *cr8r_prng_init_chacha(){
+	pthread_once(&cr8r_prng_fork_once, cr8r_prng_register_fork_handler);
+	cr8r_prng *res = malloc(offsetof(cr8r_prng, state) + sizeof(cr8r_prng_chacha_st));
+	if(res){
+		res->state_size = sizeof(cr8r_prng_chacha_st);
+		res->get_u32 = cr8r_prng_chacha_get_u32;
+		res->get_u64 = cr8r_prng_chacha_get_u64;
+		res->fill = cr8r_prng_chacha_fill;
+		res->jump = NULL;
+		res->fixup_state = cr8r_prng_chacha_fixup;
+		cr8r_prng_chacha_st *state = (cr8r_prng_chacha_st*)res->state;
+		if(!cr8r_prng_getrandom(state->key, sizeof(state->key))){
+			free(res);
+			return NULL;
+		}
+		cr8r_prng_chacha_fixup(state);
 	}
 	return res;
 }
@@ -153,6 +668,29 @@ static uint32_t cr8r_prng_lcg_get_u32(void *_state){
 	return *state >> 32;
 }
 
+static void cr8r_prng_lcg_fill(void *_state, uint64_t size, void *buf){
+	uint64_t state = *(uint64_t*)_state;
+	fill_u32s(&state, size, buf, cr8r_prng_lcg_get_u32);
+	*(uint64_t*)_state = state;
+}
+
+// x -> a*x + c composed with itself n times is another affine map, which can be found by repeated squaring
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static bool cr8r_prng_lcg_jump(void *_state, uint64_t n){
+	uint64_t a = 6364136223846793005, c = 1;
+	uint64_t an = 1, cn = 0;
+	for(; n; n >>= 1){
+		if(n&1){
+			an *= a;
+			cn = cn*a + c;
+		}
+		c = c*a + c;
+		a *= a;
+	}
+	*(uint64_t*)_state = an*(*(uint64_t*)_state) + cn;
+	return 1;
+}
+
 static bool cr8r_prng_lcg_fixup(void *_state){
 	uint64_t *state = _state;
 	if(!*state){
@@ -166,6 +704,9 @@ cr8r_prng *cr8r_prng_init_lcg(uint64_t seed){
 	if(res){
 		res->state_size = sizeof(uint64_t);
 		res->get_u32 = cr8r_prng_lcg_get_u32;
+		res->get_u64 = NULL;
+		res->fill = cr8r_prng_lcg_fill;
+		res->jump = cr8r_prng_lcg_jump;
 		res->fixup_state = cr8r_prng_lcg_fixup;
 		if(!cr8r_prng_seed(res, seed)){
 			free(res);
@@ -189,6 +730,195 @@ static uint32_t cr8r_prng_lfg_sc_get_u32(void *_state){
 	return x0 >> 16;
 }
 
+static void cr8r_prng_lfg_sc_fill(void *_state, uint64_t size, void *buf){
+	fill_u32s(_state, size, buf, cr8r_prng_lfg_sc_get_u32);
+}
+
+// The subtract with borrow generator x_n = x_(n-5) - x_(n-12) - c mod b = 2**48 is equivalent to an lcg with modulus
+// m = b**12 - b**5 + 1 (Marsaglia and Zaman, "A New Class of Random Number Generators").  A state corresponds to the
+// Z in [0, m) such that the base b digits of Z/m are x_n, x_(n-1), x_(n-2), ..., and a step takes Z to Z/b mod m.
+// So jumping is modular exponentiation, on 576 bit numbers stored as little endian arrays of words.
+// D is the number whose base b digits are the window x_n, ..., x_(n-11), which is Z*b**12/m rounded down,
+// and going the other way Z = D - Q(D) where Q(D) = D*(2**240 - 1)/2**576 rounded down
+#define SWB_WORDS 20
+#define SWB_DIRECT_STEPS 64
+
+static void swb_shl(uint64_t *res, const uint64_t *a, uint64_t bits){
+	uint64_t w = bits/64, b = bits%64;
+	for(uint64_t i = SWB_WORDS; i--;){
+		uint64_t lo = i >= w ? a[i - w] : 0;
+		uint64_t lo2 = i >= w + 1 ? a[i - w - 1] : 0;
+		res[i] = b ? (lo << b) | (lo2 >> (64 - b)) : lo;
+	}
+}
+
+static void swb_shr(uint64_t *res, const uint64_t *a, uint64_t bits){
+	uint64_t w = bits/64, b = bits%64;
+	for(uint64_t i = 0; i < SWB_WORDS; ++i){
+		uint64_t hi = i + w < SWB_WORDS ? a[i + w] : 0;
+		uint64_t hi2 = i + w + 1 < SWB_WORDS ? a[i + w + 1] : 0;
+		res[i] = b ? (hi >> b) | (hi2 << (64 - b)) : hi;
+	}
+}
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static void swb_add(uint64_t *a, const uint64_t *b){
+	uint64_t carry = 0;
+	for(uint64_t i = 0; i < SWB_WORDS; ++i){
+		carry = __builtin_add_overflow(a[i], carry, a + i) + __builtin_add_overflow(a[i], b[i], a + i);
+	}
+}
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static void swb_sub(uint64_t *a, const uint64_t *b){
+	uint64_t borrow = 0;
+	for(uint64_t i = 0; i < SWB_WORDS; ++i){
+		borrow = __builtin_sub_overflow(a[i], borrow, a + i) + __builtin_sub_overflow(a[i], b[i], a + i);
+	}
+}
+
+static int swb_cmp(const uint64_t *a, const uint64_t *b){
+	for(uint64_t i = SWB_WORDS; i--;){
+		if(a[i] != b[i]){
+			return a[i] < b[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+static void swb_m(uint64_t *m){
+	memset(m, 0, SWB_WORDS*sizeof(uint64_t));
+	m[0] = 1;
+	m[3] = 0xFFFF000000000000ull;
+	for(uint64_t i = 4; i < 9; ++i){
+		m[i] = ~0ull;
+	}
+}
+
+// a = a*b mod m, for a and b below 2**576.  Uses 2**576 = 2**240 - 1 mod m to fold the high words back down
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow", "implicit-unsigned-integer-truncation")
+static void swb_mulmod(uint64_t *a, const uint64_t *b){
+	uint64_t v[SWB_WORDS] = {}, h[SWB_WORDS], t[SWB_WORDS], m[SWB_WORDS];
+	for(uint64_t i = 0; i < 9; ++i){
+		uint64_t carry = 0;
+		for(uint64_t j = 0; j < 9; ++j){
+			unsigned __int128 p = (unsigned __int128)a[i]*b[j] + v[i + j] + carry;
+			v[i + j] = p;
+			carry = p >> 64;
+		}
+		v[i + 9] = carry;
+	}
+	while(v[9] || v[10] || v[11] || v[12] || v[13] || v[14] || v[15] || v[16] || v[17]){
+		swb_shr(h, v, 576);
+		memset(v + 9, 0, (SWB_WORDS - 9)*sizeof(uint64_t));
+		swb_shl(t, h, 240);
+		swb_add(v, t);
+		swb_sub(v, h);
+	}
+	swb_m(m);
+	while(swb_cmp(v, m) >= 0){
+		swb_sub(v, m);
+	}
+	memcpy(a, v, SWB_WORDS*sizeof(uint64_t));
+}
+
+// res = Q(d) = d*(2**240 - 1)/2**576 rounded down
+static void swb_q(uint64_t *res, const uint64_t *d){
+	uint64_t t[SWB_WORDS];
+	swb_shl(t, d, 240);
+	swb_sub(t, d);
+	swb_shr(res, t, 576);
+}
+
+// Read the window of a state as D, and check that the state is the one corresponding to Z = D - Q(D).
+// Not every state is: a state is only determined by the window when its carry is (first 5 digits of D) - Q(D),
+// and the windows of two consecutive values of D can have the same Z, in which case only the larger one is valid
+static bool swb_read(const void *_state, uint64_t *d, uint64_t *z){
+	uint64_t q[SWB_WORDS], t[SWB_WORDS], one[SWB_WORDS] = {1};
+	memset(d, 0, SWB_WORDS*sizeof(uint64_t));
+	for(uint64_t j = 0; j < 12; ++j){
+		// depends on little endianness
+		memcpy((void*)d + 6*(11 - j), _state + 6*j, 6);
+	}
+	swb_q(q, d);
+	memcpy(z, d, SWB_WORDS*sizeof(uint64_t));
+	swb_sub(z, q);
+	swb_shr(t, d, 336);
+	swb_sub(t, q);
+	if(t[0] != ((const uint8_t*)_state)[6*12] || t[0] > 1){
+		return 0;
+	}
+	for(uint64_t i = 1; i < SWB_WORDS; ++i){
+		if(t[i]){
+			return 0;
+		}
+	}
+	memcpy(t, d, SWB_WORDS*sizeof(uint64_t));
+	swb_add(t, one);
+	swb_q(q, t);
+	swb_sub(t, q);
+	return swb_cmp(t, z) != 0;
+}
+
+// Write the state corresponding to z, which is the window for the largest D with D - Q(D) = z
+static void swb_write(void *_state, const uint64_t *z){
+	uint64_t d[SWB_WORDS], q[SWB_WORDS], t[SWB_WORDS], one[SWB_WORDS] = {1};
+	memcpy(d, z, SWB_WORDS*sizeof(uint64_t));
+	// D = z + Q(D) is found by iterating from D = z, and only takes a couple of iterations since Q(D) is about D/2**336
+	while(1){
+		swb_q(q, d);
+		memcpy(t, z, SWB_WORDS*sizeof(uint64_t));
+		swb_add(t, q);
+		if(!swb_cmp(t, d)){
+			break;
+		}
+		memcpy(d, t, SWB_WORDS*sizeof(uint64_t));
+	}
+	memcpy(t, d, SWB_WORDS*sizeof(uint64_t));
+	swb_add(t, one);
+	swb_q(q, t);
+	swb_sub(t, q);
+	if(!swb_cmp(t, z)){
+		swb_add(d, one);
+	}
+	for(uint64_t j = 0; j < 12; ++j){
+		memcpy(_state + 6*j, (void*)d + 6*(11 - j), 6);
+	}
+	swb_q(q, d);
+	swb_shr(t, d, 336);
+	swb_sub(t, q);
+	((uint8_t*)_state)[6*12] = t[0];
+}
+
+static bool cr8r_prng_lfg_sc_jump(void *_state, uint64_t n){
+	uint64_t d[SWB_WORDS], z[SWB_WORDS], p[SWB_WORDS], bi[SWB_WORDS] = {};
+	// states which do not correspond to any Z (including some seeded ones) join the cycle after a few steps
+	while(n && (n < SWB_DIRECT_STEPS || !swb_read(_state, d, z))){
+		cr8r_prng_lfg_sc_get_u32(_state);
+		--n;
+	}
+	if(!n){
+		return 1;
+	}
+	// p = (1/b)**n, where 1/b = b**4 - b**11 mod m
+	swb_m(bi);
+	memset(p, 0, sizeof(p));
+	p[0] = 1;
+	swb_shl(d, p, 192);
+	swb_add(bi, d);
+	swb_shl(d, p, 528);
+	swb_sub(bi, d);
+	for(uint64_t bit = 64 - __builtin_clzll(n); bit--;){
+		swb_mulmod(p, p);
+		if((n >> bit)&1){
+			swb_mulmod(p, bi);
+		}
+	}
+	swb_mulmod(z, p);
+	swb_write(_state, z);
+	return 1;
+}
+
 static bool cr8r_prng_lfg_sc_fixup(void *_state){
 	char *state = _state;
 	for(uint64_t i = 0; i < 12; i += 6){
@@ -207,7 +937,10 @@ cr8r_prng *cr8r_prng_init_lfg_sc(uint64_t seed){
 	cr8r_prng *res = malloc(offsetof(cr8r_prng, state) + 6*12 + 1);
 	if(res){
 		res->state_size = 6*12 + 1;
-		res->get_u32 = cr8r_prng_lfg_sc_get_u32,
+		res->get_u32 = cr8r_prng_lfg_sc_get_u32;
+		res->get_u64 = NULL;
+		res->fill = cr8r_prng_lfg_sc_fill;
+		res->jump = cr8r_prng_lfg_sc_jump;
 		res->fixup_state = cr8r_prng_lfg_sc_fixup;
 		if(!cr8r_prng_seed(res, seed)){
 			free(res);
@@ -231,6 +964,84 @@ static uint32_t cr8r_prng_lfg_m_get_u32(void *_state){
 	return state->XS[next_index] >> 16;
 }
 
+static void cr8r_prng_lfg_m_fill(void *_state, uint64_t size, void *buf){
+	fill_u32s(_state, size, buf, cr8r_prng_lfg_m_get_u32);
+}
+
+// Jumping by fewer steps than this just steps directly
+#define CR8R_PRNG_LFM_DIRECT_STEPS 16384
+
+// res = a*b mod t**r - t**(r-s) - 1, the characteristic polynomial of a_i = a_(i-s) + a_(i-r)
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static void cr8r_prng_lfg_m_mulmod(const uint64_t *a, const uint64_t *b, uint64_t *res){
+	uint64_t tmp[2*CR8R_PRNG_LFM_R - 1] = {};
+	for(uint64_t i = 0; i < CR8R_PRNG_LFM_R; ++i){
+		for(uint64_t j = 0; j < CR8R_PRNG_LFM_R; ++j){
+			tmp[i + j] += a[i]*b[j];
+		}
+	}
+	// t**i = t**(i-s) + t**(i-r)
+	for(uint64_t i = 2*CR8R_PRNG_LFM_R - 1; i-- > CR8R_PRNG_LFM_R;){
+		tmp[i - CR8R_PRNG_LFM_S] += tmp[i];
+		tmp[i - CR8R_PRNG_LFM_R] += tmp[i];
+	}
+	memcpy(res, tmp, CR8R_PRNG_LFM_R*sizeof(uint64_t));
+}
+
+// res = t*res mod t**r - t**(r-s) - 1
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static void cr8r_prng_lfg_m_mulmod_t(uint64_t *res){
+	uint64_t top = res[CR8R_PRNG_LFM_R - 1];
+	memmove(res + 1, res, (CR8R_PRNG_LFM_R - 1)*sizeof(uint64_t));
+	res[0] = top;
+	res[CR8R_PRNG_LFM_R - CR8R_PRNG_LFM_S] += top;
+}
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static uint64_t cr8r_prng_lfg_m_pow(uint64_t b, uint64_t e){
+	uint64_t res = 1;
+	for(; e; e >>= 1, b *= b){
+		if(e&1){
+			res *= b;
+		}
+	}
+	return res;
+}
+
+// The exponents of x_i in any decomposition of the odd numbers mod 2**64 (see cr8r_prng_log_mod_t64) satisfy
+// a_i = a_(i-s) + a_(i-r), so if t**n = sum(q_j*t**j) mod the characteristic polynomial, x_(i+n) = prod(x_(i+j)**q_j).
+// Every odd number has order dividing 2**62, so the q_j can be computed mod 2**64 and we never need the logarithms themselves.
+// The window is x_m, ..., x_(m+r-1), where x_(m+r-1) = XS[index] is the newest
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static bool cr8r_prng_lfg_m_jump(void *_state, uint64_t n){
+	cr8r_prng_lfg_m_state *state = _state;
+	if(n < CR8R_PRNG_LFM_DIRECT_STEPS){
+		while(n--){
+			cr8r_prng_lfg_m_get_u32(state);
+		}
+		return 1;
+	}
+	uint64_t q[CR8R_PRNG_LFM_R] = {1}, t[CR8R_PRNG_LFM_R] = {0, 1}, xs[CR8R_PRNG_LFM_R];
+	for(uint64_t bit = 64 - __builtin_clzll(n); bit--;){
+		cr8r_prng_lfg_m_mulmod(q, q, q);
+		if((n >> bit)&1){
+			cr8r_prng_lfg_m_mulmod(q, t, q);
+		}
+	}
+	for(uint64_t j = 0; j < CR8R_PRNG_LFM_R; ++j){
+		xs[j] = state->XS[(state->index + CR8R_PRNG_LFM_R - 1 - j)%CR8R_PRNG_LFM_R];
+	}
+	for(uint64_t k = 0; k < CR8R_PRNG_LFM_R; ++k){
+		uint64_t x = 1;
+		for(uint64_t j = 0; j < CR8R_PRNG_LFM_R; ++j){
+			x *= cr8r_prng_lfg_m_pow(xs[j], q[j]);
+		}
+		state->XS[(state->index + CR8R_PRNG_LFM_R - 1 - k)%CR8R_PRNG_LFM_R] = x;
+		cr8r_prng_lfg_m_mulmod_t(q);
+	}
+	return 1;
+}
+
 static bool cr8r_prng_lfg_m_fixup(void *_state){
 	cr8r_prng_lfg_m_state *state = _state;
 	for(uint64_t i = 0; i < CR8R_PRNG_LFM_R; ++i){
@@ -245,6 +1056,9 @@ cr8r_prng *cr8r_prng_init_lfg_m(uint64_t seed){
 	if(res){
 		res->state_size = sizeof(cr8r_prng_lfg_m_state);
 		res->get_u32 = cr8r_prng_lfg_m_get_u32;
+		res->get_u64 = NULL;
+		res->fill = cr8r_prng_lfg_m_fill;
+		res->jump = cr8r_prng_lfg_m_jump;
 		res->fixup_state = cr8r_prng_lfg_m_fixup;
 		if(!cr8r_prng_seed(res, seed)){
 			free(res);
@@ -293,39 +1107,124 @@ static bool cr8r_prng_mt_fixup(void *_state){
 	return 1;
 }
 
+static void cr8r_prng_mt_twist(cr8r_prng_mt_st *state){
+	for(uint64_t i = 0; i < CR8R_PRNG_MT_N; ++i){
+		uint64_t x = (state->MT[i]&cr8r_prng_mt_himask)
+			| (state->MT[(i+1)%CR8R_PRNG_MT_N]&cr8r_prng_mt_lomask);
+		uint64_t xA = x >> 1;
+		if(x&1){
+			xA ^= CR8R_PRNG_MT_A;
+		}
+		state->MT[i] = state->MT[(i + CR8R_PRNG_MT_M)%CR8R_PRNG_MT_N]^xA;
+	}
+	state->index = 0;
+}
+
+// Advance a window of the underlying recurrence by one word, where twist advances it by CR8R_PRNG_MT_N words in place
+static void cr8r_prng_mt_step(uint64_t *s){
+	uint64_t x = (s[0]&cr8r_prng_mt_himask) | (s[1]&cr8r_prng_mt_lomask);
+	uint64_t xA = x >> 1;
+	if(x&1){
+		xA ^= CR8R_PRNG_MT_A;
+	}
+	x = s[CR8R_PRNG_MT_M]^xA;
+	memmove(s, s + 1, (CR8R_PRNG_MT_N - 1)*sizeof(uint64_t));
+	s[CR8R_PRNG_MT_N - 1] = x;
+}
+
+// Jumping by fewer twists than this just twists directly, since finding x**n mod the minimal polynomial
+// takes about as long as that many twists
+#define CR8R_PRNG_MT_DIRECT_TWISTS 65536
+
+static pthread_once_t cr8r_prng_mt_poly_once = PTHREAD_ONCE_INIT;
+static f2_min_poly_t cr8r_prng_mt_poly;
+
+static void cr8r_prng_mt_find_poly(){
+	f2_find_min_poly(&cr8r_prng_mt_poly, CR8R_PRNG_MT_N, 64*CR8R_PRNG_MT_N - CR8R_PRNG_MT_R, cr8r_prng_mt_step);
+}
+
+static bool cr8r_prng_mt_jump(void *_state, uint64_t n){
+	cr8r_prng_mt_st *state = _state;
+	// after seeding, index is garbage past the end of MT, which means the same as being at the end
+	uint64_t index = state->index < 2*CR8R_PRNG_MT_N ? state->index : 2*CR8R_PRNG_MT_N;
+	// n counts 32 bit halves like index
+	uint64_t twists = (uint64_t)(((unsigned __int128)index + n)/(2*CR8R_PRNG_MT_N));
+	index = (uint64_t)(((unsigned __int128)index + n)%(2*CR8R_PRNG_MT_N));
+	if(twists < CR8R_PRNG_MT_DIRECT_TWISTS){
+		while(twists--){
+			cr8r_prng_mt_twist(state);
+		}
+	}else{
+		pthread_once(&cr8r_prng_mt_poly_once, cr8r_prng_mt_find_poly);
+		if(!cr8r_prng_mt_poly.deg){
+			return 0;
+		}
+		// the low bits of MT[0] never affect later words, so only states after at least one step are annihilated
+		// by the minimal polynomial
+		uint64_t s[CR8R_PRNG_MT_N];
+		memcpy(s, state->MT, sizeof(s));
+		cr8r_prng_mt_step(s);
+		if(!f2_jump(s, CR8R_PRNG_MT_N, twists*CR8R_PRNG_MT_N - 1, &cr8r_prng_mt_poly, cr8r_prng_mt_step)){
+			return 0;
+		}
+		memcpy(state->MT, s, sizeof(s));
+	}
+	state->index = index;
+	return 1;
+}
+
+static inline uint64_t cr8r_prng_mt_temper(uint64_t y){
+	y ^= (y >> CR8R_PRNG_MT_U)&CR8R_PRNG_MT_D;
+	y ^= (y << CR8R_PRNG_MT_S)&CR8R_PRNG_MT_B;
+	y ^= (y << CR8R_PRNG_MT_T)&CR8R_PRNG_MT_C;
+	return y ^ (y >> CR8R_PRNG_MT_L);
+}
+
 CR8R_ATTR_NO_SAN("unsigned-integer-overflow", "implicit-unsigned-integer-truncation")
 static uint32_t cr8r_prng_mt_get_u32(void *_state){
 	cr8r_prng_mt_st *state = _state;
 	if(state->index >= 2*CR8R_PRNG_MT_N){
-		for(uint64_t i = 0; i < CR8R_PRNG_MT_N; ++i){
-			uint64_t x = (state->MT[i]&cr8r_prng_mt_himask)
-				| (state->MT[(i+1)%CR8R_PRNG_MT_N]&cr8r_prng_mt_lomask);
-			uint64_t xA = x >> 1;
-			if(x&1){
-				xA ^= CR8R_PRNG_MT_A;
-			}
-			state->MT[i] = state->MT[(i + CR8R_PRNG_MT_M)%CR8R_PRNG_MT_N]^xA;
-		}
-		state->index = 0;
+		cr8r_prng_mt_twist(state);
 	}
 	// we split each 64 bit output into 2 32 bit outputs,
 	// but both are computed from the state which is a little redundant
-	uint64_t y = state->MT[state->index >> 1];
-	y ^= (y >> CR8R_PRNG_MT_U)&CR8R_PRNG_MT_D;
-	y ^= (y << CR8R_PRNG_MT_S)&CR8R_PRNG_MT_B;
-	y ^= (y << CR8R_PRNG_MT_T)&CR8R_PRNG_MT_C;
-	y ^= (y >> CR8R_PRNG_MT_L);
+	uint64_t y = cr8r_prng_mt_temper(state->MT[state->index >> 1]);
 	if(state->index++&1){
 		return y >> 32;
 	}
 	return y;
 }
 
+// index counts 32 bit halves, so a 64 bit output is a whole tempered word unless
+// an odd number of 32 bit outputs have been taken, in which case it has to be stitched from two words
+// to stay consistent with get_u32
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow", "implicit-unsigned-integer-truncation")
+static uint64_t cr8r_prng_mt_get_u64(void *_state){
+	cr8r_prng_mt_st *state = _state;
+	if(state->index&1){
+		uint64_t res = cr8r_prng_mt_get_u32(state);
+		return res | ((uint64_t)cr8r_prng_mt_get_u32(state) << 32);
+	}
+	if(state->index >= 2*CR8R_PRNG_MT_N){
+		cr8r_prng_mt_twist(state);
+	}
+	uint64_t y = cr8r_prng_mt_temper(state->MT[state->index >> 1]);
+	state->index += 2;
+	return y;
+}
+
+static void cr8r_prng_mt_fill(void *_state, uint64_t size, void *buf){
+	fill_u64s(_state, size, buf, cr8r_prng_mt_get_u64);
+}
+
 cr8r_prng *cr8r_prng_init_mt(uint64_t seed){
 	cr8r_prng *res = malloc(offsetof(cr8r_prng, state) + sizeof(cr8r_prng_mt_st));
 	if(res){
 		res->state_size = sizeof(cr8r_prng_mt_st);
-		res->get_u32 = cr8r_prng_mt_get_u32,
+		res->get_u32 = cr8r_prng_mt_get_u32;
+		res->get_u64 = cr8r_prng_mt_get_u64;
+		res->fill = cr8r_prng_mt_fill;
+		res->jump = cr8r_prng_mt_jump;
 		res->fixup_state = cr8r_prng_mt_fixup;
 		if(!cr8r_prng_seed(res, seed)){
 			free(res);
@@ -367,7 +1266,7 @@ static inline uint64_t rotl(uint64_t x, uint64_t k){
 }
 
 CR8R_ATTR_NO_SAN("unsigned-integer-overflow", "implicit-unsigned-integer-truncation")
-static uint32_t cr8r_prng_xoro_get_u32(void *_state){
+static uint64_t cr8r_prng_xoro_get_u64(void *_state){
 	uint64_t *s = _state;
 	uint64_t res = rotl(s[1]*5, 7)*9;
 	uint64_t t = s[1] << 17;
@@ -377,12 +1276,23 @@ static uint32_t cr8r_prng_xoro_get_u32(void *_state){
 	s[0] ^= s[3];
 	s[2] ^= t;
 	s[3] = rotl(s[3], 45);
-	return res >> 16;
+	return res;
 }
 
-void cr8r_prng_xoro_jump_t128(cr8r_prng *self){
-	uint64_t *s = (uint64_t*)self->state;
-	static const uint64_t JUMP[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+CR8R_ATTR_NO_SAN("implicit-unsigned-integer-truncation")
+static uint32_t cr8r_prng_xoro_get_u32(void *_state){
+	return cr8r_prng_xoro_get_u64(_state) >> 16;
+}
+
+static void cr8r_prng_xoro_fill(void *_state, uint64_t size, void *buf){
+	// copy the state so the compiler can keep it in registers instead of assuming buf may alias it
+	uint64_t s[4];
+	memcpy(s, _state, sizeof(s));
+	fill_u64s(s, size, buf, cr8r_prng_xoro_get_u64);
+	memcpy(_state, s, sizeof(s));
+}
+
+static void cr8r_prng_xoro_jump(uint64_t *s, const uint64_t JUMP[static 4]){
 	uint64_t s0 = 0;
 	uint64_t s1 = 0;
 	uint64_t s2 = 0;
@@ -395,7 +1305,7 @@ void cr8r_prng_xoro_jump_t128(cr8r_prng *self){
 				s2 ^= s[2];
 				s3 ^= s[3];
 			}
-			cr8r_prng_xoro_get_u32(self->state);
+			cr8r_prng_xoro_get_u64(s);
 		}
 	}
 	s[0] = s0;
@@ -404,28 +1314,41 @@ void cr8r_prng_xoro_jump_t128(cr8r_prng *self){
 	s[3] = s3;
 }
 
-void cr8r_prng_xoro_jump_t192(cr8r_prng *self){
-	uint64_t *s = (uint64_t*)self->state;
-	static const uint64_t LONG_JUMP[] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
-	uint64_t s0 = 0;
-	uint64_t s1 = 0;
-	uint64_t s2 = 0;
-	uint64_t s3 = 0;
-	for(uint64_t i = 0; i < 4; ++i){
-		for(uint64_t b = 0; b < 64; ++b){
-			if(LONG_JUMP[i]&(1ull << b)){
-				s0 ^= s[0];
-				s1 ^= s[1];
-				s2 ^= s[2];
-				s3 ^= s[3];
-			}
-			cr8r_prng_xoro_get_u32(self->state);
+static void cr8r_prng_xoro_step(uint64_t *s){
+	cr8r_prng_xoro_get_u64(s);
+}
+
+// Jumping by fewer steps than this just steps directly
+#define CR8R_PRNG_XORO_DIRECT_STEPS 4096
+
+static pthread_once_t cr8r_prng_xoro_poly_once = PTHREAD_ONCE_INIT;
+static f2_min_poly_t cr8r_prng_xoro_poly;
+
+static void cr8r_prng_xoro_find_poly(){
+	f2_find_min_poly(&cr8r_prng_xoro_poly, 4, 256, cr8r_prng_xoro_step);
+}
+
+// Jump xoroshiro256** forwards by n steps, which unlike the fixed jumps needs x**n mod its minimal polynomial
+static bool cr8r_prng_xoro_jump_n(void *_state, uint64_t n){
+	if(n < CR8R_PRNG_XORO_DIRECT_STEPS){
+		while(n--){
+			cr8r_prng_xoro_step(_state);
 		}
+		return 1;
 	}
-	s[0] = s0;
-	s[1] = s1;
-	s[2] = s2;
-	s[3] = s3;
+	pthread_once(&cr8r_prng_xoro_poly_once, cr8r_prng_xoro_find_poly);
+	return cr8r_prng_xoro_poly.deg && f2_jump(_state, 4, n, &cr8r_prng_xoro_poly, cr8r_prng_xoro_step);
+}
+
+static const uint64_t cr8r_prng_xoro_jump_t128_poly[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+
+void cr8r_prng_xoro_jump_t128(cr8r_prng *self){
+	cr8r_prng_xoro_jump((uint64_t*)self->state, cr8r_prng_xoro_jump_t128_poly);
+}
+
+void cr8r_prng_xoro_jump_t192(cr8r_prng *self){
+	static const uint64_t LONG_JUMP[] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
+	cr8r_prng_xoro_jump((uint64_t*)self->state, LONG_JUMP);
 }
 
 static bool cr8r_prng_xoro_fixup(void *_state){
@@ -436,7 +1359,10 @@ cr8r_prng *cr8r_prng_init_xoro(uint64_t seed){
 	cr8r_prng *res = malloc(offsetof(cr8r_prng, state) + 4*sizeof(uint64_t));
 	if(res){
 		res->state_size = 4*sizeof(uint64_t);
-		res->get_u32 = cr8r_prng_xoro_get_u32,
+		res->get_u32 = cr8r_prng_xoro_get_u32;
+		res->get_u64 = cr8r_prng_xoro_get_u64;
+		res->fill = cr8r_prng_xoro_fill;
+		res->jump = cr8r_prng_xoro_jump_n;
 		res->fixup_state = cr8r_prng_xoro_fixup;
 		if(!cr8r_prng_seed(res, seed)){
 			free(res);
@@ -446,6 +1372,404 @@ cr8r_prng *cr8r_prng_init_xoro(uint64_t seed){
 	return res;
 }
 
+// Multi lane xoroshiro256**: the same algorithm as above applied to CR8R_PRNG_XORO_LANES states at once.
+// The states are stored transposed, so that s[j] holds word j of every lane and is one vector.
+// Generated steps go straight into the output buffer when filling, and single outputs come from out,
+// which holds the last step generated, so all of the output functions read from one consistent stream of bytes.
+typedef struct{
+	uint64_t s[4][CR8R_PRNG_XORO_LANES];
+	uint64_t out[CR8R_PRNG_XORO_LANES];
+	// number of bytes of out which have already been used
+	uint64_t index;
+} cr8r_prng_xoro_lanes_st;
+
+// 256 bit vectors are the widest that gcc lowers well for avx2, so the lanes are advanced as independent groups of 4,
+// which also gives the cpu several dependency chains to overlap
+typedef uint64_t v4u64 __attribute__((vector_size(32)));
+#define XORO_LANE_GROUPS (CR8R_PRNG_XORO_LANES/4)
+
+// Advance all lanes steps times, writing steps*CR8R_PRNG_XORO_LANES outputs to buf.
+// The multiplications by 5 and 9 are written as shifts and adds since avx2 has no 64 bit vector multiply
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+CR8R_ATTR_SIMD_CLONES static void cr8r_prng_xoro_lanes_steps(uint64_t (*s)[CR8R_PRNG_XORO_LANES], uint64_t steps, void *buf){
+	v4u64 s0[XORO_LANE_GROUPS], s1[XORO_LANE_GROUPS], s2[XORO_LANE_GROUPS], s3[XORO_LANE_GROUPS];
+	memcpy(s0, s[0], sizeof(s0));
+	memcpy(s1, s[1], sizeof(s1));
+	memcpy(s2, s[2], sizeof(s2));
+	memcpy(s3, s[3], sizeof(s3));
+	for(uint64_t i = 0; i < steps; ++i){
+		for(uint64_t g = 0; g < XORO_LANE_GROUPS; ++g){
+			v4u64 x = s1[g] + (s1[g] << 2);
+			x = (x << 7) | (x >> 57);
+			x += x << 3;
+			memcpy(buf + (i*XORO_LANE_GROUPS + g)*sizeof(v4u64), &x, sizeof(v4u64));
+			v4u64 t = s1[g] << 17;
+			s2[g] ^= s0[g];
+			s3[g] ^= s1[g];
+			s1[g] ^= s2[g];
+			s0[g] ^= s3[g];
+			s2[g] ^= t;
+			s3[g] = (s3[g] << 45) | (s3[g] >> 19);
+		}
+	}
+	memcpy(s[0], s0, sizeof(s0));
+	memcpy(s[1], s1, sizeof(s1));
+	memcpy(s[2], s2, sizeof(s2));
+	memcpy(s[3], s3, sizeof(s3));
+}
+
+static void cr8r_prng_xoro_lanes_fill(void *_state, uint64_t size, void *buf){
+	cr8r_prng_xoro_lanes_st *state = _state;
+	uint64_t avail = sizeof(state->out) - state->index;
+	if(size <= avail){
+		memcpy(buf, (void*)state->out + state->index, size);
+		state->index += size;
+		return;
+	}
+	memcpy(buf, (void*)state->out + state->index, avail);
+	buf += avail;
+	size -= avail;
+	uint64_t steps = size/sizeof(state->out);
+	cr8r_prng_xoro_lanes_steps(state->s, steps, buf);
+	buf += steps*sizeof(state->out);
+	size -= steps*sizeof(state->out);
+	cr8r_prng_xoro_lanes_steps(state->s, 1, state->out);
+	memcpy(buf, state->out, size);
+	state->index = size;
+}
+
+static uint64_t cr8r_prng_xoro_lanes_get_u64(void *_state){
+	cr8r_prng_xoro_lanes_st *state = _state;
+	uint64_t res;
+	if(state->index + sizeof(uint64_t) <= sizeof(state->out)){
+		memcpy(&res, (void*)state->out + state->index, sizeof(uint64_t));
+		state->index += sizeof(uint64_t);
+	}else{
+		cr8r_prng_xoro_lanes_fill(state, sizeof(uint64_t), &res);
+	}
+	return res;
+}
+
+static uint32_t cr8r_prng_xoro_lanes_get_u32(void *_state){
+	cr8r_prng_xoro_lanes_st *state = _state;
+	uint32_t res;
+	if(state->index + sizeof(uint32_t) <= sizeof(state->out)){
+		memcpy(&res, (void*)state->out + state->index, sizeof(uint32_t));
+		state->index += sizeof(uint32_t);
+	}else{
+		cr8r_prng_xoro_lanes_fill(state, sizeof(uint32_t), &res);
+	}
+	return res;
+}
+
+// n 32 bit outputs are 4*n bytes of the stream, which may end in the current step, or skip some whole steps
+// and end partway through another one
+static bool cr8r_prng_xoro_lanes_jump(void *_state, uint64_t n){
+	cr8r_prng_xoro_lanes_st *state = _state;
+	unsigned __int128 size = (unsigned __int128)n*sizeof(uint32_t);
+	uint64_t avail = sizeof(state->out) - state->index;
+	if(size <= avail){
+		state->index += size;
+		return 1;
+	}
+	size -= avail;
+	uint64_t steps = size/sizeof(state->out);
+	uint64_t rem = size%sizeof(state->out);
+	if(steps){
+		uint64_t s[4][CR8R_PRNG_XORO_LANES];
+		for(uint64_t l = 0; l < CR8R_PRNG_XORO_LANES; ++l){
+			uint64_t lane[4] = {state->s[0][l], state->s[1][l], state->s[2][l], state->s[3][l]};
+			if(!cr8r_prng_xoro_jump_n(lane, steps)){
+				return 0;
+			}
+			for(uint64_t j = 0; j < 4; ++j){
+				s[j][l] = lane[j];
+			}
+		}
+		memcpy(state->s, s, sizeof(s));
+	}
+	state->index = sizeof(state->out);
+	if(rem){
+		cr8r_prng_xoro_lanes_steps(state->s, 1, state->out);
+		state->index = rem;
+	}
+	return 1;
+}
+
+// the first 4 words of the state are the seed for lane 0, and each other lane is jumped from the one before it
+static bool cr8r_prng_xoro_lanes_fixup(void *_state){
+	cr8r_prng_xoro_lanes_st *state = _state;
+	uint64_t s[4];
+	memcpy(s, state->s, sizeof(s));
+	for(uint64_t l = 0; l < CR8R_PRNG_XORO_LANES; ++l){
+		if(l){
+			cr8r_prng_xoro_jump(s, cr8r_prng_xoro_jump_t128_poly);
+		}
+		for(uint64_t j = 0; j < 4; ++j){
+			state->s[j][l] = s[j];
+		}
+	}
+	state->index = sizeof(state->out);
+	return 1;
+}
+
+cr8r_prng *cr8r_prng_init_xoro_lanes(uint64_t seed){
+	cr8r_prng *res = malloc(offsetof(cr8r_prng, state) + sizeof(cr8r_prng_xoro_lanes_st));
+	if(res){
+		res->state_size = sizeof(cr8r_prng_xoro_lanes_st);
+		res->get_u32 = cr8r_prng_xoro_lanes_get_u32;
+		res->get_u64 = cr8r_prng_xoro_lanes_get_u64;
+		res->fill = cr8r_prng_xoro_lanes_fill;
+		res->jump = cr8r_prng_xoro_lanes_jump;
+		res->fixup_state = cr8r_prng_xoro_lanes_fixup;
+		if(!cr8r_prng_seed(res, seed)){
+			free(res);
+			return NULL;
+		}
+	}
+	return res;
+}
+
+// Philox4x32-10 and Philox4x64-10 from "Parallel Random Numbers: As Easy as 1, 2, 3" by Salmon, Moraes, Dror and Shaw.
+// Each block of output is a keyed bijection of a counter, so any block can be computed directly.
+#define PHILOX_M4x32_0 0xD2511F53u
+#define PHILOX_M4x32_1 0xCD9E8D57u
+#define PHILOX_W32_0 0x9E3779B9u
+#define PHILOX_W32_1 0xBB67AE85u
+#define PHILOX_M4x64_0 0xD2E7470EE14C6C93ull
+#define PHILOX_M4x64_1 0xCA5A826395121157ull
+#define PHILOX_W64_0 0x9E3779B97F4A7C15ull
+#define PHILOX_W64_1 0xBB67AE8584CAA73Bull
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow", "implicit-unsigned-integer-truncation")
+void cr8r_prng_philox4x32(const uint32_t ctr[static 4], const uint32_t key[static 2], uint32_t out[static 4]){
+	uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+	uint32_t k0 = key[0], k1 = key[1];
+	for(uint64_t r = 0; r < 10; ++r, k0 += PHILOX_W32_0, k1 += PHILOX_W32_1){
+		uint64_t p0 = (uint64_t)PHILOX_M4x32_0*c0, p1 = (uint64_t)PHILOX_M4x32_1*c2;
+		c0 = (p1 >> 32)^c1^k0;
+		c1 = p1;
+		c2 = (p0 >> 32)^c3^k1;
+		c3 = p0;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow", "implicit-unsigned-integer-truncation")
+void cr8r_prng_philox4x64(const uint64_t ctr[static 4], const uint64_t key[static 2], uint64_t out[static 4]){
+	uint64_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+	uint64_t k0 = key[0], k1 = key[1];
+	for(uint64_t r = 0; r < 10; ++r, k0 += PHILOX_W64_0, k1 += PHILOX_W64_1){
+		unsigned __int128 p0 = (unsigned __int128)PHILOX_M4x64_0*c0, p1 = (unsigned __int128)PHILOX_M4x64_1*c2;
+		c0 = (p1 >> 64)^c1^k0;
+		c1 = p1;
+		c2 = (p0 >> 64)^c3^k1;
+		c3 = p0;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+// Philox prngs use the counter (block, stream) for 64 bit block and stream numbers,
+// ie words (block lo, block hi, stream lo, stream hi) for 4x32 and (block, 0, stream, 0) for 4x64.
+// buf holds the block before state->block, and the first index bytes of it have been used.
+typedef struct{
+	uint64_t key;
+	uint64_t stream;
+	uint64_t block;
+	uint64_t index;
+	uint64_t buf[4];
+} cr8r_prng_philox_st;
+
+// Compute n consecutive philox4x32 blocks, 8 at a time.  Each 32 bit word is kept in a 64 bit lane
+// so the high half of each 32x32 bit product is available without widening
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow", "implicit-unsigned-integer-truncation")
+CR8R_ATTR_SIMD_CLONES static void cr8r_prng_philox4x32_blocks(const cr8r_prng_philox_st *state, uint64_t block, uint64_t n, void *buf){
+	const v4u64 lo32 = (v4u64){} + 0xFFFFFFFFull;
+	uint64_t i = 0;
+	for(; i + 8 <= n; i += 8){
+		v4u64 c0[2], c1[2], c2[2], c3[2];
+		for(uint64_t g = 0; g < 2; ++g){
+			v4u64 b = (v4u64){0, 1, 2, 3} + (block + i + 4*g);
+			c0[g] = b&lo32;
+			c1[g] = b >> 32;
+			c2[g] = ((v4u64){} + state->stream)&lo32;
+			c3[g] = (v4u64){} + (state->stream >> 32);
+		}
+		uint32_t k0 = state->key, k1 = state->key >> 32;
+		for(uint64_t r = 0; r < 10; ++r, k0 += PHILOX_W32_0, k1 += PHILOX_W32_1){
+			for(uint64_t g = 0; g < 2; ++g){
+				v4u64 p0 = c0[g]*PHILOX_M4x32_0, p1 = c2[g]*PHILOX_M4x32_1;
+				c0[g] = (p1 >> 32)^c1[g]^k0;
+				c1[g] = p1&lo32;
+				c2[g] = (p0 >> 32)^c3[g]^k1;
+				c3[g] = p0&lo32;
+			}
+		}
+		for(uint64_t g = 0; g < 2; ++g){
+			for(uint64_t l = 0; l < 4; ++l){
+				uint32_t out[4] = {c0[g][l], c1[g][l], c2[g][l], c3[g][l]};
+				memcpy(buf + 16*(i + 4*g + l), out, sizeof(out));
+			}
+		}
+	}
+	uint32_t key[2] = {state->key, state->key >> 32};
+	for(; i < n; ++i){
+		uint32_t ctr[4] = {block + i, (block + i) >> 32, state->stream, state->stream >> 32}, out[4];
+		cr8r_prng_philox4x32(ctr, key, out);
+		memcpy(buf + 16*i, out, sizeof(out));
+	}
+}
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static void cr8r_prng_philox4x64_blocks(const cr8r_prng_philox_st *state, uint64_t block, uint64_t n, void *buf){
+	const uint64_t key[2] = {state->key, 0};
+	for(uint64_t i = 0; i < n; ++i){
+		uint64_t ctr[4] = {block + i, 0, state->stream, 0}, out[4];
+		cr8r_prng_philox4x64(ctr, key, out);
+		memcpy(buf + 32*i, out, sizeof(out));
+	}
+}
+
+// Shared by both philox fill callbacks, so the block function is a direct call
+__attribute__((always_inline))
+static inline void cr8r_prng_philox_fill(cr8r_prng_philox_st *state, uint64_t size, void *buf, uint64_t block_size,
+	void (*blocks)(const cr8r_prng_philox_st*, uint64_t, uint64_t, void*)){
+	uint64_t avail = block_size - state->index;
+	if(size <= avail){
+		memcpy(buf, (void*)state->buf + state->index, size);
+		state->index += size;
+		return;
+	}
+	memcpy(buf, (void*)state->buf + state->index, avail);
+	buf += avail;
+	size -= avail;
+	uint64_t n = size/block_size;
+	blocks(state, state->block, n, buf);
+	state->block += n;
+	buf += n*block_size;
+	size -= n*block_size;
+	blocks(state, state->block++, 1, state->buf);
+	memcpy(buf, state->buf, size);
+	state->index = size;
+}
+
+// Skipping n 32 bit outputs is the same as skipping 4*n bytes, which only needs to compute the block it ends in
+__attribute__((always_inline))
+static inline bool cr8r_prng_philox_jump(cr8r_prng_philox_st *state, uint64_t n, uint64_t block_size,
+	void (*blocks)(const cr8r_prng_philox_st*, uint64_t, uint64_t, void*)){
+	unsigned __int128 size = (unsigned __int128)n*sizeof(uint32_t);
+	uint64_t avail = block_size - state->index;
+	if(size <= avail){
+		state->index += size;
+		return 1;
+	}
+	size -= avail;
+	// the block counter wraps around, just like it would if the blocks were generated
+	state->block += (uint64_t)(size/block_size);
+	state->index = block_size;
+	if(size%block_size){
+		blocks(state, state->block++, 1, state->buf);
+		state->index = size%block_size;
+	}
+	return 1;
+}
+
+static bool cr8r_prng_philox4x32_jump(void *_state, uint64_t n){
+	return cr8r_prng_philox_jump(_state, n, 16, cr8r_prng_philox4x32_blocks);
+}
+
+static bool cr8r_prng_philox4x64_jump(void *_state, uint64_t n){
+	return cr8r_prng_philox_jump(_state, n, 32, cr8r_prng_philox4x64_blocks);
+}
+
+static void cr8r_prng_philox4x32_fill(void *_state, uint64_t size, void *buf){
+	cr8r_prng_philox_fill(_state, size, buf, 16, cr8r_prng_philox4x32_blocks);
+}
+
+static void cr8r_prng_philox4x64_fill(void *_state, uint64_t size, void *buf){
+	cr8r_prng_philox_fill(_state, size, buf, 32, cr8r_prng_philox4x64_blocks);
+}
+
+static uint64_t cr8r_prng_philox4x32_get_u64(void *_state){
+	uint64_t res;
+	cr8r_prng_philox4x32_fill(_state, sizeof(uint64_t), &res);
+	return res;
+}
+
+static uint32_t cr8r_prng_philox4x32_get_u32(void *_state){
+	uint32_t res;
+	cr8r_prng_philox4x32_fill(_state, sizeof(uint32_t), &res);
+	return res;
+}
+
+static uint64_t cr8r_prng_philox4x64_get_u64(void *_state){
+	uint64_t res;
+	cr8r_prng_philox4x64_fill(_state, sizeof(uint64_t), &res);
+	return res;
+}
+
+static uint32_t cr8r_prng_philox4x64_get_u32(void *_state){
+	uint32_t res;
+	cr8r_prng_philox4x64_fill(_state, sizeof(uint32_t), &res);
+	return res;
+}
+
+// seeding sets a random key and stream, and starts from the first block
+static bool cr8r_prng_philox4x32_fixup(void *_state){
+	cr8r_prng_philox_st *state = _state;
+	state->block = 0;
+	state->index = 16;
+	return 1;
+}
+
+static bool cr8r_prng_philox4x64_fixup(void *_state){
+	cr8r_prng_philox_st *state = _state;
+	state->block = 0;
+	state->index = 32;
+	return 1;
+}
+
+static cr8r_prng *cr8r_prng_init_philox(uint64_t key, uint64_t stream, uint32_t (*get_u32)(void*), uint64_t (*get_u64)(void*),
+	void (*fill)(void*, uint64_t, void*), bool (*jump)(void*, uint64_t), bool (*fixup_state)(void*)){
+	cr8r_prng *res = malloc(offsetof(cr8r_prng, state) + sizeof(cr8r_prng_philox_st));
+	if(res){
+		res->state_size = sizeof(cr8r_prng_philox_st);
+		res->get_u32 = get_u32;
+		res->get_u64 = get_u64;
+		res->fill = fill;
+		res->jump = jump;
+		res->fixup_state = fixup_state;
+		cr8r_prng_philox_st *state = (cr8r_prng_philox_st*)res->state;
+		state->key = key;
+		state->stream = stream;
+		fixup_state(state);
+	}
+	return res;
+}
+
+cr8r_prng *cr8r_prng_init_philox4x32(uint64_t key, uint64_t stream){
+	return cr8r_prng_init_philox(key, stream, cr8r_prng_philox4x32_get_u32, cr8r_prng_philox4x32_get_u64,
+		cr8r_prng_philox4x32_fill, cr8r_prng_philox4x32_jump, cr8r_prng_philox4x32_fixup);
+}
+
+cr8r_prng *cr8r_prng_init_philox4x64(uint64_t key, uint64_t stream){
+	return cr8r_prng_init_philox(key, stream, cr8r_prng_philox4x64_get_u32, cr8r_prng_philox4x64_get_u64,
+		cr8r_prng_philox4x64_fill, cr8r_prng_philox4x64_jump, cr8r_prng_philox4x64_fixup);
+}
+
+void cr8r_prng_philox_seek(cr8r_prng *self, uint64_t block){
+	cr8r_prng_philox_st *state = (cr8r_prng_philox_st*)self->state;
+	// the fixup callback knows the block size of the variant, and resets the block and empties the buffer
+	self->fixup_state(state);
+	state->block = block;
+}
+
 /*  Written in 2015 by Sebastiano Vigna (vigna@acm.org)
 
 To the extent possible under law, the author has dedicated all copyright
@@ -461,14 +1785,30 @@ See <http://creativecommons.org/publicdomain/zero/1.0/>. */
    It is a very fast generator passing BigCrush, and it can be useful if
    for some reason you absolutely want 64 bits of state. */
 
-CR8R_ATTR_NO_SAN("unsigned-integer-overflow", "implicit-unsigned-integer-truncation")
-static uint32_t cr8r_prng_splitmix_get_u32(void *_state){
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static uint64_t cr8r_prng_splitmix_get_u64(void *_state){
 	uint64_t *state = _state;
 	uint64_t z = (*state += 0x9e3779b97f4a7c15);
 	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
 	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
-	z ^= (z >> 31);
-	return z >> 16;
+	return z ^ (z >> 31);
+}
+
+CR8R_ATTR_NO_SAN("implicit-unsigned-integer-truncation")
+static uint32_t cr8r_prng_splitmix_get_u32(void *_state){
+	return cr8r_prng_splitmix_get_u64(_state) >> 16;
+}
+
+static void cr8r_prng_splitmix_fill(void *_state, uint64_t size, void *buf){
+	uint64_t state = *(uint64_t*)_state;
+	fill_u64s(&state, size, buf, cr8r_prng_splitmix_get_u64);
+	*(uint64_t*)_state = state;
+}
+
+CR8R_ATTR_NO_SAN("unsigned-integer-overflow")
+static bool cr8r_prng_splitmix_jump(void *_state, uint64_t n){
+	*(uint64_t*)_state += n*0x9e3779b97f4a7c15;
+	return 1;
 }
 
 static bool cr8r_prng_splitmix_fixup(void *_state){
@@ -479,7 +1819,10 @@ cr8r_prng *cr8r_prng_init_splitmix(uint64_t seed){
 	cr8r_prng *res = malloc(offsetof(cr8r_prng, state) + sizeof(uint64_t));
 	if(res){
 		res->state_size = sizeof(uint64_t);
-		res->get_u32 = cr8r_prng_splitmix_get_u32,
+		res->get_u32 = cr8r_prng_splitmix_get_u32;
+		res->get_u64 = cr8r_prng_splitmix_get_u64;
+		res->fill = cr8r_prng_splitmix_fill;
+		res->jump = cr8r_prng_splitmix_jump;
 		res->fixup_state = cr8r_prng_splitmix_fixup;
 		if(!cr8r_prng_seed(res, seed)){
 			free(res);
@@ -493,11 +1836,17 @@ cr8r_prng *cr8r_prng_init_splitmix(uint64_t seed){
 static struct{
 	uint64_t state_size;
 	uint32_t (*get_u32)(void*);
+	uint64_t (*get_u64)(void*);
+	void (*fill)(void*, uint64_t, void*);
+	bool (*jump)(void*, uint64_t);
 	bool (*fixup_state)(void*);
 	uint64_t state;
 } _default_prng_splitmix = {
 	.state_size = sizeof(uint64_t),
 	.get_u32 = cr8r_prng_splitmix_get_u32,
+	.get_u64 = cr8r_prng_splitmix_get_u64,
+	.fill = cr8r_prng_splitmix_fill,
+	.jump = cr8r_prng_splitmix_jump,
 	.fixup_state = cr8r_prng_splitmix_fixup,
 	.state = CR8R_DEFAULT_PRNG_SM_SEED
 };
@@ -0,0 +1,398 @@
+#define _XOPEN_SOURCE 500
+
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <crater/prand_dist.h>
+
+// Number of 64 bit outputs generated at once by the fill functions
+#define DIST_BATCH 256
+
+// uniform on [0, 1) with 53 bits of precision
+static inline double u01(uint64_t bits){
+	return (bits >> 11)*0x1p-53;
+}
+
+// uniform on (0, 1], for taking logs
+static inline double u01_open(cr8r_prng *prng){
+	return 1. - u01(cr8r_prng_get_u64(prng));
+}
+
+// Ziggurats with 256 layers of equal area v under f(x) = exp(-x**2/2) and f(x) = exp(-x), with x[1] = r the start of the tail.
+// Layer i spans [0, x[i]) horizontally, x[0] = v/f(r) is the width of a rectangle with the same area as the base layer
+// including the tail, and x[256] = 0.  The low 8 bits of a 64 bit output pick the layer and the top 53 bits pick x
+typedef struct{
+	double x[257];
+	double f[257];
+} ziggurat;
+
+#define ZIG_NORM_R 3.6541528853610088
+#define ZIG_EXP_R 7.69711747013104972
+
+static ziggurat zig_norm, zig_exp;
+static pthread_once_t zig_norm_once = PTHREAD_ONCE_INIT, zig_exp_once = PTHREAD_ONCE_INIT;
+
+static void zig_init(ziggurat *zig, double r, double v, double (*f)(double), double (*f_inv)(double)){
+	zig->x[0] = v/f(r);
+	zig->x[1] = r;
+	for(uint64_t i = 1; i < 255; ++i){
+		zig->x[i + 1] = f_inv(f(zig->x[i]) + v/zig->x[i]);
+	}
+	zig->x[256] = 0;
+	for(uint64_t i = 0; i < 257; ++i){
+		zig->f[i] = f(zig->x[i]);
+	}
+}
+
+static double norm_f(double x){
+	return exp(-.5*x*x);
+}
+
+static double norm_f_inv(double y){
+	return y < 1 ? sqrt(-2*log(y)) : 0;
+}
+
+static double exp_f(double x){
+	return exp(-x);
+}
+
+static double exp_f_inv(double y){
+	return y < 1 ? -log(y) : 0;
+}
+
+static void zig_norm_init(){
+	double r = ZIG_NORM_R;
+	zig_init(&zig_norm, r, r*norm_f(r) + sqrt(M_PI_2)*erfc(r*M_SQRT1_2), norm_f, norm_f_inv);
+}
+
+static void zig_exp_init(){
+	double r = ZIG_EXP_R;
+	zig_init(&zig_exp, r, (r + 1)*exp_f(r), exp_f, exp_f_inv);
+}
+
+// Finish sampling a normal variate from a 64 bit output, rejecting and drawing more outputs from prng if needed
+static inline double zig_normal(cr8r_prng *prng, uint64_t bits){
+	while(1){
+		uint64_t i = bits&0xFF;
+		double u = 2*u01(bits) - 1;
+		double x = u*zig_norm.x[i];
+		if(fabs(x) < zig_norm.x[i + 1]){
+			return x;
+		}
+		if(!i){
+			// Marsaglia's tail method: x = r + a for a with density proportional to exp(-r*a - a**2/2)
+			double a, b;
+			do{
+				a = -log(u01_open(prng))/ZIG_NORM_R;
+				b = -log(u01_open(prng));
+			}while(2*b < a*a);
+			return u < 0 ? -ZIG_NORM_R - a : ZIG_NORM_R + a;
+		}
+		if(zig_norm.f[i + 1] + (zig_norm.f[i] - zig_norm.f[i + 1])*u01(cr8r_prng_get_u64(prng)) < norm_f(x)){
+			return x;
+		}
+		bits = cr8r_prng_get_u64(prng);
+	}
+}
+
+static inline double zig_exponential(cr8r_prng *prng, uint64_t bits){
+	while(1){
+		uint64_t i = bits&0xFF;
+		double x = u01(bits)*zig_exp.x[i];
+		if(x < zig_exp.x[i + 1]){
+			return x;
+		}
+		if(!i){
+			// the exponential distribution is memoryless, so the tail is just r plus another exponential variate
+			return ZIG_EXP_R - log(u01_open(prng));
+		}
+		if(zig_exp.f[i + 1] + (zig_exp.f[i] - zig_exp.f[i + 1])*u01(cr8r_prng_get_u64(prng)) < exp_f(x)){
+			return x;
+		}
+		bits = cr8r_prng_get_u64(prng);
+	}
+}
+
+double cr8r_prng_normal(cr8r_prng *prng){
+	pthread_once(&zig_norm_once, zig_norm_init);
+	return zig_normal(prng, cr8r_prng_get_u64(prng));
+}
+
+void cr8r_prng_fill_normal(cr8r_prng *prng, uint64_t n, double *out){
+	pthread_once(&zig_norm_once, zig_norm_init);
+	uint64_t bits[DIST_BATCH];
+	for(uint64_t i = 0; i < n; i += DIST_BATCH){
+		uint64_t m = n - i < DIST_BATCH ? n - i : DIST_BATCH;
+		cr8r_prng_get_bytes(prng, m*sizeof(uint64_t), bits);
+		for(uint64_t j = 0; j < m; ++j){
+			out[i + j] = zig_normal(prng, bits[j]);
+		}
+	}
+}
+
+double cr8r_prng_exponential(cr8r_prng *prng){
+	pthread_once(&zig_exp_once, zig_exp_init);
+	return zig_exponential(prng, cr8r_prng_get_u64(prng));
+}
+
+void cr8r_prng_fill_exponential(cr8r_prng *prng, uint64_t n, double *out){
+	pthread_once(&zig_exp_once, zig_exp_init);
+	uint64_t bits[DIST_BATCH];
+	for(uint64_t i = 0; i < n; i += DIST_BATCH){
+		uint64_t m = n - i < DIST_BATCH ? n - i : DIST_BATCH;
+		cr8r_prng_get_bytes(prng, m*sizeof(uint64_t), bits);
+		for(uint64_t j = 0; j < m; ++j){
+			out[i + j] = zig_exponential(prng, bits[j]);
+		}
+	}
+}
+
+// log(k!), from a table for small k and Stirling's series for lgamma(k + 1) otherwise
+// (lgamma itself is not thread safe since it sets signgam)
+static double log_factorial(uint64_t k){
+	static const double small[10] = {
+		0., 0., 0.6931471805599453, 1.791759469228055, 3.1780538303479458,
+		4.787491742782046, 6.579251212010101, 8.525161361065415, 10.60460290274525, 12.801827480081469
+	};
+	if(k < 10){
+		return small[k];
+	}
+	double x = k + 1., x2 = x*x;
+	return (x - .5)*log(x) - x + .5*log(2*M_PI) + (1./12 - (1./360 - (1./1260 - 1./(1680*x2))/x2)/x2)/x;
+}
+
+// Constants for PTRS, from "The transformed rejection method for generating Poisson random variables" by Hörmann
+typedef struct{
+	double lambda, log_lambda, exp_neg_lambda;
+	double a, b, inv_alpha, v_r;
+} poisson_params;
+
+static void poisson_setup(poisson_params *params, double lambda){
+	params->lambda = lambda;
+	params->exp_neg_lambda = exp(-lambda);
+	if(lambda >= 10){
+		params->log_lambda = log(lambda);
+		params->b = .931 + 2.53*sqrt(lambda);
+		params->a = -.059 + .02483*params->b;
+		params->inv_alpha = 1.1239 + 1.1328/(params->b - 3.4);
+		params->v_r = .9277 - 3.6224/(params->b - 2);
+	}
+}
+
+static uint64_t poisson_sample(const poisson_params *params, cr8r_prng *prng){
+	if(params->lambda < 10){
+		while(1){
+			double u = u01(cr8r_prng_get_u64(prng)), p = params->exp_neg_lambda, s = p;
+			uint64_t k = 0;
+			// rounding can leave u above the sum of all the probabilities, so start over if the terms run out
+			while(u > s && p){
+				++k;
+				p *= params->lambda/k;
+				s += p;
+			}
+			if(p){
+				return k;
+			}
+		}
+	}
+	while(1){
+		double u = u01(cr8r_prng_get_u64(prng)) - .5, v = u01(cr8r_prng_get_u64(prng));
+		double us = .5 - fabs(u);
+		double k = floor((2*params->a/us + params->b)*u + params->lambda + .43);
+		if(us >= .07 && v <= params->v_r){
+			return k;
+		}
+		if(k < 0 || (us < .013 && v > us)){
+			continue;
+		}
+		if(log(v*params->inv_alpha/(params->a/(us*us) + params->b)) <= -params->lambda + k*params->log_lambda - log_factorial(k)){
+			return k;
+		}
+	}
+}
+
+uint64_t cr8r_prng_poisson(cr8r_prng *prng, double lambda){
+	poisson_params params;
+	poisson_setup(&params, lambda);
+	return poisson_sample(&params, prng);
+}
+
+void cr8r_prng_fill_poisson(cr8r_prng *prng, double lambda, uint64_t n, uint64_t *out){
+	poisson_params params;
+	poisson_setup(&params, lambda);
+	for(uint64_t i = 0; i < n; ++i){
+		out[i] = poisson_sample(&params, prng);
+	}
+}
+
+// Constants for BTRS, from "The generation of binomial random variates" by Hörmann.
+// p is at most 1/2, and flip is set if the result should be subtracted from n since the original p was larger
+typedef struct{
+	uint64_t n;
+	double p, q;
+	bool flip;
+	// for inversion
+	double q_n, bound;
+	// for BTRS
+	double a, b, c, v_r, alpha, log_pq, h;
+	uint64_t m;
+} binomial_params;
+
+static void binomial_setup(binomial_params *params, uint64_t n, double p){
+	params->n = n;
+	params->flip = p > .5;
+	params->p = params->flip ? 1 - p : p;
+	params->q = 1 - params->p;
+	double np = n*params->p;
+	if(np < 10){
+		params->q_n = exp(n*log(params->q));
+		params->bound = fmin(n, np + 10*sqrt(np*params->q + 1));
+	}else{
+		double spq = sqrt(np*params->q);
+		params->b = 1.15 + 2.53*spq;
+		params->a = -.0873 + .0248*params->b + .01*params->p;
+		params->c = np + .5;
+		params->v_r = .92 - 4.2/params->b;
+		params->alpha = (2.83 + 5.1/params->b)*spq;
+		params->log_pq = log(params->p/params->q);
+		params->m = floor((n + 1)*params->p);
+		params->h = log_factorial(params->m) + log_factorial(n - params->m);
+	}
+}
+
+static uint64_t binomial_sample_flipped(const binomial_params *params, cr8r_prng *prng){
+	if(!params->p){
+		return 0;
+	}
+	if(params->n*params->p < 10){
+		uint64_t k = 0;
+		double px = params->q_n, u = u01(cr8r_prng_get_u64(prng));
+		while(u > px){
+			if(++k > params->bound){
+				k = 0;
+				px = params->q_n;
+				u = u01(cr8r_prng_get_u64(prng));
+			}else{
+				u -= px;
+				px *= (params->n - k + 1)*params->p/(k*params->q);
+			}
+		}
+		return k;
+	}
+	while(1){
+		double u = u01(cr8r_prng_get_u64(prng)) - .5, v = u01(cr8r_prng_get_u64(prng));
+		double us = .5 - fabs(u);
+		double k = floor((2*params->a/us + params->b)*u + params->c);
+		if(k < 0 || k > params->n){
+			continue;
+		}
+		if(us >= .07 && v <= params->v_r){
+			return k;
+		}
+		v = log(v*params->alpha/(params->a/(us*us) + params->b));
+		if(v <= params->h - log_factorial(k) - log_factorial(params->n - (uint64_t)k) + (k - params->m)*params->log_pq){
+			return k;
+		}
+	}
+}
+
+static uint64_t binomial_sample(const binomial_params *params, cr8r_prng *prng){
+	uint64_t k = binomial_sample_flipped(params, prng);
+	return params->flip ? params->n - k : k;
+}
+
+uint64_t cr8r_prng_binomial(cr8r_prng *prng, uint64_t trials, double p){
+	binomial_params params;
+	binomial_setup(&params, trials, p);
+	return binomial_sample(&params, prng);
+}
+
+void cr8r_prng_fill_binomial(cr8r_prng *prng, uint64_t trials, double p, uint64_t n, uint64_t *out){
+	binomial_params params;
+	binomial_setup(&params, trials, p);
+	for(uint64_t i = 0; i < n; ++i){
+		out[i] = binomial_sample(&params, prng);
+	}
+}
+
+bool cr8r_prng_alias_init(cr8r_prng_alias *self, uint64_t n, const double *weights){
+	double total = 0;
+	for(uint64_t i = 0; i < n; ++i){
+		if(!(weights[i] >= 0)){
+			return 0;
+		}
+		total += weights[i];
+	}
+	if(!n || !(total > 0) || !isfinite(total)){
+		return 0;
+	}
+	self->ents = malloc(n*sizeof(cr8r_prng_alias_ent));
+	double *scaled = malloc(n*sizeof(double));
+	// indices of columns with less than a full column of probability stack up from the start of work,
+	// and indices with more stack down from the end
+	uint64_t *work = malloc(n*sizeof(uint64_t));
+	if(!self->ents || !scaled || !work){
+		free(self->ents);
+		free(scaled);
+		free(work);
+		return 0;
+	}
+	self->n = n;
+	uint64_t num_small = 0, num_large = 0;
+	for(uint64_t i = 0; i < n; ++i){
+		scaled[i] = weights[i]*n/total;
+		if(scaled[i] < 1){
+			work[num_small++] = i;
+		}else{
+			work[n - ++num_large] = i;
+		}
+	}
+	// fill each small column up with part of a large one, which may become small itself
+	while(num_small && num_large){
+		uint64_t s = work[--num_small], l = work[n - num_large];
+		self->ents[s].threshold = scaled[s]*0x1p64;
+		self->ents[s].alias = l;
+		scaled[l] -= 1 - scaled[s];
+		if(scaled[l] < 1){
+			--num_large;
+			work[num_small++] = l;
+		}
+	}
+	// whatever is left is a full column up to rounding error
+	for(uint64_t i = 0; i < num_small; ++i){
+		self->ents[work[i]] = (cr8r_prng_alias_ent){UINT64_MAX, work[i]};
+	}
+	for(uint64_t i = n - num_large; i < n; ++i){
+		self->ents[work[i]] = (cr8r_prng_alias_ent){UINT64_MAX, work[i]};
+	}
+	free(scaled);
+	free(work);
+	return 1;
+}
+
+void cr8r_prng_alias_delete(cr8r_prng_alias *self){
+	free(self->ents);
+	self->ents = NULL;
+	self->n = 0;
+}
+
+static inline uint64_t alias_lookup(const cr8r_prng_alias *self, uint64_t bits){
+	unsigned __int128 prod = (unsigned __int128)bits*self->n;
+	uint64_t col = prod >> 64;
+	return (uint64_t)prod < self->ents[col].threshold ? col : self->ents[col].alias;
+}
+
+uint64_t cr8r_prng_alias_sample(const cr8r_prng_alias *self, cr8r_prng *prng){
+	return alias_lookup(self, cr8r_prng_get_u64(prng));
+}
+
+void cr8r_prng_alias_fill(const cr8r_prng_alias *self, cr8r_prng *prng, uint64_t n, uint64_t *out){
+	cr8r_prng_get_bytes(prng, n*sizeof(uint64_t), out);
+	for(uint64_t i = 0; i < n; ++i){
+		out[i] = alias_lookup(self, out[i]);
+	}
+}
+
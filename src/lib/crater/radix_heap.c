@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <crater/radix_heap.h>
+
+bool cr8r_radix_heap_init(cr8r_radix_heap *self, uint64_t n){
+	*self = (cr8r_radix_heap){.n = n};
+	if(
+		!(self->keys = malloc(n*sizeof(uint64_t) ?: 1)) ||
+		!(self->slots = malloc(n*sizeof(uint64_t) ?: 1)) ||
+		!(self->where = malloc(n ?: 1))
+	){
+		cr8r_radix_heap_delete(self);
+		return 0;
+	}
+	memset(self->where, CR8R_RADIX_HEAP_ABSENT, n);
+	for(uint64_t i = 0; i < 65; ++i){
+		if(!cr8r_vec_init(self->buckets + i, &cr8r_vecft_u64, 8)){
+			cr8r_radix_heap_delete(self);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+void cr8r_radix_heap_delete(cr8r_radix_heap *self){
+	for(uint64_t i = 0; i < 65; ++i){
+		cr8r_vec_delete(self->buckets + i, &cr8r_vecft_u64);
+	}
+	free(self->keys);
+	free(self->slots);
+	free(self->where);
+	*self = (cr8r_radix_heap){};
+}
+
+void cr8r_radix_heap_clear(cr8r_radix_heap *self){
+	for(uint64_t i = 0; i < 65; ++i){
+		self->buckets[i].len = 0;
+	}
+	memset(self->where, CR8R_RADIX_HEAP_ABSENT, self->n);
+	self->len = 0;
+	self->last = 0;
+}
+
+static inline uint64_t bucket_of(const cr8r_radix_heap *self, uint64_t key){
+	return key == self->last ? 0 : 64 - __builtin_clzll(key ^ self->last);
+}
+
+static bool insert(cr8r_radix_heap *self, uint64_t id){
+	uint64_t b = bucket_of(self, self->keys[id]);
+	self->slots[id] = self->buckets[b].len;
+	self->where[id] = b;
+	return cr8r_vec_pushr(self->buckets + b, &cr8r_vecft_u64, &id);
+}
+
+// remove an id from its bucket by moving the last id in the bucket into its slot
+static void remove_from_bucket(cr8r_radix_heap *self, uint64_t id){
+	cr8r_vec *bucket = self->buckets + self->where[id];
+	uint64_t *ids = bucket->buf;
+	uint64_t moved = ids[--bucket->len];
+	ids[self->slots[id]] = moved;
+	self->slots[moved] = self->slots[id];
+	self->where[id] = CR8R_RADIX_HEAP_ABSENT;
+}
+
+bool cr8r_radix_heap_push(cr8r_radix_heap *self, uint64_t id, uint64_t key){
+	if(id >= self->n || self->where[id] != CR8R_RADIX_HEAP_ABSENT || key < self->last){
+		return 0;
+	}
+	self->keys[id] = key;
+	if(!insert(self, id)){
+		self->where[id] = CR8R_RADIX_HEAP_ABSENT;
+		return 0;
+	}
+	++self->len;
+	return 1;
+}
+
+bool cr8r_radix_heap_decrease(cr8r_radix_heap *self, uint64_t id, uint64_t key){
+	if(!cr8r_radix_heap_contains(self, id) || key < self->last || key > self->keys[id]){
+		return 0;
+	}
+	uint64_t b = bucket_of(self, key);
+	if(b != self->where[id]){
+		// make sure the id can be inserted into its new bucket before removing it from the old one
+		if(!cr8r_vec_ensure_cap(self->buckets + b, &cr8r_vecft_u64, self->buckets[b].len + 1)){
+			return 0;
+		}
+		remove_from_bucket(self, id);
+		self->keys[id] = key;
+		insert(self, id);
+	}else{
+		self->keys[id] = key;
+	}
+	return 1;
+}
+
+bool cr8r_radix_heap_pop(cr8r_radix_heap *self, uint64_t *id, uint64_t *key){
+	if(!self->len){
+		return 0;
+	}
+	if(!self->buckets[0].len){
+		uint64_t b = 1;
+		while(!self->buckets[b].len){
+			++b;
+		}
+		cr8r_vec *bucket = self->buckets + b;
+		const uint64_t *ids = bucket->buf;
+		uint64_t min_key = UINT64_MAX;
+		for(uint64_t i = 0; i < bucket->len; ++i){
+			if(self->keys[ids[i]] < min_key){
+				min_key = self->keys[ids[i]];
+			}
+		}
+		// every key in bucket b agrees with the new last above bit b - 1, so they all move to lower buckets,
+		// which are currently empty.  Count how many go to each one so they can be grown first
+		uint64_t old_last = self->last;
+		self->last = min_key;
+		uint64_t counts[65] = {};
+		for(uint64_t i = 0; i < bucket->len; ++i){
+			++counts[bucket_of(self, self->keys[ids[i]])];
+		}
+		for(uint64_t j = 0; j < b; ++j){
+			if(counts[j] && !cr8r_vec_ensure_cap(self->buckets + j, &cr8r_vecft_u64, counts[j])){
+				self->last = old_last;
+				return 0;
+			}
+		}
+		for(uint64_t i = 0; i < bucket->len; ++i){
+			insert(self, ids[i]);
+		}
+		bucket->len = 0;
+	}
+	uint64_t top = ((uint64_t*)self->buckets[0].buf)[self->buckets[0].len - 1];
+	--self->buckets[0].len;
+	self->where[top] = CR8R_RADIX_HEAP_ABSENT;
+	--self->len;
+	if(id){
+		*id = top;
+	}
+	if(key){
+		*key = self->keys[top];
+	}
+	return 1;
+}
+
@@ -0,0 +1,215 @@
+#include <stdlib.h>
+
+#include <crater/rank_select.h>
+
+// 2048 bit blocks of 4 sub blocks of 8 words each
+#define BLOCK_WORDS 32
+#define SUB_WORDS 8
+// blocks per 2**32 bit region, so counts within a region fit in 32 bits
+#define REGION_SHIFT 21
+#define REGION_MASK ((1ull << REGION_SHIFT) - 1)
+// one select sample per 8192 set bits
+#define SAMPLE_SHIFT 13
+// block indices must fit in the uint32_t samples
+#define MAX_LEN (1ull << 43)
+
+// The functions which popcount words have avx2 clones, which matters because they also get the popcnt instruction
+// instead of a call to libgcc's bit twiddling popcount on baseline x86_64.
+
+// Number of set bits before block blk, or in total if blk is past the end
+static inline uint64_t block_cum(const cr8r_bvec_rs *self, uint64_t blk){
+	if(blk >= self->num_blocks){
+		return self->ones;
+	}
+	return self->regions[blk >> REGION_SHIFT] + (uint32_t)self->blocks[blk];
+}
+
+// Recount the blocks in [b0, b1) given the number of set bits before b0, setting the count for any region that
+// starts in this range, and return the number of set bits before b1.  Bits past len in the last word are ignored.
+CR8R_ATTR_SIMD_CLONES static uint64_t count_blocks(cr8r_bvec_rs *self, const uint64_t *buf, uint64_t b0, uint64_t b1, uint64_t cum){
+	uint64_t num_words = (self->len + 63)/64;
+	uint64_t tail_mask = self->len%64 ? ~0ull >> (64 - self->len%64) : ~0ull;
+	for(uint64_t blk = b0; blk < b1; ++blk){
+		if(!(blk & REGION_MASK)){
+			self->regions[blk >> REGION_SHIFT] = cum;
+		}
+		uint64_t entry = cum - self->regions[blk >> REGION_SHIFT];
+		for(uint64_t s = 0; s < 4; ++s){
+			uint64_t start = blk*BLOCK_WORDS + s*SUB_WORDS, c = 0;
+			for(uint64_t i = start; i < start + SUB_WORDS && i < num_words; ++i){
+				c += __builtin_popcountll(i + 1 == num_words ? buf[i] & tail_mask : buf[i]);
+			}
+			if(s < 3){
+				entry |= c << (32 + 10*s);
+			}
+			cum += c;
+		}
+		self->blocks[blk] = entry;
+	}
+	return cum;
+}
+
+// Recompute the samples for set bits from the first one in block b0 up to (but not including) set bit stop,
+// after resizing the samples for the current number of set bits
+static bool fill_samples(cr8r_bvec_rs *self, uint64_t b0, uint64_t stop){
+	uint64_t num_samples = (self->ones + (1ull << SAMPLE_SHIFT) - 1) >> SAMPLE_SHIFT;
+	if(num_samples > self->samples_cap){
+		uint64_t cap = num_samples > 2*self->samples_cap ? num_samples : 2*self->samples_cap;
+		uint32_t *tmp = realloc(self->samples, cap*sizeof(uint32_t));
+		if(!tmp){
+			return 0;
+		}
+		self->samples = tmp;
+		self->samples_cap = cap;
+	}
+	self->num_samples = num_samples;
+	uint64_t k = (block_cum(self, b0) + (1ull << SAMPLE_SHIFT) - 1) >> SAMPLE_SHIFT;
+	for(uint64_t blk = b0; k < num_samples && k << SAMPLE_SHIFT < stop; ++blk){
+		uint64_t next = block_cum(self, blk + 1);
+		while(k < num_samples && k << SAMPLE_SHIFT < next && k << SAMPLE_SHIFT < stop){
+			self->samples[k++] = blk;
+		}
+	}
+	return 1;
+}
+
+bool cr8r_bvec_rs_init(cr8r_bvec_rs *self, const cr8r_bvec *bvec){
+	if(bvec->len > MAX_LEN){
+		return 0;
+	}
+	*self = (cr8r_bvec_rs){.len = bvec->len, .num_blocks = (bvec->len + 64*BLOCK_WORDS - 1)/(64*BLOCK_WORDS)};
+	self->regions = malloc(((self->num_blocks >> REGION_SHIFT) + 1)*sizeof(uint64_t));
+	self->blocks = malloc((self->num_blocks + 1)*sizeof(uint64_t));
+	if(!self->regions || !self->blocks){
+		cr8r_bvec_rs_delete(self);
+		return 0;
+	}
+	self->ones = count_blocks(self, bvec->buf, 0, self->num_blocks, 0);
+	if(!fill_samples(self, 0, self->ones)){
+		cr8r_bvec_rs_delete(self);
+		return 0;
+	}
+	return 1;
+}
+
+void cr8r_bvec_rs_delete(cr8r_bvec_rs *self){
+	free(self->regions);
+	free(self->blocks);
+	free(self->samples);
+	*self = (cr8r_bvec_rs){};
+}
+
+bool cr8r_bvec_rs_update(cr8r_bvec_rs *self, const cr8r_bvec *bvec, uint64_t a, uint64_t b){
+	if(bvec->len != self->len){
+		return 0;
+	}
+	if(b > self->len){
+		b = self->len;
+	}
+	if(a >= b){
+		return 1;
+	}
+	uint64_t b0 = a/(64*BLOCK_WORDS), b1 = (b + 64*BLOCK_WORDS - 1)/(64*BLOCK_WORDS);
+	uint64_t r = b1 >> REGION_SHIFT;
+	uint64_t old_base = b1 < self->num_blocks ? self->regions[r] : 0;
+	uint64_t old_end = block_cum(self, b1);
+	uint64_t new_end = count_blocks(self, bvec->buf, b0, b1, block_cum(self, b0));
+	// all arithmetic is mod 2**64, so delta is effectively signed
+	uint64_t delta = new_end - old_end;
+	if(b1 < self->num_blocks){
+		if(b1 & REGION_MASK){
+			// the rest of b1's region is relative to its start, which may have been recounted
+			uint64_t adj = delta - (self->regions[r] - old_base);
+			uint64_t end = (r + 1) << REGION_SHIFT;
+			if(end > self->num_blocks){
+				end = self->num_blocks;
+			}
+			for(uint64_t blk = b1; adj && blk < end; ++blk){
+				self->blocks[blk] += adj;
+			}
+			++r;
+		}
+		for(uint64_t num_regions = (self->num_blocks + REGION_MASK) >> REGION_SHIFT; delta && r < num_regions; ++r){
+			self->regions[r] += delta;
+		}
+	}
+	self->ones += delta;
+	// if the total did not change, set bits after the range still have the same rank and sample
+	return fill_samples(self, b0, delta ? self->ones : new_end);
+}
+
+CR8R_ATTR_SIMD_CLONES uint64_t cr8r_bvec_rank(const cr8r_bvec_rs *self, const cr8r_bvec *bvec, uint64_t i){
+	if(i >= self->len){
+		return self->ones;
+	}
+	uint64_t blk = i/(64*BLOCK_WORDS);
+	uint64_t entry = self->blocks[blk];
+	uint64_t res = self->regions[blk >> REGION_SHIFT] + (uint32_t)entry;
+	uint64_t sub = i/(64*SUB_WORDS)%4;
+	for(uint64_t s = 0; s < sub; ++s){
+		res += (entry >> (32 + 10*s)) & 1023;
+	}
+	uint64_t l = i/64, w = i%64;
+	for(uint64_t k = i/(64*SUB_WORDS)*SUB_WORDS; k < l; ++k){
+		res += __builtin_popcountll(bvec->buf[k]);
+	}
+	if(w){
+		res += __builtin_popcountll(bvec->buf[l] & (~0ull >> (64 - w)));
+	}
+	return res;
+}
+
+// Find the position of the jth set bit of x, which must have more than j set bits
+static inline uint64_t select_word(uint64_t x, uint64_t j){
+	uint64_t res = 0;
+	for(uint64_t shift = 32; shift >= 8; shift >>= 1){
+		uint64_t c = __builtin_popcountll(x & (~0ull >> (64 - shift)));
+		if(j >= c){
+			j -= c;
+			x >>= shift;
+			res += shift;
+		}
+	}
+	while(j--){
+		x &= x - 1;
+	}
+	return res + __builtin_ctzll(x);
+}
+
+CR8R_ATTR_SIMD_CLONES uint64_t cr8r_bvec_select(const cr8r_bvec_rs *self, const cr8r_bvec *bvec, uint64_t j){
+	if(j >= self->ones){
+		return self->len;
+	}
+	// the jth set bit is between the blocks of the samples before and after it, so binary search for the last block
+	// starting at or before it.  This is usually only a few blocks, but can be many if the set bits are unevenly spread out.
+	uint64_t k = j >> SAMPLE_SHIFT;
+	uint64_t blk = self->samples[k];
+	uint64_t hi = k + 1 < self->num_samples ? self->samples[k + 1] : self->num_blocks - 1;
+	while(blk < hi){
+		uint64_t mid = blk + (hi - blk + 1)/2;
+		if(block_cum(self, mid) <= j){
+			blk = mid;
+		}else{
+			hi = mid - 1;
+		}
+	}
+	uint64_t entry = self->blocks[blk];
+	j -= self->regions[blk >> REGION_SHIFT] + (uint32_t)entry;
+	uint64_t s = 0;
+	for(; s < 3; ++s){
+		uint64_t c = (entry >> (32 + 10*s)) & 1023;
+		if(j < c){
+			break;
+		}
+		j -= c;
+	}
+	// bits past len in the last word can only come after the jth set bit, so they don't need to be masked off
+	for(uint64_t k = blk*BLOCK_WORDS + s*SUB_WORDS;; ++k){
+		uint64_t c = __builtin_popcountll(bvec->buf[k]);
+		if(j < c){
+			return 64*k + select_word(bvec->buf[k], j);
+		}
+		j -= c;
+	}
+}
+
@@ -0,0 +1,204 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <crater/reservoir.h>
+#include <crater/heap.h>
+
+typedef struct{
+	double log_key;
+	uint64_t idx;
+} wres_key;
+
+static int cmp_wres_keys(const cr8r_base_ft *ft, const void *_a, const void *_b){
+	const wres_key *a = _a, *b = _b;
+	return (a->log_key > b->log_key) - (a->log_key < b->log_key);
+}
+
+static cr8r_vec_ft wres_keys_ft = {
+	.base.size = sizeof(wres_key),
+	.new_size = cr8r_default_new_size,
+	.resize = cr8r_default_resize,
+	.cmp = cmp_wres_keys,
+	.swap = cr8r_default_swap
+};
+
+// uniform on (0, 1], for taking logs
+static inline double u01_nonzero(cr8r_prng *prng){
+	return 1. - cr8r_prng_uniform01_double(prng);
+}
+
+static inline void copy_ent(cr8r_vec_ft *ft, void *dest, const void *src){
+	if(ft->copy){
+		ft->copy(&ft->base, dest, src);
+	}else{
+		memcpy(dest, src, ft->base.size);
+	}
+}
+
+static inline void replace_ent(cr8r_vec_ft *ft, void *dest, const void *src){
+	if(ft->del){
+		ft->del(&ft->base, dest);
+	}
+	copy_ent(ft, dest, src);
+}
+
+static inline bool append_ent(cr8r_vec *self, cr8r_vec_ft *ft, const void *e){
+	if(!cr8r_vec_ensure_cap(self, ft, self->len + 1)){
+		return 0;
+	}
+	copy_ent(ft, self->buf + self->len++*ft->base.size, e);
+	return 1;
+}
+
+// Algorithm L: the number of elements skipped before the next kept one is geometric with success probability w
+static inline void reservoir_next(cr8r_reservoir *self){
+	self->w *= exp(log(u01_nonzero(self->prng))/self->k);
+	double skip = floor(log(u01_nonzero(self->prng))/log1p(-self->w));
+	// if w underflows or the skip is past the end of any possible stream, no more elements will be kept
+	self->next = skip < 0x1p64 - 0x1p12 && self->n < UINT64_MAX - (uint64_t)skip ? self->n + 1 + (uint64_t)skip : UINT64_MAX;
+}
+
+bool cr8r_reservoir_init(cr8r_reservoir *self, cr8r_vec_ft *ft, uint64_t k, cr8r_prng *prng){
+	if(!cr8r_vec_init(&self->sample, ft, k < 1024 ? k : 1024)){
+		return 0;
+	}
+	self->k = k;
+	self->n = 0;
+	self->next = k ? 0 : UINT64_MAX;
+	self->w = 1;
+	self->prng = prng;
+	return 1;
+}
+
+void cr8r_reservoir_delete(cr8r_reservoir *self, cr8r_vec_ft *ft){
+	cr8r_vec_delete(&self->sample, ft);
+}
+
+bool cr8r_reservoir_push(cr8r_reservoir *self, cr8r_vec_ft *ft, const void *e){
+	if(self->n != self->next){
+		++self->n;
+		return 1;
+	}
+	if(self->sample.len < self->k){
+		if(!append_ent(&self->sample, ft, e)){
+			return 0;
+		}
+		if(self->sample.len < self->k){
+			self->next = ++self->n;
+			return 1;
+		}
+	}else{
+		uint64_t i = cr8r_prng_uniform_u64(self->prng, 0, self->k);
+		replace_ent(ft, self->sample.buf + i*ft->base.size, e);
+	}
+	reservoir_next(self);
+	++self->n;
+	return 1;
+}
+
+bool cr8r_reservoir_push_many(cr8r_reservoir *self, cr8r_vec_ft *ft, const void *es, uint64_t n){
+	for(uint64_t i = 0;;){
+		uint64_t skip = self->next - self->n;
+		if(skip >= n - i){
+			self->n += n - i;
+			return 1;
+		}
+		i += skip;
+		self->n += skip;
+		if(!cr8r_reservoir_push(self, ft, es + i++*ft->base.size)){
+			return 0;
+		}
+	}
+}
+
+uint64_t cr8r_reservoir_skip(const cr8r_reservoir *self){
+	return self->next - self->n;
+}
+
+bool cr8r_reservoir_advance(cr8r_reservoir *self, uint64_t n){
+	if(n > self->next - self->n){
+		return 0;
+	}
+	self->n += n;
+	return 1;
+}
+
+bool cr8r_wreservoir_init(cr8r_wreservoir *self, cr8r_vec_ft *ft, uint64_t k, cr8r_prng *prng){
+	uint64_t cap = k < 1024 ? k : 1024;
+	if(!cr8r_vec_init(&self->sample, ft, cap)){
+		return 0;
+	}else if(!cr8r_vec_init(&self->keys, &wres_keys_ft, cap)){
+		cr8r_vec_delete(&self->sample, ft);
+		return 0;
+	}
+	self->k = k;
+	self->skip = 0;
+	self->prng = prng;
+	return 1;
+}
+
+void cr8r_wreservoir_delete(cr8r_wreservoir *self, cr8r_vec_ft *ft){
+	cr8r_vec_delete(&self->sample, ft);
+	cr8r_vec_delete(&self->keys, &wres_keys_ft);
+}
+
+// A-ExpJ works with keys u**(1/w), which are stored as their logs log(u)/w so they don't underflow for small weights.
+// The next element is kept once the total weight skipped reaches log(u)/log(T), where T is the smallest key in the sample
+bool cr8r_wreservoir_push(cr8r_wreservoir *self, cr8r_vec_ft *ft, const void *e, double weight){
+	if(!(weight > 0) || !self->k){
+		return 1;
+	}
+	if(self->sample.len < self->k){
+		wres_key key = {log(u01_nonzero(self->prng))/weight, self->sample.len};
+		if(!cr8r_vec_ensure_cap(&self->keys, &wres_keys_ft, self->keys.len + 1) || !append_ent(&self->sample, ft, e)){
+			return 0;
+		}
+		cr8r_heap_push(&self->keys, &wres_keys_ft, &key, -1);
+	}else{
+		self->skip -= weight;
+		if(self->skip > 0){
+			return 1;
+		}
+		// the new element's key is uniform on (T**weight, 1] conditioned on beating T
+		wres_key *top = cr8r_heap_top(&self->keys, &wres_keys_ft);
+		double t_w = exp(top->log_key*weight);
+		top->log_key = log(t_w + (1. - t_w)*u01_nonzero(self->prng))/weight;
+		replace_ent(ft, self->sample.buf + top->idx*ft->base.size, e);
+		cr8r_heap_sift_down(&self->keys, &wres_keys_ft, top, -1);
+	}
+	if(self->sample.len == self->k){
+		const wres_key *top = cr8r_heap_top(&self->keys, &wres_keys_ft);
+		self->skip = log(u01_nonzero(self->prng))/top->log_key;
+	}
+	return 1;
+}
+
+bool cr8r_vec_sample(cr8r_vec *dest, const cr8r_vec *src, cr8r_vec_ft *ft, uint64_t k, cr8r_prng *prng){
+	cr8r_reservoir res;
+	if(!cr8r_reservoir_init(&res, ft, k, prng)){
+		return 0;
+	}else if(!cr8r_reservoir_push_many(&res, ft, src->buf, src->len)){
+		cr8r_reservoir_delete(&res, ft);
+		return 0;
+	}
+	*dest = res.sample;
+	return 1;
+}
+
+bool cr8r_vec_sample_weighted(cr8r_vec *dest, const cr8r_vec *src, cr8r_vec_ft *ft, uint64_t k, const double *weights, cr8r_prng *prng){
+	cr8r_wreservoir res;
+	if(!cr8r_wreservoir_init(&res, ft, k, prng)){
+		return 0;
+	}
+	for(uint64_t i = 0; i < src->len; ++i){
+		if(!cr8r_wreservoir_push(&res, ft, src->buf + i*ft->base.size, weights[i])){
+			cr8r_wreservoir_delete(&res, ft);
+			return 0;
+		}
+	}
+	*dest = res.sample;
+	cr8r_vec_delete(&res.keys, &wres_keys_ft);
+	return 1;
+}
+
@@ -2,57 +2,234 @@
 
 #include <crater/sla.h>
 
+// make slab i the bump region, so its elements are handed out in order without ever being linked into the free list
+static void set_bump_slab(cr8r_sla *self, uint64_t i){
+	self->bump_slab = i;
+	self->bump = self->slabs[i].buf;
+	self->bump_end = self->bump + self->slabs[i].cap*self->elem_size;
+}
+
 bool cr8r_sla_init(cr8r_sla *self, uint64_t elem_size, uint64_t cap){
 	if(!cap || elem_size < sizeof(void*)){
 		return 0;
 	}
 	self->elem_size = elem_size;
-	char (*slab)[elem_size] = malloc(cap*elem_size);//start the allocator with one block of length cap
+	void *slab = malloc(cap*elem_size);//start the allocator with one block of length cap
 	if(!slab){
 		return 0;
-	}else if(!(self->slabs = malloc(1*sizeof(void*)))){//put slab in an array
+	}else if(!(self->slabs = malloc(1*sizeof(cr8r_sla_slab)))){//put slab in an array
 		free(slab);
 		return 0;
 	}
 	self->slab_cap = cap;
-	self->first_elem = self->slabs[0] = slab;
+	self->max_slab_cap = 0;
+	self->slabs[0] = (cr8r_sla_slab){slab, cap};
 	self->slabs_len = 1;
-	for(uint64_t i = 0; i + 1 < cap; ++i){//fill the stack with the pointers
-		*(void**)(slab + i) = slab + i + 1;
-	}
-	*(void**)(slab + cap - 1) = NULL;
+	CR8R_STATS_INC(sla_slabs_allocated);
+	self->first_elem = NULL;
+	set_bump_slab(self, 0);
 	return 1;
 }
 
 void cr8r_sla_delete(cr8r_sla *self){
 	for(uint64_t i = 0; i < self->slabs_len; ++i){
-		free(self->slabs[i]);
+		free(self->slabs[i].buf);
 	}
 	free(self->slabs);
 	*self = (cr8r_sla){};
 }
 
-void *cr8r_sla_alloc(cr8r_sla *self){
-	if(!self->first_elem){
-		uint64_t slab_cap = self->slab_cap << 1;
-		char (*slab)[self->elem_size] = malloc(slab_cap*self->elem_size);
-		void **slabs;
-		if(!slab){
-			return NULL;
-		}else if(!(slabs = realloc(self->slabs, (self->slabs_len + 1)*sizeof(void*)))){
-			free(slab);
-			return NULL;
-		}
-		self->first_elem = slabs[self->slabs_len++] = (void*)slab;
-		self->slabs = slabs;
-		for(uint64_t i = 0; i + 1 < slab_cap; ++i){
-			*(void**)(slab + i) = slab + i + 1;
-		}
-		*(void**)(slab + slab_cap - 1) = NULL;
+void cr8r_sla_reset(cr8r_sla *self, bool release){
+	if(!self->slabs_len){
+		return;
+	}
+	if(release){
+		for(uint64_t i = 1; i < self->slabs_len; ++i){
+			free(self->slabs[i].buf);
+		}
+		CR8R_STATS_ADD(sla_slabs_released, self->slabs_len - 1);
+		self->slabs_len = 1;
+		self->slab_cap = self->slabs[0].cap;
+		void *slabs = realloc(self->slabs, 1*sizeof(cr8r_sla_slab));
+		if(slabs){//shrinking should never fail, but keeping the old array is harmless if it does
+			self->slabs = slabs;
+		}
+	}
+	self->first_elem = NULL;
+	set_bump_slab(self, 0);
+}
+
+typedef struct{
+	char *start, *end;
+	uint64_t i;
+} slab_range;
+
+static int cmp_slab_ranges(const void *_a, const void *_b){
+	const slab_range *a = _a, *b = _b;
+	return a->start < b->start ? -1 : a->start > b->start;
+}
+
+// find the index of the slab containing p, or -1 if p is not in any slab
+static int64_t find_slab(const slab_range *ranges, uint64_t len, const char *p){
+	uint64_t a = 0, b = len;
+	while(a < b){
+		uint64_t m = a + (b - a)/2;
+		if(p < ranges[m].start){
+			b = m;
+		}else if(p >= ranges[m].end){
+			a = m + 1;
+		}else{
+			return ranges[m].i;
+		}
+	}
+	return -1;
+}
+
+// count the unallocated elements in each slab.  on success, the caller must free *_ranges and *_counts.
+// *_ranges is sorted by address so it can be used with find_slab
+static bool count_free(const cr8r_sla *self, slab_range **_ranges, uint64_t **_counts){
+	slab_range *ranges = malloc(self->slabs_len*sizeof(slab_range));
+	uint64_t *counts = calloc(self->slabs_len, sizeof(uint64_t));
+	if(!ranges || !counts){
+		free(ranges);
+		free(counts);
+		return 0;
+	}
+	for(uint64_t i = 0; i < self->slabs_len; ++i){
+		char *start = self->slabs[i].buf;
+		ranges[i] = (slab_range){start, start + self->slabs[i].cap*self->elem_size, i};
+	}
+	qsort(ranges, self->slabs_len, sizeof(slab_range), cmp_slab_ranges);
+	for(void *it = self->first_elem; it; it = *(void**)it){
+		int64_t i = find_slab(ranges, self->slabs_len, it);
+		if(i >= 0){//elements "freed" from outside any slab are left alone
+			++counts[i];
+		}
+	}
+	if(self->bump_slab < self->slabs_len){//elements in the bump region and the slabs after it have never been allocated
+		counts[self->bump_slab] += (self->bump_end - self->bump)/self->elem_size;
+		for(uint64_t i = self->bump_slab + 1; i < self->slabs_len; ++i){
+			counts[i] = self->slabs[i].cap;
+		}
+	}
+	*_ranges = ranges;
+	*_counts = counts;
+	return 1;
+}
+
+uint64_t cr8r_sla_trim(cr8r_sla *self){
+	slab_range *ranges;
+	uint64_t *counts;
+	if(self->slabs_len < 2 || !count_free(self, &ranges, &counts)){
+		return 0;
+	}
+	uint64_t released = 0;
+	for(uint64_t i = 1; i < self->slabs_len; ++i){
+		if(counts[i] == self->slabs[i].cap){
+			++released;
+		}
+	}
+	if(released){
+		void **link = &self->first_elem;
+		for(void *it = self->first_elem; it; it = *(void**)it){
+			int64_t i = find_slab(ranges, self->slabs_len, it);
+			if(i <= 0 || counts[i] != self->slabs[i].cap){
+				*link = it;
+				link = it;
+			}
+		}
+		*link = NULL;
+		uint64_t j = 1, slab_cap = self->slabs[0].cap, bump_slab = self->bump_slab ? UINT64_MAX : 0;
+		for(uint64_t i = 1; i < self->slabs_len; ++i){
+			if(counts[i] == self->slabs[i].cap){
+				free(self->slabs[i].buf);
+				continue;
+			}
+			if(self->slabs[i].cap > slab_cap){
+				slab_cap = self->slabs[i].cap;
+			}
+			if(i == self->bump_slab){
+				bump_slab = j;
+			}
+			self->slabs[j++] = self->slabs[i];
+		}
+		self->slabs_len = j;
+		if(bump_slab == UINT64_MAX){//the bump slab (and hence every slab after it) was released, so the next allocation must grow
+			self->bump = self->bump_end = NULL;
+			self->bump_slab = j - 1;
+		}else{
+			self->bump_slab = bump_slab;
+		}
 		self->slab_cap = slab_cap;
+		void *slabs = realloc(self->slabs, j*sizeof(cr8r_sla_slab));
+		if(slabs){
+			self->slabs = slabs;
+		}
 	}
+	free(ranges);
+	free(counts);
+	CR8R_STATS_ADD(sla_slabs_released, released);
+	return released;
+}
+
+void cr8r_sla_get_stats(const cr8r_sla *self, cr8r_sla_stats *stats){
+	*stats = (cr8r_sla_stats){.slabs = self->slabs_len};
+	for(uint64_t i = 0; i < self->slabs_len; ++i){
+		stats->cap += self->slabs[i].cap;
+	}
+	for(void *it = self->first_elem; it; it = *(void**)it){
+		++stats->free_listed;
+	}
+	if(self->bump_slab < self->slabs_len){
+		stats->untouched = (self->bump_end - self->bump)/self->elem_size;
+		for(uint64_t i = self->bump_slab + 1; i < self->slabs_len; ++i){
+			stats->untouched += self->slabs[i].cap;
+		}
+	}
+	stats->allocated = stats->cap - stats->free_listed - stats->untouched;
+	stats->fragmentation = stats->allocated + stats->free_listed ? (double)stats->free_listed/(stats->allocated + stats->free_listed) : 0.;
+	slab_range *ranges;
+	uint64_t *counts;
+	if(self->slabs_len && count_free(self, &ranges, &counts)){
+		for(uint64_t i = 1; i < self->slabs_len; ++i){
+			stats->free_slabs += counts[i] == self->slabs[i].cap;
+		}
+		free(ranges);
+		free(counts);
+	}
+}
+
+void *cr8r_sla_alloc(cr8r_sla *self){
 	void *ret = self->first_elem;
-	self->first_elem = *(void**)self->first_elem;
+	if(ret){
+		self->first_elem = *(void**)ret;
+		return ret;
+	}
+	if(self->bump == self->bump_end){
+		if(self->bump_slab + 1 < self->slabs_len){
+			set_bump_slab(self, self->bump_slab + 1);
+		}else{
+			uint64_t slab_cap = self->slab_cap << 1;
+			if(self->max_slab_cap && slab_cap > self->max_slab_cap){
+				slab_cap = self->max_slab_cap;
+			}
+			void *slab = malloc(slab_cap*self->elem_size);
+			cr8r_sla_slab *slabs;
+			if(!slab){
+				return NULL;
+			}else if(!(slabs = realloc(self->slabs, (self->slabs_len + 1)*sizeof(cr8r_sla_slab)))){
+				free(slab);
+				return NULL;
+			}
+			slabs[self->slabs_len++] = (cr8r_sla_slab){slab, slab_cap};
+			CR8R_STATS_INC(sla_slabs_allocated);
+			self->slabs = slabs;
+			self->slab_cap = slab_cap;
+			set_bump_slab(self, self->slabs_len - 1);
+		}
+	}
+	ret = self->bump;
+	self->bump += self->elem_size;
 	return ret;
 }
 
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <crater/stats.h>
+
+_Thread_local cr8r_counters cr8r_stats_counters;
+
+void cr8r_stats_dump(FILE *file){
+	const cr8r_counters *c = &cr8r_stats_counters;
+	#ifndef CR8R_STATS
+	fprintf(file, "(crater was compiled without CR8R_STATS, event counters are disabled)\n");
+	#endif
+	fprintf(file, "vec: %"PRIu64" grows, %"PRIu64" resizes\n", c->vec_grows, c->vec_resizes);
+	fprintf(file, "hash: %"PRIu64" resizes, %"PRIu64" moves, %"PRIu64" lookups, %"PRIu64" probes (%.3f per lookup)\n",
+		c->hash_resizes, c->hash_moves, c->hash_lookups, c->hash_probes, c->hash_lookups ? (double)c->hash_probes/c->hash_lookups : 0.);
+	fprintf(file, "avl: %"PRIu64" rotations\n", c->avl_rotations);
+	fprintf(file, "sla: %"PRIu64" slabs allocated, %"PRIu64" released\n", c->sla_slabs_allocated, c->sla_slabs_released);
+}
+
+void cr8r_stats_clear(){
+	cr8r_stats_counters = (cr8r_counters){};
+}
+
+void cr8r_hash_stats_dump(FILE *file, const cr8r_hash_stats *stats){
+	fprintf(file, "hash table: %"PRIu64"/%"PRIu64" slots full (%.3f), %"PRIu64" tombstones%s\n",
+		stats->len, stats->slots, stats->slots ? (double)stats->len/stats->slots : 0., stats->tombstones, stats->resizing ? ", resizing" : "");
+	fprintf(file, "probe length: avg %.3f, max %"PRIu64"\n", stats->avg_probe, stats->max_probe);
+	for(uint64_t i = 0; i < CR8R_STATS_PROBE_BUCKETS; ++i){
+		if(stats->probe_hist[i]){
+			fprintf(file, "  %2"PRIu64"%s: %"PRIu64"\n", i, i + 1 == CR8R_STATS_PROBE_BUCKETS ? "+" : " ", stats->probe_hist[i]);
+		}
+	}
+}
+
+void cr8r_avl_stats_dump(FILE *file, const cr8r_avl_stats *stats){
+	fprintf(file, "avl tree: %"PRIu64" nodes, height %"PRIu64", avg depth %.3f\n", stats->nodes, stats->height, stats->avg_depth);
+}
+
+void cr8r_sla_stats_dump(FILE *file, const cr8r_sla_stats *stats){
+	fprintf(file, "slab allocator: %"PRIu64" slabs, %"PRIu64"/%"PRIu64" elements allocated (%.3f), %"PRIu64" free listed, %"PRIu64" untouched\n",
+		stats->slabs, stats->allocated, stats->cap, stats->cap ? (double)stats->allocated/stats->cap : 0., stats->free_listed, stats->untouched);
+	fprintf(file, "fragmentation %.3f, %"PRIu64" slabs could be trimmed\n", stats->fragmentation, stats->free_slabs);
+}
+
@@ -3,6 +3,9 @@
 
 #include <crater/vec.h>
 #include <crater/heap.h>
+#include <crater/stats.h>
+
+#include "parallel.h"
 
 #ifdef DEBUG
 #include <crater/vec_check.h>
@@ -69,6 +72,7 @@ void cr8r_default_swap(cr8r_base_ft *base, void *a, void *b){
 }
 
 bool cr8r_vec_init(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t cap){
+	CR8R_STATS_INC(vec_resizes);
 	void *tmp = ft->resize(&ft->base, NULL, cap);
 	if(!tmp){
 		return !(cap && ft->base.size);
@@ -79,6 +83,7 @@ bool cr8r_vec_init(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t cap){
 
 void cr8r_vec_delete(cr8r_vec *self, cr8r_vec_ft *ft){
 	cr8r_vec_clear(self, ft);
+	CR8R_STATS_INC(vec_resizes);
 	ft->resize(&ft->base, self->buf, 0);
 	*self = (cr8r_vec){};
 }
@@ -111,6 +116,7 @@ bool cr8r_vec_resize(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t cap){
 	if(cap < self->len){
 		return 0;
 	}
+	CR8R_STATS_INC(vec_resizes);
 	void *tmp = ft->resize(&ft->base, self->buf, cap);
 	if(!tmp){
 		return !(cap && ft->base.size);
@@ -121,6 +127,7 @@ bool cr8r_vec_resize(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t cap){
 }
 
 bool cr8r_vec_trim(cr8r_vec *self, cr8r_vec_ft *ft){
+	CR8R_STATS_INC(vec_resizes);
 	void *tmp = ft->resize(&ft->base, self->buf, self->len);
 	if(!tmp){
 		if(!(self->len && ft->base.size)){
@@ -166,6 +173,7 @@ bool cr8r_vec_combine(cr8r_vec *dest, const cr8r_vec *src_a, const cr8r_vec *src
 bool cr8r_vec_augment(cr8r_vec *self, const cr8r_vec *other, cr8r_vec_ft *ft){
 	if(self->len + other->len > self->cap){
 		uint64_t cap = ft->new_size(&ft->base, self->cap);
+		CR8R_STATS_INC(vec_grows);
 		if(self->len + other->len > cap){
 			cap = self->len + other->len;
 		}
@@ -204,10 +212,167 @@ uint64_t cr8r_vec_len(cr8r_vec *self){
 }
 
 void cr8r_vec_shuffle(cr8r_vec *self, cr8r_vec_ft *ft, cr8r_prng *prng){
-	for(uint64_t i = self->len - 1, j; i; --i){
-		j = cr8r_prng_uniform_u64(prng, 0, i + 1);
-		ft->swap(&ft->base, self->buf + i*ft->base.size, self->buf + j*ft->base.size);
+	uint64_t js[256];
+	for(uint64_t i = self->len; i > 1;){
+		uint64_t n = i - 1 < 256 ? i - 1 : 256;
+		cr8r_prng_fill_fisher_yates(prng, i, n, js);
+		for(uint64_t k = 0; k < n; ++k){
+			--i;
+			ft->swap(&ft->base, self->buf + i*ft->base.size, self->buf + js[k]*ft->base.size);
+		}
+	}
+}
+
+// vectors with fewer bytes than this mostly fit in cache, so they are shuffled with plain Fisher-Yates
+#define SHUFFLE_BLOCKED_MIN (1ULL << 22)
+// target size in bytes of each bucket of the blocked shuffle, so that shuffling a bucket stays in cache
+#define SHUFFLE_BUCKET_SIZE (1ULL << 18)
+// with more buckets than this, scattering elements to them thrashes the tlb
+#define SHUFFLE_MAX_BUCKETS (1ULL << 9)
+
+typedef struct{
+	cr8r_vec *self;
+	cr8r_vec_ft *ft;
+	void *scratch;
+	cr8r_prng *prng;
+	void *prng_start;// copy of prng->state from before phase 0
+	uint64_t num_buckets;
+	uint64_t a, b;// elements assigned to buckets by this task
+	uint64_t bucket_a, bucket_b;// buckets shuffled by this task
+	uint64_t *counts;// number of elements of [a, b) in each bucket, then the next index in scratch for each bucket
+	const uint64_t *bucket_starts;// start of each bucket in scratch, with an extra entry for the end of the last one
+	int phase;
+} par_shuffle_task;
+
+// always inlined so that common element sizes get specialized copies where memcpy is a single load and store
+static inline __attribute__((always_inline)) void par_shuffle_work(par_shuffle_task *task, uint64_t size){
+	uint64_t idxs[256];
+	if(task->phase == 2){
+		// "inside out" Fisher-Yates, which shuffles the bucket while copying it back from scratch.
+		// Element i is swapped with a random j <= i, so the indices for [i, i + n) are generated in reverse
+		for(uint64_t k = task->bucket_a; k < task->bucket_b; ++k){
+			uint64_t a = task->bucket_starts[k], len = task->bucket_starts[k + 1] - a;
+			void *dst = task->self->buf + a*size;
+			const void *src = task->scratch + a*size;
+			for(uint64_t i = 0; i < len;){
+				uint64_t n = len - i < 256 ? len - i : 256;
+				cr8r_prng_fill_fisher_yates(task->prng, i + n, n, idxs);
+				for(uint64_t l = n; l--; ++i){
+					uint64_t j = idxs[l];
+					if(j != i){
+						memcpy(dst + i*size, dst + j*size, size);
+					}
+					memcpy(dst + j*size, src + i*size, size);
+				}
+			}
+		}
+		return;
+	}
+	// phase 1 regenerates the same buckets as phase 0 instead of storing them
+	if(task->phase == 0){
+		memcpy(task->prng_start, task->prng->state, task->prng->state_size);
+	}else{
+		memcpy(task->prng->state, task->prng_start, task->prng->state_size);
+	}
+	for(uint64_t i = task->a; i < task->b;){
+		uint64_t n = task->b - i < 256 ? task->b - i : 256;
+		cr8r_prng_fill_uniform_u64(task->prng, 0, task->num_buckets, n, idxs);
+		for(uint64_t j = 0; j < n; ++j, ++i){
+			if(task->phase == 0){
+				++task->counts[idxs[j]];
+			}else{
+				memcpy(task->scratch + task->counts[idxs[j]]++*size, task->self->buf + i*size, size);
+			}
+		}
+	}
+}
+
+static void *par_shuffle_worker(void *_task){
+	par_shuffle_task *task = _task;
+	switch(task->ft->base.size){
+		case 4: par_shuffle_work(task, 4); break;
+		case 8: par_shuffle_work(task, 8); break;
+		case 16: par_shuffle_work(task, 16); break;
+		default: par_shuffle_work(task, task->ft->base.size);
+	}
+	return NULL;
+}
+
+// Scatter the elements into random buckets, then shuffle each bucket.  Since every element independently goes to a
+// uniformly random bucket, this gives a uniformly random permutation (Rao and Sandelius).
+// Each task has its own multi lane xoroshiro generator seeded from the caller's prng.
+void cr8r_vec_shuffle_mt(cr8r_vec *self, cr8r_vec_ft *ft, cr8r_prng *prng, uint64_t threads){
+	uint64_t size = ft->base.size;
+	if(self->len*size < SHUFFLE_BLOCKED_MIN){
+		cr8r_vec_shuffle(self, ft, prng);
+		return;
+	}
+	uint64_t num_buckets = self->len*size/SHUFFLE_BUCKET_SIZE;
+	if(num_buckets > SHUFFLE_MAX_BUCKETS){
+		num_buckets = SHUFFLE_MAX_BUCKETS;
+	}
+	if(!threads){
+		threads = 1;
+	}else if(threads > num_buckets){
+		threads = num_buckets;
+	}
+	void *scratch = malloc(self->len*size);
+	uint64_t *counts = calloc((threads + 1)*num_buckets + 1, sizeof(uint64_t));
+	par_shuffle_task *tasks = calloc(threads, sizeof(par_shuffle_task));
+	uint64_t started = 0;
+	if(scratch && counts && tasks){
+		for(; started < threads; ++started){
+			cr8r_prng *task_prng = cr8r_prng_init_xoro_lanes(cr8r_prng_get_u64(prng));
+			void *prng_start = task_prng ? malloc(task_prng->state_size) : NULL;
+			if(!prng_start){
+				free(task_prng);
+				break;
+			}
+			tasks[started] = (par_shuffle_task){
+				.self = self, .ft = ft, .scratch = scratch, .prng = task_prng, .prng_start = prng_start, .num_buckets = num_buckets,
+				.a = started*self->len/threads, .b = (started + 1)*self->len/threads,
+				.bucket_a = started*num_buckets/threads, .bucket_b = (started + 1)*num_buckets/threads,
+				.counts = counts + num_buckets + 1 + started*num_buckets, .bucket_starts = counts
+			};
+		}
+	}
+	if(started != threads){
+		for(uint64_t i = 0; i < started; ++i){
+			free(tasks[i].prng);
+			free(tasks[i].prng_start);
+		}
+		free(scratch);
+		free(counts);
+		free(tasks);
+		cr8r_vec_shuffle(self, ft, prng);
+		return;
+	}
+	cr8r_run_parallel(par_shuffle_worker, tasks, sizeof(par_shuffle_task), threads);
+	// counts holds the start of each bucket, followed by the counts for each task
+	for(uint64_t k = 0, off = 0; k < num_buckets; ++k){
+		counts[k] = off;
+		for(uint64_t i = 0; i < threads; ++i){
+			uint64_t count = tasks[i].counts[k];
+			tasks[i].counts[k] = off;
+			off += count;
+		}
+	}
+	counts[num_buckets] = self->len;
+	for(uint64_t i = 0; i < threads; ++i){
+		tasks[i].phase = 1;
+	}
+	cr8r_run_parallel(par_shuffle_worker, tasks, sizeof(par_shuffle_task), threads);
+	for(uint64_t i = 0; i < threads; ++i){
+		tasks[i].phase = 2;
+	}
+	cr8r_run_parallel(par_shuffle_worker, tasks, sizeof(par_shuffle_task), threads);
+	for(uint64_t i = 0; i < threads; ++i){
+		free(tasks[i].prng);
+		free(tasks[i].prng_start);
 	}
+	free(scratch);
+	free(counts);
+	free(tasks);
 }
 
 bool cr8r_vec_ensure_cap(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t cap){
@@ -216,6 +381,8 @@ bool cr8r_vec_ensure_cap(cr8r_vec *self, cr8r_vec_ft *ft, uint64_t cap){
 		if(cap > new_cap){
 			new_cap = cap;
 		}
+		CR8R_STATS_INC(vec_grows);
+		CR8R_STATS_INC(vec_resizes);
 		void *tmp = ft->resize(&ft->base, self->buf, new_cap);
 		if(!tmp){
 			return !ft->base.size;
@@ -0,0 +1,227 @@
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <crater/vp_tree.h>
+#include <crater/heap.h>
+
+typedef struct{
+	double dist;
+	uint64_t idx;
+} candidate;
+
+typedef struct{
+	const cr8r_vp_tree *tree;
+	const cr8r_vec *ents;
+	cr8r_vp_ft *ft;
+	const void *pt;
+	uint64_t k;
+	cr8r_vec *heap;// max heap of candidates
+} vp_knn_state;
+
+typedef struct{
+	const cr8r_vp_tree *tree;
+	const cr8r_vec *ents;
+	cr8r_vp_ft *ft;
+	const void *pt;
+	double r;
+	cr8r_vec *out;// NULL when only counting
+	uint64_t count;
+} vp_range_state;
+
+static int cmp_candidates(const cr8r_base_ft *ft, const void *_a, const void *_b){
+	const candidate *a = _a, *b = _b;
+	return (a->dist > b->dist) - (a->dist < b->dist);
+}
+
+static cr8r_vec_ft candidate_ft = {
+	.base.size = sizeof(candidate),
+	.new_size = cr8r_default_new_size,
+	.resize = cr8r_default_resize,
+	.cmp = cmp_candidates,
+	.swap = cr8r_default_swap
+};
+
+// boundary between the inner and outer subtrees of the subtree [a, b)
+static inline uint64_t vp_split_idx(uint64_t a, uint64_t b){
+	return a + 1 + (b - a - 1)/2;
+}
+
+static void swap_ents(cr8r_vec *ents, cr8r_vp_ft *ft, double *dists, uint64_t i, uint64_t j){
+	ft->super.swap(&ft->super.base, ents->buf + i*ft->super.base.size, ents->buf + j*ft->super.base.size);
+	double tmp = dists[i];
+	dists[i] = dists[j];
+	dists[j] = tmp;
+}
+
+// quickselect on [a, b) by the distances in dists, moving the points along with their distances,
+// so that dists[m] is the m - a smallest and everything before/after it is at most/at least dists[m]
+static void select_dist(cr8r_vec *ents, cr8r_vp_ft *ft, double *dists, uint64_t a, uint64_t b, uint64_t m){
+	while(b - a > 1){
+		double piv = dists[a + (b - a - 1)/2];
+		// hoare partition: afterwards [a, j] is at most piv and [j + 1, b) is at least piv
+		uint64_t i = a, j = b - 1;
+		while(1){
+			while(dists[i] < piv){
+				++i;
+			}
+			while(dists[j] > piv){
+				--j;
+			}
+			if(i >= j){
+				break;
+			}
+			swap_ents(ents, ft, dists, i++, j--);
+		}
+		if(m <= j){
+			b = j + 1;
+		}else{
+			a = j + 1;
+		}
+	}
+}
+
+static void build_r(cr8r_vp_tree *self, cr8r_vec *ents, cr8r_vp_ft *ft, double *dists, uint64_t a, uint64_t b){
+	while(b - a > 1){
+		// the input is usually in no particular order, so any point is as good a vantage point as any other
+		swap_ents(ents, ft, dists, a, (a + b)/2);
+		const void *vp = ents->buf + a*ft->super.base.size;
+		for(uint64_t i = a + 1; i < b; ++i){
+			dists[i] = ft->dist(ft, vp, ents->buf + i*ft->super.base.size);
+		}
+		uint64_t m = vp_split_idx(a, b);
+		select_dist(ents, ft, dists, a + 1, b, m);
+		self->radii[a] = dists[m];
+		build_r(self, ents, ft, dists, a + 1, m);
+		a = m;
+	}
+	if(b > a){
+		self->radii[a] = 0;
+	}
+}
+
+bool cr8r_vp_build(cr8r_vp_tree *self, cr8r_vec *ents, cr8r_vp_ft *ft){
+	*self = (cr8r_vp_tree){.len = ents->len};
+	double *dists = malloc(ents->len*sizeof(double) ?: 1);
+	if(!dists || !(self->radii = malloc(ents->len*sizeof(double) ?: 1))){
+		free(dists);
+		return 0;
+	}
+	build_r(self, ents, ft, dists, 0, ents->len);
+	free(dists);
+	return 1;
+}
+
+void cr8r_vp_delete(cr8r_vp_tree *self){
+	free(self->radii);
+	*self = (cr8r_vp_tree){};
+}
+
+static void consider(vp_knn_state *st, double dist, uint64_t idx){
+	if(st->heap->len < st->k){
+		cr8r_heap_push(st->heap, &candidate_ft, &(candidate){dist, idx}, 1);
+	}else{
+		candidate *top = cr8r_heap_top(st->heap, &candidate_ft);
+		if(dist < top->dist){
+			*top = (candidate){dist, idx};
+			cr8r_heap_sift_down(st->heap, &candidate_ft, top, 1);
+		}
+	}
+}
+
+static double kth_dist(const vp_knn_state *st){
+	if(st->heap->len < st->k){
+		return INFINITY;
+	}
+	return ((const candidate*)cr8r_heap_top(st->heap, &candidate_ft))->dist;
+}
+
+static void knn_r(vp_knn_state *st, uint64_t a, uint64_t b){
+	while(b > a){
+		double d = st->ft->dist(st->ft, st->pt, st->ents->buf + a*st->ft->super.base.size);
+		consider(st, d, a);
+		double mu = st->tree->radii[a];
+		uint64_t m = vp_split_idx(a, b);
+		// points in the inner subtree are within mu of the vantage point and points in the outer subtree are at least mu
+		// from it, so by the triangle inequality they are at least d - mu and mu - d from pt respectively
+		if(d < mu){
+			knn_r(st, a + 1, m);
+			if(d + kth_dist(st) < mu){
+				return;
+			}
+			a = m;
+		}else{
+			knn_r(st, m, b);
+			if(d - kth_dist(st) > mu){
+				return;
+			}
+			++a;
+			b = m;
+		}
+	}
+}
+
+bool cr8r_vp_k_closest(const cr8r_vp_tree *self, const cr8r_vec *ents, cr8r_vp_ft *ft, const void *pt, uint64_t k, cr8r_vec *out){
+	cr8r_vec_clear(out, &ft->super);
+	if(!cr8r_vec_ensure_cap(out, &ft->super, k)){
+		return false;
+	}
+	cr8r_vec heap;
+	if(!cr8r_vec_init(&heap, &candidate_ft, k + 1)){
+		return false;
+	}
+	vp_knn_state st = {.tree = self, .ents = ents, .ft = ft, .pt = pt, .k = k, .heap = &heap};
+	if(k){
+		knn_r(&st, 0, self->len);
+	}
+	// popping from the max heap gives the candidates from farthest to closest
+	out->len = heap.len;
+	for(candidate c; heap.len;){
+		cr8r_heap_pop(&heap, &candidate_ft, &c, 1);
+		memcpy(out->buf + heap.len*ft->super.base.size, ents->buf + c.idx*ft->super.base.size, ft->super.base.size);
+	}
+	cr8r_vec_delete(&heap, &candidate_ft);
+	return true;
+}
+
+static bool range_r(vp_range_state *st, uint64_t a, uint64_t b){
+	while(b > a){
+		const void *vp = st->ents->buf + a*st->ft->super.base.size;
+		double d = st->ft->dist(st->ft, st->pt, vp);
+		if(d <= st->r){
+			++st->count;
+			if(st->out && !cr8r_vec_pushr(st->out, &st->ft->super, vp)){
+				return false;
+			}
+		}
+		double mu = st->tree->radii[a];
+		uint64_t m = vp_split_idx(a, b);
+		bool inner = d - st->r <= mu, outer = d + st->r >= mu;
+		if(inner && outer){
+			if(!range_r(st, a + 1, m)){
+				return false;
+			}
+			a = m;
+		}else if(inner){
+			++a;
+			b = m;
+		}else{
+			a = m;
+		}
+	}
+	return true;
+}
+
+bool cr8r_vp_within_radius(const cr8r_vp_tree *self, const cr8r_vec *ents, cr8r_vp_ft *ft, const void *pt, double r, cr8r_vec *out){
+	cr8r_vec_clear(out, &ft->super);
+	vp_range_state st = {.tree = self, .ents = ents, .ft = ft, .pt = pt, .r = r, .out = out};
+	return range_r(&st, 0, self->len);
+}
+
+uint64_t cr8r_vp_count_within_radius(const cr8r_vp_tree *self, const cr8r_vec *ents, cr8r_vp_ft *ft, const void *pt, double r){
+	vp_range_state st = {.tree = self, .ents = ents, .ft = ft, .pt = pt, .r = r};
+	range_r(&st, 0, self->len);
+	return st.count;
+}
+
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <crater/arena.h>
+#include <crater/vec.h>
+#include <crater/hash.h>
+#include <crater/avl.h>
+
+#define NUM_ELEMS 10000
+#define NUM_ROUNDS 4
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_arena arena [[gnu::cleanup(cr8r_arena_delete)]];
+	cr8r_arena_init(&arena);
+	cr8r_vec_ft vecft = cr8r_vecft_u64;
+	vecft.base.data = &arena;
+	vecft.resize = cr8r_default_resize_arena;
+	cr8r_hashtbl_ft htft = cr8r_htft_u64_u64;
+	htft.base.data = &arena;
+	htft.alloc = cr8r_default_alloc_arena;
+	htft.free = cr8r_default_free_arena;
+	cr8r_avl_ft avlft;
+	cr8r_avl_ft_init(&avlft, &arena, sizeof(uint64_t), cr8r_default_cmp_u64, NULL, cr8r_default_alloc_arena_avl, cr8r_default_free_arena_avl);
+	for(uint64_t round = 0; round < NUM_ROUNDS; ++round){
+		fprintf(stderr, "\e[1;34mFilling vector, hash table, and avl tree from one arena (round %"PRIu64")...\e[0m\n", round);
+		cr8r_vec vec;
+		cr8r_hashtbl_t ht;
+		cr8r_avl_node *avl = NULL;
+		if(!cr8r_vec_init(&vec, &vecft, 1) || !cr8r_hash_init(&ht, &htft, 1)){
+			fprintf(stderr, "\e[1;31mERROR: Could not allocate containers from arena!\e[0m\n");
+			exit(1);
+		}
+		bool ok = true;
+		for(uint64_t i = 0; i < NUM_ELEMS && ok; ++i){
+			uint64_t ent[2] = {i, i*i};
+			int status;
+			ok = cr8r_vec_pushr(&vec, &vecft, &i) && cr8r_hash_insert(&ht, &htft, ent, &status) && status == 1 && cr8r_avl_insert(&avl, &i, &avlft);
+		}
+		++tested;
+		if(!ok){
+			fprintf(stderr, "\e[1;31mAllocation from arena failed!\e[0m\n");
+		}else{
+			for(uint64_t i = 0; i < NUM_ELEMS && ok; ++i){
+				uint64_t *ent = cr8r_hash_get(&ht, &htft, &i);
+				cr8r_avl_node *n = cr8r_avl_get(avl, &i, &avlft);
+				ok = *(uint64_t*)cr8r_vec_get(&vec, &vecft, i) == i && ent && ent[1] == i*i && n && *(uint64_t*)n->data == i;
+			}
+			if(ok){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31mContainers backed by arena lost elements!\e[0m\n");
+			}
+		}
+		if(round&1){
+			cr8r_arena_reset(&arena, round == NUM_ROUNDS - 1);
+		}else{
+			cr8r_vec_delete(&vec, &vecft);
+			cr8r_hash_destroy(&ht, &htft);
+			cr8r_avl_delete(avl, &avlft);
+		}
+	}
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
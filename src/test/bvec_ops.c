@@ -0,0 +1,304 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include <crater/prand.h>
+#include <crater/bitvec.h>
+
+// lengths just below, at, and above word and vector boundaries, and long enough to span several blocks in the _many functions
+static const uint64_t lens[] = {0, 1, 63, 64, 65, 511, 512, 513, 1000, 4097, 300001};
+#define NUM_LENS (sizeof(lens)/sizeof(*lens))
+#define NUM_MANY 7
+#define BENCH_BITS (1ull << 26)
+#define BENCH_MANY 16
+
+enum{OP_AND, OP_OR, OP_XOR, OP_ANDNOT, OP_COMPL};
+static const char *op_names[] = {"iand", "ior", "ixor", "iandnot", "icompl"};
+
+// Fill the whole buffer, including bits past the end, so that the functions have to ignore them
+static bool random_bvec(cr8r_bvec *self, uint64_t len, cr8r_prng *prng){
+	if(!cr8r_bvec_init(self, &cr8r_bvecft, len)){
+		return false;
+	}
+	cr8r_prng_get_bytes(prng, self->cap/8, self->buf);
+	self->len = len;
+	return true;
+}
+
+static bool ref_get(const cr8r_bvec *self, uint64_t i){
+	return i < self->len && cr8r_bvec_getu((cr8r_bvec*)self, i);
+}
+
+static bool ref_op(int op, bool a, bool b){
+	switch(op){
+		case OP_AND: return a && b;
+		case OP_OR: return a || b;
+		case OP_XOR: return a != b;
+		case OP_ANDNOT: return a && !b;
+		default: return !a;
+	}
+}
+
+static void apply_op(int op, cr8r_bvec *a, const cr8r_bvec *b){
+	switch(op){
+		case OP_AND: cr8r_bvec_iand(a, b); break;
+		case OP_OR: cr8r_bvec_ior(a, b); break;
+		case OP_XOR: cr8r_bvec_ixor(a, b); break;
+		case OP_ANDNOT: cr8r_bvec_iandnot(a, b); break;
+		default: cr8r_bvec_icompl(a);
+	}
+}
+
+static int ref_cmp(const cr8r_bvec *a, const cr8r_bvec *b){
+	for(uint64_t i = a->len > b->len ? a->len : b->len; i-- > 0;){
+		bool x = ref_get(a, i), y = ref_get(b, i);
+		if(x != y){
+			return x ? 1 : -1;
+		}
+	}
+	return 0;
+}
+
+static bool same_bits(const cr8r_bvec *a, const cr8r_bvec *b){
+	if(a->len != b->len){
+		return false;
+	}
+	for(uint64_t i = 0; i < a->len; ++i){
+		if(ref_get(a, i) != ref_get(b, i)){
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool test_op(int op, const cr8r_bvec *a, const cr8r_bvec *b){
+	cr8r_bvec res;
+	if(!cr8r_bvec_copy(&res, a, &cr8r_bvecft)){
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return false;
+	}
+	apply_op(op, &res, b);
+	bool ok = res.len == a->len;
+	for(uint64_t i = 0; ok && i < a->len; ++i){
+		ok = ref_get(&res, i) == ref_op(op, ref_get(a, i), ref_get(b, i));
+	}
+	if(!ok){
+		fprintf(stderr, "\e[1;31m%s is wrong for lengths %"PRIu64" and %"PRIu64"!\e[0m\n", op_names[op], a->len, b->len);
+	}
+	cr8r_bvec_delete(&res, &cr8r_bvecft);
+	return ok;
+}
+
+static bool test_counts(const cr8r_bvec *a, const cr8r_bvec *b){
+	uint64_t pop = 0, pop_and = 0;
+	for(uint64_t i = 0; i < a->len; ++i){
+		pop += ref_get(a, i);
+		pop_and += ref_get(a, i) && ref_get(b, i);
+	}
+	bool ok = true;
+	if(cr8r_bvec_popcount(a) != pop){
+		fprintf(stderr, "\e[1;31mpopcount is wrong for length %"PRIu64"!\e[0m\n", a->len);
+		ok = false;
+	}
+	if(cr8r_bvec_popcount_and(a, b) != pop_and || cr8r_bvec_popcount_and(b, a) != pop_and){
+		fprintf(stderr, "\e[1;31mpopcount_and is wrong for lengths %"PRIu64" and %"PRIu64"!\e[0m\n", a->len, b->len);
+		ok = false;
+	}
+	return ok;
+}
+
+// Compare a with b, and with copies of a with one bit flipped near the top, middle, and bottom
+static bool test_cmp(const cr8r_bvec *a, const cr8r_bvec *b){
+	bool ok = cr8r_bvec_cmp(a, b) == ref_cmp(a, b) && !cr8r_bvec_cmp(a, a);
+	cr8r_bvec c;
+	if(!cr8r_bvec_copy(&c, a, &cr8r_bvecft)){
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return false;
+	}
+	for(uint64_t j = 1; ok && j <= 3 && a->len; ++j){
+		uint64_t i = (a->len - 1)*j/3;
+		cr8r_bvec_setu(&c, i, !cr8r_bvec_getu(&c, i));
+		ok = cr8r_bvec_cmp(a, &c) == ref_cmp(a, &c) && cr8r_bvec_cmp(&c, a) == ref_cmp(&c, a);
+		cr8r_bvec_setu(&c, i, !cr8r_bvec_getu(&c, i));
+	}
+	if(!ok){
+		fprintf(stderr, "\e[1;31mcmp is wrong for lengths %"PRIu64" and %"PRIu64"!\e[0m\n", a->len, b->len);
+	}
+	cr8r_bvec_delete(&c, &cr8r_bvecft);
+	return ok;
+}
+
+// The _many functions should match applying the single operand function to each operand in turn
+static bool test_many(const cr8r_bvec *a, const cr8r_bvec *const *others, bool is_or){
+	cr8r_bvec res, expected;
+	if(!cr8r_bvec_copy(&res, a, &cr8r_bvecft)){
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return false;
+	}else if(!cr8r_bvec_copy(&expected, a, &cr8r_bvecft)){
+		cr8r_bvec_delete(&res, &cr8r_bvecft);
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return false;
+	}
+	for(uint64_t i = 0; i < NUM_MANY; ++i){
+		apply_op(is_or ? OP_OR : OP_AND, &expected, others[i]);
+	}
+	if(is_or){
+		cr8r_bvec_ior_many(&res, others, NUM_MANY);
+	}else{
+		cr8r_bvec_iand_many(&res, others, NUM_MANY);
+	}
+	bool ok = same_bits(&res, &expected);
+	if(!ok){
+		fprintf(stderr, "\e[1;31m%s is wrong for length %"PRIu64"!\e[0m\n", is_or ? "ior_many" : "iand_many", a->len);
+	}
+	cr8r_bvec_delete(&res, &cr8r_bvecft);
+	cr8r_bvec_delete(&expected, &cr8r_bvecft);
+	return ok;
+}
+
+// Operating on a vector with itself is allowed, including passing it in the others array of the _many functions
+static bool test_aliased(const cr8r_bvec *a, const cr8r_bvec *b){
+	bool ok = true;
+	for(int op = OP_AND; ok && op <= OP_ANDNOT; ++op){
+		cr8r_bvec res;
+		if(!cr8r_bvec_copy(&res, a, &cr8r_bvecft)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return false;
+		}
+		apply_op(op, &res, &res);
+		for(uint64_t i = 0; ok && i < a->len; ++i){
+			ok = ref_get(&res, i) == ref_op(op, ref_get(a, i), ref_get(a, i));
+		}
+		if(!ok){
+			fprintf(stderr, "\e[1;31m%s is wrong for a vector of length %"PRIu64" with itself!\e[0m\n", op_names[op], a->len);
+		}
+		cr8r_bvec_delete(&res, &cr8r_bvecft);
+	}
+	for(int is_or = 0; ok && is_or < 2; ++is_or){
+		cr8r_bvec res;
+		if(!cr8r_bvec_copy(&res, a, &cr8r_bvecft)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return false;
+		}
+		const cr8r_bvec *others[2] = {&res, b};
+		if(is_or){
+			cr8r_bvec_ior_many(&res, others, 2);
+		}else{
+			cr8r_bvec_iand_many(&res, others, 2);
+		}
+		for(uint64_t i = 0; ok && i < a->len; ++i){
+			ok = ref_get(&res, i) == ref_op(is_or ? OP_OR : OP_AND, ref_get(a, i), ref_get(b, i));
+		}
+		if(!ok){
+			fprintf(stderr, "\e[1;31m%s is wrong when self is one of the others, for length %"PRIu64"!\e[0m\n", is_or ? "ior_many" : "iand_many", a->len);
+		}
+		cr8r_bvec_delete(&res, &cr8r_bvecft);
+	}
+	return ok;
+}
+
+static double elapsed(const struct timespec *start){
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (double)(end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec)*1e-9;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_prng *prng = cr8r_prng_init_lcg(0x2b7e151628aed2a6);
+	cr8r_bvec vecs[NUM_LENS];
+	if(!prng){
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return 1;
+	}
+	for(uint64_t i = 0; i < NUM_LENS; ++i){
+		if(!random_bvec(vecs + i, lens[i], prng)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return 1;
+		}
+	}
+
+	fprintf(stderr, "\e[1;34mTesting bitwise operations on all pairs of %zu lengths...\e[0m\n", NUM_LENS);
+	for(uint64_t i = 0; i < NUM_LENS; ++i){
+		for(uint64_t j = 0; j < NUM_LENS; ++j){
+			for(int op = OP_AND; op <= OP_COMPL; ++op){
+				++tested;
+				passed += test_op(op, vecs + i, vecs + j);
+			}
+			tested += 2;
+			passed += test_counts(vecs + i, vecs + j);
+			passed += test_cmp(vecs + i, vecs + j);
+		}
+	}
+
+	fprintf(stderr, "\e[1;34mTesting iand_many and ior_many with %d operands...\e[0m\n", NUM_MANY);
+	for(uint64_t i = 0; i < NUM_LENS; ++i){
+		const cr8r_bvec *others[NUM_MANY];
+		for(uint64_t j = 0; j < NUM_MANY; ++j){
+			others[j] = vecs + (i + 3*j + 1)%NUM_LENS;
+		}
+		tested += 2;
+		passed += test_many(vecs + i, others, true);
+		passed += test_many(vecs + i, others, false);
+	}
+
+	fprintf(stderr, "\e[1;34mTesting operations on vectors with themselves...\e[0m\n");
+	for(uint64_t i = 0; i < NUM_LENS; ++i){
+		++tested;
+		passed += test_aliased(vecs + i, vecs + (i + 5)%NUM_LENS);
+	}
+	for(uint64_t i = 0; i < NUM_LENS; ++i){
+		cr8r_bvec_delete(vecs + i, &cr8r_bvecft);
+	}
+
+	fprintf(stderr, "\e[1;34mTiming %d bit vectors of %llu bits...\e[0m\n", BENCH_MANY, BENCH_BITS);
+	{
+		cr8r_bvec bench[BENCH_MANY + 1];
+		const cr8r_bvec *others[BENCH_MANY];
+		for(uint64_t i = 0; i <= BENCH_MANY; ++i){
+			if(!random_bvec(bench + i, BENCH_BITS, prng)){
+				fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+				return 1;
+			}
+			if(i){
+				others[i - 1] = bench + i;
+			}
+		}
+		struct timespec start;
+		uint64_t total = 0;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(uint64_t i = 0; i < BENCH_MANY; ++i){
+			total += cr8r_bvec_popcount_and(bench, others[i]);
+		}
+		double secs = elapsed(&start);
+		fprintf(stderr, "\e[1;33mpopcount_and: %f GB/s (mean %f)\e[0m\n", 2.*BENCH_MANY*BENCH_BITS/8/secs*1e-9, (double)total/BENCH_MANY/BENCH_BITS);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		cr8r_bvec_ior_many(bench, others, BENCH_MANY);
+		secs = elapsed(&start);
+		fprintf(stderr, "\e[1;33mior_many: %f GB/s\e[0m\n", (double)BENCH_MANY*BENCH_BITS/8/secs*1e-9);
+		// every bit set in an operand should be set in the result
+		bool ok = true;
+		for(uint64_t i = 0; ok && i < BENCH_MANY; ++i){
+			ok = cr8r_bvec_popcount_and(bench, others[i]) == cr8r_bvec_popcount(others[i]);
+		}
+		++tested;
+		if(ok){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mior_many missed some bits!\e[0m\n");
+		}
+		for(uint64_t i = 0; i <= BENCH_MANY; ++i){
+			cr8r_bvec_delete(bench + i, &cr8r_bvecft);
+		}
+	}
+
+	free(prng);
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include <crater/prand.h>
+#include <crater/bitvec.h>
+#include <crater/rank_select.h>
+
+#define NUM_EDITS 300
+#define CHECK_EVERY 25
+#define BENCH_BITS (1ull << 26)
+#define BENCH_QUERIES (1ull << 22)
+
+// Make a bit vector where each bit is set with probability p, except for the bits in [clear_a, clear_b) which are cleared.
+// The bits past the end are random so the index has to ignore them.
+static bool random_bvec(cr8r_bvec *self, uint64_t len, double p, uint64_t clear_a, uint64_t clear_b, cr8r_prng *prng){
+	if(!cr8r_bvec_init(self, &cr8r_bvecft, len)){
+		return false;
+	}
+	cr8r_prng_get_bytes(prng, self->cap/8, self->buf);
+	self->len = len;
+	if(p != .5){
+		for(uint64_t i = 0; i < len; ++i){
+			cr8r_bvec_setu(self, i, cr8r_prng_uniform01_double(prng) < p);
+		}
+	}
+	if(clear_a < clear_b){
+		cr8r_bvec_set_range(self, clear_a, clear_b, 0);
+	}
+	return true;
+}
+
+// Check rank at every position and select for every set bit against a linear scan
+static bool check_rs(const char *name, const cr8r_bvec_rs *rs, cr8r_bvec *bvec){
+	uint64_t ones = 0;
+	for(uint64_t i = 0; i < bvec->len; ++i){
+		if(cr8r_bvec_rank(rs, bvec, i) != ones){
+			fprintf(stderr, "\e[1;31m%s: rank(%"PRIu64") is wrong!\e[0m\n", name, i);
+			return false;
+		}
+		if(cr8r_bvec_getu(bvec, i)){
+			if(cr8r_bvec_select(rs, bvec, ones) != i){
+				fprintf(stderr, "\e[1;31m%s: select(%"PRIu64") is wrong!\e[0m\n", name, ones);
+				return false;
+			}
+			++ones;
+		}
+	}
+	if(rs->ones != ones || cr8r_bvec_rank(rs, bvec, bvec->len) != ones || cr8r_bvec_select(rs, bvec, ones) != bvec->len){
+		fprintf(stderr, "\e[1;31m%s: the total or the end is wrong!\e[0m\n", name);
+		return false;
+	}
+	return true;
+}
+
+// An updated index should be exactly the same as one built from scratch
+static bool same_rs(const cr8r_bvec_rs *a, const cr8r_bvec_rs *b){
+	return a->len == b->len && a->ones == b->ones && a->num_blocks == b->num_blocks && a->num_samples == b->num_samples &&
+		!memcmp(a->blocks, b->blocks, a->num_blocks*sizeof(uint64_t)) &&
+		!memcmp(a->regions, b->regions, ((a->num_blocks + (1ull << 21) - 1) >> 21)*sizeof(uint64_t)) &&
+		!memcmp(a->samples, b->samples, a->num_samples*sizeof(uint32_t));
+}
+
+static double elapsed(const struct timespec *start){
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (double)(end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec)*1e-9;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_prng *prng = cr8r_prng_init_lcg(0x5be0cd19137e2179);
+	if(!prng){
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return 1;
+	}
+
+	// lengths around block and sub block boundaries, very sparse and dense vectors, and long runs of zeros
+	// so select has to scan past blocks with no set bits
+	const struct{uint64_t len; double p; uint64_t clear_a, clear_b;} cases[] = {
+		{0, .5, 0, 0}, {1, .5, 0, 0}, {64, .5, 0, 0}, {511, .5, 0, 0}, {2047, .5, 0, 0}, {2048, .5, 0, 0}, {2049, .5, 0, 0},
+		{100003, .5, 0, 0}, {100003, .001, 0, 0}, {100003, .999, 0, 0}, {300000, 0, 0, 0}, {300000, 1, 0, 0},
+		{(1ull << 22) + 17, .5, 10000, (1ull << 22) - 10000}, {(1ull << 22) + 17, .5, 0, 1ull << 21}
+	};
+	for(uint64_t c = 0; c < sizeof(cases)/sizeof(*cases); ++c){
+		char name[96];
+		snprintf(name, sizeof(name), "len %"PRIu64", p %g", cases[c].len, cases[c].p);
+		fprintf(stderr, "\e[1;34mTesting rank and select with %s...\e[0m\n", name);
+		cr8r_bvec bvec;
+		cr8r_bvec_rs rs;
+		if(!random_bvec(&bvec, cases[c].len, cases[c].p, cases[c].clear_a, cases[c].clear_b, prng) || !cr8r_bvec_rs_init(&rs, &bvec)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return 1;
+		}
+		++tested;
+		passed += check_rs(name, &rs, &bvec);
+		cr8r_bvec_rs_delete(&rs);
+		cr8r_bvec_delete(&bvec, &cr8r_bvecft);
+	}
+
+	fprintf(stderr, "\e[1;34mTesting %d incremental updates...\e[0m\n", NUM_EDITS);
+	{
+		cr8r_bvec bvec;
+		cr8r_bvec_rs rs, fresh;
+		if(!random_bvec(&bvec, (1ull << 20) + 123, .5, 0, 0, prng) || !cr8r_bvec_rs_init(&rs, &bvec)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return 1;
+		}
+		uint64_t same = 0, checks = 0, checks_passed = 0;
+		for(uint64_t e = 0; e < NUM_EDITS; ++e){
+			// mostly short ranges, with some long ones and some that change bits without changing the total
+			uint64_t max_len = e%10 ? 5000 : bvec.len;
+			uint64_t a = cr8r_prng_uniform_u64(prng, 0, bvec.len);
+			uint64_t b = a + cr8r_prng_uniform_u64(prng, 0, max_len);
+			if(b > bvec.len){
+				b = bvec.len;
+			}
+			switch(e%3){
+				case 0: cr8r_bvec_set_range(&bvec, a, b, e%2); break;
+				case 1:
+					for(uint64_t i = a; i < b; ++i){
+						cr8r_bvec_setu(&bvec, i, cr8r_prng_uniform01_double(prng) < .5);
+					}
+					break;
+				default:
+					if(b - a >= 2){
+						bool x = cr8r_bvec_getu(&bvec, a), y = cr8r_bvec_getu(&bvec, b - 1);
+						cr8r_bvec_setu(&bvec, a, y);
+						cr8r_bvec_setu(&bvec, b - 1, x);
+					}
+			}
+			if(!cr8r_bvec_rs_update(&rs, &bvec, a, b) || !cr8r_bvec_rs_init(&fresh, &bvec)){
+				fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+				return 1;
+			}
+			same += same_rs(&rs, &fresh);
+			cr8r_bvec_rs_delete(&fresh);
+			if(e%CHECK_EVERY == 0){
+				++checks;
+				checks_passed += check_rs("updated index", &rs, &bvec);
+			}
+		}
+		tested += 3;
+		if(same == NUM_EDITS){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31m%"PRIu64"/%d updated indices were different from rebuilt ones!\e[0m\n", NUM_EDITS - same, NUM_EDITS);
+		}
+		passed += checks_passed == checks;
+		if(!cr8r_bvec_pushr(&bvec, &cr8r_bvecft, 1)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return 1;
+		}
+		if(!cr8r_bvec_rs_update(&rs, &bvec, 0, 1)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mUpdating after changing the length did not fail!\e[0m\n");
+		}
+		cr8r_bvec_rs_delete(&rs);
+		cr8r_bvec_delete(&bvec, &cr8r_bvecft);
+	}
+
+	fprintf(stderr, "\e[1;34mTiming %llu queries on %llu bits...\e[0m\n", BENCH_QUERIES, BENCH_BITS);
+	{
+		cr8r_bvec bvec;
+		cr8r_bvec_rs rs;
+		uint64_t *queries = malloc(BENCH_QUERIES*sizeof(uint64_t));
+		struct timespec start;
+		if(!queries || !random_bvec(&bvec, BENCH_BITS, .5, 0, 0, prng)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return 1;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if(!cr8r_bvec_rs_init(&rs, &bvec)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return 1;
+		}
+		double secs = elapsed(&start);
+		uint64_t overhead = (rs.num_blocks + (rs.num_blocks >> 21) + 1)*sizeof(uint64_t) + rs.samples_cap*sizeof(uint32_t);
+		fprintf(stderr, "\e[1;33mbuild: %f GB/s, %f%% space overhead\e[0m\n", BENCH_BITS/8/secs*1e-9, 100.*overhead/(BENCH_BITS/8));
+		cr8r_prng_fill_uniform_u64(prng, 0, BENCH_BITS, BENCH_QUERIES, queries);
+		uint64_t total = 0;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(uint64_t i = 0; i < BENCH_QUERIES; ++i){
+			total += cr8r_bvec_rank(&rs, &bvec, queries[i]);
+		}
+		secs = elapsed(&start);
+		fprintf(stderr, "\e[1;33mrank: %f ns per query\e[0m\n", secs/BENCH_QUERIES*1e9);
+		for(uint64_t i = 0; i < BENCH_QUERIES; ++i){
+			queries[i] = queries[i]/2;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(uint64_t i = 0; i < BENCH_QUERIES; ++i){
+			total += cr8r_bvec_select(&rs, &bvec, queries[i]);
+		}
+		secs = elapsed(&start);
+		fprintf(stderr, "\e[1;33mselect: %f ns per query (checksum %"PRIu64")\e[0m\n", secs/BENCH_QUERIES*1e9, total);
+		free(queries);
+		cr8r_bvec_rs_delete(&rs);
+		cr8r_bvec_delete(&bvec, &cr8r_bvecft);
+	}
+
+	free(prng);
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
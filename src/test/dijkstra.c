@@ -3,8 +3,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <time.h>
+
 #include <crater/hash.h>
 #include <crater/pheap.h>
+#include <crater/heap.h>
+#include <crater/radix_heap.h>
 
 typedef struct{
 	uint64_t i, j, weight;
@@ -42,8 +46,18 @@ typedef struct{
 	uint64_t dist;
 	bool visited;
 	cr8r_pheap_node imeta;
+	uint64_t heap_idx;// position in the d-ary heap frontier
 } graph_node;
 
+// which priority queue to use for the frontier
+typedef enum{
+	QUEUE_PHEAP,
+	QUEUE_DARY,
+	QUEUE_RADIX
+} queue_kind;
+
+#define FRONTIER_ARITY 4
+
 static int cmp_node_dist(const cr8r_base_ft *ft, const void *_a, const void *_b){
 	const graph_node *a = _a, *b = _b;
 	if(a->dist < b->dist){
@@ -58,7 +72,10 @@ typedef struct{
 	cr8r_hashtbl_t edges;
 	uint64_t width, height, start_weight;
 	graph_node *nodes;
+	queue_kind queue;
 	cr8r_pheap_node *frontier;
+	cr8r_vec dary_frontier;// node indices
+	cr8r_radix_heap radix_frontier;
 } graph;
 
 cr8r_pheap_ft graph_pqft = {
@@ -68,6 +85,30 @@ cr8r_pheap_ft graph_pqft = {
 	.cmp=cmp_node_dist
 };
 
+static int cmp_node_idx_dist(const cr8r_base_ft *ft, const void *a, const void *b){
+	const graph *g = ft->data;
+	return cmp_node_dist(ft, g->nodes + *(const uint64_t*)a, g->nodes + *(const uint64_t*)b);
+}
+
+// keep track of the position of each node in the d-ary heap so its key can be decreased
+static void swap_node_idx(cr8r_base_ft *ft, void *_a, void *_b){
+	graph *g = ft->data;
+	uint64_t *a = _a, *b = _b;
+	uint64_t t = *a;
+	*a = *b;
+	*b = t;
+	g->nodes[*a].heap_idx = a - (uint64_t*)g->dary_frontier.buf;
+	g->nodes[*b].heap_idx = b - (uint64_t*)g->dary_frontier.buf;
+}
+
+cr8r_vec_ft graph_dary_ft = {
+	.base.size = sizeof(uint64_t),
+	.new_size = cr8r_default_new_size,
+	.resize = cr8r_default_resize,
+	.cmp = cmp_node_idx_dist,
+	.swap = swap_node_idx
+};
+
 static bool read_file(const char *path, graph *out){
 	FILE *f = fopen(path, "r");
 	out->edges.cap = 0;
@@ -179,13 +220,75 @@ static void visit_edge(graph *self, uint64_t i, uint64_t j){
 	if(!dest->visited){
 		dest->visited = true;
 		dest->dist = dist_here;
-		self->frontier = cr8r_pheap_meld(self->frontier, &dest->imeta, &graph_pqft);
+		if(self->queue == QUEUE_PHEAP){
+			self->frontier = cr8r_pheap_meld(self->frontier, &dest->imeta, &graph_pqft);
+		}else if(self->queue == QUEUE_DARY){
+			dest->heap_idx = self->dary_frontier.len;
+			cr8r_heap_push_d(&self->dary_frontier, &graph_dary_ft, FRONTIER_ARITY, &j, -1);
+		}else{
+			cr8r_radix_heap_push(&self->radix_frontier, j, dist_here);
+		}
 	}else if(dist_here < dest->dist){// TODO: this is redundant for completed nodes
 		dest->dist = dist_here;
-		self->frontier = cr8r_pheap_decreased_key(&dest->imeta, &graph_pqft);
+		if(self->queue == QUEUE_PHEAP){
+			cr8r_pheap_decrease(&self->frontier, &dest->imeta, &graph_pqft);
+		}else if(self->queue == QUEUE_DARY){
+			cr8r_heap_sift_up_d(&self->dary_frontier, &graph_dary_ft, FRONTIER_ARITY, cr8r_vec_get(&self->dary_frontier, &graph_dary_ft, dest->heap_idx), -1);
+		}else{
+			cr8r_radix_heap_decrease(&self->radix_frontier, j, dist_here);
+		}
 	}
 }
 
+static bool pop_frontier(graph *self, uint64_t *idx){
+	if(self->queue == QUEUE_PHEAP){
+		graph_node *curr = CR8R_OUTER_S(cr8r_pheap_pop(&self->frontier, &graph_pqft), &graph_pqft);
+		*idx = curr - self->nodes;
+		return curr;
+	}else if(self->queue == QUEUE_DARY){
+		return cr8r_heap_pop_d(&self->dary_frontier, &graph_dary_ft, FRONTIER_ARITY, idx, -1);
+	}
+	return cr8r_radix_heap_pop(&self->radix_frontier, idx, NULL);
+}
+
+static uint64_t shortest_path(graph *graph, queue_kind queue){
+	for(uint64_t i = 0; i < graph->width*graph->height; ++i){
+		graph->nodes[i] = (graph_node){.dist = UINT64_MAX};
+	}
+	graph->queue = queue;
+	graph->nodes[0].dist = graph->start_weight;
+	graph->nodes[0].visited = true;
+	uint64_t zero = 0;
+	if(queue == QUEUE_PHEAP){
+		graph->frontier = CR8R_INNER_S(graph->nodes, &graph_pqft);
+	}else if(queue == QUEUE_DARY){
+		cr8r_vec_clear(&graph->dary_frontier, &graph_dary_ft);
+		cr8r_heap_push_d(&graph->dary_frontier, &graph_dary_ft, FRONTIER_ARITY, &zero, -1);
+	}else{
+		cr8r_radix_heap_clear(&graph->radix_frontier);
+		cr8r_radix_heap_push(&graph->radix_frontier, 0, graph->start_weight);
+	}
+	for(uint64_t idx; pop_frontier(graph, &idx);){
+		//printf("[%"PRIu64"]=%"PRIu64"\n", idx, graph->nodes[idx].dist);
+		if(idx ==  graph->width*graph->height - 1){
+			break;
+		}
+		if(idx >= graph->width){
+			visit_edge(graph, idx, idx - graph->width);
+		}
+		if(idx < graph->width*(graph->height - 1)){
+			visit_edge(graph, idx, idx + graph->width);
+		}
+		if(idx%graph->width){
+			visit_edge(graph, idx, idx - 1);
+		}
+		if(idx%graph->width != graph->width - 1){
+			visit_edge(graph, idx, idx + 1);
+		}
+	};
+	return graph->nodes[graph->width*graph->height - 1].dist;
+}
+
 int main(int argc, char **argv){
 	if(argc != 2){
 		fprintf(stderr, "\e[1;31mERROR: Invalid arguments.  Use like:\n%s <input file>\e[0m\n", argv[0]);
@@ -196,34 +299,24 @@ int main(int argc, char **argv){
 		fprintf(stderr, "\e[1;31mERROR: Could not read file!\e[0m\n");
 		return EXIT_FAILURE;
 	}
-	graph.nodes[0].dist = graph.start_weight;
-	graph.nodes[0].visited = true;
-	graph.frontier = CR8R_INNER_S(graph.nodes, &graph_pqft);
-	for(graph_node *curr; (curr = CR8R_OUTER_S(cr8r_pheap_pop(&graph.frontier, &graph_pqft), &graph_pqft));){
-		uint64_t idx = curr - graph.nodes;
-		//printf("[%"PRIu64"]=%"PRIu64"\n", idx, graph.nodes[idx].dist);
-		if(idx ==  graph.width*graph.height - 1){
-			break;
-		}
-		if(idx >= graph.width){
-			visit_edge(&graph, idx, idx - graph.width);
-		}
-		if(idx < graph.width*(graph.height - 1)){
-			visit_edge(&graph, idx, idx + graph.width);
-		}
-		if(idx%graph.width){
-			visit_edge(&graph, idx, idx - 1);
-		}
-		if(idx%graph.width != graph.width - 1){
-			visit_edge(&graph, idx, idx + 1);
-		}
-	};
-	uint64_t dist = graph.nodes[graph.width*graph.height - 1].dist;
-	fprintf(stderr, dist == 425185 ? 
-		"\e[1;32mSUCCESS: distance from top left to bottom right is %"PRIu64".\e[0m\n" :
-		"\e[1;31mFAILED: got incorrect distance from top left to bottom right (%"PRIu64").\e[0m",
-		dist);
+	graph_dary_ft.base.data = &graph;
+	if(!cr8r_vec_init(&graph.dary_frontier, &graph_dary_ft, graph.width + graph.height) || !cr8r_radix_heap_init(&graph.radix_frontier, graph.width*graph.height)){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate frontier!\e[0m\n");
+		return EXIT_FAILURE;
+	}
+	const char *queue_names[] = {"pairing heap", "4-ary heap", "radix heap"};
+	for(queue_kind queue = QUEUE_PHEAP; queue <= QUEUE_RADIX; ++queue){
+		clock_t t0 = clock();
+		uint64_t dist = shortest_path(&graph, queue);
+		clock_t t1 = clock();
+		fprintf(stderr, dist == 425185 ? 
+			"\e[1;32mSUCCESS: distance from top left to bottom right is %"PRIu64" using a %s (%.4fs).\e[0m\n" :
+			"\e[1;31mFAILED: got incorrect distance from top left to bottom right (%"PRIu64") using a %s (%.4fs).\e[0m\n",
+			dist, queue_names[queue], (double)(t1 - t0)/CLOCKS_PER_SEC);
+	}
 	
+	cr8r_vec_delete(&graph.dary_frontier, &graph_dary_ft);
+	cr8r_radix_heap_delete(&graph.radix_frontier);
 	free(graph.nodes);
 	cr8r_hash_destroy(&graph.edges, &graph_edge_ft);
 }
@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include <crater/heap.h>
+#include <crater/radix_heap.h>
+#include <crater/prand.h>
+
+#define NUM_ELEMS 10000
+#define NUM_IDS 1000
+#define NUM_OPS 100000
+
+// state for a d-ary heap of ids ordered by keys[id], where swap keeps pos[id] up to date for decrease key
+typedef struct{
+	cr8r_vec heap;
+	uint64_t keys[NUM_IDS];
+	uint64_t pos[NUM_IDS];
+} indexed_heap;
+
+static int cmp_ids(const cr8r_base_ft *ft, const void *_a, const void *_b){
+	const indexed_heap *ih = ft->data;
+	uint64_t a = ih->keys[*(const uint64_t*)_a], b = ih->keys[*(const uint64_t*)_b];
+	return (a > b) - (a < b);
+}
+
+static void swap_ids(cr8r_base_ft *ft, void *_a, void *_b){
+	indexed_heap *ih = ft->data;
+	uint64_t *a = _a, *b = _b;
+	uint64_t t = *a;
+	*a = *b;
+	*b = t;
+	ih->pos[*a] = a - (uint64_t*)ih->heap.buf;
+	ih->pos[*b] = b - (uint64_t*)ih->heap.buf;
+}
+
+static bool test_heapsort(cr8r_prng *prng, uint64_t arity, int ord){
+	cr8r_vec vec, out;
+	bool ok = cr8r_vec_init(&vec, &cr8r_vecft_u64, NUM_ELEMS) && cr8r_vec_init(&out, &cr8r_vecft_u64, NUM_ELEMS);
+	for(uint64_t i = 0; i < NUM_ELEMS && ok; ++i){
+		uint64_t x = cr8r_prng_uniform_u64(prng, 0, NUM_ELEMS/4);
+		// push half the elements one at a time and heapify the other half at once
+		ok = i < NUM_ELEMS/2 ? cr8r_vec_pushr(&vec, &cr8r_vecft_u64, &x) : cr8r_heap_push_d(&vec, &cr8r_vecft_u64, arity, &x, ord);
+		if(i == NUM_ELEMS/2 - 1){
+			cr8r_heap_ify_d(&vec, &cr8r_vecft_u64, arity, ord);
+		}
+	}
+	for(uint64_t x; ok && cr8r_heap_pop_d(&vec, &cr8r_vecft_u64, arity, &x, ord);){
+		if(out.len && ord*cr8r_default_cmp_u64(&cr8r_vecft_u64.base, &x, cr8r_vec_getx(&out, &cr8r_vecft_u64, -1)) > 0){
+			ok = false;
+		}
+		ok = ok && cr8r_vec_pushr(&out, &cr8r_vecft_u64, &x);
+	}
+	ok = ok && out.len == NUM_ELEMS;
+	cr8r_vec_delete(&vec, &cr8r_vecft_u64);
+	cr8r_vec_delete(&out, &cr8r_vecft_u64);
+	return ok;
+}
+
+static bool test_decrease_key(cr8r_prng *prng, uint64_t arity){
+	static indexed_heap ih;
+	cr8r_vec_ft ft = {
+		.base.data = &ih,
+		.base.size = sizeof(uint64_t),
+		.new_size = cr8r_default_new_size,
+		.resize = cr8r_default_resize,
+		.cmp = cmp_ids,
+		.swap = swap_ids
+	};
+	bool ok = cr8r_vec_init(&ih.heap, &ft, NUM_IDS);
+	for(uint64_t id = 0; id < NUM_IDS && ok; ++id){
+		ih.keys[id] = cr8r_prng_uniform_u64(prng, 0, 1ull << 40);
+		ih.pos[id] = ih.heap.len;
+		ok = cr8r_heap_push_d(&ih.heap, &ft, arity, &id, -1);
+	}
+	for(uint64_t i = 0; i < NUM_OPS && ok; ++i){
+		uint64_t id = cr8r_prng_uniform_u64(prng, 0, NUM_IDS);
+		ih.keys[id] = cr8r_prng_uniform_u64(prng, 0, ih.keys[id] + 1);
+		cr8r_heap_sift_up_d(&ih.heap, &ft, arity, cr8r_vec_get(&ih.heap, &ft, ih.pos[id]), -1);
+	}
+	uint64_t prev = 0, popped = 0;
+	for(uint64_t id; ok && cr8r_heap_pop_d(&ih.heap, &ft, arity, &id, -1); ++popped){
+		ok = ih.keys[id] >= prev;
+		prev = ih.keys[id];
+	}
+	cr8r_vec_delete(&ih.heap, &ft);
+	return ok && popped == NUM_IDS;
+}
+
+// simulate a monotone priority queue, checking the radix heap against a linear scan
+static bool test_radix(cr8r_prng *prng){
+	static uint64_t keys[NUM_IDS];
+	static bool present[NUM_IDS];
+	memset(present, 0, sizeof(present));
+	cr8r_radix_heap rh;
+	if(!cr8r_radix_heap_init(&rh, NUM_IDS)){
+		return false;
+	}
+	bool ok = true;
+	uint64_t len = 0, last = 0;
+	for(uint64_t i = 0; i < NUM_OPS && ok; ++i){
+		uint64_t id = cr8r_prng_uniform_u64(prng, 0, NUM_IDS);
+		uint64_t key = last + cr8r_prng_uniform_u64(prng, 0, 1ull << cr8r_prng_uniform_u64(prng, 0, 40));
+		uint64_t op = cr8r_prng_uniform_u64(prng, 0, 3);
+		if(op == 0){
+			ok = cr8r_radix_heap_push(&rh, id, key) == !present[id];
+			if(!present[id]){
+				present[id] = true;
+				keys[id] = key;
+				++len;
+			}
+		}else if(op == 1){
+			bool valid = present[id] && key <= keys[id];
+			ok = cr8r_radix_heap_decrease(&rh, id, key) == valid;
+			if(valid){
+				keys[id] = key;
+			}
+		}else{
+			uint64_t popped_id, popped_key;
+			ok = cr8r_radix_heap_pop(&rh, &popped_id, &popped_key) == !!len;
+			if(ok && len){
+				uint64_t min_key = UINT64_MAX;
+				for(uint64_t j = 0; j < NUM_IDS; ++j){
+					if(present[j] && keys[j] < min_key){
+						min_key = keys[j];
+					}
+				}
+				ok = present[popped_id] && keys[popped_id] == popped_key && popped_key == min_key;
+				present[popped_id] = false;
+				--len;
+				last = popped_key;
+			}
+		}
+		ok = ok && rh.len == len && !cr8r_radix_heap_push(&rh, NUM_IDS, last) && (!last || !cr8r_radix_heap_push(&rh, id, last - 1) || present[id]);
+	}
+	cr8r_radix_heap_delete(&rh);
+	return ok;
+}
+
+static bool is_heap(cr8r_vec *self, int ord){
+	for(uint64_t i = 1; i < self->len; ++i){
+		if(ord*cr8r_default_cmp_u64(&cr8r_vecft_u64.base, cr8r_vec_get(self, &cr8r_vecft_u64, i), cr8r_vec_get(self, &cr8r_vecft_u64, (i - 1) >> 1)) > 0){
+			return false;
+		}
+	}
+	return true;
+}
+
+// push bursts of various sizes into heaps of various sizes, then check pop_k against a sorted copy
+static bool test_bulk(cr8r_prng *prng, int ord){
+	uint64_t sizes[] = {0, 1, 5, 100, 3000};
+	cr8r_vec heap = {}, burst = {}, all = {}, out = {};
+	bool ok = cr8r_vec_init(&heap, &cr8r_vecft_u64, 1) && cr8r_vec_init(&burst, &cr8r_vecft_u64, 1) && cr8r_vec_init(&all, &cr8r_vecft_u64, 1) && cr8r_vec_init(&out, &cr8r_vecft_u64, 1);
+	for(uint64_t i = 0; i < sizeof(sizes)/sizeof(*sizes) && ok; ++i){
+		for(uint64_t j = 0; j < sizeof(sizes)/sizeof(*sizes) && ok; ++j){
+			cr8r_vec_clear(&heap, &cr8r_vecft_u64);
+			cr8r_vec_clear(&burst, &cr8r_vecft_u64);
+			for(uint64_t l = 0; l < sizes[i] + sizes[j] && ok; ++l){
+				uint64_t x = cr8r_prng_uniform_u64(prng, 0, 1000);
+				ok = l < sizes[i] ? cr8r_heap_push(&heap, &cr8r_vecft_u64, &x, ord) : cr8r_vec_pushr(&burst, &cr8r_vecft_u64, &x);
+			}
+			cr8r_vec_clear(&all, &cr8r_vecft_u64);
+			ok = ok && cr8r_vec_augment(&all, &heap, &cr8r_vecft_u64) && cr8r_vec_augment(&all, &burst, &cr8r_vecft_u64);
+			// merging the burst as a vector is the same as pushing many
+			ok = ok && (j&1 ? cr8r_heap_merge(&heap, &cr8r_vecft_u64, &burst, ord) : cr8r_heap_push_many(&heap, &cr8r_vecft_u64, burst.buf, burst.len, ord));
+			ok = ok && is_heap(&heap, ord);
+			cr8r_vec_sort(&all, &cr8r_vecft_u64);
+			uint64_t k = all.len/2 + 1;
+			ok = ok && cr8r_heap_pop_k(&heap, &cr8r_vecft_u64, k, &out, ord) && out.len == (k < all.len ? k : all.len) && is_heap(&heap, ord);
+			for(uint64_t l = 0; l < out.len && ok; ++l){
+				ok = *(uint64_t*)cr8r_vec_get(&out, &cr8r_vecft_u64, l) == *(uint64_t*)cr8r_vec_get(&all, &cr8r_vecft_u64, ord > 0 ? all.len - 1 - l : l);
+			}
+		}
+	}
+	cr8r_vec_delete(&heap, &cr8r_vecft_u64);
+	cr8r_vec_delete(&burst, &cr8r_vecft_u64);
+	cr8r_vec_delete(&all, &cr8r_vecft_u64);
+	cr8r_vec_delete(&out, &cr8r_vecft_u64);
+	return ok;
+}
+
+#define BENCH_HEAP 100000
+#define BENCH_BURST 10000
+#define BENCH_ROUNDS 20
+
+// compare inserting bursts one at a time and with push_many
+static bool bench_bulk(cr8r_prng *prng){
+	cr8r_vec heap1 = {}, heap2 = {}, burst = {};
+	bool ok = cr8r_vec_init(&heap1, &cr8r_vecft_u64, BENCH_HEAP + BENCH_ROUNDS*BENCH_BURST) && cr8r_vec_init(&burst, &cr8r_vecft_u64, BENCH_BURST);
+	for(uint64_t i = 0; i < BENCH_HEAP && ok; ++i){
+		uint64_t x = cr8r_prng_uniform_u64(prng, 0, 1ull << 40);
+		ok = cr8r_vec_pushr(&heap1, &cr8r_vecft_u64, &x);
+	}
+	cr8r_heap_ify(&heap1, &cr8r_vecft_u64, -1);
+	ok = ok && cr8r_vec_copy(&heap2, &heap1, &cr8r_vecft_u64) && cr8r_vec_ensure_cap(&heap2, &cr8r_vecft_u64, heap1.cap);
+	clock_t one_at_a_time = 0, many = 0;
+	for(uint64_t r = 0; r < BENCH_ROUNDS && ok; ++r){
+		cr8r_vec_clear(&burst, &cr8r_vecft_u64);
+		for(uint64_t i = 0; i < BENCH_BURST && ok; ++i){
+			uint64_t x = cr8r_prng_uniform_u64(prng, 0, 1ull << 40);
+			ok = cr8r_vec_pushr(&burst, &cr8r_vecft_u64, &x);
+		}
+		clock_t t0 = clock();
+		for(uint64_t i = 0; i < BENCH_BURST && ok; ++i){
+			ok = cr8r_heap_push(&heap1, &cr8r_vecft_u64, cr8r_vec_get(&burst, &cr8r_vecft_u64, i), -1);
+		}
+		clock_t t1 = clock();
+		ok = ok && cr8r_heap_push_many(&heap2, &cr8r_vecft_u64, burst.buf, burst.len, -1);
+		clock_t t2 = clock();
+		one_at_a_time += t1 - t0;
+		many += t2 - t1;
+	}
+	fprintf(stderr, "\e[1;34mInserting %d bursts of %d into a heap of %d: %.4fs one at a time, %.4fs with push_many\e[0m\n", BENCH_ROUNDS, BENCH_BURST, BENCH_HEAP, (double)one_at_a_time/CLOCKS_PER_SEC, (double)many/CLOCKS_PER_SEC);
+	ok = ok && is_heap(&heap2, -1) && *(uint64_t*)cr8r_heap_top(&heap1, &cr8r_vecft_u64) == *(uint64_t*)cr8r_heap_top(&heap2, &cr8r_vecft_u64);
+	cr8r_vec_delete(&heap1, &cr8r_vecft_u64);
+	cr8r_vec_delete(&heap2, &cr8r_vecft_u64);
+	cr8r_vec_delete(&burst, &cr8r_vecft_u64);
+	return ok;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_prng *prng = cr8r_prng_init_lcg(0x3c6ef372fe94f82b);
+	uint64_t arities[] = {2, 3, 4, 8};
+	for(uint64_t i = 0; i < sizeof(arities)/sizeof(*arities); ++i){
+		fprintf(stderr, "\e[1;34mTesting %"PRIu64"-ary heaps\e[0m\n", arities[i]);
+		for(int ord = -1; ord <= 1; ord += 2){
+			++tested;
+			if(test_heapsort(prng, arities[i], ord)){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31m%"PRIu64"-ary %s heap did not pop elements in order!\e[0m\n", arities[i], ord > 0 ? "max" : "min");
+			}
+		}
+		++tested;
+		if(test_decrease_key(prng, arities[i])){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31m%"PRIu64"-ary heap did not pop elements in order after decreasing keys!\e[0m\n", arities[i]);
+		}
+	}
+	fprintf(stderr, "\e[1;34mTesting bulk heap operations\e[0m\n");
+	for(int ord = -1; ord <= 1; ord += 2){
+		++tested;
+		if(test_bulk(prng, ord)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mBulk %s heap operations failed!\e[0m\n", ord > 0 ? "max" : "min");
+		}
+	}
+	++tested;
+	if(bench_bulk(prng)){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mpush_many did not produce a valid heap!\e[0m\n");
+	}
+	fprintf(stderr, "\e[1;34mTesting radix heap\e[0m\n");
+	++tested;
+	if(test_radix(prng)){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mRadix heap did not match linear scan!\e[0m\n");
+	}
+
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+	free(prng);
+}
+
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <crater/hugemem.h>
+#include <crater/vec.h>
+#include <crater/hash.h>
+
+#define NUM_ELEMS 2000000
+#define NUM_ENTS 300000
+
+static bool test_vec(cr8r_hugemem *cfg){
+	cr8r_vec_ft vecft = cr8r_vecft_u64;
+	vecft.base.data = cfg;
+	vecft.resize = cr8r_default_resize_huge;
+	cr8r_vec vec;
+	if(!cr8r_vec_init(&vec, &vecft, 1)){
+		return false;
+	}
+	bool ok = true;
+	for(uint64_t i = 0; i < NUM_ELEMS && ok; ++i){
+		ok = cr8r_vec_pushr(&vec, &vecft, &i);
+	}
+	for(uint64_t i = NUM_ELEMS/2, x; i < NUM_ELEMS && ok; ++i){
+		ok = cr8r_vec_popr(&vec, &vecft, &x);
+	}
+	ok = ok && cr8r_vec_trim(&vec, &vecft);
+	for(uint64_t i = 0; i < NUM_ELEMS/2 && ok; ++i){
+		ok = *(uint64_t*)cr8r_vec_get(&vec, &vecft, i) == i;
+	}
+	cr8r_vec_delete(&vec, &vecft);
+	return ok;
+}
+
+static bool test_hash(cr8r_hugemem *cfg){
+	cr8r_hashtbl_ft htft = cr8r_htft_u64_u64;
+	htft.base.data = cfg;
+	htft.alloc = cr8r_default_alloc_huge;
+	htft.free = cr8r_default_free_huge;
+	cr8r_hashtbl_t ht;
+	if(!cr8r_hash_init(&ht, &htft, 1)){
+		return false;
+	}
+	bool ok = true;
+	for(uint64_t i = 0; i < NUM_ENTS && ok; ++i){
+		ok = cr8r_hash_insert(&ht, &htft, &(uint64_t[2]){i, ~i}, NULL);
+	}
+	for(uint64_t i = 0; i < NUM_ENTS && ok; ++i){
+		uint64_t *ent = cr8r_hash_get(&ht, &htft, &i);
+		ok = ent && ent[1] == ~i;
+	}
+	cr8r_hash_destroy(&ht, &htft);
+	return ok;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_hugemem cfgs[] = {
+		{},
+		{.threshold = 1ULL << 16, .flags = CR8R_HUGEMEM_HUGETLB},
+		{.threshold = 1ULL << 16, .flags = CR8R_HUGEMEM_INTERLEAVE, .nodemask = 1}
+	};
+	const char *names[] = {"default", "hugetlb", "interleave"};
+	for(uint64_t i = 0; i < sizeof(cfgs)/sizeof(*cfgs); ++i){
+		fprintf(stderr, "\e[1;34mTesting %s hugepage backed vector and hash table...\e[0m\n", names[i]);
+		++tested;
+		if(test_vec(cfgs + i)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mHugepage backed vector failed!\e[0m\n");
+		}
+		++tested;
+		if(test_hash(cfgs + i)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mHugepage backed hash table failed!\e[0m\n");
+		}
+	}
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+#include <crater/kd_tree.h>
+#include <crater/kd_bucket.h>
+#include <crater/prand.h>
+
+#define DIM 16
+#define NUM_CLUSTERS 32
+#define NUM_POINTS 20000
+#define NUM_QUERIES 200
+#define K 10
+#define MAX_TREES 8
+
+static cr8r_kd_ft ft;
+static double true_sqdists[NUM_QUERIES][K];
+
+// Points are drawn from clusters around random centers, since in 16 uniformly random dimensions all points are about
+// equally far apart and no kd tree can do much better than checking every point
+static void gen_point(cr8r_prng *prng, float centers[NUM_CLUSTERS][DIM], float *point){
+	const float *center = centers[cr8r_prng_uniform_u64(prng, 0, NUM_CLUSTERS)];
+	for(uint64_t j = 0; j < DIM; ++j){
+		point[j] = center[j] + 0.15*(2*cr8r_prng_uniform01_double(prng) - 1);
+	}
+}
+
+// Fraction of the points found which are at least as close as the true kth closest point
+static double recall(const cr8r_vec *res, const float *q, uint64_t i){
+	uint64_t found = 0;
+	for(uint64_t j = 0; j < res->len; ++j){
+		if(ft.sqdist(&ft, q, cr8r_vec_get((cr8r_vec*)res, &ft.super, j)) <= true_sqdists[i][K - 1]){
+			++found;
+		}
+	}
+	return (double)found/K;
+}
+
+// Check that an approximate search without a budget found K points, and that its kth point is within the 1 + eps guarantee
+static bool check_guarantee(const cr8r_vec *res, const float *q, uint64_t i, double eps){
+	if(res->len != K){
+		return false;
+	}
+	double sqdist = ft.sqdist(&ft, q, cr8r_vec_get((cr8r_vec*)res, &ft.super, K - 1));
+	return sqdist <= (1 + eps)*(1 + eps)*true_sqdists[i][K - 1]*(1 + 1e-5);
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_prng *prng = cr8r_prng_init_lcg(0x9e3779b97f4a7c15);
+	cr8r_kd_ft_init_cf32(&ft, DIM, DIM*sizeof(float));
+	static float centers[NUM_CLUSTERS][DIM];
+	for(uint64_t i = 0; i < NUM_CLUSTERS; ++i){
+		for(uint64_t j = 0; j < DIM; ++j){
+			centers[i][j] = cr8r_prng_uniform01_double(prng);
+		}
+	}
+	cr8r_vec points = {}, tree_points = {}, queries = {}, res = {};
+	bool ok = cr8r_vec_init(&points, &ft.super, NUM_POINTS) && cr8r_vec_init(&queries, &ft.super, NUM_QUERIES) && cr8r_vec_init(&res, &ft.super, K + 1);
+	for(uint64_t i = 0; i < NUM_POINTS && ok; ++i){
+		float point[DIM];
+		gen_point(prng, centers, point);
+		ok = cr8r_vec_pushr(&points, &ft.super, point);
+	}
+	for(uint64_t i = 0; i < NUM_QUERIES && ok; ++i){
+		float point[DIM];
+		gen_point(prng, centers, point);
+		ok = cr8r_vec_pushr(&queries, &ft.super, point);
+	}
+	float bounds[2*DIM];
+	cr8r_kd_buckets buckets = {};
+	cr8r_kd_rforest forest = {};
+	ok = ok && cr8r_kdwin_bounding_cf32(bounds, &points, &ft) && cr8r_vec_copy(&tree_points, &points, &ft.super);
+	ok = ok && cr8r_kd_buckets_build(&buckets, &tree_points, &ft, 0) && cr8r_kd_rforest_build(&forest, &points, &ft, bounds, MAX_TREES, 0, prng);
+	if(!ok){
+		fprintf(stderr, "\e[1;31mERROR: Could not build trees for benchmark!\e[0m\n");
+		exit(1);
+	}
+	fprintf(stderr, "\e[1;34mFinding exact %d closest points to %d queries among %d clustered points in %d dimensions\e[0m\n", K, NUM_QUERIES, NUM_POINTS, DIM);
+	clock_t t0 = clock();
+	for(uint64_t i = 0; i < NUM_QUERIES && ok; ++i){
+		const float *q = cr8r_vec_get(&queries, &ft.super, i);
+		ok = cr8r_kd_buckets_k_closest(&buckets, &tree_points, &ft, bounds, q, K, &res) && res.len == K;
+		for(uint64_t j = 0; j < res.len && ok; ++j){
+			true_sqdists[i][j] = ft.sqdist(&ft, q, cr8r_vec_get(&res, &ft.super, j));
+		}
+	}
+	clock_t t1 = clock();
+	fprintf(stderr, "\e[1;34mExact bucketed search: %.1fus/query\e[0m\n", 1e6*(t1 - t0)/CLOCKS_PER_SEC/NUM_QUERIES);
+	++tested;
+	if(ok){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mExact bucketed search failed!\e[0m\n");
+	}
+
+	fprintf(stderr, "\e[1;34mPer node kd tree with eps (first %d queries)\e[0m\n", NUM_QUERIES/10);
+	cr8r_vec node_points = {};
+	ok = cr8r_vec_copy(&node_points, &points, &ft.super) && cr8r_kd_ify(&node_points, &ft, 0, node_points.len);
+	double node_epss[] = {0, 0.5};
+	for(uint64_t e = 0; e < sizeof(node_epss)/sizeof(*node_epss) && ok; ++e){
+		double total_recall = 0;
+		bool guaranteed = true;
+		t0 = clock();
+		for(uint64_t i = 0; i < NUM_QUERIES/10 && ok; ++i){
+			const float *q = cr8r_vec_get(&queries, &ft.super, i);
+			ok = cr8r_kd_k_closest_approx(&node_points, &ft, bounds, q, K, node_epss[e], 0, &res);
+			cr8r_kd_k_closest_state kcs = {.ft = ft, .pt = q};
+			kcs.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
+			cr8r_vec_sort(&res, &kcs.ft.super);
+			total_recall += recall(&res, q, i);
+			guaranteed = guaranteed && check_guarantee(&res, q, i, node_epss[e]);
+		}
+		t1 = clock();
+		double mean_recall = total_recall/(NUM_QUERIES/10);
+		fprintf(stderr, "\e[1;34m  eps=%.2f: recall %.3f, %.1fus/query\e[0m\n", node_epss[e], mean_recall, 1e6*(t1 - t0)/CLOCKS_PER_SEC/(NUM_QUERIES/10));
+		++tested;
+		if(ok && guaranteed && (node_epss[e] || mean_recall == 1)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mPer node approximate search did not meet its guarantee!\e[0m\n");
+		}
+	}
+	cr8r_vec_delete(&node_points, &ft.super);
+
+	fprintf(stderr, "\e[1;34mBest bin first search (trees, eps, max leaves: recall, time)\e[0m\n");
+	uint64_t tree_counts[] = {1, 4, MAX_TREES};
+	double epss[] = {0, 0.5};
+	uint64_t budgets[] = {0, 64, 16, 4};
+	for(uint64_t t = 0; t < sizeof(tree_counts)/sizeof(*tree_counts); ++t){
+		// a forest with fewer trees is just a prefix of the full forest
+		cr8r_kd_rforest sub_forest = forest;
+		sub_forest.num_trees = tree_counts[t];
+		for(uint64_t e = 0; e < sizeof(epss)/sizeof(*epss); ++e){
+			for(uint64_t b = 0; b < sizeof(budgets)/sizeof(*budgets); ++b){
+				double total_recall = 0;
+				bool guaranteed = true;
+				ok = true;
+				t0 = clock();
+				for(uint64_t i = 0; i < NUM_QUERIES && ok; ++i){
+					const float *q = cr8r_vec_get(&queries, &ft.super, i);
+					ok = cr8r_kd_rforest_k_closest(&sub_forest, &ft, q, K, epss[e], budgets[b], &res);
+					total_recall += recall(&res, q, i);
+					guaranteed = guaranteed && (budgets[b] || check_guarantee(&res, q, i, epss[e]));
+				}
+				t1 = clock();
+				double mean_recall = total_recall/NUM_QUERIES;
+				fprintf(stderr, "\e[1;34m  %"PRIu64", %.2f, %"PRIu64": recall %.3f, %.1fus/query\e[0m\n", tree_counts[t], epss[e], budgets[b], mean_recall, 1e6*(t1 - t0)/CLOCKS_PER_SEC/NUM_QUERIES);
+				++tested;
+				if(ok && guaranteed && (budgets[b] || epss[e] || mean_recall == 1)){
+					++passed;
+				}else{
+					fprintf(stderr, "\e[1;31mBest bin first search did not meet its guarantee!\e[0m\n");
+				}
+			}
+		}
+	}
+	++tested;
+	if(cr8r_kd_buckets_k_closest_approx(&buckets, &tree_points, &ft, bounds, cr8r_vec_get(&queries, &ft.super, 0), K, 0, 0, &res) && recall(&res, cr8r_vec_get(&queries, &ft.super, 0), 0) == 1){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mBest bin first search on a single bucketed tree was not exact!\e[0m\n");
+	}
+
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+	cr8r_kd_rforest_delete(&forest, &ft);
+	cr8r_kd_buckets_delete(&buckets);
+	cr8r_vec_delete(&points, &ft.super);
+	cr8r_vec_delete(&tree_points, &ft.super);
+	cr8r_vec_delete(&queries, &ft.super);
+	cr8r_vec_delete(&res, &ft.super);
+	free(prng);
+}
+
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <crater/kd_check.h>
+#include <crater/kd_forest.h>
+#include <crater/prand.h>
+
+static cr8r_kd_k_closest_state point_kcs;
+
+#define NUM_POINTS 2000
+#define BOX_SIZE 2000
+#define KCS_SIZE 2200
+#define KCS_COUNT 20
+#define KCS_TRIALS 20
+#define ROUNDS 5
+
+static cr8r_walk_decision count_visitor(cr8r_kd_ft *ft, const void *bounds, void *ent, void *data){
+	++*(uint64_t*)data;
+	return CR8R_WALK_CONTINUE;
+}
+
+static bool check_levels(cr8r_kd_forest *forest){
+	uint64_t total = 0, deleted = 0;
+	for(uint64_t i = 0; i < CR8R_KD_FOREST_LEVELS; ++i){
+		const cr8r_vec *tree = forest->trees + i;
+		if(tree->len > 1ULL << i || forest->deleted[i].len != tree->len || !cr8r_kd_check_tree(tree, &cr8r_kdft_c3i64, 0, tree->len)){
+			return false;
+		}
+		total += tree->len;
+		deleted += cr8r_bvec_popcount(forest->deleted + i);
+	}
+	uint64_t visited = 0;
+	cr8r_kd_forest_walk(forest, &cr8r_kdft_c3i64, count_visitor, &visited);
+	return deleted == forest->deleted_len && total == forest->len + deleted && visited == forest->len;
+}
+
+static bool check_k_closest(cr8r_kd_forest *forest, cr8r_vec *points, cr8r_prng *prng, cr8r_vec *res_points1, cr8r_vec *res_points2){
+	cr8r_kdwin_s2i64 bounds;
+	cr8r_kdwin_bounding_i64x3(&bounds, points, &cr8r_kdft_c3i64);
+	for(uint64_t i = 0; i < KCS_TRIALS; ++i){
+		int64_t point[3];
+		for(uint64_t j = 0; j < 3; ++j){
+			int64_t x = cr8r_prng_uniform_u64(prng, 0, KCS_SIZE + 1);
+			point[j] = x - KCS_SIZE/2;
+		}
+		if(!cr8r_kd_forest_k_closest(forest, &cr8r_kdft_c3i64, point, KCS_COUNT, res_points1)){
+			return false;
+		}
+		cr8r_kd_k_closest_naive(points, &cr8r_kdft_c3i64, &bounds, point, KCS_COUNT, res_points2);
+		if(res_points1->len != res_points2->len){
+			fprintf(stderr, "\e[1;31mkd_forest_k_closest found %"PRIu64" points (%"PRIu64" expected)\e[0m\n", res_points1->len, res_points2->len);
+			return false;
+		}
+		point_kcs.pt = point;
+		cr8r_vec_sort(res_points1, &point_kcs.ft.super);
+		cr8r_vec_sort(res_points2, &point_kcs.ft.super);
+		for(uint64_t j = 0; j < res_points1->len; ++j){
+			double d_a = point_kcs.ft.sqdist(&point_kcs.ft, point, cr8r_vec_get(res_points1, &point_kcs.ft.super, j));
+			double d_b = point_kcs.ft.sqdist(&point_kcs.ft, point, cr8r_vec_get(res_points2, &point_kcs.ft.super, j));
+			if(d_a != d_b){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main(){
+	point_kcs.ft = cr8r_kdft_c3i64;
+	point_kcs.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
+	uint64_t tested = 0, passed = 0;
+	cr8r_prng *prng = cr8r_prng_init_lcg(0x8a5cd789635d2dff);
+	cr8r_vec points = {}, res_points1 = {}, res_points2 = {};
+	cr8r_vec_init(&points, &cr8r_kdft_c3i64.super, NUM_POINTS);
+	cr8r_vec_init(&res_points1, &point_kcs.ft.super, KCS_COUNT + 1);
+	cr8r_vec_init(&res_points2, &point_kcs.ft.super, KCS_COUNT + 1);
+	cr8r_kd_forest forest;
+	cr8r_kdwin_s2i64 bounds = {};
+	if(!cr8r_kd_forest_init(&forest, &cr8r_kdft_c3i64, &bounds)){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate kd forest!\e[0m\n");
+		exit(1);
+	}
+	for(uint64_t round = 0; round < ROUNDS; ++round){
+		fprintf(stderr, "\e[1;34mInserting %1$d random lattice points within [-%2$d, %2$d]^3 one at a time\e[0m\n", NUM_POINTS/2, BOX_SIZE/2);
+		bool ok = true;
+		for(uint64_t i = 0; i < NUM_POINTS/2; ++i){
+			int64_t point[3];
+			for(uint64_t j = 0; j < 3; ++j){
+				int64_t x = cr8r_prng_uniform_u64(prng, 0, BOX_SIZE + 1);
+				point[j] = x - BOX_SIZE/2;
+			}
+			ok = ok && cr8r_kd_forest_insert(&forest, &cr8r_kdft_c3i64, point) && cr8r_vec_pushr(&points, &cr8r_kdft_c3i64.super, point);
+		}
+		++tested;
+		if(ok && check_levels(&forest)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mkd forest is inconsistent after inserting!\e[0m\n");
+		}
+		++tested;
+		if(check_k_closest(&forest, &points, prng, &res_points1, &res_points2)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mkd_forest_k_closest did not produce the same points as naive search!\e[0m\n");
+		}
+		fprintf(stderr, "\e[1;34mRemoving %d random points one at a time\e[0m\n", NUM_POINTS/3);
+		for(uint64_t i = 0; i < NUM_POINTS/3; ++i){
+			uint64_t j = cr8r_prng_uniform_u64(prng, 0, points.len);
+			int64_t point[3];
+			memcpy(point, cr8r_vec_get(&points, &cr8r_kdft_c3i64.super, j), sizeof(point));
+			memcpy(cr8r_vec_get(&points, &cr8r_kdft_c3i64.super, j), cr8r_vec_get(&points, &cr8r_kdft_c3i64.super, points.len - 1), sizeof(point));
+			--points.len;
+			ok = ok && cr8r_kd_forest_remove(&forest, &cr8r_kdft_c3i64, point);
+		}
+		int64_t missing[3] = {BOX_SIZE, BOX_SIZE, BOX_SIZE};
+		++tested;
+		if(ok && !cr8r_kd_forest_remove(&forest, &cr8r_kdft_c3i64, missing) && check_levels(&forest) && forest.len == points.len){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mkd forest is inconsistent after removing!\e[0m\n");
+		}
+		++tested;
+		if(check_k_closest(&forest, &points, prng, &res_points1, &res_points2)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mkd_forest_k_closest did not produce the same points as naive search after removing!\e[0m\n");
+		}
+	}
+	fprintf(stderr, "\e[1;34mCompacting forest\e[0m\n");
+	++tested;
+	if(cr8r_kd_forest_compact(&forest, &cr8r_kdft_c3i64) && !forest.deleted_len && check_levels(&forest) && check_k_closest(&forest, &points, prng, &res_points1, &res_points2)){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mkd forest is inconsistent after compacting!\e[0m\n");
+	}
+
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+	cr8r_kd_forest_delete(&forest, &cr8r_kdft_c3i64);
+	cr8r_vec_delete(&points, &cr8r_kdft_c3i64.super);
+	cr8r_vec_delete(&res_points1, &point_kcs.ft.super);
+	cr8r_vec_delete(&res_points2, &point_kcs.ft.super);
+	free(prng);
+}
+
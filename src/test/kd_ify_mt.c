@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <crater/kd_check.h>
+#include <crater/kd_tree.h>
+#include <crater/prand.h>
+
+static cr8r_kd_k_closest_state point_kcs;
+
+#define NUM_POINTS 200000
+#define KCS_COUNT 20
+#define KCS_TRIALS 10
+
+static bool check_k_closest(cr8r_vec *points, cr8r_prng *prng, int64_t box_size, cr8r_vec *res_points1, cr8r_vec *res_points2){
+	cr8r_kdwin_s2i64 bounds;
+	cr8r_kdwin_bounding_i64x3(&bounds, points, &cr8r_kdft_c3i64);
+	for(uint64_t i = 0; i < KCS_TRIALS; ++i){
+		int64_t point[3];
+		for(uint64_t j = 0; j < 3; ++j){
+			point[j] = (int64_t)cr8r_prng_uniform_u64(prng, 0, box_size + 1) - box_size/2;
+		}
+		cr8r_kd_k_closest(points, &cr8r_kdft_c3i64, &bounds, point, KCS_COUNT, res_points1);
+		cr8r_kd_k_closest_naive(points, &cr8r_kdft_c3i64, &bounds, point, KCS_COUNT, res_points2);
+		if(res_points1->len != res_points2->len){
+			return false;
+		}
+		point_kcs.pt = point;
+		cr8r_vec_sort(res_points1, &point_kcs.ft.super);
+		cr8r_vec_sort(res_points2, &point_kcs.ft.super);
+		for(uint64_t j = 0; j < res_points1->len; ++j){
+			double d_a = point_kcs.ft.sqdist(&point_kcs.ft, point, cr8r_vec_get(res_points1, &point_kcs.ft.super, j));
+			double d_b = point_kcs.ft.sqdist(&point_kcs.ft, point, cr8r_vec_get(res_points2, &point_kcs.ft.super, j));
+			if(d_a != d_b){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main(){
+	point_kcs.ft = cr8r_kdft_c3i64;
+	point_kcs.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
+	uint64_t tested = 0, passed = 0;
+	cr8r_prng *prng = cr8r_prng_init_lcg(0x2545f4914f6cdd1d);
+	cr8r_vec points = {}, res_points1 = {}, res_points2 = {};
+	cr8r_vec_init(&points, &cr8r_kdft_c3i64.super, NUM_POINTS);
+	cr8r_vec_init(&res_points1, &point_kcs.ft.super, KCS_COUNT + 1);
+	cr8r_vec_init(&res_points2, &point_kcs.ft.super, KCS_COUNT + 1);
+	// the small box has many duplicate coordinates, which exercises the handling of elements equal to the median
+	int64_t box_sizes[] = {2000000, 2000};
+	uint64_t thread_counts[] = {2, 3, 8};
+	for(uint64_t b = 0; b < sizeof(box_sizes)/sizeof(*box_sizes); ++b){
+		for(uint64_t t = 0; t < sizeof(thread_counts)/sizeof(*thread_counts); ++t){
+			fprintf(stderr, "\e[1;34mBuilding kd tree of %1$d random points within [-%2$"PRIi64", %2$"PRIi64"]^3 with %3$"PRIu64" threads\e[0m\n", NUM_POINTS, box_sizes[b]/2, thread_counts[t]);
+			cr8r_vec_clear(&points, &cr8r_kdft_c3i64.super);
+			for(uint64_t i = 0; i < NUM_POINTS; ++i){
+				int64_t point[3];
+				for(uint64_t j = 0; j < 3; ++j){
+					point[j] = (int64_t)cr8r_prng_uniform_u64(prng, 0, box_sizes[b] + 1) - box_sizes[b]/2;
+				}
+				cr8r_vec_pushr(&points, &cr8r_kdft_c3i64.super, point);
+			}
+			++tested;
+			if(!cr8r_kd_ify_mt(&points, &cr8r_kdft_c3i64, 0, points.len, thread_counts[t])){
+				fprintf(stderr, "\e[1;31mKD Tree build failed!\e[0m\n");
+			}else if(!cr8r_kd_check_tree(&points, &cr8r_kdft_c3i64, 0, points.len)){
+				fprintf(stderr, "\e[1;31mKD Tree built wrong!\e[0m\n");
+			}else{
+				++passed;
+			}
+			++tested;
+			if(check_k_closest(&points, prng, box_sizes[b], &res_points1, &res_points2)){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31mkd_k_closest did not produce the same points as naive search!\e[0m\n");
+			}
+		}
+	}
+
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+	cr8r_vec_delete(&points, &cr8r_kdft_c3i64.super);
+	cr8r_vec_delete(&res_points1, &point_kcs.ft.super);
+	cr8r_vec_delete(&res_points2, &point_kcs.ft.super);
+	free(prng);
+}
+
@@ -52,6 +52,60 @@ static int test_exm100(cr8r_vec *vec, cr8r_vec_ft *ft, cr8r_prng *prng){
 	return status;
 }
 
+// push a burst into a minmax heap with push_many or merge, then pop the smallest and largest quarters
+static int test_bulk(cr8r_vec_ft *ft, cr8r_prng *prng){
+	uint64_t sizes[] = {0, 1, 6, 100, 1000};
+	cr8r_vec heap, burst, all, out;
+	cr8r_vec_init(&heap, ft, 1);
+	cr8r_vec_init(&burst, ft, 1);
+	cr8r_vec_init(&all, ft, 1);
+	cr8r_vec_init(&out, ft, 1);
+	int status = 1;
+	for(uint64_t i = 0; i < sizeof(sizes)/sizeof(*sizes) && status; ++i){
+		for(uint64_t j = 0; j < sizeof(sizes)/sizeof(*sizes) && status; ++j){
+			cr8r_vec_clear(&heap, ft);
+			cr8r_vec_clear(&burst, ft);
+			cr8r_vec_clear(&all, ft);
+			for(uint64_t l = 0; l < sizes[i] + sizes[j]; ++l){
+				uint64_t x = cr8r_prng_uniform_u64(prng, 0, 500);
+				if(l < sizes[i]){
+					cr8r_mmheap_push(&heap, ft, &x);
+				}else{
+					cr8r_vec_pushr(&burst, ft, &x);
+				}
+				cr8r_vec_pushr(&all, ft, &x);
+			}
+			if(!(j&1 ? cr8r_mmheap_merge(&heap, ft, &burst) : cr8r_mmheap_push_many(&heap, ft, burst.buf, burst.len))){
+				status = 0;
+				break;
+			}
+			cr8r_vec_sort(&all, ft);
+			uint64_t k = all.len/4 + 1;
+			if(!cr8r_mmheap_pop_k_min(&heap, ft, k, &out) || out.len != (k < all.len ? k : all.len)){
+				status = 0;
+			}
+			for(uint64_t l = 0; l < out.len && status; ++l){
+				status = *(uint64_t*)cr8r_vec_get(&out, ft, l) == *(uint64_t*)cr8r_vec_get(&all, ft, l);
+			}
+			uint64_t popped = out.len;
+			if(status && (!cr8r_mmheap_pop_k_max(&heap, ft, k, &out) || out.len != (k < all.len - popped ? k : all.len - popped))){
+				status = 0;
+			}
+			for(uint64_t l = 0; l < out.len && status; ++l){
+				status = *(uint64_t*)cr8r_vec_get(&out, ft, l) == *(uint64_t*)cr8r_vec_get(&all, ft, all.len - 1 - l);
+			}
+			if(!status){
+				fprintf(stderr, "\e[1;31mBulk operations failed for heap of %"PRIu64" and burst of %"PRIu64"\e[0m\n", sizes[i], sizes[j]);
+			}
+		}
+	}
+	cr8r_vec_delete(&heap, ft);
+	cr8r_vec_delete(&burst, ft);
+	cr8r_vec_delete(&all, ft);
+	cr8r_vec_delete(&out, ft);
+	return status;
+}
+
 int main(){
 	fprintf(stderr, "\e[1;34mTesting vector minmax heap functions\e[0m\n");
 	uint64_t tested = 0, passed = 0;
@@ -84,6 +138,15 @@ int main(){
 		++passed;
 	}
 
+	fprintf(stderr, "\e[1;34mTesting push_many, pop_k_min, pop_k_max, and merge\e[0m\n");
+	++tested;
+	if(test_bulk(&ft, prng)){
+		fprintf(stderr, "\e[1;32mbulk operations test succeeded!\e[0m\n");
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mbulk operations test failed!\e[0m\n");
+	}
+
 	free(prng);
 	cr8r_vec_delete(&vec, &ft);
 	if(passed == tested){
@@ -3,9 +3,11 @@
 #include <string.h>
 #include <inttypes.h>
 #include <math.h>
+#include <time.h>
 
 #include <crater/kd_check.h>
 #include <crater/kd_tree.h>
+#include <crater/kd_bucket.h>
 
 static cr8r_kd_k_closest_state point_kcs;
 
@@ -15,6 +17,10 @@ static cr8r_kd_k_closest_state point_kcs;
 #define KCS_COUNT 50
 #define KCS_TRIALS 50
 #define KD_TRIALS 5
+#define RANGE_TRIALS 20
+#define BENCH_POINTS 200000
+#define BENCH_QUERIES 2000
+#define BENCH_K 10
 
 static void print_kcs(const cr8r_vec *points){
 	for(uint64_t i = 0; i < points->len; ++i){
@@ -40,6 +46,68 @@ static void get_bounds(cr8r_vec *points, cr8r_kdwin_s2i64 *bounds){
 	}
 }
 
+static int cmp_doubles(const void *_a, const void *_b){
+	double a = *(const double*)_a, b = *(const double*)_b;
+	return (a > b) - (a < b);
+}
+
+// compare the per node layout to the bucketed layout on the same random double points
+static bool bench_buckets(cr8r_prng *prng){
+	cr8r_kd_ft *ft = &cr8r_kdft_c3f64;
+	cr8r_vec points1 = {}, points2 = {}, queries = {}, res = {};
+	cr8r_kd_buckets buckets = {};
+	static double dists1[BENCH_QUERIES][BENCH_K], dists2[BENCH_QUERIES][BENCH_K];
+	bool ok = cr8r_vec_init(&points1, &ft->super, BENCH_POINTS) && cr8r_vec_init(&queries, &ft->super, BENCH_QUERIES) && cr8r_vec_init(&res, &ft->super, BENCH_K + 1);
+	for(uint64_t i = 0; i < BENCH_POINTS && ok; ++i){
+		double point[3] = {2*cr8r_prng_uniform01_double(prng) - 1, 2*cr8r_prng_uniform01_double(prng) - 1, 2*cr8r_prng_uniform01_double(prng) - 1};
+		ok = cr8r_vec_pushr(&points1, &ft->super, point);
+	}
+	for(uint64_t i = 0; i < BENCH_QUERIES && ok; ++i){
+		double point[3] = {2.2*cr8r_prng_uniform01_double(prng) - 1.1, 2.2*cr8r_prng_uniform01_double(prng) - 1.1, 2.2*cr8r_prng_uniform01_double(prng) - 1.1};
+		ok = cr8r_vec_pushr(&queries, &ft->super, point);
+	}
+	ok = ok && cr8r_vec_copy(&points2, &points1, &ft->super);
+	double bounds[6];
+	ok = ok && cr8r_kdwin_bounding_cf64(bounds, &points1, ft);
+	if(!ok){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate points for benchmark!\e[0m\n");
+		exit(1);
+	}
+	clock_t t0 = clock();
+	ok = cr8r_kd_ify(&points1, ft, 0, points1.len);
+	clock_t t1 = clock();
+	ok = ok && cr8r_kd_buckets_build(&buckets, &points2, ft, 0);
+	clock_t t2 = clock();
+	for(uint64_t i = 0; i < BENCH_QUERIES && ok; ++i){
+		const double *q = cr8r_vec_get(&queries, &ft->super, i);
+		ok = cr8r_kd_k_closest(&points1, ft, bounds, q, BENCH_K, &res) && res.len == BENCH_K;
+		for(uint64_t j = 0; j < res.len && ok; ++j){
+			dists1[i][j] = ft->sqdist(ft, q, cr8r_vec_get(&res, &ft->super, j));
+		}
+	}
+	clock_t t3 = clock();
+	for(uint64_t i = 0; i < BENCH_QUERIES && ok; ++i){
+		const double *q = cr8r_vec_get(&queries, &ft->super, i);
+		ok = cr8r_kd_buckets_k_closest(&buckets, &points2, ft, bounds, q, BENCH_K, &res) && res.len == BENCH_K;
+		for(uint64_t j = 0; j < res.len && ok; ++j){
+			dists2[i][j] = ft->sqdist(ft, q, cr8r_vec_get(&res, &ft->super, j));
+		}
+	}
+	clock_t t4 = clock();
+	for(uint64_t i = 0; i < BENCH_QUERIES && ok; ++i){
+		qsort(dists1[i], BENCH_K, sizeof(double), cmp_doubles);
+		ok = !memcmp(dists1[i], dists2[i], sizeof(dists1[i]));
+	}
+	fprintf(stderr, "\e[1;34mPer node kd tree: built in %.3fs, %d queries in %.3fs\e[0m\n", (double)(t1 - t0)/CLOCKS_PER_SEC, BENCH_QUERIES, (double)(t3 - t2)/CLOCKS_PER_SEC);
+	fprintf(stderr, "\e[1;34mBucketed kd tree: built in %.3fs, %d queries in %.3fs\e[0m\n", (double)(t2 - t1)/CLOCKS_PER_SEC, BENCH_QUERIES, (double)(t4 - t3)/CLOCKS_PER_SEC);
+	cr8r_kd_buckets_delete(&buckets);
+	cr8r_vec_delete(&points1, &ft->super);
+	cr8r_vec_delete(&points2, &ft->super);
+	cr8r_vec_delete(&queries, &ft->super);
+	cr8r_vec_delete(&res, &ft->super);
+	return ok;
+}
+
 int main(){
 	point_kcs.ft = cr8r_kdft_c3i64;
 	point_kcs.ft.super.cmp = cr8r_default_cmp_kd_kcs_pt_dist;
@@ -49,6 +117,11 @@ int main(){
 	cr8r_vec_init(&points, &cr8r_kdft_c3i64.super, NUM_POINTS);
 	cr8r_vec_init(&res_points1, &point_kcs.ft.super, KCS_COUNT + 1);
 	cr8r_vec_init(&res_points2, &point_kcs.ft.super, KCS_COUNT + 1);
+	cr8r_vec queries = {}, batch_res = {}, range_res1 = {}, range_res2 = {};
+	cr8r_vec_init(&range_res1, &cr8r_kdft_c3i64.super, NUM_POINTS);
+	cr8r_vec_init(&range_res2, &cr8r_kdft_c3i64.super, NUM_POINTS);
+	cr8r_vec_init(&queries, &cr8r_kdft_c3i64.super, KCS_TRIALS);
+	cr8r_vec_init(&batch_res, &point_kcs.ft.super, KCS_TRIALS*KCS_COUNT);
 	for(uint64_t trial = 0; trial < KD_TRIALS; ++trial){
 		cr8r_vec_clear(&points, &cr8r_kdft_c3i64.super);
 		fprintf(stderr, "\e[1;34mGenerating %1$d random lattice points within [-%2$d, %2$d]^3\e[0m\n", NUM_POINTS, BOX_SIZE/2);
@@ -126,6 +199,83 @@ int main(){
 				fprintf(stderr, "\e[1;31mkd_k_closest did not produce the same points as naive search!\e[0m\n");
 			}
 		}
+
+		fprintf(stderr, "\e[1;34mFinding points in %d random balls and boxes ...\e[0m\n", RANGE_TRIALS);
+		for(uint64_t i = 0; i < RANGE_TRIALS; ++i){
+			++tested;
+			int64_t point[3];
+			cr8r_kdwin_s2i64 box;
+			for(uint64_t j = 0; j < 3; ++j){
+				point[j] = (int64_t)cr8r_prng_uniform_u64(prng, 0, KCS_SIZE + 1) - KCS_SIZE/2;
+				box.bl[j] = (int64_t)cr8r_prng_uniform_u64(prng, 0, KCS_SIZE + 1) - KCS_SIZE/2;
+				box.tr[j] = box.bl[j] + (int64_t)cr8r_prng_uniform_u64(prng, 0, KCS_SIZE/2);
+			}
+			double r = cr8r_prng_uniform_u64(prng, 0, BOX_SIZE);
+			uint64_t naive_ball = 0, naive_box = 0;
+			for(uint64_t j = 0; j < points.len; ++j){
+				const int64_t *p = cr8r_vec_get(&points, &cr8r_kdft_c3i64.super, j);
+				naive_ball += cr8r_kdft_c3i64.sqdist(&cr8r_kdft_c3i64, point, p) <= r*r;
+				naive_box += box.bl[0] <= p[0] && p[0] <= box.tr[0] && box.bl[1] <= p[1] && p[1] <= box.tr[1] && box.bl[2] <= p[2] && p[2] <= box.tr[2];
+			}
+			uint64_t count_ball = cr8r_kd_count_within_radius(&points, &cr8r_kdft_c3i64, &bounds, point, r);
+			uint64_t count_box = cr8r_kd_count_in_box(&points, &cr8r_kdft_c3i64, &bounds, &box);
+			bool found_ball = cr8r_kd_within_radius(&points, &cr8r_kdft_c3i64, &bounds, point, r, &range_res1);
+			bool found_box = cr8r_kd_in_box(&points, &cr8r_kdft_c3i64, &bounds, &box, &range_res2);
+			for(uint64_t j = 0; j < range_res1.len && found_ball; ++j){
+				found_ball = cr8r_kdft_c3i64.sqdist(&cr8r_kdft_c3i64, point, cr8r_vec_get(&range_res1, &cr8r_kdft_c3i64.super, j)) <= r*r;
+			}
+			for(uint64_t j = 0; j < range_res2.len && found_box; ++j){
+				found_box = !cr8r_kdft_c3i64.min_sqdist(&cr8r_kdft_c3i64, &box, cr8r_vec_get(&range_res2, &cr8r_kdft_c3i64.super, j));
+			}
+			if(count_ball == naive_ball && count_box == naive_box && found_ball && found_box && range_res1.len == naive_ball && range_res2.len == naive_box){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31mRange queries found %"PRIu64"/%"PRIu64" points in ball (%"PRIu64" expected) and %"PRIu64"/%"PRIu64" in box (%"PRIu64" expected)!\e[0m\n",
+					count_ball, range_res1.len, naive_ball, count_box, range_res2.len, naive_box);
+			}
+		}
+
+		fprintf(stderr, "\e[1;34mFinding %1$d closest points for a batch of %2$d random points in [-%3$d, %3$d]^3 ...\e[0m\n", KCS_COUNT, KCS_TRIALS, KCS_SIZE);
+		cr8r_vec_clear(&queries, &cr8r_kdft_c3i64.super);
+		for(uint64_t i = 0; i < KCS_TRIALS; ++i){
+			int64_t point[3];
+			for(uint64_t j = 0; j < 3; ++j){
+				int64_t x = cr8r_prng_uniform_u64(prng, 0, KCS_SIZE + 1);
+				point[j] = x - KCS_SIZE/2;
+			}
+			cr8r_vec_pushr(&queries, &cr8r_kdft_c3i64.super, point);
+		}
+		++tested;
+		if(!cr8r_kd_k_closest_batch(&points, &cr8r_kdft_c3i64, &bounds, &queries, KCS_COUNT, &batch_res, 4) || batch_res.len != KCS_TRIALS*KCS_COUNT){
+			fprintf(stderr, "\e[1;31mkd_k_closest_batch failed!\e[0m\n");
+		}else{
+			bool is_same = true;
+			for(uint64_t i = 0; i < KCS_TRIALS && is_same; ++i){
+				point_kcs.pt = cr8r_vec_get(&queries, &cr8r_kdft_c3i64.super, i);
+				cr8r_kd_k_closest(&points, &cr8r_kdft_c3i64, &bounds, point_kcs.pt, KCS_COUNT, &res_points1);
+				cr8r_vec_sort(&res_points1, &point_kcs.ft.super);
+				for(uint64_t j = 0; j < KCS_COUNT; ++j){
+					double d_a = point_kcs.ft.sqdist(&point_kcs.ft, point_kcs.pt, cr8r_vec_get(&res_points1, &point_kcs.ft.super, j));
+					double d_b = point_kcs.ft.sqdist(&point_kcs.ft, point_kcs.pt, cr8r_vec_get(&batch_res, &point_kcs.ft.super, i*KCS_COUNT + j));
+					if(d_a != d_b){
+						is_same = false;
+					}
+				}
+			}
+			if(is_same){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31mkd_k_closest_batch did not produce the same points as kd_k_closest!\e[0m\n");
+			}
+		}
+	}
+
+	fprintf(stderr, "\e[1;34mBenchmarking %d closest point queries on %d random double points ...\e[0m\n", BENCH_K, BENCH_POINTS);
+	++tested;
+	if(bench_buckets(prng)){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mBucketed kd tree did not produce the same points as per node kd tree!\e[0m\n");
 	}
 
 	if(passed == tested){
@@ -136,6 +286,10 @@ int main(){
 	cr8r_vec_delete(&points, &cr8r_kdft_c3i64.super);
 	cr8r_vec_delete(&res_points1, &point_kcs.ft.super);
 	cr8r_vec_delete(&res_points2, &point_kcs.ft.super);
+	cr8r_vec_delete(&queries, &cr8r_kdft_c3i64.super);
+	cr8r_vec_delete(&batch_res, &point_kcs.ft.super);
+	cr8r_vec_delete(&range_res1, &cr8r_kdft_c3i64.super);
+	cr8r_vec_delete(&range_res2, &cr8r_kdft_c3i64.super);
 	free(prng);
 }
 
@@ -0,0 +1,206 @@
+#define _XOPEN_SOURCE 500
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <crater/prand.h>
+#include <crater/vec.h>
+#include <crater/bitvec.h>
+
+#define NUM_SAMPLES (1ull << 20)
+#define MAX_BINS 128
+// fail only on results this unlikely, so a correct sampler essentially never fails with a fixed seed
+#define MIN_P 1e-6
+
+static double chi2_prob_wilson_hilferty(double chi2, uint64_t k){
+	double z = (cbrt(chi2/k) - (1. - 2./(9.*k)))/sqrt(2./(9.*k));
+	return .5*erfc(M_SQRT1_2*z);
+}
+
+// Every bin is expected to get the same number of samples
+static bool report_chi2(const char *name, const uint64_t *counts, uint64_t bins){
+	double expected = 0, chi2 = 0;
+	for(uint64_t i = 0; i < bins; ++i){
+		expected += counts[i];
+	}
+	expected /= bins;
+	for(uint64_t i = 0; i < bins; ++i){
+		chi2 += (counts[i] - expected)*(counts[i] - expected)/expected;
+	}
+	double p = chi2_prob_wilson_hilferty(chi2, bins - 1);
+	fprintf(stderr, "\e[1;33m%s --> chi2 = %f with %"PRIu64" degrees of freedom (p ~= %f)\e[0m\n", name, chi2, bins - 1, p);
+	if(p < MIN_P){
+		fprintf(stderr, "\e[1;31m%s is not uniform!\e[0m\n", name);
+		return false;
+	}
+	return true;
+}
+
+// Check samples are in [a, b) and that they are uniform when divided into equal ranges (or one bin per value if b - a is small).
+// So b - a should be a multiple of MAX_BINS or so large that the ranges are almost exactly equal
+static bool check_uniform(const char *name, const uint64_t *samples, uint64_t a, uint64_t b){
+	uint64_t counts[MAX_BINS] = {}, l = b - a, bins = l < MAX_BINS ? l : MAX_BINS;
+	for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+		if(samples[i] - a >= l){
+			fprintf(stderr, "\e[1;31m%s gave %"PRIu64" which is not in [%"PRIu64", %"PRIu64")!\e[0m\n", name, samples[i], a, b);
+			return false;
+		}
+		++counts[(unsigned __int128)(samples[i] - a)*bins/l];
+	}
+	return report_chi2(name, counts, bins);
+}
+
+static uint64_t factorial(uint64_t n){
+	uint64_t res = 1;
+	while(n > 1){
+		res *= n--;
+	}
+	return res;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	uint64_t *samples = malloc(NUM_SAMPLES*sizeof(uint64_t));
+	cr8r_prng *prng = cr8r_prng_init_lcg(0x6c4b3e1b7f5a2d09);
+	if(!samples || !prng){
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return 1;
+	}
+
+	// covers small bounds (32 bit samples), bounds just over 32 bits, and bounds over 2**63 (where rejection is common)
+	const uint64_t ranges[][2] = {{0, 7}, {1000, 3048}, {5, 0x100000005ull}, {0, 3ull << 40}, {17, (1ull << 63) + 12345}, {0, -1ull}};
+	for(uint64_t j = 0; j < sizeof(ranges)/sizeof(*ranges); ++j){
+		uint64_t a = ranges[j][0], b = ranges[j][1];
+		char name[96];
+		fprintf(stderr, "\e[1;34mTesting %llu uniform samples on [%"PRIu64", %"PRIu64")...\e[0m\n", NUM_SAMPLES, a, b);
+		for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+			samples[i] = cr8r_prng_uniform_u64(prng, a, b);
+		}
+		tested += 2;
+		snprintf(name, sizeof(name), "uniform_u64(%"PRIu64", %"PRIu64")", a, b);
+		passed += check_uniform(name, samples, a, b);
+		cr8r_prng_fill_uniform_u64(prng, a, b, NUM_SAMPLES, samples);
+		snprintf(name, sizeof(name), "fill_uniform_u64(%"PRIu64", %"PRIu64")", a, b);
+		passed += check_uniform(name, samples, a, b);
+	}
+	++tested;
+	if(cr8r_prng_uniform_u64(prng, 12, 12) == 12){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31muniform_u64 on an empty range did not return its start!\e[0m\n");
+	}
+
+	// the 5 indices for a shuffle of length 5 (the last is always 0) correspond to the 120 permutations
+	fprintf(stderr, "\e[1;34mTesting %llu Fisher-Yates index sequences...\e[0m\n", NUM_SAMPLES/8);
+	{
+		uint64_t counts[120] = {}, idxs[5];
+		bool in_range = true;
+		for(uint64_t i = 0; i < NUM_SAMPLES/8; ++i){
+			cr8r_prng_fill_fisher_yates(prng, 5, 5, idxs);
+			uint64_t code = 0;
+			for(uint64_t k = 0; k < 5; ++k){
+				if(idxs[k] >= 5 - k){
+					in_range = false;
+				}
+				code = code*(5 - k) + idxs[k];
+			}
+			++counts[code < 120 ? code : 0];
+		}
+		tested += 2;
+		if(in_range){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mfill_fisher_yates gave an index out of range!\e[0m\n");
+		}
+		passed += report_chi2("fill_fisher_yates(5, 5)", counts, 120);
+	}
+
+	// shuffling a vector of length 5 should give every permutation equally often, and short vectors should not be touched
+	fprintf(stderr, "\e[1;34mTesting %llu vector shuffles...\e[0m\n", NUM_SAMPLES/8);
+	{
+		uint64_t counts[120] = {};
+		cr8r_vec vec;
+		if(!cr8r_vec_init(&vec, &cr8r_vecft_u64, 5)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return 1;
+		}
+		tested += 2;
+		cr8r_vec_shuffle(&vec, &cr8r_vecft_u64, prng);
+		uint64_t x = 0;
+		cr8r_vec_pushr(&vec, &cr8r_vecft_u64, &x);
+		cr8r_vec_shuffle(&vec, &cr8r_vecft_u64, prng);
+		if(vec.len == 1 && *(uint64_t*)vec.buf == 0){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mShuffling a short vector changed it!\e[0m\n");
+		}
+		for(x = 1; x < 5; ++x){
+			cr8r_vec_pushr(&vec, &cr8r_vecft_u64, &x);
+		}
+		for(uint64_t i = 0; i < NUM_SAMPLES/8; ++i){
+			cr8r_vec_shuffle(&vec, &cr8r_vecft_u64, prng);
+			// Lehmer code of the permutation
+			const uint64_t *p = vec.buf;
+			uint64_t code = 0;
+			for(uint64_t k = 0; k < 5; ++k){
+				uint64_t smaller = 0;
+				for(uint64_t l = k + 1; l < 5; ++l){
+					smaller += p[l] < p[k];
+				}
+				code += smaller*factorial(4 - k);
+			}
+			++counts[code];
+		}
+		passed += report_chi2("vec_shuffle(5)", counts, 120);
+		cr8r_vec_delete(&vec, &cr8r_vecft_u64);
+	}
+
+	// shuffling a bit vector of length 7 with 2 or 5 ones should give every arrangement of the ones equally often
+	for(uint64_t num_ones = 2; num_ones <= 5; num_ones += 3){
+		char name[64];
+		fprintf(stderr, "\e[1;34mTesting %llu bit vector shuffles with %"PRIu64" ones...\e[0m\n", NUM_SAMPLES/8, num_ones);
+		uint64_t counts[128] = {};
+		cr8r_bvec bvec;
+		if(!cr8r_bvec_init(&bvec, &cr8r_bvecft, 7)){
+			fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+			return 1;
+		}
+		for(uint64_t i = 0; i < 7; ++i){
+			cr8r_bvec_pushr(&bvec, &cr8r_bvecft, i < num_ones);
+		}
+		for(uint64_t i = 0; i < NUM_SAMPLES/8; ++i){
+			cr8r_bvec_shuffle(&bvec, prng);
+			++counts[bvec.buf[0] & 0x7F];
+		}
+		// compact the counts for the 21 bit patterns with the right popcount, and make sure no others appeared
+		uint64_t bins = 0, wrong = 0;
+		for(uint64_t i = 0; i < 128; ++i){
+			if((uint64_t)__builtin_popcountll(i) == num_ones){
+				counts[bins++] = counts[i];
+			}else{
+				wrong += counts[i];
+			}
+		}
+		tested += 2;
+		if(!wrong){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mbvec_shuffle changed the number of ones!\e[0m\n");
+		}
+		snprintf(name, sizeof(name), "bvec_shuffle(7, %"PRIu64")", num_ones);
+		passed += report_chi2(name, counts, bins);
+		cr8r_bvec_delete(&bvec, &cr8r_bvecft);
+	}
+
+	free(samples);
+	free(prng);
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
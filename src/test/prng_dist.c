@@ -0,0 +1,251 @@
+#define _XOPEN_SOURCE 500
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <crater/prand.h>
+#include <crater/prand_dist.h>
+
+#define NUM_SAMPLES (1ull << 20)
+#define NUM_BINS 1024
+// expected count for each group of values of a discrete distribution
+#define MIN_EXPECTED 20.
+// fail only on results this unlikely, so a correct sampler essentially never fails with a fixed seed
+#define MIN_P 1e-6
+
+static double chi2_prob_wilson_hilferty(double chi2, uint64_t k){
+	double z = (cbrt(chi2/k) - (1. - 2./(9.*k)))/sqrt(2./(9.*k));
+	return .5*erfc(M_SQRT1_2*z);
+}
+
+static double normal_cdf(double x){
+	return .5*erfc(-M_SQRT1_2*x);
+}
+
+static double exponential_cdf(double x){
+	return -expm1(-x);
+}
+
+static bool report_chi2(const char *name, const uint64_t *counts, const double *expected, uint64_t bins){
+	double chi2 = 0;
+	for(uint64_t i = 0; i < bins; ++i){
+		chi2 += (counts[i] - expected[i])*(counts[i] - expected[i])/expected[i];
+	}
+	double p = chi2_prob_wilson_hilferty(chi2, bins - 1);
+	fprintf(stderr, "\e[1;33m%s --> chi2 = %f with %"PRIu64" degrees of freedom (p ~= %f)\e[0m\n", name, chi2, bins - 1, p);
+	if(p < MIN_P){
+		fprintf(stderr, "\e[1;31m%s samples do not fit the distribution!\e[0m\n", name);
+		return false;
+	}
+	return true;
+}
+
+// Continuous samples are mapped through the cdf, which should make them uniform on [0, 1), and then counted in equal bins
+static bool check_continuous(const char *name, const double *samples, double (*cdf)(double)){
+	uint64_t *counts = calloc(NUM_BINS, sizeof(uint64_t));
+	double *expected = malloc(NUM_BINS*sizeof(double));
+	bool res = false;
+	if(counts && expected){
+		for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+			uint64_t bin = cdf(samples[i])*NUM_BINS;
+			++counts[bin < NUM_BINS ? bin : NUM_BINS - 1];
+		}
+		for(uint64_t i = 0; i < NUM_BINS; ++i){
+			expected[i] = (double)NUM_SAMPLES/NUM_BINS;
+		}
+		res = report_chi2(name, counts, expected, NUM_BINS);
+	}
+	free(counts);
+	free(expected);
+	return res;
+}
+
+// Discrete samples from 0 to max are counted in groups of consecutive values with at least MIN_EXPECTED expected samples each,
+// where pmf gives log(P(k)) and the last group includes everything past max
+static bool check_discrete(const char *name, const uint64_t *samples, uint64_t max, double (*log_pmf)(uint64_t, const double*), const double *params){
+	uint64_t *groups = malloc((max + 1)*sizeof(uint64_t)), *counts = calloc(max + 1, sizeof(uint64_t));
+	double *expected = calloc(max + 1, sizeof(double));
+	bool res = false;
+	if(groups && counts && expected){
+		uint64_t num_groups = 0;
+		double total = 0;
+		for(uint64_t k = 0; k <= max; ++k){
+			double e = NUM_SAMPLES*exp(log_pmf(k, params));
+			groups[k] = num_groups;
+			expected[num_groups] += e;
+			total += e;
+			if(expected[num_groups] >= MIN_EXPECTED && NUM_SAMPLES - total >= MIN_EXPECTED){
+				++num_groups;
+			}
+		}
+		expected[num_groups] += NUM_SAMPLES - total;
+		for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+			++counts[groups[samples[i] <= max ? samples[i] : max]];
+		}
+		res = report_chi2(name, counts, expected, num_groups + 1);
+	}
+	free(groups);
+	free(counts);
+	free(expected);
+	return res;
+}
+
+static double poisson_log_pmf(uint64_t k, const double *params){
+	double lambda = params[0];
+	return -lambda + k*log(lambda) - lgamma(k + 1.);
+}
+
+static double binomial_log_pmf(uint64_t k, const double *params){
+	double n = params[0], p = params[1];
+	if(k > n){
+		return -INFINITY;
+	}
+	return lgamma(n + 1) - lgamma(k + 1.) - lgamma(n - k + 1) + k*log(p) + (n - k)*log1p(-p);
+}
+
+static double alias_log_pmf(uint64_t k, const double *params){
+	return log(params[k]/params[12]);
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	double *samples = malloc(NUM_SAMPLES*sizeof(double));
+	uint64_t *isamples = malloc(NUM_SAMPLES*sizeof(uint64_t));
+	cr8r_prng *prng = cr8r_prng_init_xoro(0x4f1bbcdcbfa53e0b);
+	if(!samples || !isamples || !prng){
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return 1;
+	}
+
+	fprintf(stderr, "\e[1;34mTesting %llu ziggurat normal samples...\e[0m\n", NUM_SAMPLES);
+	for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+		samples[i] = cr8r_prng_normal(prng);
+	}
+	tested += 2;
+	passed += check_continuous("Normal", samples, normal_cdf);
+	cr8r_prng_fill_normal(prng, NUM_SAMPLES, samples);
+	passed += check_continuous("Normal (fill)", samples, normal_cdf);
+
+	fprintf(stderr, "\e[1;34mTesting %llu ziggurat exponential samples...\e[0m\n", NUM_SAMPLES);
+	for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+		samples[i] = cr8r_prng_exponential(prng);
+	}
+	tested += 2;
+	passed += check_continuous("Exponential", samples, exponential_cdf);
+	cr8r_prng_fill_exponential(prng, NUM_SAMPLES, samples);
+	passed += check_continuous("Exponential (fill)", samples, exponential_cdf);
+
+	// small means use inversion and large ones use transformed rejection
+	const double lambdas[] = {0.25, 3.5, 10, 37.5, 1000};
+	for(uint64_t j = 0; j < sizeof(lambdas)/sizeof(*lambdas); ++j){
+		char name[64];
+		fprintf(stderr, "\e[1;34mTesting %llu Poisson(%g) samples...\e[0m\n", NUM_SAMPLES, lambdas[j]);
+		uint64_t max = lambdas[j] + 20*sqrt(lambdas[j]) + 20;
+		for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+			isamples[i] = cr8r_prng_poisson(prng, lambdas[j]);
+		}
+		tested += 2;
+		snprintf(name, sizeof(name), "Poisson(%g)", lambdas[j]);
+		passed += check_discrete(name, isamples, max, poisson_log_pmf, lambdas + j);
+		cr8r_prng_fill_poisson(prng, lambdas[j], NUM_SAMPLES, isamples);
+		snprintf(name, sizeof(name), "Poisson(%g) (fill)", lambdas[j]);
+		passed += check_discrete(name, isamples, max, poisson_log_pmf, lambdas + j);
+	}
+
+	// covers inversion, BTRS, p > 1/2, and the edge cases p = 0 and p = 1
+	const double binomial_params[][2] = {{20, .3}, {100, .95}, {1000, .5}, {1000000, .7}, {12345, .001}, {50, 0}, {50, 1}};
+	for(uint64_t j = 0; j < sizeof(binomial_params)/sizeof(*binomial_params); ++j){
+		char name[64];
+		uint64_t n = binomial_params[j][0];
+		double p = binomial_params[j][1];
+		fprintf(stderr, "\e[1;34mTesting %llu Binomial(%"PRIu64", %g) samples...\e[0m\n", NUM_SAMPLES, n, p);
+		for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+			isamples[i] = cr8r_prng_binomial(prng, n, p);
+		}
+		tested += 2;
+		if(p == 0 || p == 1){
+			for(uint64_t k = 0; k < 2; ++k){
+				uint64_t i = 0;
+				while(i < NUM_SAMPLES && isamples[i] == p*n){
+					++i;
+				}
+				if(i == NUM_SAMPLES){
+					++passed;
+				}else{
+					fprintf(stderr, "\e[1;31mBinomial(%"PRIu64", %g) was not constant!\e[0m\n", n, p);
+				}
+				cr8r_prng_fill_binomial(prng, n, p, NUM_SAMPLES, isamples);
+			}
+			continue;
+		}
+		snprintf(name, sizeof(name), "Binomial(%"PRIu64", %g)", n, p);
+		passed += check_discrete(name, isamples, n, binomial_log_pmf, binomial_params[j]);
+		cr8r_prng_fill_binomial(prng, n, p, NUM_SAMPLES, isamples);
+		snprintf(name, sizeof(name), "Binomial(%"PRIu64", %g) (fill)", n, p);
+		passed += check_discrete(name, isamples, n, binomial_log_pmf, binomial_params[j]);
+	}
+
+	// weights[12] is the total, for alias_log_pmf.  Index 10 has weight 0 and must never be sampled
+	double weights[13] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 0, .5};
+	for(uint64_t i = 0; i < 12; ++i){
+		weights[12] += weights[i];
+	}
+	cr8r_prng_alias alias;
+	fprintf(stderr, "\e[1;34mTesting %llu alias table samples...\e[0m\n", NUM_SAMPLES);
+	++tested;
+	if(!cr8r_prng_alias_init(&alias, 12, weights)){
+		fprintf(stderr, "\e[1;31mFailed to build alias table!\e[0m\n");
+	}else{
+		++passed;
+		for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+			isamples[i] = cr8r_prng_alias_sample(&alias, prng);
+		}
+		for(uint64_t k = 0; k < 2; ++k){
+			const char *name = k ? "Alias table (fill)" : "Alias table";
+			uint64_t i = 0;
+			while(i < NUM_SAMPLES && isamples[i] != 10){
+				++i;
+			}
+			tested += 2;
+			if(i == NUM_SAMPLES){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31m%s sampled an index with weight 0!\e[0m\n", name);
+			}
+			// with index 10 never sampled, the chi squared test can skip it by counting it with index 11
+			for(uint64_t i = 0; i < NUM_SAMPLES; ++i){
+				if(isamples[i] == 11){
+					isamples[i] = 10;
+				}
+			}
+			weights[10] = weights[11];
+			passed += check_discrete(name, isamples, 10, alias_log_pmf, weights);
+			weights[10] = 0;
+			cr8r_prng_alias_fill(&alias, prng, NUM_SAMPLES, isamples);
+		}
+		cr8r_prng_alias_delete(&alias);
+	}
+	const double bad_weights[][2] = {{0, 0}, {1, -1}, {1, NAN}, {1, INFINITY}};
+	for(uint64_t i = 0; i < sizeof(bad_weights)/sizeof(*bad_weights); ++i){
+		++tested;
+		if(cr8r_prng_alias_init(&alias, 2, bad_weights[i])){
+			fprintf(stderr, "\e[1;31mBuilt an alias table from invalid weights!\e[0m\n");
+			cr8r_prng_alias_delete(&alias);
+		}else{
+			++passed;
+		}
+	}
+
+	free(samples);
+	free(isamples);
+	free(prng);
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
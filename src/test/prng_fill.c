@@ -0,0 +1,322 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <crater/prand.h>
+
+#define CHECK_STEPS 1000
+#define BENCH_BYTES (1ull << 24)
+
+typedef struct{
+	const char *name;
+	cr8r_prng *(*init)(uint64_t);
+	uint64_t seed;
+	// false for generators which can not be seeded, which are only benchmarked
+	bool seedable;
+} prng_kind;
+
+static cr8r_prng *init_chacha_seeded(uint64_t seed){
+	cr8r_prng *res = cr8r_prng_init_chacha();
+	if(res){
+		cr8r_prng_seed(res, seed);
+	}
+	return res;
+}
+
+static cr8r_prng *init_philox4x32(uint64_t seed){
+	return cr8r_prng_init_philox4x32(seed, 7);
+}
+
+static cr8r_prng *init_philox4x64(uint64_t seed){
+	return cr8r_prng_init_philox4x64(seed, 7);
+}
+
+static cr8r_prng *init_system(uint64_t seed){
+	return cr8r_prng_init_system();
+}
+
+static const prng_kind kinds[] = {
+	{"LCG", cr8r_prng_init_lcg, 0x29470e6ed1b94291, true},
+	{"SC LFG", cr8r_prng_init_lfg_sc, 0x6374e583f47f55cb, true},
+	{"M LFG", cr8r_prng_init_lfg_m, 0x8990c29a1d6c6ded, true},
+	{"MT", cr8r_prng_init_mt, 0xb95f32c4886c1d36, true},
+	{"Xoro", cr8r_prng_init_xoro, 0x31ebf64ab4a7f90e, true},
+	{"Xoro lanes", cr8r_prng_init_xoro_lanes, 0x31ebf64ab4a7f90e, true},
+	{"SplitMix", cr8r_prng_init_splitmix, 0xa0761d6478bd642f, true},
+	{"ChaCha", init_chacha_seeded, 0xe7037ed1a0b428db, true},
+	{"Philox4x32", init_philox4x32, 0x8ebc6af09c88c6e3, true},
+	{"Philox4x64", init_philox4x64, 0x589965cc75374cc3, true},
+	{"System", init_system, 0, false},
+};
+
+// get_bytes on one generator should give exactly the same bytes as calling get_u64 on another with the same seed,
+// including for a size which is not a multiple of 8 and after an odd number of 32 bit outputs
+static bool check_fill_matches_u64(const prng_kind *kind){
+	cr8r_prng *a = kind->init(kind->seed), *b = kind->init(kind->seed);
+	uint64_t size = 8*CHECK_STEPS + 3;
+	uint64_t *buf_a = malloc(size + 8), *buf_b = malloc(size + 8);
+	bool res = false;
+	if(a && b && buf_a && buf_b){
+		res = cr8r_prng_get_u32(a) == cr8r_prng_get_u32(b);
+		cr8r_prng_get_bytes(a, size, buf_a);
+		for(uint64_t i = 0; i <= CHECK_STEPS; ++i){
+			buf_b[i] = cr8r_prng_get_u64(b);
+		}
+		res = res && !memcmp(buf_a, buf_b, size);
+	}
+	free(a);
+	free(b);
+	free(buf_a);
+	free(buf_b);
+	return res;
+}
+
+// lane l of the multi lane generator should be the scalar generator with the same seed jumped forwards l*2**128 steps
+static bool check_lanes(){
+	cr8r_prng *lanes = cr8r_prng_init_xoro_lanes(0x9e6c63d0676a9a99);
+	cr8r_prng *scalar[CR8R_PRNG_XORO_LANES] = {};
+	uint64_t *buf = malloc(CHECK_STEPS*CR8R_PRNG_XORO_LANES*sizeof(uint64_t));
+	bool res = lanes && buf;
+	for(uint64_t l = 0; res && l < CR8R_PRNG_XORO_LANES; ++l){
+		scalar[l] = cr8r_prng_init_xoro(0x9e6c63d0676a9a99);
+		if(!scalar[l]){
+			res = false;
+			break;
+		}
+		for(uint64_t i = 0; i < l; ++i){
+			cr8r_prng_xoro_jump_t128(scalar[l]);
+		}
+	}
+	if(res){
+		cr8r_prng_get_bytes(lanes, CHECK_STEPS*CR8R_PRNG_XORO_LANES*sizeof(uint64_t), buf);
+		for(uint64_t i = 0; res && i < CHECK_STEPS; ++i){
+			for(uint64_t l = 0; l < CR8R_PRNG_XORO_LANES; ++l){
+				if(buf[i*CR8R_PRNG_XORO_LANES + l] != cr8r_prng_get_u64(scalar[l])){
+					res = false;
+					break;
+				}
+			}
+		}
+	}
+	for(uint64_t l = 0; l < CR8R_PRNG_XORO_LANES; ++l){
+		free(scalar[l]);
+	}
+	free(lanes);
+	free(buf);
+	return res;
+}
+
+// test vector from RFC 8439 section 2.3.2
+static bool check_chacha_rfc(){
+	uint32_t key[8], nonce[3] = {0x09000000, 0x4a000000, 0};
+	for(uint64_t i = 0; i < 8; ++i){
+		key[i] = 0x03020100 + 0x04040404*i;
+	}
+	static const uint8_t expected[64] = {
+		0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15, 0x50, 0x0f, 0xdd, 0x1f, 0xa3, 0x20, 0x71, 0xc4,
+		0xc7, 0xd1, 0xf4, 0xc7, 0x33, 0xc0, 0x68, 0x03, 0x04, 0x22, 0xaa, 0x9a, 0xc3, 0xd4, 0x6c, 0x4e,
+		0xd2, 0x82, 0x64, 0x46, 0x07, 0x9f, 0xaa, 0x09, 0x14, 0xc2, 0xd7, 0x05, 0xd9, 0x8b, 0x02, 0xa2,
+		0xb5, 0x12, 0x9c, 0xd1, 0xde, 0x16, 0x4e, 0xb9, 0xcb, 0xd0, 0x83, 0xe8, 0xa2, 0x50, 0x3c, 0x4e
+	};
+	uint8_t block[64];
+	cr8r_prng_chacha20_blocks(key, 1, nonce, 1, block);
+	if(memcmp(block, expected, 64)){
+		return false;
+	}
+	// blocks computed 8 at a time should match blocks computed one at a time, including across a counter wrap
+	uint8_t blocks[64*11];
+	cr8r_prng_chacha20_blocks(key, 0xfffffffa, nonce, 11, blocks);
+	for(uint64_t i = 0; i < 11; ++i){
+		cr8r_prng_chacha20_blocks(key, 0xfffffffa + (uint32_t)i, nonce, 1, block);
+		if(memcmp(block, blocks + 64*i, 64)){
+			return false;
+		}
+	}
+	return true;
+}
+
+// known answer tests from Random123 (counter all 0s, all 1s, and digits of pi)
+static bool check_philox_kat(){
+	static const uint32_t ctr32[3][4] = {{0, 0, 0, 0}, {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+	static const uint32_t key32[3][2] = {{0, 0}, {0xffffffff, 0xffffffff}, {0xa4093822, 0x299f31d0}};
+	static const uint32_t expected32[3][4] = {
+		{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+		{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+		{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}
+	};
+	static const uint64_t ctr64[3][4] = {{0, 0, 0, 0}, {-1, -1, -1, -1}, {0x243f6a8885a308d3, 0x13198a2e03707344, 0xa4093822299f31d0, 0x082efa98ec4e6c89}};
+	static const uint64_t key64[3][2] = {{0, 0}, {-1, -1}, {0x452821e638d01377, 0xbe5466cf34e90c6c}};
+	static const uint64_t expected64[3][4] = {
+		{0x16554d9eca36314c, 0xdb20fe9d672d0fdc, 0xd7e772cee186176b, 0x7e68b68aec7ba23b},
+		{0x87b092c3013fe90b, 0x438c3c67be8d0224, 0x9cc7d7c69cd777b6, 0xa09caebf594f0ba0},
+		{0xa528f45403e61d95, 0x38c72dbd566e9788, 0xa5a1610e72fd18b5, 0x57bd43b5e52b7fe6}
+	};
+	for(uint64_t i = 0; i < 3; ++i){
+		uint32_t out32[4];
+		uint64_t out64[4];
+		cr8r_prng_philox4x32(ctr32[i], key32[i], out32);
+		cr8r_prng_philox4x64(ctr64[i], key64[i], out64);
+		if(memcmp(out32, expected32[i], sizeof(out32)) || memcmp(out64, expected64[i], sizeof(out64))){
+			return false;
+		}
+	}
+	return true;
+}
+
+// seeking to a block should give the same bytes as generating everything before it, and both should
+// match the block function on the corresponding counter
+static bool check_philox_seek(){
+	cr8r_prng *a = cr8r_prng_init_philox4x32(0x0123456789abcdef, 0xfedcba9876543210);
+	cr8r_prng *b = cr8r_prng_init_philox4x32(0x0123456789abcdef, 0xfedcba9876543210);
+	uint32_t buf[4*100];
+	bool res = a && b;
+	if(res){
+		cr8r_prng_get_bytes(a, sizeof(buf), buf);
+		cr8r_prng_philox_seek(b, 37);
+		for(uint64_t i = 4*37; i < 4*100; ++i){
+			res = res && cr8r_prng_get_u32(b) == buf[i];
+		}
+		uint32_t ctr[4] = {99, 0, 0x76543210, 0xfedcba98}, key[2] = {0x89abcdef, 0x01234567}, out[4];
+		cr8r_prng_philox4x32(ctr, key, out);
+		res = res && !memcmp(out, buf + 4*99, sizeof(out));
+	}
+	free(a);
+	free(b);
+	return res;
+}
+
+// a child process must not get the same bytes as its parent from a buffered generator
+static bool check_fork(cr8r_prng *prng){
+	int fds[2];
+	uint64_t parent[4], child[4];
+	// make sure there are buffered bytes for the child to (incorrectly) reuse
+	cr8r_prng_get_u32(prng);
+	if(pipe(fds)){
+		return false;
+	}
+	pid_t pid = fork();
+	if(pid < 0){
+		return false;
+	}else if(!pid){
+		cr8r_prng_get_bytes(prng, sizeof(child), child);
+		ssize_t written = write(fds[1], child, sizeof(child));
+		_exit(written != sizeof(child));
+	}
+	cr8r_prng_get_bytes(prng, sizeof(parent), parent);
+	bool res = read(fds[0], child, sizeof(child)) == sizeof(child);
+	int status;
+	res = waitpid(pid, &status, 0) == pid && res && WIFEXITED(status) && !WEXITSTATUS(status);
+	close(fds[0]);
+	close(fds[1]);
+	return res && memcmp(parent, child, sizeof(parent));
+}
+
+static double bench_u32(cr8r_prng *prng){
+	clock_t t0 = clock();
+	uint32_t acc = 0;
+	for(uint64_t i = 0; i < BENCH_BYTES/sizeof(uint32_t); ++i){
+		acc ^= cr8r_prng_get_u32(prng);
+	}
+	clock_t t1 = clock();
+	// make sure the loop is not optimized out
+	if(acc == 0x12345678){
+		fprintf(stderr, "\e[1;34m(unlucky xor)\e[0m\n");
+	}
+	return (double)(t1 - t0)/CLOCKS_PER_SEC;
+}
+
+static double bench_fill(cr8r_prng *prng, void *buf){
+	clock_t t0 = clock();
+	cr8r_prng_get_bytes(prng, BENCH_BYTES, buf);
+	clock_t t1 = clock();
+	return (double)(t1 - t0)/CLOCKS_PER_SEC;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	const uint64_t num_kinds = sizeof(kinds)/sizeof(*kinds);
+	for(uint64_t k = 0; k < num_kinds; ++k){
+		if(!kinds[k].seedable){
+			continue;
+		}
+		fprintf(stderr, "\e[1;34mChecking %s get_bytes against get_u64...\e[0m\n", kinds[k].name);
+		++tested;
+		if(check_fill_matches_u64(kinds + k)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31m%s get_bytes and get_u64 produced different streams!\e[0m\n", kinds[k].name);
+		}
+	}
+	fprintf(stderr, "\e[1;34mChecking %d lane xoro against jumped scalar xoro...\e[0m\n", CR8R_PRNG_XORO_LANES);
+	++tested;
+	if(check_lanes()){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mMulti lane xoro did not match scalar xoro!\e[0m\n");
+	}
+
+	fprintf(stderr, "\e[1;34mChecking ChaCha20 block function against RFC 8439...\e[0m\n");
+	++tested;
+	if(check_chacha_rfc()){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mChaCha20 blocks did not match RFC 8439!\e[0m\n");
+	}
+	fprintf(stderr, "\e[1;34mChecking Philox block functions against Random123 known answers...\e[0m\n");
+	++tested;
+	if(check_philox_kat()){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mPhilox blocks did not match known answers!\e[0m\n");
+	}
+	fprintf(stderr, "\e[1;34mChecking Philox seek...\e[0m\n");
+	++tested;
+	if(check_philox_seek()){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mPhilox seek did not match generating the whole stream!\e[0m\n");
+	}
+	cr8r_prng *forked[2] = {cr8r_prng_init_system(), cr8r_prng_init_chacha()};
+	const char *forked_names[2] = {"System", "ChaCha"};
+	for(uint64_t i = 0; i < 2; ++i){
+		fprintf(stderr, "\e[1;34mChecking %s prng gives different bytes after fork...\e[0m\n", forked_names[i]);
+		++tested;
+		if(forked[i] && check_fork(forked[i])){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31m%s prng gave the same bytes in parent and child!\e[0m\n", forked_names[i]);
+		}
+		free(forked[i]);
+	}
+
+	void *buf = malloc(BENCH_BYTES);
+	if(!buf){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate buffer!\e[0m\n");
+		exit(1);
+	}
+	fprintf(stderr, "\e[1;34mGenerating %llu MB with get_u32 / get_bytes:\e[0m\n", BENCH_BYTES >> 20);
+	for(uint64_t k = 0; k < num_kinds; ++k){
+		cr8r_prng *prng = kinds[k].init(kinds[k].seed);
+		if(!prng){
+			fprintf(stderr, "\e[1;31mERROR: Could not allocate %s prng!\e[0m\n", kinds[k].name);
+			continue;
+		}
+		double t_u32 = bench_u32(prng);
+		double t_fill = bench_fill(prng, buf);
+		fprintf(stderr, "\e[1;34m%-12s %8.4fs %8.4fs (%.0f MB/s)\e[0m\n", kinds[k].name, t_u32, t_fill, (BENCH_BYTES >> 20)/t_fill);
+		free(prng);
+	}
+	free(buf);
+
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
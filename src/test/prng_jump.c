@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include <crater/prand.h>
+
+#define CHECK_OUTPUTS 64
+
+typedef struct{
+	const char *name;
+	cr8r_prng *(*init)(uint64_t);
+	uint64_t seed;
+	// number of steps to check against stepping directly, which is past the point where each generator stops stepping directly
+	uint64_t long_steps;
+} prng_kind;
+
+static cr8r_prng *init_philox4x32(uint64_t seed){
+	return cr8r_prng_init_philox4x32(seed, 7);
+}
+
+static cr8r_prng *init_philox4x64(uint64_t seed){
+	return cr8r_prng_init_philox4x64(seed, 7);
+}
+
+static const prng_kind kinds[] = {
+	{"LCG", cr8r_prng_init_lcg, 0x29470e6ed1b94291, 1000003},
+	{"SC LFG", cr8r_prng_init_lfg_sc, 0x6374e583f47f55cb, 1000003},
+	{"M LFG", cr8r_prng_init_lfg_m, 0x8990c29a1d6c6ded, 100003},
+	{"MT", cr8r_prng_init_mt, 0xb95f32c4886c1d36, 65536*2*312 + 12345},
+	{"Xoro", cr8r_prng_init_xoro, 0x31ebf64ab4a7f90e, 100003},
+	{"Xoro lanes", cr8r_prng_init_xoro_lanes, 0x31ebf64ab4a7f90e, 1000003},
+	{"SplitMix", cr8r_prng_init_splitmix, 0xa0761d6478bd642f, 100003},
+	{"Philox4x32", init_philox4x32, 0x8ebc6af09c88c6e3, 100003},
+	{"Philox4x64", init_philox4x64, 0x589965cc75374cc3, 100003},
+};
+
+static bool same_outputs(cr8r_prng *a, cr8r_prng *b){
+	for(uint64_t i = 0; i < CHECK_OUTPUTS; ++i){
+		if(cr8r_prng_get_u32(a) != cr8r_prng_get_u32(b)){
+			return false;
+		}
+	}
+	return true;
+}
+
+// jumping should give the same outputs as calling get_u32 n times, including after an odd number of outputs
+// have already been taken
+static bool check_jump_matches_steps(const prng_kind *kind, uint64_t n){
+	cr8r_prng *a = kind->init(kind->seed), *b = kind->init(kind->seed);
+	bool res = false;
+	if(a && b){
+		for(uint64_t i = 0; i < 3; ++i){
+			cr8r_prng_get_u32(a);
+			cr8r_prng_get_u32(b);
+		}
+		res = cr8r_prng_jump(a, n);
+		for(uint64_t i = 0; i < n; ++i){
+			cr8r_prng_get_u32(b);
+		}
+		res = res && same_outputs(a, b);
+	}
+	free(a);
+	free(b);
+	return res;
+}
+
+// jumps far beyond what can be checked by stepping should at least compose
+static bool check_jumps_compose(const prng_kind *kind){
+	const uint64_t x = (1ull << 62) + 123457, y = (1ull << 61) + 98765;
+	cr8r_prng *a = kind->init(kind->seed), *b = kind->init(kind->seed);
+	bool res = false;
+	if(a && b){
+		cr8r_prng_get_u32(a);
+		cr8r_prng_get_u32(b);
+		res = cr8r_prng_jump(a, x) && cr8r_prng_jump(a, y) && cr8r_prng_jump(b, x + y) && same_outputs(a, b);
+	}
+	free(a);
+	free(b);
+	return res;
+}
+
+// a thread's part of the stream should not overlap the next thread's part
+static bool check_jump_changes_outputs(const prng_kind *kind){
+	cr8r_prng *a = kind->init(kind->seed), *b = kind->init(kind->seed);
+	bool res = false;
+	if(a && b){
+		res = cr8r_prng_jump(b, 1ull << 40) && !same_outputs(a, b);
+	}
+	free(a);
+	free(b);
+	return res;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	for(uint64_t k = 0; k < sizeof(kinds)/sizeof(*kinds); ++k){
+		const prng_kind *kind = kinds + k;
+		const uint64_t steps[] = {0, 1, 17, 1001, kind->long_steps};
+		for(uint64_t i = 0; i < sizeof(steps)/sizeof(*steps); ++i){
+			fprintf(stderr, "\e[1;34mChecking %s jump by %"PRIu64" against stepping\e[0m\n", kind->name, steps[i]);
+			++tested;
+			if(check_jump_matches_steps(kind, steps[i])){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31m%s jump by %"PRIu64" did not match stepping!\e[0m\n", kind->name, steps[i]);
+			}
+		}
+		fprintf(stderr, "\e[1;34mChecking %s long jumps compose\e[0m\n", kind->name);
+		clock_t start = clock();
+		++tested;
+		if(check_jumps_compose(kind) && check_jump_changes_outputs(kind)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31m%s long jumps did not compose!\e[0m\n", kind->name);
+		}
+		fprintf(stderr, "\e[1;34m(took %.3fs)\e[0m\n", (double)(clock() - start)/CLOCKS_PER_SEC);
+	}
+	cr8r_prng *prngs[] = {cr8r_prng_init_system(), cr8r_prng_init_chacha()};
+	for(uint64_t i = 0; i < 2; ++i){
+		++tested;
+		if(prngs[i] && !cr8r_prng_jump(prngs[i], 1)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mJumping a %s prng did not fail!\e[0m\n", i ? "chacha" : "system");
+		}
+		free(prngs[i]);
+	}
+
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
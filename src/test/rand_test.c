@@ -86,6 +86,15 @@ int main(){
 	fprintf(stderr, "\e[1;33m --> %f\e[0m\n", test_stat);
 	free(prng);
 	
+	prng = cr8r_prng_init_chacha();
+	fprintf(stderr, "\e[1;34mTesting %d %s samples with Chi-squared byte counts test...\e[0m\n", 1000000, "ChaCha");
+	test_stat = cr8r_rndchk_chi2_bytes(prng, 1000000);
+	fprintf(stderr, "\e[1;33m --> %f (p ~= %f)\e[0m\n", test_stat, chi2_prob_wilson_hilferty(test_stat, 255));
+	fprintf(stderr, "\e[1;34mTesting %d %s samples with sequential bytes correlation test...\e[0m\n", 1000000, "ChaCha");
+	test_stat = cr8r_rndchk_corr_bytes(prng, 1000000);
+	fprintf(stderr, "\e[1;33m --> %f\e[0m\n", test_stat);
+	free(prng);
+	
 	prng = cr8r_prng_init_lfg_sc(0x6374e583f47f55cb);
 	fprintf(stderr, "\e[1;34mTesting %d %s samples with Chi-squared byte counts test...\e[0m\n", 1000000, "SC LFG");
 	test_stat = cr8r_rndchk_chi2_bytes(prng, 1000000);
@@ -114,6 +123,24 @@ int main(){
 	fprintf(stderr, "\e[1;33m --> %f\e[0m\n", test_stat);
 	free(prng);
 	
+	prng = cr8r_prng_init_xoro_lanes(0x31ebf64ab4a7f90e);
+	fprintf(stderr, "\e[1;34mTesting %d %s samples with Chi-squared byte counts test...\e[0m\n", 1000000, "Xoro lanes");
+	test_stat = cr8r_rndchk_chi2_bytes(prng, 1000000);
+	fprintf(stderr, "\e[1;33m --> %f (p ~= %f)\e[0m\n", test_stat, chi2_prob_wilson_hilferty(test_stat, 255));
+	fprintf(stderr, "\e[1;34mTesting %d %s samples with sequential bytes correlation test...\e[0m\n", 1000000, "Xoro lanes");
+	test_stat = cr8r_rndchk_corr_bytes(prng, 1000000);
+	fprintf(stderr, "\e[1;33m --> %f\e[0m\n", test_stat);
+	free(prng);
+	
+	prng = cr8r_prng_init_philox4x32(0x4bd6a1f3c0e2a7d5, 0);
+	fprintf(stderr, "\e[1;34mTesting %d %s samples with Chi-squared byte counts test...\e[0m\n", 1000000, "Philox");
+	test_stat = cr8r_rndchk_chi2_bytes(prng, 1000000);
+	fprintf(stderr, "\e[1;33m --> %f (p ~= %f)\e[0m\n", test_stat, chi2_prob_wilson_hilferty(test_stat, 255));
+	fprintf(stderr, "\e[1;34mTesting %d %s samples with sequential bytes correlation test...\e[0m\n", 1000000, "Philox");
+	test_stat = cr8r_rndchk_corr_bytes(prng, 1000000);
+	fprintf(stderr, "\e[1;33m --> %f\e[0m\n", test_stat);
+	free(prng);
+	
 	prng = cr8r_prng_init_mt(0xb95f32c4886c1d36);
 	fprintf(stderr, "\e[1;34mTesting %d %s samples with Chi-squared byte counts test...\e[0m\n", 1000000, "MT");
 	test_stat = cr8r_rndchk_chi2_bytes(prng, 1000000);
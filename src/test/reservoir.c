@@ -0,0 +1,203 @@
+#define _XOPEN_SOURCE 500
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <crater/reservoir.h>
+
+#define NUM_TRIALS 4000
+// fail only on results this unlikely, so a correct sampler essentially never fails with a fixed seed
+#define MIN_P 1e-6
+
+static double chi2_prob_wilson_hilferty(double chi2, uint64_t k){
+	double z = (cbrt(chi2/k) - (1. - 2./(9.*k)))/sqrt(2./(9.*k));
+	return .5*erfc(M_SQRT1_2*z);
+}
+
+static bool report_chi2(const char *name, const uint64_t *counts, const double *expected, uint64_t bins){
+	double chi2 = 0;
+	for(uint64_t i = 0; i < bins; ++i){
+		chi2 += (counts[i] - expected[i])*(counts[i] - expected[i])/expected[i];
+	}
+	double p = chi2_prob_wilson_hilferty(chi2, bins - 1);
+	fprintf(stderr, "\e[1;33m%s --> chi2 = %f with %"PRIu64" degrees of freedom (p ~= %f)\e[0m\n", name, chi2, bins - 1, p);
+	if(p < MIN_P){
+		fprintf(stderr, "\e[1;31m%s samples do not have the right distribution!\e[0m\n", name);
+		return false;
+	}
+	return true;
+}
+
+// Check a sample has the right size and no repeated elements, and count how often each range of width elements is sampled
+static bool count_sample(const char *name, const cr8r_vec *sample, uint64_t k, uint64_t *counts, uint64_t n, uint64_t width){
+	const uint64_t *buf = sample->buf;
+	if(sample->len != k){
+		fprintf(stderr, "\e[1;31m%s sample has %"PRIu64" elements instead of %"PRIu64"!\e[0m\n", name, sample->len, k);
+		return false;
+	}
+	for(uint64_t i = 0; i < sample->len; ++i){
+		if(buf[i] >= n){
+			fprintf(stderr, "\e[1;31m%s sampled a nonexistent element!\e[0m\n", name);
+			return false;
+		}
+		for(uint64_t j = 0; j < i; ++j){
+			if(buf[i] == buf[j]){
+				fprintf(stderr, "\e[1;31m%s sampled an element twice!\e[0m\n", name);
+				return false;
+			}
+		}
+		++counts[buf[i]/width];
+	}
+	return true;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_prng *prng = cr8r_prng_init_xoro(0x2545f4914f6cdd1d);
+	cr8r_vec nums, sample;
+	uint64_t n = 20000, k = 10;
+	if(!prng || !cr8r_vec_init(&nums, &cr8r_vecft_u64, n)){
+		fprintf(stderr, "\e[1;31mAllocation failed!\e[0m\n");
+		return 1;
+	}
+	for(uint64_t i = 0; i < n; ++i){
+		cr8r_vec_pushr(&nums, &cr8r_vecft_u64, &i);
+	}
+
+	// every element should be in the sample with probability k/n, so each range of n/100 should get k/100*NUM_TRIALS hits
+	double expected[100];
+	for(uint64_t i = 0; i < 100; ++i){
+		expected[i] = k/100.*NUM_TRIALS;
+	}
+	for(uint64_t mode = 0; mode < 3; ++mode){
+		const char *name = (const char*[]){"vec_sample", "reservoir_push", "reservoir_skip"}[mode];
+		fprintf(stderr, "\e[1;34mTesting %s for %d samples of %"PRIu64" out of %"PRIu64"...\e[0m\n", name, NUM_TRIALS, k, n);
+		uint64_t counts[100] = {}, trial = 0;
+		for(; trial < NUM_TRIALS; ++trial){
+			if(mode == 0){
+				if(!cr8r_vec_sample(&sample, &nums, &cr8r_vecft_u64, k, prng)){
+					break;
+				}
+			}else{
+				cr8r_reservoir res;
+				if(!cr8r_reservoir_init(&res, &cr8r_vecft_u64, k, prng)){
+					break;
+				}
+				for(uint64_t i = 0; i < n; ++i){
+					uint64_t skip = cr8r_reservoir_skip(&res);
+					if(mode == 2 && skip){
+						skip = skip < n - i ? skip : n - i;
+						cr8r_reservoir_advance(&res, skip);
+						i += skip - 1;
+					}else{
+						cr8r_reservoir_push(&res, &cr8r_vecft_u64, &i);
+					}
+				}
+				sample = res.sample;
+			}
+			bool ok = count_sample(name, &sample, k, counts, n, n/100);
+			cr8r_vec_delete(&sample, &cr8r_vecft_u64);
+			if(!ok){
+				break;
+			}
+		}
+		tested += 2;
+		if(trial == NUM_TRIALS){
+			++passed;
+			passed += report_chi2(name, counts, expected, 100);
+		}
+	}
+
+	fprintf(stderr, "\e[1;34mTesting vec_sample with k >= n...\e[0m\n");
+	++tested;
+	if(cr8r_vec_sample(&sample, &nums, &cr8r_vecft_u64, n + 5, prng)){
+		if(!cr8r_vec_cmp(&sample, &nums, &cr8r_vecft_u64)){
+			++passed;
+		}else{
+			fprintf(stderr, "\e[1;31mSampling at least as many elements as a vector has did not copy it!\e[0m\n");
+		}
+		cr8r_vec_delete(&sample, &cr8r_vecft_u64);
+	}
+
+	// element i has weight i + 1, except element 7 which has weight 0.
+	// With k = 2, element i is sampled first with probability p_i and then second with probability p_j*p_i/(1 - p_j) for j != i
+	uint64_t wn = 20, wk = 2;
+	double weights[20], total_weight = 0, wexpected[20] = {};
+	for(uint64_t i = 0; i < wn; ++i){
+		weights[i] = i == 7 ? 0 : i + 1;
+		total_weight += weights[i];
+	}
+	for(uint64_t i = 0; i < wn; ++i){
+		double p_i = weights[i]/total_weight;
+		wexpected[i] = p_i;
+		for(uint64_t j = 0; j < wn; ++j){
+			if(j != i){
+				double p_j = weights[j]/total_weight;
+				wexpected[i] += p_j*p_i/(1 - p_j);
+			}
+		}
+		wexpected[i] *= NUM_TRIALS*10;
+	}
+	nums.len = wn;
+	fprintf(stderr, "\e[1;34mTesting vec_sample_weighted for %d samples of %"PRIu64" out of %"PRIu64"...\e[0m\n", NUM_TRIALS*10, wk, wn);
+	{
+		uint64_t counts[20] = {}, trial = 0;
+		for(; trial < NUM_TRIALS*10; ++trial){
+			if(!cr8r_vec_sample_weighted(&sample, &nums, &cr8r_vecft_u64, wk, weights, prng)){
+				break;
+			}
+			bool ok = count_sample("vec_sample_weighted", &sample, wk, counts, wn, 1);
+			cr8r_vec_delete(&sample, &cr8r_vecft_u64);
+			if(!ok){
+				break;
+			}
+		}
+		tested += 3;
+		if(trial == NUM_TRIALS*10){
+			++passed;
+			if(!counts[7]){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31mvec_sample_weighted sampled an element with weight 0!\e[0m\n");
+			}
+			// element 7 is never sampled, so leave it out of the chi squared test
+			counts[7] = counts[wn - 1];
+			wexpected[7] = wexpected[wn - 1];
+			passed += report_chi2("vec_sample_weighted", counts, wexpected, wn - 1);
+		}
+	}
+
+	// a weighted reservoir with fewer positive weight elements than k keeps all of them
+	fprintf(stderr, "\e[1;34mTesting weighted reservoir with fewer than k elements...\e[0m\n");
+	{
+		cr8r_wreservoir res;
+		++tested;
+		if(cr8r_wreservoir_init(&res, &cr8r_vecft_u64, 5, prng)){
+			for(uint64_t i = 0; i < 6; ++i){
+				cr8r_wreservoir_push(&res, &cr8r_vecft_u64, &i, i == 2 ? 0 : .5);
+			}
+			uint64_t seen = 0;
+			for(uint64_t i = 0; i < res.sample.len; ++i){
+				seen |= 1ull << ((uint64_t*)res.sample.buf)[i];
+			}
+			if(res.sample.len == 5 && seen == 0x3B){
+				++passed;
+			}else{
+				fprintf(stderr, "\e[1;31mWeighted reservoir did not keep every element!\e[0m\n");
+			}
+			cr8r_wreservoir_delete(&res, &cr8r_vecft_u64);
+		}
+	}
+
+	cr8r_vec_delete(&nums, &cr8r_vecft_u64);
+	free(prng);
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
@@ -0,0 +1,111 @@
+#define _XOPEN_SOURCE 500
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <crater/vec.h>
+
+// large enough to use the blocked shuffle instead of falling back to Fisher-Yates
+#define NUM_ENTS (1ull << 20)
+#define BINS 16
+// fail only on results this unlikely, so a correct shuffle essentially never fails with a fixed seed
+#define MIN_P 1e-6
+
+static double chi2_prob_wilson_hilferty(double chi2, uint64_t k){
+	double z = (cbrt(chi2/k) - (1. - 2./(9.*k)))/sqrt(2./(9.*k));
+	return .5*erfc(M_SQRT1_2*z);
+}
+
+// In a uniform permutation, the range of positions an element moves to is independent of the range it started in,
+// so count elements by (starting range, final range) and check every pair is equally common
+static bool check_spread(const cr8r_vec *vec, uint64_t threads){
+	uint64_t counts[BINS][BINS] = {};
+	const uint64_t *buf = vec->buf;
+	for(uint64_t i = 0; i < NUM_ENTS; ++i){
+		++counts[buf[i]*BINS/NUM_ENTS][i*BINS/NUM_ENTS];
+	}
+	double expected = (double)NUM_ENTS/(BINS*BINS), chi2 = 0;
+	for(uint64_t i = 0; i < BINS; ++i){
+		for(uint64_t j = 0; j < BINS; ++j){
+			chi2 += (counts[i][j] - expected)*(counts[i][j] - expected)/expected;
+		}
+	}
+	double p = chi2_prob_wilson_hilferty(chi2, BINS*BINS - 1);
+	fprintf(stderr, "\e[1;33m%"PRIu64" threads --> chi2 = %f with %d degrees of freedom (p ~= %f)\e[0m\n", threads, chi2, BINS*BINS - 1, p);
+	if(p < MIN_P){
+		fprintf(stderr, "\e[1;31mElements did not move uniformly!\e[0m\n");
+		return false;
+	}
+	return true;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_vec nums_asc, nums_shuf, nums_shuf2;
+	cr8r_prng *prng = cr8r_prng_init_xoro(0x8d2b4b3c1f0e9a77);
+	if(!prng){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate prng!\e[0m\n");
+		exit(1);
+	}
+	if(!cr8r_vec_init(&nums_asc, &cr8r_vecft_u64, NUM_ENTS)){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate vector!\e[0m\n");
+		exit(1);
+	}
+	for(uint64_t i = 0; i < NUM_ENTS; ++i){
+		cr8r_vec_pushr(&nums_asc, &cr8r_vecft_u64, &i);
+	}
+	if(!cr8r_vec_copy(&nums_shuf, &nums_asc, &cr8r_vecft_u64) || !cr8r_vec_copy(&nums_shuf2, &nums_asc, &cr8r_vecft_u64)){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate vector!\e[0m\n");
+		exit(1);
+	}
+	const uint64_t thread_counts[] = {0, 1, 3, 8, 100000};
+	for(uint64_t j = 0; j < sizeof(thread_counts)/sizeof(*thread_counts); ++j){
+		uint64_t threads = thread_counts[j];
+		fprintf(stderr, "\e[1;34mTesting shuffling %llu element vector with %"PRIu64" threads...\e[0m\n", NUM_ENTS, threads);
+		cr8r_prng *prng2 = malloc(sizeof(cr8r_prng) + prng->state_size);
+		if(!prng2){
+			fprintf(stderr, "\e[1;31mERROR: Could not allocate prng!\e[0m\n");
+			exit(1);
+		}
+		memcpy(prng2, prng, sizeof(cr8r_prng) + prng->state_size);
+		memcpy(nums_shuf2.buf, nums_shuf.buf, NUM_ENTS*sizeof(uint64_t));
+		cr8r_vec_shuffle_mt(&nums_shuf, &cr8r_vecft_u64, prng, threads);
+		cr8r_vec_shuffle_mt(&nums_shuf2, &cr8r_vecft_u64, prng2, threads);
+		free(prng2);
+		tested += 3;
+		if(cr8r_vec_cmp(&nums_shuf, &nums_shuf2, &cr8r_vecft_u64)){
+			fprintf(stderr, "\e[1;31mShuffling with the same prng state gave different results!\e[0m\n");
+		}else{
+			++passed;
+		}
+		passed += check_spread(&nums_shuf, threads);
+		// nums_shuf2 is a copy of nums_shuf, so use it to mark which elements have been seen
+		uint64_t *seen = nums_shuf2.buf, i = 0;
+		memset(seen, 0, NUM_ENTS*sizeof(uint64_t));
+		for(; i < NUM_ENTS; ++i){
+			uint64_t x = ((uint64_t*)nums_shuf.buf)[i];
+			if(x >= NUM_ENTS || seen[x]){
+				break;
+			}
+			seen[x] = 1;
+		}
+		if(i != NUM_ENTS){
+			fprintf(stderr, "\e[1;31mShuffled vector is not a permutation!\e[0m\n");
+		}else{
+			++passed;
+		}
+	}
+	cr8r_vec_delete(&nums_asc, &cr8r_vecft_u64);
+	cr8r_vec_delete(&nums_shuf, &cr8r_vecft_u64);
+	cr8r_vec_delete(&nums_shuf2, &cr8r_vecft_u64);
+	free(prng);
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
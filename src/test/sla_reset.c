@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include <crater/sla.h>
+
+#define NUM_ALLOCS 10000
+
+static uint64_t count_free(const cr8r_sla *sla){
+	uint64_t n = 0;
+	for(void *it = sla->first_elem; it; it = *(void**)it){
+		++n;
+	}
+	n += (sla->bump_end - sla->bump)/sla->elem_size;
+	for(uint64_t i = sla->bump_slab + 1; i < sla->slabs_len; ++i){
+		n += sla->slabs[i].cap;
+	}
+	return n;
+}
+
+static uint64_t total_cap(const cr8r_sla *sla){
+	uint64_t n = 0;
+	for(uint64_t i = 0; i < sla->slabs_len; ++i){
+		n += sla->slabs[i].cap;
+	}
+	return n;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_sla sla [[gnu::cleanup(cr8r_sla_delete)]] = {};
+	void **ptrs = malloc(NUM_ALLOCS*sizeof(void*));
+	if(!ptrs || !cr8r_sla_init(&sla, sizeof(uint64_t), 16)){
+		free(ptrs);
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate slab allocator!\e[0m\n");
+		exit(1);
+	}
+	sla.max_slab_cap = 1024;
+	fprintf(stderr, "\e[1;34mAllocating %d elements with slab size capped at %"PRIu64"...\e[0m\n", NUM_ALLOCS, sla.max_slab_cap);
+	for(uint64_t i = 0; i < NUM_ALLOCS; ++i){
+		if(!(ptrs[i] = cr8r_sla_alloc(&sla))){
+			free(ptrs);
+			fprintf(stderr, "\e[1;31mERROR: Could not allocate element!\e[0m\n");
+			exit(1);
+		}
+		*(uint64_t*)ptrs[i] = i;
+	}
+	++tested;
+	if(sla.slab_cap == sla.max_slab_cap && total_cap(&sla) - count_free(&sla) == NUM_ALLOCS){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mSlab growth did not respect max_slab_cap!\e[0m\n");
+	}
+	fprintf(stderr, "\e[1;34mFreeing all but every 3000th element and trimming...\e[0m\n");
+	for(uint64_t i = 0; i < NUM_ALLOCS; ++i){
+		if(i%3000){
+			cr8r_sla_free(&sla, ptrs[i]);
+		}
+	}
+	uint64_t slabs_before = sla.slabs_len;
+	uint64_t released = cr8r_sla_trim(&sla);
+	++tested;
+	if(released && sla.slabs_len + released == slabs_before && total_cap(&sla) - count_free(&sla) == (NUM_ALLOCS + 2999)/3000){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mcr8r_sla_trim released %"PRIu64" of %"PRIu64" slabs incorrectly!\e[0m\n", released, slabs_before);
+	}
+	++tested;
+	bool kept = true;
+	for(uint64_t i = 0; i < NUM_ALLOCS; i += 3000){
+		kept = kept && *(uint64_t*)ptrs[i] == i;
+	}
+	if(kept){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mcr8r_sla_trim clobbered allocated elements!\e[0m\n");
+	}
+	fprintf(stderr, "\e[1;34mResetting allocator...\e[0m\n");
+	uint64_t slabs_len = sla.slabs_len;
+	cr8r_sla_reset(&sla, false);
+	++tested;
+	if(sla.slabs_len == slabs_len && count_free(&sla) == total_cap(&sla)){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mcr8r_sla_reset did not free all elements!\e[0m\n");
+	}
+	fprintf(stderr, "\e[1;34mRefilling kept slabs...\e[0m\n");
+	uint64_t cap = total_cap(&sla);
+	for(uint64_t i = 0; i < cap; ++i){
+		cr8r_sla_alloc(&sla);
+	}
+	++tested;
+	if(sla.slabs_len == slabs_len && !count_free(&sla)){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mRefilling after cr8r_sla_reset did not reuse kept slabs!\e[0m\n");
+	}
+	cr8r_sla_reset(&sla, true);
+	++tested;
+	if(sla.slabs_len == 1 && sla.slab_cap == 16 && count_free(&sla) == 16){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mcr8r_sla_reset did not release slabs!\e[0m\n");
+	}
+	free(ptrs);
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <crater/stats.h>
+#include <crater/hash.h>
+#include <crater/avl.h>
+#include <crater/vec.h>
+
+#define NUM_ENTS 10000
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_stats_clear();
+
+	fprintf(stderr, "\e[1;34mInserting %d entries into a hash table and removing half...\e[0m\n", NUM_ENTS);
+	cr8r_hashtbl_t ht;
+	if(!cr8r_hash_init(&ht, &cr8r_htft_u64_u64, 1)){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate hash table!\e[0m\n");
+		exit(1);
+	}
+	for(uint64_t i = 0; i < NUM_ENTS; ++i){
+		cr8r_hash_insert(&ht, &cr8r_htft_u64_u64, &(uint64_t[2]){i, i}, NULL);
+	}
+	for(uint64_t i = 0; i < NUM_ENTS; i += 2){
+		cr8r_hash_remove(&ht, &cr8r_htft_u64_u64, &i);
+	}
+	cr8r_hash_stats hstats;
+	cr8r_hash_get_stats(&ht, &cr8r_htft_u64_u64, &hstats);
+	cr8r_hash_stats_dump(stderr, &hstats);
+	uint64_t hist_total = 0;
+	for(uint64_t i = 0; i < CR8R_STATS_PROBE_BUCKETS; ++i){
+		hist_total += hstats.probe_hist[i];
+	}
+	++tested;
+	if(hstats.len == NUM_ENTS/2 && hist_total == hstats.len && hstats.tombstones == NUM_ENTS/2 && hstats.avg_probe <= hstats.max_probe){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mHash table statistics are wrong!\e[0m\n");
+	}
+	cr8r_hash_destroy(&ht, &cr8r_htft_u64_u64);
+
+	fprintf(stderr, "\e[1;34mInserting %d entries into an avl tree in order...\e[0m\n", NUM_ENTS);
+	cr8r_avl_ft avlft;
+	cr8r_sla sla [[gnu::cleanup(cr8r_sla_delete)]] = {};
+	if(!cr8r_avl_ft_initsla(&avlft, &sla, sizeof(uint64_t), 64, cr8r_default_cmp_u64, NULL)){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate slab allocator!\e[0m\n");
+		exit(1);
+	}
+	cr8r_avl_node *r = NULL;
+	for(uint64_t i = 0; i < NUM_ENTS; ++i){
+		cr8r_avl_insert(&r, &i, &avlft);
+	}
+	cr8r_avl_stats astats;
+	cr8r_avl_get_stats(r, &astats);
+	cr8r_avl_stats_dump(stderr, &astats);
+	++tested;
+	if(astats.nodes == NUM_ENTS && astats.height >= log2(NUM_ENTS) && astats.height <= 1.45*log2(NUM_ENTS + 2) && astats.avg_depth <= astats.height){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mAvl tree statistics are wrong!\e[0m\n");
+	}
+	for(uint64_t i = 0; i < NUM_ENTS; i += 2){
+		cr8r_avl_remove(&r, &i, &avlft);
+	}
+	cr8r_sla_stats sstats;
+	cr8r_sla_get_stats(&sla, &sstats);
+	cr8r_sla_stats_dump(stderr, &sstats);
+	++tested;
+	if(sstats.allocated == NUM_ENTS/2 && sstats.free_listed == NUM_ENTS/2 && sstats.allocated + sstats.free_listed + sstats.untouched == sstats.cap && !sstats.free_slabs){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mSlab allocator statistics are wrong!\e[0m\n");
+	}
+	cr8r_avl_delete(r, &avlft);
+
+	cr8r_vec vec;
+	cr8r_vec_init(&vec, &cr8r_vecft_u64, 1);
+	for(uint64_t i = 0; i < NUM_ENTS; ++i){
+		cr8r_vec_pushr(&vec, &cr8r_vecft_u64, &i);
+	}
+	cr8r_vec_delete(&vec, &cr8r_vecft_u64);
+
+	cr8r_stats_dump(stderr);
+	#ifdef CR8R_STATS
+	++tested;
+	if(cr8r_stats_counters.hash_resizes && cr8r_stats_counters.hash_lookups && cr8r_stats_counters.avl_rotations && cr8r_stats_counters.vec_grows && cr8r_stats_counters.sla_slabs_allocated){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mEvent counters were not updated!\e[0m\n");
+	}
+	#endif
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+}
+
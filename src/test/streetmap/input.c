@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 #include <crater/hash.h>
 #include <crater/pheap.h>
@@ -176,23 +177,24 @@ static bool read_file(const char *path, graph *out){
 	return 1;
 }
 
-int main(int argc, char **argv){
-	if(argc != 2){
-		fprintf(stderr, "\e[1;31mPlease specify the file to read!\e[0m\n");
-		exit(EXIT_FAILURE);
+// find the shortest path from the start node to the target node using dijkstra's algorithm.
+// if track_root is false, the root of the frontier is found from scratch on each decrease key, which is how
+// cr8r_pheap_decreased_key works, so that the cost of walking up to the root can be compared
+static street_node *shortest_path(graph *graph, bool track_root){
+	for(street_node *it = cr8r_hash_next(&graph->nodes, &node_ft, NULL); it; it = cr8r_hash_next(&graph->nodes, &node_ft, it)){
+		it->dist = INFINITY;
+		it->visited = false;
+		it->imeta = (cr8r_pheap_node){};
 	}
-	graph graph = {.start_id=104314819, .target_id=104304705};
-	node_pqft.base.data = &graph.nodes;
-	read_file(argv[1], &graph);
-	street_node *start = cr8r_hash_get(&graph.nodes, &node_ft, &(street_node){.id=graph.start_id});
-	graph.frontier = CR8R_INNER_S(start, &node_pqft);
+	street_node *start = cr8r_hash_get(&graph->nodes, &node_ft, &(street_node){.id=graph->start_id});
+	graph->frontier = CR8R_INNER_S(start, &node_pqft);
 	start->dist = 0;
 	start->visited = true;
 	street_node *curr = NULL;
 	void *tmp;
-	while((tmp = cr8r_pheap_pop(&graph.frontier, &node_pqft))){
+	while((tmp = cr8r_pheap_pop(&graph->frontier, &node_pqft))){
 		curr = CR8R_OUTER_S(tmp, &node_pqft);
-		if(curr->id == graph.target_id){
+		if(curr->id == graph->target_id){
 			break;
 		}
 		for(street_neighbor *out = curr->out; out; out = out->next){
@@ -201,20 +203,48 @@ int main(int argc, char **argv){
 				key.u = out->id;
 				key.v = curr->id;
 			}
-			street_edge *edge = cr8r_hash_get(&graph.edges, &edge_ft, &key);
-			street_node *node = cr8r_hash_get(&graph.nodes, &node_ft, &(street_node){.id = out->id});
+			street_edge *edge = cr8r_hash_get(&graph->edges, &edge_ft, &key);
+			street_node *node = cr8r_hash_get(&graph->nodes, &node_ft, &(street_node){.id = out->id});
 			double dist_here = curr->dist + edge->length;
 			if(!node->visited){
 				node->visited = true;
 				node->dist = dist_here;
-				graph.frontier = cr8r_pheap_meld(graph.frontier, &node->imeta, &node_pqft);
+				graph->frontier = cr8r_pheap_meld(graph->frontier, &node->imeta, &node_pqft);
 			}else if(dist_here < node->dist){// TODO: this is redundant for completed nodes
 				node->dist = dist_here;
-				graph.frontier = cr8r_pheap_decreased_key(&node->imeta, &node_pqft);
+				if(track_root){
+					cr8r_pheap_decrease(&graph->frontier, &node->imeta, &node_pqft);
+				}else{
+					graph->frontier = cr8r_pheap_decreased_key(&node->imeta, &node_pqft);
+				}
 			}
 		}
 	}
-	printf("Computed distance from College Farm Road to Allison Road: %f m\n", curr->dist);
+	return curr;
+}
+
+int main(int argc, char **argv){
+	if(argc != 2){
+		fprintf(stderr, "\e[1;31mPlease specify the file to read!\e[0m\n");
+		exit(EXIT_FAILURE);
+	}
+	graph graph = {.start_id=104314819, .target_id=104304705};
+	node_pqft.base.data = &graph.nodes;
+	read_file(argv[1], &graph);
+	clock_t t0 = clock();
+	double walk_dist = shortest_path(&graph, false)->dist;
+	clock_t t1 = clock();
+	double dist = shortest_path(&graph, true)->dist;
+	clock_t t2 = clock();
+	printf("Computed distance from College Farm Road to Allison Road: %f m\n", dist);
+	printf("Dijkstra took %.4fs finding the root on each decrease key, %.4fs tracking the root\n", (double)(t1 - t0)/CLOCKS_PER_SEC, (double)(t2 - t1)/CLOCKS_PER_SEC);
+	if(walk_dist != dist){
+		fprintf(stderr, "\e[1;31mDijkstra got different distances depending on how decrease key found the root!\e[0m\n");
+	}
+	// reference value from an independent implementation
+	if(fabs(dist - 6020.081138) > 1e-3){
+		fprintf(stderr, "\e[1;31mDijkstra got the wrong distance!\e[0m\n");
+	}
 	cr8r_sla_delete(&neighbor_sla);
 	cr8r_hash_destroy(&graph.edges, &edge_ft);
 	cr8r_hash_destroy(&graph.nodes, &node_ft);
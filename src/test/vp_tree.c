@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+
+#include <crater/kd_check.h>
+#include <crater/kd_tree.h>
+#include <crater/vp_tree.h>
+#include <crater/prand.h>
+
+#define NUM_POINTS 20000
+#define BOX_SIZE 2000
+#define NUM_QUERIES 200
+#define K 20
+#define RADIUS 100
+#define NUM_WORDS 5000
+#define WORD_CAP 16
+#define WORD_QUERIES 50
+
+static double dist_c3i64(const cr8r_vp_ft *ft, const void *a, const void *b){
+	return sqrt(cr8r_kdft_c3i64.sqdist(&cr8r_kdft_c3i64, a, b));
+}
+
+static cr8r_vp_ft vpft_c3i64 = {
+	.super.base.size = 3*sizeof(int64_t),
+	.super.new_size = cr8r_default_new_size,
+	.super.resize = cr8r_default_resize,
+	.super.swap = cr8r_default_swap,
+	.dist = dist_c3i64
+};
+
+// levenshtein distance between nul terminated strings stored in fixed size buffers
+static double dist_edit(const cr8r_vp_ft *ft, const void *_a, const void *_b){
+	const char *a = _a, *b = _b;
+	uint64_t n = strlen(b);
+	uint64_t row[WORD_CAP];
+	for(uint64_t j = 0; j <= n; ++j){
+		row[j] = j;
+	}
+	for(uint64_t i = 0; a[i]; ++i){
+		uint64_t diag = row[0];
+		row[0] = i + 1;
+		for(uint64_t j = 1; j <= n; ++j){
+			uint64_t next = diag + (a[i] != b[j - 1]);
+			if(row[j] + 1 < next){
+				next = row[j] + 1;
+			}
+			if(row[j - 1] + 1 < next){
+				next = row[j - 1] + 1;
+			}
+			diag = row[j];
+			row[j] = next;
+		}
+	}
+	return row[n];
+}
+
+static cr8r_vp_ft vpft_edit = {
+	.super.base.size = WORD_CAP,
+	.super.new_size = cr8r_default_new_size,
+	.super.resize = cr8r_default_resize,
+	.super.swap = cr8r_default_swap,
+	.dist = dist_edit
+};
+
+static int cmp_doubles(const void *_a, const void *_b){
+	double a = *(const double*)_a, b = *(const double*)_b;
+	return (a > b) - (a < b);
+}
+
+// check that a vp tree's k closest points are sorted and at the same distances as some reference k closest points
+static bool check_dists(const cr8r_vec *res, const cr8r_vec *expected, cr8r_vp_ft *ft, const void *pt){
+	if(res->len != expected->len){
+		return false;
+	}
+	double dists[expected->len];
+	for(uint64_t i = 0; i < expected->len; ++i){
+		dists[i] = ft->dist(ft, pt, expected->buf + i*ft->super.base.size);
+	}
+	qsort(dists, expected->len, sizeof(double), cmp_doubles);
+	for(uint64_t i = 0; i < res->len; ++i){
+		if(ft->dist(ft, pt, res->buf + i*ft->super.base.size) != dists[i]){
+			return false;
+		}
+	}
+	return true;
+}
+
+static void gen_word(cr8r_prng *prng, char *word){
+	uint64_t len = cr8r_prng_uniform_u64(prng, 6, WORD_CAP);
+	for(uint64_t i = 0; i < len; ++i){
+		word[i] = "acgt"[cr8r_prng_uniform_u64(prng, 0, 4)];
+	}
+	memset(word + len, 0, WORD_CAP - len);
+}
+
+static bool test_points(cr8r_prng *prng){
+	cr8r_vec points = {}, tree_points = {}, queries = {}, res1 = {}, res2 = {};
+	bool ok = cr8r_vec_init(&points, &vpft_c3i64.super, NUM_POINTS) && cr8r_vec_init(&queries, &vpft_c3i64.super, NUM_QUERIES);
+	ok = ok && cr8r_vec_init(&res1, &vpft_c3i64.super, K + 1) && cr8r_vec_init(&res2, &vpft_c3i64.super, K + 1);
+	for(uint64_t i = 0; i < NUM_POINTS + NUM_QUERIES && ok; ++i){
+		int64_t point[3];
+		for(uint64_t j = 0; j < 3; ++j){
+			point[j] = (int64_t)cr8r_prng_uniform_u64(prng, 0, BOX_SIZE + 1) - BOX_SIZE/2;
+		}
+		ok = cr8r_vec_pushr(i < NUM_POINTS ? &points : &queries, &vpft_c3i64.super, point);
+	}
+	cr8r_kdwin_s2i64 bounds;
+	ok = ok && cr8r_kdwin_bounding_i64x3(&bounds, &points, &cr8r_kdft_c3i64) && cr8r_vec_copy(&tree_points, &points, &vpft_c3i64.super);
+	if(!ok){
+		fprintf(stderr, "\e[1;31mERROR: Could not allocate points!\e[0m\n");
+		exit(1);
+	}
+	fprintf(stderr, "\e[1;34mBuilding vp tree of %d random lattice points within [-%d, %d]^3\e[0m\n", NUM_POINTS, BOX_SIZE/2, BOX_SIZE/2);
+	cr8r_vp_tree tree;
+	clock_t t0 = clock();
+	ok = cr8r_vp_build(&tree, &tree_points, &vpft_c3i64);
+	clock_t t1 = clock();
+	for(uint64_t i = 0; i < NUM_QUERIES && ok; ++i){
+		ok = cr8r_vp_k_closest(&tree, &tree_points, &vpft_c3i64, cr8r_vec_get(&queries, &vpft_c3i64.super, i), K, &res1);
+	}
+	clock_t t2 = clock();
+	for(uint64_t i = 0; i < NUM_QUERIES && ok; ++i){
+		ok = cr8r_kd_k_closest_naive(&points, &cr8r_kdft_c3i64, &bounds, cr8r_vec_get(&queries, &vpft_c3i64.super, i), K, &res2);
+	}
+	clock_t t3 = clock();
+	fprintf(stderr, "\e[1;34mvp tree: built in %.3fs, %d queries in %.3fs; naive: %d queries in %.3fs\e[0m\n", (double)(t1 - t0)/CLOCKS_PER_SEC, NUM_QUERIES, (double)(t2 - t1)/CLOCKS_PER_SEC, NUM_QUERIES, (double)(t3 - t2)/CLOCKS_PER_SEC);
+	for(uint64_t i = 0; i < NUM_QUERIES && ok; ++i){
+		const void *q = cr8r_vec_get(&queries, &vpft_c3i64.super, i);
+		ok = cr8r_vp_k_closest(&tree, &tree_points, &vpft_c3i64, q, K, &res1) && cr8r_kd_k_closest_naive(&points, &cr8r_kdft_c3i64, &bounds, q, K, &res2);
+		if(!ok || !check_dists(&res1, &res2, &vpft_c3i64, q)){
+			fprintf(stderr, "\e[1;31mvp_k_closest did not produce the same points as naive search!\e[0m\n");
+			ok = false;
+		}
+		uint64_t count = 0;
+		for(uint64_t j = 0; j < points.len; ++j){
+			if(dist_c3i64(&vpft_c3i64, q, cr8r_vec_get(&points, &vpft_c3i64.super, j)) <= RADIUS){
+				++count;
+			}
+		}
+		if(ok && (!cr8r_vp_within_radius(&tree, &tree_points, &vpft_c3i64, q, RADIUS, &res1) || res1.len != count || cr8r_vp_count_within_radius(&tree, &tree_points, &vpft_c3i64, q, RADIUS) != count)){
+			fprintf(stderr, "\e[1;31mvp_within_radius found the wrong number of points!\e[0m\n");
+			ok = false;
+		}
+		for(uint64_t j = 0; j < res1.len && ok; ++j){
+			ok = dist_c3i64(&vpft_c3i64, q, cr8r_vec_get(&res1, &vpft_c3i64.super, j)) <= RADIUS;
+		}
+	}
+	cr8r_vp_delete(&tree);
+	cr8r_vec_delete(&points, &vpft_c3i64.super);
+	cr8r_vec_delete(&tree_points, &vpft_c3i64.super);
+	cr8r_vec_delete(&queries, &vpft_c3i64.super);
+	cr8r_vec_delete(&res1, &vpft_c3i64.super);
+	cr8r_vec_delete(&res2, &vpft_c3i64.super);
+	return ok;
+}
+
+// edit distance has lots of ties, so only the distances of the k closest words can be compared, not the words themselves
+static bool test_words(cr8r_prng *prng){
+	cr8r_vec words = {}, tree_words = {}, res = {};
+	bool ok = cr8r_vec_init(&words, &vpft_edit.super, NUM_WORDS) && cr8r_vec_init(&res, &vpft_edit.super, K + 1);
+	for(uint64_t i = 0; i < NUM_WORDS && ok; ++i){
+		char word[WORD_CAP];
+		gen_word(prng, word);
+		ok = cr8r_vec_pushr(&words, &vpft_edit.super, word);
+	}
+	ok = ok && cr8r_vec_copy(&tree_words, &words, &vpft_edit.super);
+	cr8r_vp_tree tree;
+	fprintf(stderr, "\e[1;34mBuilding vp tree of %d random words under edit distance\e[0m\n", NUM_WORDS);
+	ok = ok && cr8r_vp_build(&tree, &tree_words, &vpft_edit);
+	if(!ok){
+		fprintf(stderr, "\e[1;31mERROR: Could not build vp tree of words!\e[0m\n");
+		exit(1);
+	}
+	for(uint64_t i = 0; i < WORD_QUERIES && ok; ++i){
+		char q[WORD_CAP];
+		gen_word(prng, q);
+		ok = cr8r_vp_k_closest(&tree, &tree_words, &vpft_edit, q, K, &res);
+		// check against the closest K of all words
+		double dists[NUM_WORDS];
+		for(uint64_t j = 0; j < NUM_WORDS; ++j){
+			dists[j] = dist_edit(&vpft_edit, q, cr8r_vec_get(&words, &vpft_edit.super, j));
+		}
+		qsort(dists, NUM_WORDS, sizeof(double), cmp_doubles);
+		for(uint64_t j = 0; j < K && ok; ++j){
+			ok = j < res.len && dist_edit(&vpft_edit, q, cr8r_vec_get(&res, &vpft_edit.super, j)) == dists[j];
+		}
+		uint64_t count = 0;
+		while(count < NUM_WORDS && dists[count] <= 3){
+			++count;
+		}
+		ok = ok && cr8r_vp_count_within_radius(&tree, &tree_words, &vpft_edit, q, 3) == count;
+	}
+	cr8r_vp_delete(&tree);
+	cr8r_vec_delete(&words, &vpft_edit.super);
+	cr8r_vec_delete(&tree_words, &vpft_edit.super);
+	cr8r_vec_delete(&res, &vpft_edit.super);
+	return ok;
+}
+
+int main(){
+	uint64_t tested = 0, passed = 0;
+	cr8r_prng *prng = cr8r_prng_init_lcg(0xd1b54a32d192ed03);
+	++tested;
+	if(test_points(prng)){
+		++passed;
+	}
+	++tested;
+	if(test_words(prng)){
+		++passed;
+	}else{
+		fprintf(stderr, "\e[1;31mvp tree queries under edit distance did not match brute force!\e[0m\n");
+	}
+
+	if(passed == tested){
+		fprintf(stderr, "\e[1;32mSuccess: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}else{
+		fprintf(stderr, "\e[1;31mFailed: passed %"PRIu64"/%"PRIu64" tests\e[0m\n", passed, tested);
+	}
+	free(prng);
+}
+